@@ -49,13 +49,83 @@ extern "C"
 /// A normal header field.
 typedef struct
 {
-    char* key; /// The key (name) for this field. Should be capitalized.
+    char* key; /// The key (name) for this field. Within an instance, it points at the interned name, which must not be modified.
     char* value; /// The value of this field. It must not contain newlines.
 } hypertext_Header_Field;
 
+/// A read-only reference to a range of characters owned by someone else.
+typedef struct
+{
+    const char* data; /// The first character of the range. It is not null-terminated.
+    size_t length; /// The amount of characters within the range.
+} hypertext_View;
+
+/// A single name/value pair of a query string or an urlencoded form. Both views are still percent-encoded.
+typedef struct
+{
+    hypertext_View name; /// The parameter's name.
+    hypertext_View value; /// The parameter's value; empty if the pair didn't contain a '='.
+} hypertext_Parameter;
+
+/// A header field along with the lengths of its name and value; the value can hold any character but line breaks, including null characters.
+typedef struct
+{
+    hypertext_View name; /// The field's name.
+    hypertext_View value; /// The field's value.
+} hypertext_Field;
+
+/// An inclusive range of bytes within a representation, as per RFC 9110, section 14.1.1.
+typedef struct
+{
+    uint64_t first; /// The position of the first byte.
+    uint64_t last; /// The position of the last byte; never before first.
+} hypertext_Range;
+
+/// A piece of a body, either in memory or within a file; the pieces of a body are sent in order, i.e. through writev and sendfile.
+typedef struct
+{
+    const char* data; /// The piece's characters, or NULL if it's read from descriptor.
+    int descriptor; /// The file to read from if data is NULL; -1 otherwise.
+    uint64_t offset; /// Where the piece starts within the file; 0 if it's in memory.
+    size_t length; /// The amount of characters within the piece.
+} hypertext_Segment;
+
 /// An instance stored as an opaque structure; contains any required data.
 typedef struct hypertext_Instance hypertext_Instance;
 
+/// An immutable, reference-counted copy of an instance stored as an opaque structure; any amount of threads can read and output it at once.
+typedef struct hypertext_Frozen hypertext_Frozen;
+
+/// A shared cache of frozen responses stored as an opaque structure; any amount of threads can look up and store at once.
+typedef struct hypertext_Cache hypertext_Cache;
+
+/// The receiving side of an HTTP/1.x connection stored as an opaque structure; buffers what arrives and splits it into requests.
+typedef struct hypertext_Connection hypertext_Connection;
+
+/// A set of routes stored as an opaque structure; compiled into a radix tree before use.
+typedef struct hypertext_Router hypertext_Router;
+
+/// A HPACK (RFC 7541) compression context stored as an opaque structure; holds the dynamic table of one direction of a connection.
+typedef struct hypertext_HPACK hypertext_HPACK;
+
+/// An HTTP/2 server connection stored as an opaque structure; turns frames into request instances and response instances back into frames.
+typedef struct hypertext_Session hypertext_Session;
+
+#ifdef hypertext_ENCODING
+/// A Content-Encoding stage stored as an opaque structure; turns a response into its head and compressed body windows.
+typedef struct hypertext_Encoder hypertext_Encoder;
+
+/// Content codings supported by the encoding stage.
+enum hypertext_Content_Encoding
+{
+    hypertext_Content_Encoding_Identity, /// No transformation.
+    hypertext_Content_Encoding_Gzip, /// The gzip format, as per RFC 1952. "x-gzip" is understood as well.
+    hypertext_Content_Encoding_Deflate, /// The zlib format, as per RFC 1950.
+
+    hypertext_Content_Encoding_Max /// Used for error checking.
+};
+#endif
+
 /// Different types of contents held within an instance.
 enum hypertext_Instance_Content_Type
 {
@@ -79,7 +149,61 @@ enum hypertext_Method
     hypertext_Method_TRACE, /// Used to figure out the recipient's identity.
     hypertext_Method_CONNECT, /// Used for proxying / switching to being a tunnel (e.g. SSL tunneling).
 
-    hypertext_Method_Max /// Used for error checking.
+    hypertext_Method_Max, /// Used for error checking. Methods registered via hypertext_Register_Method are numbered above this value.
+
+    hypertext_Method_Extension = UINT8_MAX /// A valid, but unregistered method token; use hypertext_Fetch_Method_Token to read it.
+};
+
+/// The components of a request target, as per RFC 3986.
+enum hypertext_Target_Component
+{
+    hypertext_Target_Component_Path, /// Everything in front of the first '?' or '#'.
+    hypertext_Target_Component_Query, /// Everything between the first '?' and the following '#', without both.
+    hypertext_Target_Component_Fragment, /// Everything behind the first '#', without it.
+
+    hypertext_Target_Component_Max /// Used for error checking.
+};
+
+/// Sources that can hold "application/x-www-form-urlencoded" parameters.
+enum hypertext_Parameter_Source
+{
+    hypertext_Parameter_Source_Query, /// The query component of the request target.
+    hypertext_Parameter_Source_Body, /// The body of the instance.
+
+    hypertext_Parameter_Source_Max /// Used for error checking.
+};
+
+/// Limits of the router.
+enum hypertext_Route_Limit
+{
+    hypertext_Route_Max_Captures = 16 /// The maximum amount of ":name" and "*name" captures within a single route.
+};
+
+/// The result of matching a request against a router.
+typedef struct
+{
+    void* data; /// The data passed to hypertext_Add_Route for the matching route.
+    size_t capture_count; /// The amount of captures set.
+    hypertext_Parameter captures[hypertext_Route_Max_Captures]; /// The captures, in the order they appear in the route. The values are views into the request's path, still percent-encoded.
+} hypertext_Route_Match;
+
+/// HTTP/2 error codes, as per RFC 9113, section 7.
+enum hypertext_Session_Error
+{
+    hypertext_Session_Error_None, /// Graceful shutdown.
+    hypertext_Session_Error_Protocol, /// The peer violated the protocol.
+    hypertext_Session_Error_Internal, /// An internal error, i.e. an allocation failed.
+    hypertext_Session_Error_Flow_Control, /// The peer violated flow control.
+    hypertext_Session_Error_Settings_Timeout, /// The peer didn't acknowledge the settings in time.
+    hypertext_Session_Error_Stream_Closed, /// A frame arrived on a stream that was already half-closed.
+    hypertext_Session_Error_Frame_Size, /// A frame had an invalid size.
+    hypertext_Session_Error_Refused_Stream, /// The stream was refused before any processing happened.
+    hypertext_Session_Error_Cancel, /// The stream isn't needed anymore.
+    hypertext_Session_Error_Compression, /// The header compression context can't be maintained anymore.
+    hypertext_Session_Error_Connect, /// The connection of a CONNECT request was reset or closed.
+    hypertext_Session_Error_Enhance_Your_Calm, /// The peer generates excessive load.
+    hypertext_Session_Error_Inadequate_Security, /// The underlying transport doesn't meet the security requirements.
+    hypertext_Session_Error_HTTP_1_1_Required /// HTTP/1.1 has to be used instead.
 };
 
 /** \brief Different return codes. */
@@ -101,6 +225,11 @@ enum hypertext_Result
     hypertext_Result_Not_Found, /// The specific header field doesn't exist.
     hypertext_Result_Already_Present, /// An another header field with the same key exists already.
     hypertext_Result_No_Body, /// The instance does not contain a body.
+    hypertext_Result_Out_Of_Memory, /// An allocation failed or a fixed-size table is full.
+    hypertext_Result_Incomplete, /// The operation made progress, but has to be called again to finish; i.e. a non-blocking socket is full.
+    hypertext_Result_Unsupported, /// The operation isn't supported on this platform or for the given input.
+    hypertext_Result_IO_Error, /// A system call failed; errno tells why.
+    hypertext_Result_Not_Satisfiable, /// None of the requested ranges overlap the representation.
 
     hypertext_Result_Unknown = UINT8_MAX /// Unknown or unset result; mostly used within a freshly created instance.
 };
@@ -215,6 +344,58 @@ hypertext_EXPORT uint8_t hypertext_API hypertext_Create_Request(hypertext_Instan
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Create_Response(hypertext_Instance* instance, uint8_t version, uint16_t code, hypertext_Header_Field* fields, size_t field_count, const char* body, size_t body_length);
 
+/** \brief Initializes the instance as a new request, taking fields along with their lengths.
+ *
+ * \param instance The instance to use.
+ * \param method The method used in the request.
+ * \param path The absolute path to the file.
+ * \param path_length The length of the path.
+ * \param version The HTTP version this request supports.
+ * \param fields All header fields; names have to be tokens and values can't contain line breaks.
+ * \param field_count The field count.
+ * \param body The body's content.
+ * \param body_length The body's length.
+ *
+ * \note Works like hypertext_Create_Request, but the fields are copied into the instance, so they don't have to outlive it.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Create_Request_Fields(hypertext_Instance* instance, uint8_t method, const char* path, size_t path_length, uint8_t version, const hypertext_Field* fields, size_t field_count, const char* body, size_t body_length);
+
+/** \brief Initializes the instance as a new response, taking fields along with their lengths.
+ *
+ * \param instance The instance to use.
+ * \param version The HTTP version this response supports.
+ * \param code The response code.
+ * \param fields All header fields; names have to be tokens and values can't contain line breaks.
+ * \param field_count The field count.
+ * \param body The body's content.
+ * \param body_length The body's length.
+ *
+ * \note Works like hypertext_Create_Response, but the fields are copied into the instance, so they don't have to outlive it.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Create_Response_Fields(hypertext_Instance* instance, uint8_t version, uint16_t code, const hypertext_Field* fields, size_t field_count, const char* body, size_t body_length);
+
+/** \brief Initializes the instance as the minimal response to a failed precondition, without a body.
+ *
+ * \param instance The instance to use.
+ * \param request The request the response answers; its version is used.
+ * \param code Either hypertext_Status_Not_Modified or hypertext_Status_Precondition_Failed, as given by hypertext_Evaluate_Conditions.
+ * \param entity_tag The representation's entity tag, sent with a 304; can be NULL.
+ * \param last_modified The representation's Last-Modified date, sent with a 304; can be NULL.
+ *
+ * \note Like any other fields, entity_tag and last_modified aren't copied and have to outlive the instance.
+ * \note Other fields a 200 would carry, like Cache-Control or Vary, can be added afterwards.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Create_Conditional_Response(hypertext_Instance* instance, hypertext_Instance* request, uint16_t code, const char* entity_tag, const char* last_modified);
+
 /** \brief Parses a raw request coming from a UTF-8 character array.
  *
  * \param instance The instance to use.
@@ -245,6 +426,82 @@ hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Request(hypertext_Instanc
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Response(hypertext_Instance* instance, const char* input, size_t length);
 
+/** \brief Parses one raw request from a buffer that doesn't need to be null-terminated, i.e. a socket buffer or a mapped file.
+ *
+ * \param instance The instance to use.
+ * \param input The input to parse; it can hold more than one message.
+ * \param size The amount of characters within input.
+ * \param consumed Set to the length of the message, to find the next one; can be NULL.
+ *
+ * \note The body is framed by Transfer-Encoding or Content-Length; chunked bodies are decoded.
+ * \note hypertext_Result_Incomplete is returned if input ends before the message does; parse again once more input arrived.
+ * \note The instance is left empty if parsing fails, so it can be used again right away.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Request_Buffer(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed);
+
+/** \brief Parses one raw request from a buffer, leaving its header fields to be split the first time they're needed.
+ *
+ * \param instance The instance to use.
+ * \param input The input to parse; it can hold more than one message.
+ * \param size The amount of characters within input.
+ * \param consumed Set to the length of the message, to find the next one; can be NULL.
+ *
+ * \note Works like hypertext_Parse_Request_Buffer and rejects the same requests, but only keeps a copy of the header block; requests that are answered from their request line alone never pay for splitting, interning and merging their fields.
+ * \note Requests carrying Content-Length or Transfer-Encoding have their fields split right away, as their body can't be framed otherwise.
+ * \note Any call reading or changing the fields splits them first, and can therefore return hypertext_Result_Out_Of_Memory.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Request_Lazy(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed);
+
+/** \brief Parses one raw response from a buffer that doesn't need to be null-terminated.
+ *
+ * \param instance The instance to use.
+ * \param input The input to parse; it can hold more than one message.
+ * \param size The amount of characters within input.
+ * \param consumed Set to the length of the message, to find the next one; can be NULL.
+ *
+ * \note Works like hypertext_Parse_Request_Buffer. 1xx, 204 and 304 responses never have a body; a response without any framing lasts until the end of input.
+ * \note Responses to HEAD requests can't be told apart from the response alone; they have to be parsed with the request in mind.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Response_Buffer(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed);
+
+/** \brief Parses one raw request to be passed on, remembering where it came from so hypertext_Output_Forward can reuse the received characters.
+ *
+ * \param instance The instance to use.
+ * \param input The input to parse; it can hold more than one message.
+ * \param size The amount of characters within input.
+ * \param consumed Set to the length of the message, to find the next one; can be NULL.
+ *
+ * \note Works like hypertext_Parse_Request_Buffer. input isn't copied and has to stay unchanged until the instance is destroyed.
+ * \note Field changes and hypertext_Set_Path are recorded as edits of the original. The method, version and body can't be changed; hypertext_Result_Unsupported is returned for those.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Request_Forward(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed);
+
+/** \brief Parses one raw response to be passed on, remembering where it came from so hypertext_Output_Forward can reuse the received characters.
+ *
+ * \param instance The instance to use.
+ * \param input The input to parse; it can hold more than one message.
+ * \param size The amount of characters within input.
+ * \param consumed Set to the length of the message, to find the next one; can be NULL.
+ *
+ * \note Works like hypertext_Parse_Response_Buffer and hypertext_Parse_Request_Forward; the status code can't be changed either.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Response_Forward(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed);
+
 /** \brief Takes the request contents stored within the instance and pushes it into "output".
  *
  * \param instance The instance to use.
@@ -278,24 +535,156 @@ hypertext_EXPORT uint8_t hypertext_API hypertext_Output_Request(hypertext_Instan
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Output_Response(hypertext_Instance* instance, char* output, size_t* length, bool keep_desc, bool keep_compat);
 
+/** \brief Outputs only the head of a response, with the Content-Length field set to the body's length.
+ *
+ * \param instance The instance to use.
+ * \param output The output variable.
+ * \param length The length of the head to return or to process.
+ * \param keep_desc Whether to keep the status description.
+ * \param keep_compat Whether to use CRLF line endings.
+ *
+ * \note Works like hypertext_Output_Response; any Content-Length or Transfer-Encoding fields of the instance are replaced.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Output_Response_Head(hypertext_Instance* instance, char* output, size_t* length, bool keep_desc, bool keep_compat);
+
+/** \brief Fetches the pieces of a forwarded message, for sending them through writev or similar.
+ *
+ * \param instance The instance to use; it must have been parsed with hypertext_Parse_Request_Forward or hypertext_Parse_Response_Forward.
+ * \param output The output variable; can be NULL to fetch the amount of pieces.
+ * \param count The amount of pieces output can hold; set to the amount of pieces the message is made of.
+ *
+ * \note Untouched parts of the message point into the parsed input, so sending costs depend on what was changed rather than on the message's size.
+ * \note Replaced fields keep their position and added fields go last, both with CRLF line endings. The body is passed on as it was received.
+ * \note Pieces of added fields point at their values, which have to outlive the output like they outlive the instance.
+ *
+ * \return hypertext_Result_Unsupported if the instance wasn't parsed for forwarding, hypertext_Result_Invalid_Parameters if output can't hold all pieces; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Output_Forward(hypertext_Instance* instance, hypertext_View* output, size_t* count);
+
+/** \brief Writes the body to a socket or any other descriptor; file bodies are sent via sendfile on Linux.
+ *
+ * \param instance The instance to use.
+ * \param descriptor The descriptor to write to.
+ * \param offset How much of the body was sent already; start with 0. It's updated as the body is sent.
+ *
+ * \note Non-blocking descriptors return hypertext_Result_Incomplete once they're full; call this again once they're writable.
+ * \note This isn't supported on Windows.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Send_Body(hypertext_Instance* instance, int descriptor, size_t* offset);
+
+/** \brief Fetches the pieces the body is made of, for sending them through writev, sendfile or similar.
+ *
+ * \param instance The instance to use.
+ * \param output The output variable; can be NULL to fetch the amount of pieces.
+ * \param count The amount of pieces output can hold; set to the amount of pieces written.
+ *
+ * \note A plain body is a single piece; ranged responses are made of several.
+ * \note The pieces point into the instance and stay valid until its body is changed.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Segments(hypertext_Instance* instance, hypertext_Segment* output, size_t* count);
+
 /** \brief Adds a header field to the instance.
  * \param instance The instance to use.
  * \param input The header field to add.
  *
- * \return A normal return code.
+ * \note The key is replaced by its interned name; the value isn't copied and has to outlive the instance.
+ * \note Names are compared case-insensitively.
+ *
+ * \return hypertext_Result_Already_Present if a field with the same name exists; otherwise a normal return code.
  * \sa hypertext_Result.
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Add_Field(hypertext_Instance* instance, hypertext_Header_Field* input);
 
-/** \brief Removes a header field from the instance.
+/** \brief Adds several header fields to the instance at once.
+ * \param instance The instance to use.
+ * \param input The header fields to add.
+ * \param count The amount of fields within input.
+ *
+ * \note Either all fields are added or none; room for them is made once.
+ * \note Like with hypertext_Add_Field, keys are replaced by their interned names and values aren't copied.
+ *
+ * \return hypertext_Result_Already_Present if a name exists already or appears twice within input; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Add_Fields(hypertext_Instance* instance, hypertext_Header_Field* input, size_t count);
+
+/** \brief Adds another occurrence of a header field, even if fields with the same name exist; i.e. for Set-Cookie.
+ * \param instance The instance to use.
+ * \param input The header field to add.
+ *
+ * \note The field goes after all others. Like with hypertext_Add_Field, the key is interned and the value isn't copied.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Add_Repeated_Field(hypertext_Instance* instance, hypertext_Header_Field* input);
+
+/** \brief Sets a header field, replacing the value of a field with the same name or adding it if there's none.
  * \param instance The instance to use.
- * \param input The name of the field to remove.
+ * \param input The header field to set.
+ *
+ * \note A replaced field keeps its position; any later fields with the same name are removed. Like with hypertext_Add_Field, the value isn't copied.
  *
  * \return A normal return code.
  * \sa hypertext_Result.
  */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Set_Field(hypertext_Instance* instance, hypertext_Header_Field* input);
+
+/** \brief Removes a header field from the instance, along with every other occurrence of its name.
+ * \param instance The instance to use.
+ * \param input The name of the field to remove, in any case.
+ *
+ * \return hypertext_Result_Not_Found if there's no such field; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Remove_Field(hypertext_Instance* instance, const char* input);
 
+/** \brief Removes the hop-by-hop fields a proxy mustn't pass on: Connection, the fields it names, Keep-Alive, Proxy-Connection, TE and Upgrade.
+ * \param instance The instance to use.
+ *
+ * \note Host, Content-Length and Transfer-Encoding stay even if Connection names them, since the body is passed on with its framing.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Strip_Hop_Fields(hypertext_Instance* instance);
+
+/** \brief Adds a header field given along with its lengths to the instance.
+ * \param instance The instance to use.
+ * \param input The header field to add; its name has to be a token and its value can't contain line breaks.
+ *
+ * \note Unlike hypertext_Add_Field, the field is copied into the instance.
+ *
+ * \return hypertext_Result_Already_Present if a field with the same name exists; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Append_Field(hypertext_Instance* instance, const hypertext_Field* input);
+
+/** \brief Fetches the interned copy of a header field name.
+ *
+ * \param input The name, which doesn't need to be null-terminated.
+ * \param length The length of the name.
+ * \param output Set to the interned name; it stays valid until the process ends.
+ *
+ * \note Every spelling of a name maps to the same copy, so interned names can be compared by pointer; the fields of parsed and created instances point at them.
+ * \note Standard names are interned with their usual capitalization, i.e. "content-length" becomes "Content-Length".
+ * \note The table is shared by all threads and bounded; once it is full, names that aren't in it yet keep their own copies and are compared by content.
+ *
+ * \return hypertext_Result_Out_Of_Memory if the table is full, hypertext_Result_Unsupported if the name is too long to be interned; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Intern_Name(const char* input, size_t length, const char** output);
+
 /** \brief Returns the request's method.
  * \param instance The instance to use.
  * \param output The output variable.
@@ -305,6 +694,17 @@ hypertext_EXPORT uint8_t hypertext_API hypertext_Remove_Field(hypertext_Instance
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Method(hypertext_Instance* instance, uint8_t* output);
 
+/** \brief Returns the textual token of the request's method.
+ * \param instance The instance to use.
+ * \param output The output variable.
+ *
+ * \note The view stays valid until the instance is destroyed or its method is changed.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Method_Token(hypertext_Instance* instance, hypertext_View* output);
+
 /** \brief Returns the request's path.
  * \param instance The instance to use.
  * \param output The output variable.
@@ -317,75 +717,784 @@ hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Method(hypertext_Instance
  */
 hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Path(hypertext_Instance* instance, char* output, size_t* length);
 
-/** \brief Returns the used version of the response/request stored inside.
+/** \brief Returns one component of the request's target, exactly as it was received.
  * \param instance The instance to use.
+ * \param component The component to return.
  * \param output The output variable.
  *
+ * \note The component boundaries are recorded while the request line is scanned; this doesn't scan the target again.
+ * \note The view stays valid until the instance is destroyed or its path is changed.
+ * \note hypertext_Result_Not_Found is returned if the target doesn't contain a query or fragment; an empty one is still found.
+ *
  * \return A normal return code.
  * \sa hypertext_Result.
+ * \sa hypertext_Target_Component.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Version(hypertext_Instance* instance, uint8_t* output);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Target_Component(hypertext_Instance* instance, uint8_t component, hypertext_View* output);
 
-/** \brief Returns the response's return code.
+/** \brief Returns one component of the request's target with percent-encoding undone.
  * \param instance The instance to use.
+ * \param component The component to return.
  * \param output The output variable.
  *
+ * \note The component is decoded on first access and cached within the instance; components without any escapes aren't copied at all.
+ * \note Within the query, '+' is decoded to a space as well.
+ * \note The view stays valid until the instance is destroyed or its path is changed.
+ *
  * \return A normal return code.
  * \sa hypertext_Result.
+ * \sa hypertext_Target_Component.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Code(hypertext_Instance* instance, uint16_t* output);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Decoded_Target_Component(hypertext_Instance* instance, uint8_t component, hypertext_View* output);
 
-/** \brief Fetches a header field based on its key.
+/** \brief Returns the amount of urlencoded parameters within a source.
  * \param instance The instance to use.
- * \param output The output variable.
- * \param key_name The name to search for.
+ * \param source The source to read the parameters from.
+ * \param count The output variable.
+ *
+ * \note The first call per source builds an index which is cached within the instance; all parameter functions share it.
+ * \note The body is only accepted if the instance doesn't have a "Content-Type" header field or if it is "application/x-www-form-urlencoded".
  *
  * \return A normal return code.
  * \sa hypertext_Result.
+ * \sa hypertext_Parameter_Source.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Header_Field(hypertext_Instance* instance, hypertext_Header_Field* output, const char* key_name);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Parameter_Count(hypertext_Instance* instance, uint8_t source, size_t* count);
 
-/** \brief Returns the amount of header fields.
+/** \brief Returns a urlencoded parameter based on its position.
  * \param instance The instance to use.
- * \param count The output variable.
+ * \param source The source to read the parameters from.
+ * \param index The position of the parameter, in the order they were received.
+ * \param output The output variable.
+ *
+ * \note The views stay valid until the instance is destroyed or the source is changed.
  *
  * \return A normal return code.
  * \sa hypertext_Result.
+ * \sa hypertext_Parameter_Source.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Header_Field_Count(hypertext_Instance* instance, size_t* count);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Parameter(hypertext_Instance* instance, uint8_t source, size_t index, hypertext_Parameter* output);
 
-/** \brief Returns the body of the request/response.
+/** \brief Looks up a urlencoded parameter by its decoded name.
  * \param instance The instance to use.
+ * \param source The source to read the parameters from.
+ * \param name The decoded name to search for.
+ * \param length The length of the name.
+ * \param index The position to start searching at; receives the position of the parameter that was found.
+ *
+ * \note Set index to 0 to find the first occurrence; to find repeated parameters, call this again with the last position plus one.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ * \sa hypertext_Fetch_Parameter.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Find_Parameter(hypertext_Instance* instance, uint8_t source, const char* name, size_t length, size_t* index);
+
+/** \brief Undoes percent-encoding within a view, e.g. a parameter name or value.
+ * \param input The view to decode.
  * \param output The output variable.
- * \param length The length of the body to return or to process.
+ * \param length The length of the output variable.
+ * \param plus_as_space Whether '+' should be decoded to a space, as done within urlencoded forms.
  *
  * \note If output is NULL, the length will be overwritten. Use this to fetch the length.
+ * \note The output isn't null-terminated.
  *
  * \return A normal return code.
  * \sa hypertext_Result.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Body(hypertext_Instance* instance, char* output, size_t* length);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Decode_View(const hypertext_View* input, char* output, size_t* length, bool plus_as_space);
 
-/** \brief Returns the internal type of the instance.
+/** \brief Returns the used version of the response/request stored inside.
  * \param instance The instance to use.
- * \param type The output variable.
+ * \param output The output variable.
  *
  * \return A normal return code.
  * \sa hypertext_Result.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Type(hypertext_Instance* instance, uint8_t* type);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Version(hypertext_Instance* instance, uint8_t* output);
 
-/** \brief Sets a new body.
+/** \brief Returns the response's return code.
  * \param instance The instance to use.
- * \param body The body to use.
- * \param length The length of the body to use.
+ * \param output The output variable.
  *
- * \note The body cannot be NULL and the length must be greater than 0.
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Code(hypertext_Instance* instance, uint16_t* output);
+
+/** \brief Fetches a header field based on its key.
+ * \param instance The instance to use.
+ * \param output The output variable.
+ * \param key_name The name to search for, in any case.
+ *
+ * \note If the name was repeated, this is its first occurrence; see hypertext_Fetch_Field_Values and hypertext_Fetch_Joined_Field for the others.
  *
  * \return A normal return code.
  * \sa hypertext_Result.
  */
-hypertext_EXPORT uint8_t hypertext_API hypertext_Set_Body(hypertext_Instance* instance, const char* body, size_t length);
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Header_Field(hypertext_Instance* instance, hypertext_Header_Field* output, const char* key_name);
+
+/** \brief Returns the header field at the given position, i.e. to walk all of them.
+ * \param instance The instance to use.
+ * \param index The position of the field; below the amount returned by hypertext_Fetch_Header_Field_Count.
+ * \param output The output variable.
+ *
+ * \return hypertext_Result_Not_Found if index is out of range; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Header_Field_At(hypertext_Instance* instance, size_t index, hypertext_Header_Field* output);
+
+/** \brief Fetches a header field along with its lengths based on its name.
+ * \param instance The instance to use.
+ * \param name The name to search for, in any case; it doesn't need to be null-terminated.
+ * \param length The length of the name.
+ * \param output The output variable; the views point into the instance.
+ *
+ * \note The lengths were measured when the field was parsed or created, so nothing is measured again.
+ * \note Repeated fields are kept apart in the order they arrived; this returns the first one.
+ *
+ * \return hypertext_Result_Not_Found if there's no such field; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Field(hypertext_Instance* instance, const char* name, size_t length, hypertext_Field* output);
+
+/** \brief Fetches several header fields at once, walking the fields a single time instead of once per name.
+ * \param instance The instance to use.
+ * \param names The names to search for, in any case.
+ * \param count The amount of names.
+ * \param output The output variable; holds one field per name, in the same order.
+ *
+ * \note Like with hypertext_Fetch_Field, each name gets its first occurrence; a name that isn't present gets empty views, while the others are still filled in.
+ * \note Names returned by hypertext_Intern_Name aren't looked up again, so interning the names once up front saves most of the work.
+ *
+ * \return hypertext_Result_Not_Found if any of the names isn't present; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Fields(hypertext_Instance* instance, const hypertext_View* names, size_t count, hypertext_Field* output);
+
+/** \brief Walks the header fields in the order they arrived, either all of them or every occurrence of one name.
+ * \param instance The instance to use.
+ * \param name The name to search for, in any case; NULL to walk all fields.
+ * \param length The length of the name.
+ * \param position Where to continue; start with 0. It's moved past the field returned.
+ * \param output The output variable; the views point into the instance.
+ *
+ * \return hypertext_Result_Not_Found once there are no more fields; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Find_Next_Field(hypertext_Instance* instance, const char* name, size_t length, size_t* position, hypertext_Field* output);
+
+/** \brief Fetches the values of every field with the given name, in the order they arrived, without copying them.
+ * \param instance The instance to use.
+ * \param name The name to search for, in any case.
+ * \param length The length of the name.
+ * \param output The output variable; can be NULL to fetch the amount of values.
+ * \param count The amount of values output can hold; set to the amount of values written.
+ *
+ * \return hypertext_Result_Not_Found if there's no such field; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Field_Values(hypertext_Instance* instance, const char* name, size_t length, hypertext_View* output, size_t* count);
+
+/** \brief Joins the values of every field with the given name with ", ", as per RFC 9110, section 5.3.
+ * \param instance The instance to use.
+ * \param name The name to search for, in any case.
+ * \param length The length of the name.
+ * \param output The output variable; can be NULL to fetch the length. It isn't null-terminated.
+ * \param output_length The amount of characters output can hold; set to the length of the joined values.
+ *
+ * \note Set-Cookie fields can't be joined without changing their meaning; hypertext_Result_Unsupported is returned for those.
+ *
+ * \return hypertext_Result_Not_Found if there's no such field, hypertext_Result_Invalid_Parameters if output is too short; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Joined_Field(hypertext_Instance* instance, const char* name, size_t length, char* output, size_t* output_length);
+
+/** \brief Returns the header field at the given position along with its lengths.
+ * \param instance The instance to use.
+ * \param index The position of the field; below the amount returned by hypertext_Fetch_Header_Field_Count.
+ * \param output The output variable; the views point into the instance.
+ *
+ * \return hypertext_Result_Not_Found if index is out of range; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Field_At(hypertext_Instance* instance, size_t index, hypertext_Field* output);
+
+/** \brief Returns the amount of header fields.
+ * \param instance The instance to use.
+ * \param count The output variable.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Header_Field_Count(hypertext_Instance* instance, size_t* count);
+
+/** \brief Formats a time as an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", for Date, Last-Modified or Expires fields.
+ *
+ * \param time The time, in seconds since the Unix epoch; it has to be before the year 10000.
+ * \param output The output character array; must hold at least 30 characters, the last one being the null terminator.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Format_Date(uint64_t time, char* output);
+
+/** \brief Fetches the current time as an IMF-fixdate, formatted at most once per second and thread.
+ *
+ * \param output The output variable; null-terminated and owned by the calling thread.
+ *
+ * \note The content changes on the thread's next call in a later second, so copy it if the field has to outlive that or the thread.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Current_Date(hypertext_View* output);
+
+/** \brief Parses an HTTP date in any of the three formats of RFC 9110, section 5.6.7, without allocating.
+ *
+ * \param input The date, e.g. "Sun, 06 Nov 1994 08:49:37 GMT", "Sunday, 06-Nov-94 08:49:37 GMT" or "Sun Nov  6 08:49:37 1994".
+ * \param length The date's length.
+ * \param output Set to the time, in seconds since the Unix epoch.
+ *
+ * \note Dates before 1970 are rejected; two-digit years are read as 1970 to 2069.
+ *
+ * \return hypertext_Result_Invalid_Parameters if the date is malformed; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Parse_Date(const char* input, size_t length, uint64_t* output);
+
+/** \brief Evaluates a request's preconditions against the current representation, as per RFC 9110, section 13.2.2.
+ *
+ * \param request The request to use.
+ * \param entity_tag The representation's entity tag, including the quotes; can be NULL.
+ * \param last_modified The representation's Last-Modified date, as sent; can be NULL.
+ * \param output Set to 0 if the request should be handled as usual, otherwise to hypertext_Status_Not_Modified or hypertext_Status_Precondition_Failed.
+ *
+ * \note Call this before generating the body and before hypertext_Fetch_Ranges; if output isn't 0, hypertext_Create_Conditional_Response builds the whole response.
+ * \note Invalid dates make their condition be ignored.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Evaluate_Conditions(hypertext_Instance* request, const char* entity_tag, const char* last_modified, uint16_t* output);
+
+/** \brief Fetches the byte ranges a GET request asks for, validated against the representation and coalesced.
+ *
+ * \param request The request to use.
+ * \param size The length of the selected representation.
+ * \param entity_tag The representation's entity tag, including the quotes; can be NULL.
+ * \param last_modified The representation's Last-Modified date, as sent; can be NULL.
+ * \param output The output variable; sorted and without overlaps.
+ * \param count The amount of ranges output can hold; set to the amount of ranges found.
+ *
+ * \note count is set to 0 if the full representation should be sent instead: there's no Range field, it's malformed, an If-Range field doesn't match or there are more ranges than fit into output.
+ *
+ * \return hypertext_Result_Not_Satisfiable if no range overlaps the representation; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Ranges(hypertext_Instance* request, uint64_t size, const char* entity_tag, const char* last_modified, hypertext_Range* output, size_t* count);
+
+/** \brief Returns the body of the request/response.
+ * \param instance The instance to use.
+ * \param output The output variable.
+ * \param length The length of the body to return or to process.
+ *
+ * \note If output is NULL, the length will be overwritten. Use this to fetch the length.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Body(hypertext_Instance* instance, char* output, size_t* length);
+
+/** \brief Returns the internal type of the instance.
+ * \param instance The instance to use.
+ * \param type The output variable.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Type(hypertext_Instance* instance, uint8_t* type);
+
+/** \brief Registers an additional method token, like PATCH or a WebDAV method.
+ * \param token The method token, e.g. "PATCH".
+ * \param length The length of the token.
+ * \param output The output variable, receives the method's identifier.
+ *
+ * \note Registered methods are recognized by the parser and accepted by hypertext_Create_Request and hypertext_Set_Method.
+ * \note Registration isn't thread-safe; register all methods during startup, before any instance is parsed or created.
+ * \note Registering an already known token returns hypertext_Result_Already_Present and still sets output.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Register_Method(const char* token, size_t length, uint8_t* output);
+
+/** \brief Copies an instance into one immutable block, along with its output, for sharing it between threads.
+ *
+ * \param instance The instance to freeze; it's left as is and still owned by the caller.
+ * \param keep_desc Whether the stored output of a response contains the status description.
+ * \param keep_compat Whether the stored output uses CRLF line endings.
+ * \param output Set to the frozen copy, holding one reference.
+ *
+ * \note Anything that's otherwise computed on first use, like decoded target components and parameters, is computed beforehand, so reading never writes to the copy.
+ * \note File bodies and ranged responses can't be frozen; hypertext_Result_Unsupported is returned for those.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Freeze(hypertext_Instance* instance, bool keep_desc, bool keep_compat, hypertext_Frozen** output);
+
+/** \brief Adds a reference to a frozen instance; safe to call from any thread.
+ *
+ * \param frozen The frozen instance to use.
+ *
+ * \return frozen, for convenience.
+ */
+hypertext_EXPORT hypertext_Frozen* hypertext_API hypertext_Acquire_Frozen(hypertext_Frozen* frozen);
+
+/** \brief Drops a reference to a frozen instance and frees it once the last one is gone; safe to call from any thread.
+ *
+ * \param frozen The frozen instance to use.
+ */
+hypertext_EXPORT void hypertext_API hypertext_Release_Frozen(hypertext_Frozen* frozen);
+
+/** \brief Fetches the instance within a frozen instance, for use with the fetching and output functions.
+ *
+ * \param frozen The frozen instance to use.
+ * \param output The output variable; valid as long as a reference is held.
+ *
+ * \note Modifying functions return hypertext_Result_Invalid_Instance for it, and hypertext_Destroy does nothing.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Frozen_Instance(hypertext_Frozen* frozen, hypertext_Instance** output);
+
+/** \brief Fetches the output stored while freezing, ready to be sent as is.
+ *
+ * \param frozen The frozen instance to use.
+ * \param output The output variable; valid as long as a reference is held.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Frozen_Output(hypertext_Frozen* frozen, hypertext_View* output);
+
+/** \brief Creates a new response cache.
+ *
+ * \param budget The amount of bytes the stored responses and their keys may take up, split evenly between the cache's shards.
+ *
+ * \note Entries are keyed on method, target and the request's values of the fields named by the response's Vary field; the least recently hit ones are evicted first.
+ *
+ * \return Returns NULL if an error occurred; otherwise it'll be a usable cache.
+ */
+hypertext_EXPORT hypertext_Cache* hypertext_API hypertext_New_Cache(size_t budget);
+
+/// Destroys the cache's content, releasing all stored responses; the cache stays usable, so this resets it. No other thread may use it meanwhile.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_Cache(hypertext_Cache* cache);
+
+/// Destroys the cache's content and its locks and frees the cache itself; use this instead of free once it's no longer needed. No other thread may use it meanwhile.
+hypertext_EXPORT void hypertext_API hypertext_Free_Cache(hypertext_Cache* cache);
+
+/** \brief Freezes and stores a response to a request, if a shared cache may do so (RFC 9111, section 3); safe to call from any thread.
+ *
+ * \param cache The cache to use.
+ * \param request The request the response answers; only GET and HEAD requests are stored.
+ * \param response The response to store; it's left as is and still owned by the caller.
+ * \param now The current time, in seconds since the Unix epoch.
+ * \param keep_desc Whether the stored output contains the status description.
+ * \param keep_compat Whether the stored output uses CRLF line endings.
+ *
+ * \note The response stays fresh for the time given by s-maxage, max-age, or Expires, in that order, minus its Age; without any of those it isn't stored.
+ * \note Responses with no-store, no-cache, private, Set-Cookie or "Vary: *", and requests with Authorization or no-store, are never stored.
+ *
+ * \return hypertext_Result_Unsupported if the response mustn't or can't be stored; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Store_Cache(hypertext_Cache* cache, hypertext_Instance* request, hypertext_Instance* response, uint64_t now, bool keep_desc, bool keep_compat);
+
+/** \brief Looks up a fresh stored response for a request; safe to call from any thread.
+ *
+ * \param cache The cache to use.
+ * \param request The request to answer.
+ * \param now The current time, in seconds since the Unix epoch.
+ * \param output Set to the stored response, holding a reference the caller has to release.
+ *
+ * \note Requests with no-cache, no-store, max-age=0 or "Pragma: no-cache" always miss.
+ *
+ * \return hypertext_Result_Not_Found on a miss; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Lookup_Cache(hypertext_Cache* cache, hypertext_Instance* request, uint64_t now, hypertext_Frozen** output);
+
+/** \brief Drops every stored response for a target, e.g. after an unsafe request succeeded on it; safe to call from any thread.
+ *
+ * \param cache The cache to use.
+ * \param path The target, as found in the requests.
+ * \param length The target's length.
+ *
+ * \return hypertext_Result_Not_Found if nothing was stored for the target; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Invalidate_Cache(hypertext_Cache* cache, const char* path, size_t length);
+
+/** \brief Creates a new connection buffer for one socket.
+ *
+ * \param limit The most bytes the connection buffers at once; a request that doesn't fit can never be parsed.
+ *
+ * \return Returns NULL if an error occurred or limit is 0; otherwise it'll be a usable connection.
+ */
+hypertext_EXPORT hypertext_Connection* hypertext_API hypertext_New_Connection(size_t limit);
+
+/// Destroys the connection's content, including anything buffered. Use this to reset the connection.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_Connection(hypertext_Connection* connection);
+
+/** \brief Fetches free space at the end of the connection's buffer, for receiving into it without a copy.
+ *
+ * \param connection The connection to use.
+ * \param minimum The least amount of bytes the space has to hold.
+ * \param output Set to the start of the space; valid until the next call with this connection.
+ * \param length Set to the size of the space, which may be more than minimum.
+ *
+ * \note Call hypertext_Commit_Connection with the amount of bytes written afterwards.
+ * \note Unconsumed bytes are only moved to the front once there's no room behind them, instead of after every request.
+ *
+ * \return hypertext_Result_Out_Of_Memory if the space would exceed the limit; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Connection_Space(hypertext_Connection* connection, size_t minimum, char** output, size_t* length);
+
+/** \brief Marks bytes written into the space given by hypertext_Fetch_Connection_Space as received.
+ *
+ * \param connection The connection to use.
+ * \param length The amount of bytes written.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Commit_Connection(hypertext_Connection* connection, size_t length);
+
+/** \brief Copies received bytes into the connection's buffer.
+ *
+ * \param connection The connection to use.
+ * \param input The received bytes.
+ * \param length The amount of received bytes.
+ *
+ * \return hypertext_Result_Out_Of_Memory if the bytes would exceed the limit; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Feed_Connection(hypertext_Connection* connection, const char* input, size_t length);
+
+/** \brief Fetches the amount of received bytes that weren't parsed into requests yet.
+ *
+ * \param connection The connection to use.
+ * \param output The output variable.
+ *
+ * \note While this is 0, requests can be parsed straight out of the receive buffer with hypertext_Parse_Request_Buffer, and only a partial tail has to be fed.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Connection_Length(hypertext_Connection* connection, size_t* output);
+
+/** \brief Fetches whether the connection stays open after a request, as per HTTP/1.0 and HTTP/1.1 rules; hypertext_Next_Request does this on its own.
+ *
+ * \param request The request to use.
+ * \param output The output variable.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Keep_Alive(hypertext_Instance* request, bool* output);
+
+/** \brief Parses the next complete request out of the connection's buffer, so pipelined requests come out in order.
+ *
+ * \param connection The connection to use.
+ * \param instance The instance to parse into; it has to be empty.
+ * \param keep_alive Set to whether the connection stays open after this request, as per HTTP/1.0 and HTTP/1.1 rules; can be NULL.
+ *
+ * \note hypertext_Result_Incomplete is returned until enough bytes arrived; receive more and call this again.
+ * \note After a request that closes the connection, or after a parsing error, no more requests are parsed and hypertext_Result_Not_Found is returned.
+ * \note The response to a request without keep_alive should carry "Connection: close", and the socket should be closed after sending it.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Next_Request(hypertext_Connection* connection, hypertext_Instance* instance, bool* keep_alive);
+
+/** \brief Creates a new router.
+ *
+ * \return Returns NULL if an error occurred; otherwise it'll be a usable router.
+ */
+hypertext_EXPORT hypertext_Router* hypertext_API hypertext_New_Router();
+
+/// Destroys the router's content, including all routes. Use this to reset the router.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_Router(hypertext_Router* router);
+
+/** \brief Adds a route to the router.
+ * \param router The router to use.
+ * \param method The method this route applies to; use hypertext_Method_Unknown to accept any method.
+ * \param pattern The pattern to match the path against, e.g. "/users/:id".
+ * \param length The length of the pattern.
+ * \param data Any data to return once this route matches; usually a handler.
+ *
+ * \note Segments starting with ':' capture everything up to the next '/'. A segment starting with '*' captures the remaining path and must be the last one.
+ * \note Static segments take priority over ':' captures, which take priority over '*' captures.
+ * \note The router must be compiled again via hypertext_Compile_Router after adding routes.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Add_Route(hypertext_Router* router, uint8_t method, const char* pattern, size_t length, void* data);
+
+/** \brief Compiles all routes into a compact node array used for matching.
+ * \param router The router to use.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Compile_Router(hypertext_Router* router);
+
+/** \brief Matches a request's method and path against a compiled router.
+ * \param router The router to use.
+ * \param instance The request to match.
+ * \param output The output variable.
+ *
+ * \note Matching doesn't allocate; a compiled router may be used by multiple threads at once.
+ * \note The query and fragment of the request target are ignored.
+ * \note hypertext_Result_Invalid_Method is returned if the path matched, but no route accepts the request's method.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Match_Route(hypertext_Router* router, hypertext_Instance* instance, hypertext_Route_Match* output);
+
+/** \brief Creates a new HPACK context.
+ * \param table_size The maximum size of the dynamic table, as announced via SETTINGS_HEADER_TABLE_SIZE; usually 4096.
+ *
+ * \note A connection needs two contexts: one for encoding and one for decoding.
+ *
+ * \return Returns NULL if an error occurred; otherwise it'll be a usable context.
+ */
+hypertext_EXPORT hypertext_HPACK* hypertext_API hypertext_New_HPACK(size_t table_size);
+
+/// Destroys the context's content, including the dynamic table. Use this to reset the context.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_HPACK(hypertext_HPACK* context);
+
+/** \brief Changes the maximum size of the dynamic table.
+ * \param context The context to use.
+ * \param table_size The new maximum size.
+ *
+ * \note An encoding context announces the change at the start of the next block.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Resize_HPACK(hypertext_HPACK* context, size_t table_size);
+
+/** \brief Compresses a list of header fields into a header block.
+ * \param context The context to use.
+ * \param fields The fields to compress, including any pseudo-header fields.
+ * \param field_count The amount of fields.
+ * \param output Where to store the header block.
+ *
+ * \note The header block is owned by the context and stays valid until the next call.
+ * \note Names are sent in lower case; "authorization" and "proxy-authorization" are never indexed.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Encode_HPACK(hypertext_HPACK* context, const hypertext_Header_Field* fields, size_t field_count, hypertext_View* output);
+
+/** \brief Decompresses a complete header block.
+ * \param context The context to use.
+ * \param input The header block.
+ * \param length The length of the header block.
+ * \param fields Where to store the decoded fields.
+ * \param field_count Where to store the amount of decoded fields.
+ *
+ * \note The fields are owned by the context and stay valid until the next call.
+ * \note Any error is a compression error; the context can't be used any further afterwards.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Decode_HPACK(hypertext_HPACK* context, const char* input, size_t length, hypertext_Header_Field** fields, size_t* field_count);
+
+/** \brief Creates a new HTTP/2 server session.
+ * \param limit The most bytes a request's body may have; larger ones are answered with 413 and the rest of them is refused.
+ *
+ * \note The session doesn't do any I/O; feed it whatever arrives and send whatever it drains.
+ * \note Each stream's flow-control window is the limit, up to 2^31 - 1 bytes, which also bounds bodies above that.
+ *
+ * \return Returns NULL if an error occurred or limit is 0; otherwise it'll be a usable session.
+ */
+hypertext_EXPORT hypertext_Session* hypertext_API hypertext_New_Session(size_t limit);
+
+/// Destroys the session's content, including all streams and their requests. Use this to reset the session.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_Session(hypertext_Session* session);
+
+/** \brief Processes received bytes.
+ * \param session The session to use.
+ * \param input The bytes, starting with the client connection preface; frames may be split at any point.
+ * \param length The amount of bytes.
+ *
+ * \note Complete requests are returned by hypertext_Fetch_Session_Request; any frames to send back are returned by hypertext_Drain_Session.
+ * \note Received bodies count against the connection's flow-control window until their request is fetched; frames beyond a window are refused with FLOW_CONTROL_ERROR.
+ * \note hypertext_Result_Invalid_Parameters means the connection failed; a GOAWAY frame is queued and the connection should be closed once it was sent.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Feed_Session(hypertext_Session* session, const char* input, size_t length);
+
+/** \brief Returns the next complete request.
+ * \param session The session to use.
+ * \param stream Where to store the request's stream identifier.
+ * \param request Where to store the request.
+ *
+ * \note The request is an HTTP/1.1 instance owned by the session; the ":authority" pseudo-header field becomes a Host field.
+ * \note The request stays valid until a response is submitted for its stream or the session gets destroyed.
+ * \note Fetching a request gives its body's flow-control credit back to the peer, so drain the session afterwards.
+ *
+ * \return hypertext_Result_Not_Found if no request is complete; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Fetch_Session_Request(hypertext_Session* session, uint32_t* stream, hypertext_Instance** request);
+
+/** \brief Queues a response for a stream.
+ * \param session The session to use.
+ * \param stream The stream identifier returned by hypertext_Fetch_Session_Request.
+ * \param response The response to send. Its version is ignored and connection-specific fields are left out.
+ *
+ * \note The response is copied and can be destroyed right away.
+ * \note The body is sent as far as flow control allows; the rest is sent once the peer grants more credit.
+ *
+ * \return hypertext_Result_Not_Found if the peer reset the stream in the meantime; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Submit_Session_Response(hypertext_Session* session, uint32_t stream, hypertext_Instance* response);
+
+/** \brief Returns all frames queued so far.
+ * \param session The session to use.
+ * \param output Where to store the frames.
+ *
+ * \note The frames are owned by the session and stay valid until the session is used again.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Drain_Session(hypertext_Session* session, hypertext_View* output);
+
+/** \brief Queues a GOAWAY frame; no new streams are accepted afterwards.
+ * \param session The session to use.
+ * \param error The error code to send.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result, hypertext_Session_Error.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Close_Session(hypertext_Session* session, uint32_t error);
+
+#ifdef hypertext_ENCODING
+/** \brief Picks the content coding for a response, based on the request's Accept-Encoding fields.
+ * \param request The request to use.
+ * \param output Where to store the coding.
+ *
+ * \note Quality values and "*" are respected; gzip is preferred over deflate, and both over identity, if they're equally acceptable.
+ * \note This and the following functions are only available if hypertext was built with zlib.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result, hypertext_Content_Encoding.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Negotiate_Encoding(hypertext_Instance* request, uint8_t* output);
+
+/** \brief Creates a new encoder.
+ *
+ * \return Returns NULL if an error occurred; otherwise it'll be a usable encoder.
+ */
+hypertext_EXPORT hypertext_Encoder* hypertext_API hypertext_New_Encoder();
+
+/// Destroys the encoder's content. Use this to reset the encoder.
+hypertext_EXPORT void hypertext_API hypertext_Destroy_Encoder(hypertext_Encoder* encoder);
+
+/** \brief Prepares the output of a response using a content coding.
+ * \param encoder The encoder to use.
+ * \param response The response to output. It has to stay alive and unchanged until the output is done.
+ * \param encoding The content coding to use.
+ * \param keep_desc Whether to keep the status description, as with hypertext_Output_Response.
+ * \param keep_compat Whether to use CRLF line endings, as with hypertext_Output_Response.
+ *
+ * \note The framing fields are set automatically: Content-Length for identity, otherwise Content-Encoding, Vary and, for HTTP/1.1, chunked Transfer-Encoding.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Start_Encoder(hypertext_Encoder* encoder, hypertext_Instance* response, uint8_t encoding, bool keep_desc, bool keep_compat);
+
+/** \brief Returns the next piece of the output: first the head, then the body in windows of at most 16 KiB input each.
+ * \param encoder The encoder to use.
+ * \param output Where to store the piece. It stays valid until the next call.
+ *
+ * \note An empty piece means the output is done.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Pull_Encoder(hypertext_Encoder* encoder, hypertext_View* output);
+
+/** \brief Removes the content coding of a parsed body.
+ * \param instance The instance to use.
+ * \param limit The maximum decoded length; 0 for none.
+ *
+ * \note The Content-Encoding and Content-Length fields are removed afterwards.
+ *
+ * \return hypertext_Result_Not_Found if there's no Content-Encoding field, hypertext_Result_Out_Of_Memory if the limit was exceeded; otherwise a normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Decode_Body(hypertext_Instance* instance, size_t limit);
+#endif
+
+/** \brief Sets a new body.
+ * \param instance The instance to use.
+ * \param body The body to use.
+ * \param length The length of the body to use.
+ *
+ * \note The body cannot be NULL and the length must be greater than 0.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Set_Body(hypertext_Instance* instance, const char* body, size_t length);
+
+/** \brief Sets a body that's read from a file when it's sent.
+ *
+ * \param instance The instance to use.
+ * \param descriptor The file descriptor to read from. It isn't closed by hypertext and has to stay open as long as the instance uses it.
+ * \param offset Where the body starts within the file.
+ * \param length The length of the body.
+ *
+ * \note Use hypertext_Output_Response_Head and hypertext_Send_Body to send the body without copying it into memory.
+ * \note This isn't supported on Windows.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Set_Body_File(hypertext_Instance* instance, int descriptor, uint64_t offset, size_t length);
+
+/** \brief Turns a response into a partial one, containing only the given ranges of its body.
+ *
+ * \param response The response to use; its body has to be the full representation.
+ * \param ranges The sorted, non-overlapping ranges to send, i.e. from hypertext_Fetch_Ranges.
+ * \param count The amount of ranges; 0 makes the response a 416 one without a body.
+ *
+ * \note A single range sets the code to 206 and adds a Content-Range field; several ranges make a multipart/byteranges body. Any Content-Length field is removed.
+ * \note The parts point into the original body, be it memory or a file; nothing is copied. Use hypertext_Fetch_Segments or hypertext_Send_Body to send them.
+ * \note This can only be done once per instance; hypertext_Result_Already_Present is returned afterwards.
+ *
+ * \return A normal return code.
+ * \sa hypertext_Result.
+ */
+hypertext_EXPORT uint8_t hypertext_API hypertext_Set_Ranges(hypertext_Instance* response, const hypertext_Range* ranges, size_t count);
 
 /** \brief Sets the response code.
  * \param instance The instance to use.
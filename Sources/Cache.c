@@ -0,0 +1,643 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef SRWLOCK hypertext_utilities_lock;
+
+#define hypertext_utilities_lock_initialize(lock) InitializeSRWLock(lock)
+#define hypertext_utilities_lock_destroy(lock)    ((void)(lock))
+#define hypertext_utilities_lock_read(lock)       AcquireSRWLockShared(lock)
+#define hypertext_utilities_unlock_read(lock)     ReleaseSRWLockShared(lock)
+#define hypertext_utilities_lock_write(lock)      AcquireSRWLockExclusive(lock)
+#define hypertext_utilities_unlock_write(lock)    ReleaseSRWLockExclusive(lock)
+#else
+#include <pthread.h>
+
+typedef pthread_rwlock_t hypertext_utilities_lock;
+
+#define hypertext_utilities_lock_initialize(lock) pthread_rwlock_init(lock, NULL)
+#define hypertext_utilities_lock_destroy(lock)    pthread_rwlock_destroy(lock)
+#define hypertext_utilities_lock_read(lock)       pthread_rwlock_rdlock(lock)
+#define hypertext_utilities_unlock_read(lock)     pthread_rwlock_unlock(lock)
+#define hypertext_utilities_lock_write(lock)      pthread_rwlock_wrlock(lock)
+#define hypertext_utilities_unlock_write(lock)    pthread_rwlock_unlock(lock)
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+typedef volatile char hypertext_utilities_flag;
+
+#define hypertext_utilities_flag_set(flag)   (*(flag) = 1)
+#define hypertext_utilities_flag_clear(flag) (_InterlockedExchange8(flag, 0) != 0)
+#else
+#include <stdatomic.h>
+
+typedef atomic_bool hypertext_utilities_flag;
+
+// Hits only mark entries, so readers never need more than a shared lock.
+#define hypertext_utilities_flag_set(flag)   atomic_store_explicit(flag, true, memory_order_relaxed)
+#define hypertext_utilities_flag_clear(flag) atomic_exchange_explicit(flag, false, memory_order_relaxed)
+#endif
+
+// Must be a power of two; the top bits of a key's hash pick its shard.
+#define hypertext_utilities_cache_shards       16
+#define hypertext_utilities_cache_shard_bits   4
+#define hypertext_utilities_cache_min_buckets  16
+
+typedef struct hypertext_utilities_cache_entry
+{
+    struct hypertext_utilities_cache_entry* next;
+    uint64_t                                hash;
+    uint8_t                                 method;
+    char*                                   path;
+    size_t                                  path_length;
+    hypertext_Header_Field*                 vary;
+    size_t                                  vary_count;
+    hypertext_Frozen*                       response;
+    uint64_t                                expires;
+    size_t                                  size;
+    size_t                                  position;
+    hypertext_utilities_flag                referenced;
+} hypertext_utilities_cache_entry;
+
+typedef struct
+{
+    hypertext_utilities_lock          lock;
+    hypertext_utilities_cache_entry** buckets;
+    size_t                            bucket_count;
+    hypertext_utilities_cache_entry** ring;
+    size_t                            count;
+    size_t                            hand;
+    size_t                            bytes;
+} hypertext_utilities_cache_shard;
+
+struct hypertext_Cache
+{
+    hypertext_utilities_cache_shard shards[hypertext_utilities_cache_shards];
+    size_t                          shard_budget;
+};
+
+static uint64_t hypertext_utilities_cache_hash(uint8_t method, const char* path, size_t length)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL ^ method;
+    hash *= 0x100000001B3ULL;
+
+    for (size_t i = 0; i != length; i++)
+    {
+        hash ^= (uint8_t)path[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+inline static hypertext_utilities_cache_shard* hypertext_utilities_cache_shard_of(hypertext_Cache* cache, uint64_t hash)
+{
+    return &cache->shards[hash >> (64 - hypertext_utilities_cache_shard_bits)];
+}
+
+static const char* hypertext_utilities_cache_find(hypertext_Instance* instance, const char* name, size_t length)
+{
+    size_t index = hypertext_utilities_find_field(instance, name, length);
+
+    return index != SIZE_MAX ? instance->fields[index].value : NULL;
+}
+
+// Whether the request's values for a name, joined the way they're stored, equal a stored value; NULL stands for none.
+static bool hypertext_utilities_cache_same_value(hypertext_Instance* request, const char* name, const char* stored)
+{
+    size_t length = strlen(name), stored_length = stored != NULL ? strlen(stored) : 0, position = 0;
+    const char* interned = hypertext_utilities_intern(name, length, false);
+
+    size_t index = hypertext_utilities_next_field(request, interned, name, length, 0);
+    if (index == SIZE_MAX || stored == NULL) return index == SIZE_MAX && stored == NULL;
+
+    for (bool first = true; index != SIZE_MAX; index = hypertext_utilities_next_field(request, interned, name, length, index + 1), first = false)
+    {
+        const hypertext_utilities_field* field = &request->fields[index];
+
+        if (!first)
+        {
+            if (stored_length - position < 2 || memcmp(stored + position, ", ", 2) != 0) return false;
+            position += 2;
+        }
+
+        if (stored_length - position < field->value_length || memcmp(stored + position, field->value, field->value_length) != 0) return false;
+        position += field->value_length;
+    }
+
+    return position == stored_length;
+}
+
+// Matches a directive's name, setting value to what follows the '=', if anything.
+static bool hypertext_utilities_cache_is_directive(const char* item, size_t length, const char* name, const char** value, size_t* value_length)
+{
+    size_t name_length = strlen(name);
+
+    if (length < name_length || !hypertext_utilities_equals_ignore_case(item, name, name_length)) return false;
+    else if (length == name_length)
+    {
+        *value        = NULL;
+        *value_length = 0;
+
+        return true;
+    }
+    else if (item[name_length] != '=') return false;
+
+    *value        = item + name_length + 1;
+    *value_length = length - name_length - 1;
+
+    if (*value_length >= 2 && **value == '"' && (*value)[*value_length - 1] == '"')
+    {
+        (*value)++;
+        *value_length -= 2;
+    }
+
+    return true;
+}
+
+static bool hypertext_utilities_cache_seconds(const char* text, size_t length, uint64_t* output)
+{
+    if (text == NULL || length == 0) return false;
+
+    uint64_t value = 0;
+
+    for (size_t i = 0; i != length; i++)
+    {
+        if (text[i] < '0' || text[i] > '9') return false;
+
+        // Anything past 2^31 seconds is treated as 2^31; as per RFC 9111, section 1.2.2.
+        value = value * 10 + (uint64_t)(text[i] - '0');
+        if (value > 0x80000000ULL) value = 0x80000000ULL;
+    }
+
+    *output = value;
+
+    return true;
+}
+
+// Whether a request asks to bypass stored responses.
+static bool hypertext_utilities_cache_bypassed(hypertext_Instance* request, bool storing)
+{
+    for (size_t i = 0; i != request->field_count; i++)
+    {
+        const char* cursor = request->fields[i].value;
+        const char* item;
+        const char* value;
+        size_t length, value_length;
+        uint64_t seconds;
+
+        if (hypertext_utilities_is_field(&request->fields[i], hypertext_utilities_known_Cache_Control))
+        {
+            while (hypertext_utilities_next_item(&cursor, &item, &length))
+            {
+                if (hypertext_utilities_cache_is_directive(item, length, "no-store", &value, &value_length)) return true;
+                else if (storing) continue;
+                else if (hypertext_utilities_cache_is_directive(item, length, "no-cache", &value, &value_length)) return true;
+                else if (hypertext_utilities_cache_is_directive(item, length, "max-age", &value, &value_length) && hypertext_utilities_cache_seconds(value, value_length, &seconds) && seconds == 0) return true;
+            }
+        }
+        else if (!storing && hypertext_utilities_is_field(&request->fields[i], hypertext_utilities_known_Pragma))
+        {
+            while (hypertext_utilities_next_item(&cursor, &item, &length)) if (hypertext_utilities_cache_is_directive(item, length, "no-cache", &value, &value_length)) return true;
+        }
+    }
+
+    return false;
+}
+
+// Seconds a response stays fresh for a shared cache, zero if it mustn't be stored; as per RFC 9111, sections 3 and 4.2.
+static uint64_t hypertext_utilities_cache_lifetime(hypertext_Instance* response, uint64_t now)
+{
+    bool has_shared = false, has_maximum = false;
+    uint64_t shared = 0, maximum = 0, age = 0;
+    const char* expires = NULL;
+    const char* date    = NULL;
+
+    for (size_t i = 0; i != response->field_count; i++)
+    {
+        const hypertext_utilities_field* field = &response->fields[i];
+        const char* cursor = response->fields[i].value;
+        const char* item;
+        const char* value;
+        size_t length, value_length;
+
+        if (hypertext_utilities_is_field(field, hypertext_utilities_known_Set_Cookie)) return 0;
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Expires)) expires = cursor;
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Date)) date = cursor;
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Age)) hypertext_utilities_cache_seconds(cursor, strlen(cursor), &age);
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Vary))
+        {
+            while (hypertext_utilities_next_item(&cursor, &item, &length)) if (length == 1 && *item == '*') return 0;
+        }
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Cache_Control))
+        {
+            while (hypertext_utilities_next_item(&cursor, &item, &length))
+            {
+                if (hypertext_utilities_cache_is_directive(item, length, "no-store", &value, &value_length) || hypertext_utilities_cache_is_directive(item, length, "no-cache", &value, &value_length) || hypertext_utilities_cache_is_directive(item, length, "private", &value, &value_length)) return 0;
+                else if (hypertext_utilities_cache_is_directive(item, length, "s-maxage", &value, &value_length)) has_shared = hypertext_utilities_cache_seconds(value, value_length, &shared);
+                else if (hypertext_utilities_cache_is_directive(item, length, "max-age", &value, &value_length)) has_maximum = hypertext_utilities_cache_seconds(value, value_length, &maximum);
+            }
+        }
+    }
+
+    uint64_t lifetime = 0;
+
+    if (has_shared) lifetime = shared;
+    else if (has_maximum) lifetime = maximum;
+    else if (expires != NULL)
+    {
+        uint64_t expiry, origin = now;
+
+        // An invalid Expires means the response is already stale.
+        if (!hypertext_utilities_parse_date(expires, strlen(expires), &expiry)) return 0;
+        else if (date != NULL && !hypertext_utilities_parse_date(date, strlen(date), &origin)) origin = now;
+
+        lifetime = expiry > origin ? expiry - origin : 0;
+    }
+
+    return lifetime > age ? lifetime - age : 0;
+}
+
+// Codes cacheable by default, except partial content; as per RFC 9110, section 15.1.
+static bool hypertext_utilities_cache_is_storable_code(uint16_t code)
+{
+    switch (code)
+    {
+        case 200: case 203: case 204: case 300: case 301: case 308: case 404: case 405: case 410: case 414: case 501: return true;
+        default: return false;
+    }
+}
+
+static bool hypertext_utilities_cache_matches(hypertext_utilities_cache_entry* entry, uint64_t hash, uint8_t method, hypertext_Instance* request)
+{
+    if (entry->hash != hash || entry->method != method || entry->path_length != request->path_length || memcmp(entry->path, request->path, request->path_length) != 0) return false;
+
+    for (size_t i = 0; i != entry->vary_count; i++) if (!hypertext_utilities_cache_same_value(request, entry->vary[i].key, entry->vary[i].value)) return false;
+
+    return true;
+}
+
+static void hypertext_utilities_cache_remove(hypertext_utilities_cache_shard* shard, hypertext_utilities_cache_entry* entry)
+{
+    hypertext_utilities_cache_entry** link = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+    while (*link != entry) link = &(*link)->next;
+
+    *link = entry->next;
+
+    shard->count--;
+    shard->ring[entry->position] = shard->ring[shard->count];
+    shard->ring[entry->position]->position = entry->position;
+    shard->bytes -= entry->size;
+
+    hypertext_Release_Frozen(entry->response);
+    free(entry);
+}
+
+// Sweeps the CLOCK hand, giving referenced entries a second chance, until the new entry fits.
+static void hypertext_utilities_cache_evict(hypertext_utilities_cache_shard* shard, size_t budget, size_t size, uint64_t now)
+{
+    while (shard->count != 0 && shard->bytes + size > budget)
+    {
+        if (shard->hand >= shard->count) shard->hand = 0;
+
+        hypertext_utilities_cache_entry* entry = shard->ring[shard->hand];
+
+        if (entry->expires > now && hypertext_utilities_flag_clear(&entry->referenced)) shard->hand++;
+        else hypertext_utilities_cache_remove(shard, entry);
+    }
+}
+
+static bool hypertext_utilities_cache_grow(hypertext_utilities_cache_shard* shard)
+{
+    if (shard->count < shard->bucket_count) return true;
+
+    size_t bucket_count = shard->bucket_count != 0 ? shard->bucket_count * 2 : hypertext_utilities_cache_min_buckets;
+
+    hypertext_utilities_cache_entry** buckets = calloc(bucket_count, sizeof(hypertext_utilities_cache_entry*));
+    hypertext_utilities_cache_entry** ring    = realloc(shard->ring, bucket_count * sizeof(hypertext_utilities_cache_entry*));
+
+    if (ring != NULL) shard->ring = ring;
+    if (buckets == NULL || ring == NULL)
+    {
+        free(buckets);
+        return false;
+    }
+
+    for (size_t i = 0; i != shard->bucket_count; i++)
+    {
+        hypertext_utilities_cache_entry* entry = shard->buckets[i];
+
+        while (entry != NULL)
+        {
+            hypertext_utilities_cache_entry* next = entry->next;
+            hypertext_utilities_cache_entry** bucket = &buckets[entry->hash & (bucket_count - 1)];
+
+            entry->next = *bucket;
+            *bucket     = entry;
+            entry       = next;
+        }
+    }
+
+    free(shard->buckets);
+    shard->buckets      = buckets;
+    shard->bucket_count = bucket_count;
+
+    return true;
+}
+
+// Builds an entry holding the key in the same allocation: the path, then the Vary names and the request's values for them.
+static hypertext_utilities_cache_entry* hypertext_utilities_cache_create(hypertext_Instance* request, hypertext_Instance* response, uint64_t hash)
+{
+    size_t vary_count = 0, text_length = request->path_length + 1;
+
+    for (size_t i = 0; i != response->field_count; i++)
+    {
+        if (!hypertext_utilities_is_field(&response->fields[i], hypertext_utilities_known_Vary)) continue;
+
+        const char* cursor = response->fields[i].value;
+        const char* item;
+        size_t length;
+
+        while (hypertext_utilities_next_item(&cursor, &item, &length))
+        {
+            size_t value_length = hypertext_utilities_join_field(request, item, length, NULL);
+
+            vary_count++;
+            text_length += length + 1 + (value_length != SIZE_MAX ? value_length + 1 : 0);
+        }
+    }
+
+    size_t header = sizeof(hypertext_utilities_cache_entry) + vary_count * sizeof(hypertext_Header_Field);
+
+    hypertext_utilities_cache_entry* entry = malloc(header + text_length);
+    if (entry == NULL) return NULL;
+
+    memset(entry, 0, sizeof(hypertext_utilities_cache_entry));
+
+    char* text = (char*)entry + header;
+
+    entry->hash        = hash;
+    entry->method      = request->method;
+    entry->path        = text;
+    entry->path_length = request->path_length;
+    entry->vary        = (hypertext_Header_Field*)(entry + 1);
+    entry->size        = header + text_length;
+
+    memcpy(text, request->path, request->path_length);
+    text[request->path_length] = '\0';
+    text += request->path_length + 1;
+
+    for (size_t i = 0; i != response->field_count; i++)
+    {
+        if (!hypertext_utilities_is_field(&response->fields[i], hypertext_utilities_known_Vary)) continue;
+
+        const char* cursor = response->fields[i].value;
+        const char* item;
+        size_t length;
+
+        while (hypertext_utilities_next_item(&cursor, &item, &length))
+        {
+            hypertext_Header_Field* field = &entry->vary[entry->vary_count++];
+            size_t value_length = hypertext_utilities_join_field(request, item, length, NULL);
+
+            memcpy(text, item, length);
+            text[length] = '\0';
+            field->key   = text;
+            field->value = NULL;
+            text        += length + 1;
+
+            // Repeated request fields are stored joined, as they're all the same to Vary.
+            if (value_length != SIZE_MAX)
+            {
+                hypertext_utilities_join_field(request, item, length, text);
+                text[value_length] = '\0';
+                field->value = text;
+                text        += value_length + 1;
+            }
+        }
+    }
+
+    return entry;
+}
+
+hypertext_Cache* hypertext_New_Cache(size_t budget)
+{
+    hypertext_Cache* cache = calloc(1, sizeof(hypertext_Cache));
+    if (cache == NULL) return NULL;
+
+    for (size_t i = 0; i != hypertext_utilities_cache_shards; i++) hypertext_utilities_lock_initialize(&cache->shards[i].lock);
+
+    cache->shard_budget = budget / hypertext_utilities_cache_shards;
+
+    return cache;
+}
+
+void hypertext_Destroy_Cache(hypertext_Cache* cache)
+{
+    if (cache == NULL) return;
+
+    for (size_t i = 0; i != hypertext_utilities_cache_shards; i++)
+    {
+        hypertext_utilities_cache_shard* shard = &cache->shards[i];
+
+        for (size_t j = 0; j != shard->count; j++)
+        {
+            hypertext_Release_Frozen(shard->ring[j]->response);
+            free(shard->ring[j]);
+        }
+
+        free(shard->buckets);
+        free(shard->ring);
+
+        shard->buckets      = NULL;
+        shard->bucket_count = 0;
+        shard->ring         = NULL;
+        shard->count        = 0;
+        shard->hand         = 0;
+        shard->bytes        = 0;
+    }
+}
+
+void hypertext_Free_Cache(hypertext_Cache* cache)
+{
+    if (cache == NULL) return;
+
+    hypertext_Destroy_Cache(cache);
+
+    for (size_t i = 0; i != hypertext_utilities_cache_shards; i++) hypertext_utilities_lock_destroy(&cache->shards[i].lock);
+
+    free(cache);
+}
+
+uint8_t hypertext_Store_Cache(hypertext_Cache* cache, hypertext_Instance* request, hypertext_Instance* response, uint64_t now, bool keep_desc, bool keep_compat)
+{
+    if (!hypertext_utilities_is_valid_instance(request) || !hypertext_utilities_is_valid_instance(response)) return hypertext_Result_Invalid_Instance;
+    else if (cache == NULL || request->type != hypertext_Instance_Content_Type_Request || response->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+    else if (request->method != hypertext_Method_GET && request->method != hypertext_Method_HEAD) return hypertext_Result_Unsupported;
+    else if (hypertext_utilities_cache_find(request, "Authorization", 13) != NULL || hypertext_utilities_cache_bypassed(request, true)) return hypertext_Result_Unsupported;
+    else if (!hypertext_utilities_cache_is_storable_code(response->code)) return hypertext_Result_Unsupported;
+
+    uint64_t lifetime = hypertext_utilities_cache_lifetime(response, now);
+    if (lifetime == 0) return hypertext_Result_Unsupported;
+
+    uint64_t hash = hypertext_utilities_cache_hash(request->method, request->path, request->path_length);
+
+    hypertext_utilities_cache_entry* entry = hypertext_utilities_cache_create(request, response, hash);
+    if (entry == NULL) return hypertext_Result_Out_Of_Memory;
+
+    uint8_t result = hypertext_Freeze(response, keep_desc, keep_compat, &entry->response);
+    if (result != hypertext_Result_Success)
+    {
+        free(entry);
+        return result;
+    }
+
+    hypertext_View output;
+    hypertext_Fetch_Frozen_Output(entry->response, &output);
+
+    entry->size   += output.length;
+    entry->expires = now + lifetime;
+
+    if (entry->size > cache->shard_budget)
+    {
+        hypertext_Release_Frozen(entry->response);
+        free(entry);
+
+        return hypertext_Result_Unsupported;
+    }
+
+    hypertext_utilities_cache_shard* shard = hypertext_utilities_cache_shard_of(cache, hash);
+    hypertext_utilities_lock_write(&shard->lock);
+
+    // A newer response replaces whichever one this request would have been served.
+    if (shard->bucket_count != 0)
+    {
+        hypertext_utilities_cache_entry* previous = shard->buckets[hash & (shard->bucket_count - 1)];
+        while (previous != NULL && !hypertext_utilities_cache_matches(previous, hash, request->method, request)) previous = previous->next;
+
+        if (previous != NULL) hypertext_utilities_cache_remove(shard, previous);
+    }
+
+    hypertext_utilities_cache_evict(shard, cache->shard_budget, entry->size, now);
+
+    if (!hypertext_utilities_cache_grow(shard))
+    {
+        hypertext_utilities_unlock_write(&shard->lock);
+        hypertext_Release_Frozen(entry->response);
+        free(entry);
+
+        return hypertext_Result_Out_Of_Memory;
+    }
+
+    hypertext_utilities_cache_entry** bucket = &shard->buckets[hash & (shard->bucket_count - 1)];
+
+    entry->next     = *bucket;
+    entry->position = shard->count;
+    *bucket         = entry;
+
+    shard->ring[shard->count++] = entry;
+    shard->bytes += entry->size;
+
+    hypertext_utilities_unlock_write(&shard->lock);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Lookup_Cache(hypertext_Cache* cache, hypertext_Instance* request, uint64_t now, hypertext_Frozen** output)
+{
+    if (!hypertext_utilities_is_valid_instance(request)) return hypertext_Result_Invalid_Instance;
+    else if (cache == NULL || output == NULL || request->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+    else if (hypertext_utilities_cache_bypassed(request, false)) return hypertext_Result_Not_Found;
+
+    uint64_t hash = hypertext_utilities_cache_hash(request->method, request->path, request->path_length);
+    hypertext_utilities_cache_shard* shard = hypertext_utilities_cache_shard_of(cache, hash);
+
+    hypertext_utilities_lock_read(&shard->lock);
+
+    hypertext_utilities_cache_entry* entry = shard->bucket_count != 0 ? shard->buckets[hash & (shard->bucket_count - 1)] : NULL;
+
+    // Stale entries stay put until a store sweeps past them.
+    while (entry != NULL && (entry->expires <= now || !hypertext_utilities_cache_matches(entry, hash, request->method, request))) entry = entry->next;
+
+    if (entry != NULL)
+    {
+        hypertext_utilities_flag_set(&entry->referenced);
+        *output = hypertext_Acquire_Frozen(entry->response);
+    }
+
+    hypertext_utilities_unlock_read(&shard->lock);
+
+    return entry != NULL ? hypertext_Result_Success : hypertext_Result_Not_Found;
+}
+
+uint8_t hypertext_Invalidate_Cache(hypertext_Cache* cache, const char* path, size_t length)
+{
+    if (cache == NULL || path == NULL) return hypertext_Result_Invalid_Parameters;
+
+    static const uint8_t methods[] = { hypertext_Method_GET, hypertext_Method_HEAD };
+    bool found = false;
+
+    for (size_t i = 0; i != sizeof(methods); i++)
+    {
+        uint64_t hash = hypertext_utilities_cache_hash(methods[i], path, length);
+        hypertext_utilities_cache_shard* shard = hypertext_utilities_cache_shard_of(cache, hash);
+
+        hypertext_utilities_lock_write(&shard->lock);
+
+        hypertext_utilities_cache_entry* entry = shard->bucket_count != 0 ? shard->buckets[hash & (shard->bucket_count - 1)] : NULL;
+
+        while (entry != NULL)
+        {
+            hypertext_utilities_cache_entry* next = entry->next;
+
+            if (entry->hash == hash && entry->method == methods[i] && entry->path_length == length && memcmp(entry->path, path, length) == 0)
+            {
+                hypertext_utilities_cache_remove(shard, entry);
+                found = true;
+            }
+
+            entry = next;
+        }
+
+        hypertext_utilities_unlock_write(&shard->lock);
+    }
+
+    return found ? hypertext_Result_Success : hypertext_Result_Not_Found;
+}
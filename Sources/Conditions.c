@@ -0,0 +1,163 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <string.h>
+
+// Splits an entity tag into its opaque part, quotes included, and whether it's weak; false if it's malformed.
+static bool hypertext_utilities_conditions_tag(const char** cursor, const char** opaque, size_t* length, bool* weak)
+{
+    const char* position = *cursor;
+
+    *weak = position[0] == 'W' && position[1] == '/';
+    if (*weak) position += 2;
+
+    if (*position != '"') return false;
+
+    const char* end = strchr(position + 1, '"');
+    if (end == NULL) return false;
+
+    *opaque = position;
+    *length = (size_t)(end + 1 - position);
+    *cursor = end + 1;
+
+    return true;
+}
+
+// Whether a list of entity tags is "*" or contains the current one; as per RFC 9110, section 8.8.3.2.
+static bool hypertext_utilities_conditions_match(const char* list, const char* entity_tag, bool weak_comparison)
+{
+    const char* current = NULL;
+    size_t current_length = 0;
+    bool current_weak = false;
+
+    if (entity_tag != NULL && !hypertext_utilities_conditions_tag(&entity_tag, &current, &current_length, &current_weak)) current = NULL;
+
+    while (true)
+    {
+        while (*list == ' ' || *list == '\t' || *list == ',') list++;
+
+        // "*" matches any current representation, which the caller implies exists.
+        if (*list == '*') return true;
+        else if (*list == '\0' || current == NULL) return false;
+
+        const char* opaque;
+        size_t length;
+        bool weak;
+
+        if (!hypertext_utilities_conditions_tag(&list, &opaque, &length, &weak)) return false;
+        else if (length == current_length && memcmp(opaque, current, length) == 0 && (weak_comparison || (!weak && !current_weak))) return true;
+    }
+}
+
+// Whether a date field holds a time at or after the last modification; invalid dates make the condition be ignored.
+static bool hypertext_utilities_conditions_date(const char* field, const char* last_modified, bool* output)
+{
+    uint64_t date, modified;
+
+    if (field == NULL || last_modified == NULL) return false;
+    else if (!hypertext_utilities_parse_date(field, strlen(field), &date) || !hypertext_utilities_parse_date(last_modified, strlen(last_modified), &modified)) return false;
+
+    *output = modified <= date;
+
+    return true;
+}
+
+uint8_t hypertext_Evaluate_Conditions(hypertext_Instance* request, const char* entity_tag, const char* last_modified, uint16_t* output)
+{
+    if (request == NULL || request->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+
+    bool if_match                   = false, if_match_found         = false;
+    bool if_none_match              = false, if_none_match_found    = false;
+    const char* if_modified_since   = NULL;
+    const char* if_unmodified_since = NULL;
+
+    // Entity tag lists may be spread over several lines, which count as one list.
+    for (size_t i = 0; i != request->field_count; i++)
+    {
+        const hypertext_utilities_field* field = &request->fields[i];
+
+        if (hypertext_utilities_is_field(field, hypertext_utilities_known_If_Match))
+        {
+            if_match         = true;
+            if_match_found  |= hypertext_utilities_conditions_match(request->fields[i].value, entity_tag, false);
+        }
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_If_None_Match))
+        {
+            if_none_match        = true;
+            if_none_match_found |= hypertext_utilities_conditions_match(request->fields[i].value, entity_tag, true);
+        }
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_If_Modified_Since)) if_modified_since = request->fields[i].value;
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_If_Unmodified_Since)) if_unmodified_since = request->fields[i].value;
+    }
+
+    bool safe = request->method == hypertext_Method_GET || request->method == hypertext_Method_HEAD;
+    bool unmodified;
+
+    *output = 0;
+
+    // The order of evaluation is as per RFC 9110, section 13.2.2; a date condition only counts without its entity tag counterpart.
+    if (if_match)
+    {
+        if (!if_match_found) *output = hypertext_Status_Precondition_Failed;
+    }
+    else if (hypertext_utilities_conditions_date(if_unmodified_since, last_modified, &unmodified) && !unmodified) *output = hypertext_Status_Precondition_Failed;
+
+    if (*output != 0) return hypertext_Result_Success;
+
+    if (if_none_match)
+    {
+        if (if_none_match_found) *output = safe ? hypertext_Status_Not_Modified : hypertext_Status_Precondition_Failed;
+    }
+    else if (safe && hypertext_utilities_conditions_date(if_modified_since, last_modified, &unmodified) && unmodified) *output = hypertext_Status_Not_Modified;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Create_Conditional_Response(hypertext_Instance* instance, hypertext_Instance* request, uint16_t code, const char* entity_tag, const char* last_modified)
+{
+    if (request == NULL || request->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (code != hypertext_Status_Not_Modified && code != hypertext_Status_Precondition_Failed) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+
+    hypertext_Header_Field fields[2];
+    size_t count = 0;
+
+    // A 304 carries the validators a 200 would have; a 412 needs framing for the connection to be reused.
+    if (code == hypertext_Status_Not_Modified)
+    {
+        if (entity_tag != NULL) fields[count++] = (hypertext_Header_Field){ "ETag", (char*)entity_tag };
+        if (last_modified != NULL) fields[count++] = (hypertext_Header_Field){ "Last-Modified", (char*)last_modified };
+    }
+    else fields[count++] = (hypertext_Header_Field){ "Content-Length", "0" };
+
+    return hypertext_Create_Response(instance, request->version, code, fields, count, NULL, 0);
+}
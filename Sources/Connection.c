@@ -0,0 +1,258 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define hypertext_utilities_connection_minimum_capacity 4096
+
+struct hypertext_Connection
+{
+    char*   buffer;
+    size_t  capacity;
+    size_t  limit;
+    size_t  start;
+    size_t  end;
+    size_t  scanned;
+    size_t  pending;
+    bool    has_head;
+    bool    closing;
+};
+
+// Whether the head of the message at the start of the buffer has arrived, scanning only what's new since the last call.
+static bool hypertext_utilities_connection_has_head(hypertext_Connection* connection)
+{
+    const char* data = connection->buffer + connection->start;
+    size_t size = connection->end - connection->start;
+
+    // The empty line might straddle what was scanned before and what's new.
+    size_t position = connection->scanned > 2 ? connection->scanned - 2 : 0;
+
+    while (position < size)
+    {
+        const char* line_feed = memchr(data + position, '\n', size - position);
+        if (line_feed == NULL) break;
+
+        position = (size_t)(line_feed - data) + 1;
+
+        if (position < size && data[position] == '\n') return true;
+        else if (position + 1 < size && data[position] == '\r' && data[position + 1] == '\n') return true;
+    }
+
+    connection->scanned = size;
+
+    return false;
+}
+
+// Whether the connection stays open after a request; as per RFC 9112, section 9.3.
+static bool hypertext_utilities_connection_is_persistent(hypertext_Instance* instance)
+{
+    bool close = false, keep_alive = false;
+
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        if (!hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Connection)) continue;
+
+        const char* cursor = instance->fields[i].value;
+        const char* item;
+        size_t length;
+
+        while (hypertext_utilities_next_item(&cursor, &item, &length))
+        {
+            if (length == 5 && hypertext_utilities_equals_ignore_case(item, "close", 5)) close = true;
+            else if (length == 10 && hypertext_utilities_equals_ignore_case(item, "keep-alive", 10)) keep_alive = true;
+        }
+    }
+
+    if (close) return false;
+
+    return instance->version == hypertext_HTTP_Version_1_1 || keep_alive;
+}
+
+hypertext_Connection* hypertext_New_Connection(size_t limit)
+{
+    if (limit == 0) return NULL;
+
+    hypertext_Connection* connection = calloc(1, sizeof(hypertext_Connection));
+    if (connection == NULL) return NULL;
+
+    connection->limit = limit;
+
+    return connection;
+}
+
+void hypertext_Destroy_Connection(hypertext_Connection* connection)
+{
+    if (connection == NULL) return;
+
+    size_t limit = connection->limit;
+
+    free(connection->buffer);
+    memset(connection, 0, sizeof(hypertext_Connection));
+
+    connection->limit = limit;
+}
+
+uint8_t hypertext_Fetch_Connection_Space(hypertext_Connection* connection, size_t minimum, char** output, size_t* length)
+{
+    if (connection == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || length == NULL) return hypertext_Result_Invalid_Parameters;
+
+    if (minimum == 0) minimum = 1;
+
+    size_t used = connection->end - connection->start;
+
+    // Unconsumed bytes are only moved once there's no room left behind them, not on every read.
+    if (connection->capacity - connection->end < minimum && connection->start != 0 && connection->capacity - used >= minimum)
+    {
+        memmove(connection->buffer, connection->buffer + connection->start, used);
+
+        connection->start = 0;
+        connection->end   = used;
+    }
+    else if (connection->capacity - connection->end < minimum)
+    {
+        if (used > connection->limit || minimum > connection->limit - used) return hypertext_Result_Out_Of_Memory;
+
+        size_t capacity = connection->capacity != 0 ? connection->capacity : hypertext_utilities_connection_minimum_capacity;
+        while (capacity < used + minimum && capacity <= SIZE_MAX / 2) capacity *= 2;
+
+        if (capacity > connection->limit) capacity = connection->limit;
+
+        // Moving the unconsumed bytes first lets realloc copy only those.
+        if (connection->start != 0)
+        {
+            memmove(connection->buffer, connection->buffer + connection->start, used);
+
+            connection->start = 0;
+            connection->end   = used;
+        }
+
+        char* buffer = realloc(connection->buffer, capacity);
+        if (buffer == NULL) return hypertext_Result_Out_Of_Memory;
+
+        connection->buffer   = buffer;
+        connection->capacity = capacity;
+    }
+
+    *output = connection->buffer + connection->end;
+    *length = connection->capacity - connection->end;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Commit_Connection(hypertext_Connection* connection, size_t length)
+{
+    if (connection == NULL) return hypertext_Result_Invalid_Instance;
+    else if (length > connection->capacity - connection->end) return hypertext_Result_Invalid_Parameters;
+
+    connection->end += length;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Feed_Connection(hypertext_Connection* connection, const char* input, size_t length)
+{
+    if (connection == NULL) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL && length != 0) return hypertext_Result_Invalid_Parameters;
+    else if (length == 0) return hypertext_Result_Success;
+
+    char* space;
+    size_t available;
+
+    uint8_t result = hypertext_Fetch_Connection_Space(connection, length, &space, &available);
+    if (result != hypertext_Result_Success) return result;
+
+    memcpy(space, input, length);
+    connection->end += length;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Connection_Length(hypertext_Connection* connection, size_t* output)
+{
+    if (connection == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    *output = connection->end - connection->start;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Keep_Alive(hypertext_Instance* request, bool* output)
+{
+    if (request == NULL || request->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+
+    *output = hypertext_utilities_connection_is_persistent(request);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Next_Request(hypertext_Connection* connection, hypertext_Instance* instance, bool* keep_alive)
+{
+    if (connection == NULL) return hypertext_Result_Invalid_Instance;
+    else if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
+    else if (connection->closing) return hypertext_Result_Not_Found;
+
+    size_t size = connection->end - connection->start;
+
+    // Nothing arrived since the last attempt, or the head is still missing; parsing again would only repeat the same work.
+    if (size == 0 || size == connection->pending) return hypertext_Result_Incomplete;
+    else if (!connection->has_head && !(connection->has_head = hypertext_utilities_connection_has_head(connection))) return hypertext_Result_Incomplete;
+
+    size_t consumed = 0;
+    uint8_t result = hypertext_Parse_Request_Buffer(instance, connection->buffer + connection->start, size, &consumed);
+
+    if (result == hypertext_Result_Incomplete)
+    {
+        connection->pending = size;
+        return result;
+    }
+    else if (result != hypertext_Result_Success)
+    {
+        // There's no telling where the next message would start.
+        connection->closing = true;
+        return result;
+    }
+
+    connection->start   += consumed;
+    connection->scanned  = 0;
+    connection->pending  = 0;
+    connection->has_head = false;
+
+    if (connection->start == connection->end) connection->start = connection->end = 0;
+
+    bool persistent = hypertext_utilities_connection_is_persistent(instance);
+    if (!persistent) connection->closing = true;
+
+    if (keep_alive != NULL) *keep_alive = persistent;
+
+    return hypertext_Result_Success;
+}
@@ -27,10 +27,26 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Copies the fields into the freshly created instance; if that fails, the instance is emptied again.
+static uint8_t hypertext_utilities_create_fields(hypertext_Instance* instance, const hypertext_Field* fields, size_t field_count)
+{
+    if (field_count == 0) return hypertext_Result_Success;
+
+    uint8_t result = hypertext_Result_Out_Of_Memory;
+
+    instance->fields = calloc(field_count, sizeof(hypertext_utilities_field));
+    if (instance->fields != NULL) result = hypertext_utilities_copy_fields(instance, fields, field_count, instance->fields);
+
+    if (result == hypertext_Result_Success) instance->field_count = instance->field_capacity = field_count;
+    else hypertext_Destroy(instance);
+
+    return result;
+}
+
 uint8_t hypertext_Create_Request(hypertext_Instance* instance, uint8_t method, const char* path, size_t path_length, uint8_t version, hypertext_Header_Field* fields, size_t field_count, const char* body, size_t body_length)
 {
     if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
-    else if (path == NULL || method == hypertext_Method_Unknown || method >= hypertext_Method_Max || version == hypertext_HTTP_Version_Unknown || version >= hypertext_HTTP_Version_Max) return hypertext_Result_Invalid_Parameters;
+    else if (path == NULL || !hypertext_utilities_is_valid_method(method) || version == hypertext_HTTP_Version_Unknown || version >= hypertext_HTTP_Version_Max) return hypertext_Result_Invalid_Parameters;
 
     instance->type = hypertext_Instance_Content_Type_Request;
 
@@ -38,14 +54,22 @@ uint8_t hypertext_Create_Request(hypertext_Instance* instance, uint8_t method, c
 
     instance->path = calloc(path_length + 1, sizeof(char));
     memcpy(instance->path, path, path_length * sizeof(char));
+    instance->path_length = path_length;
+
+    hypertext_utilities_scan_target(instance);
 
     if (field_count != 0)
     {
         if (fields == NULL) return hypertext_Result_Invalid_Parameters;
 
-        instance->field_count = field_count;
-        instance->fields = calloc(field_count, sizeof(hypertext_Header_Field));
-        memcpy(instance->fields, fields, sizeof(hypertext_Header_Field) * field_count);
+        for (size_t i = 0; i != field_count; i++) if (fields[i].key == NULL || fields[i].value == NULL) return hypertext_Result_Invalid_Parameters;
+
+        instance->fields = calloc(field_count, sizeof(hypertext_utilities_field));
+        if (instance->fields == NULL) return hypertext_Result_Out_Of_Memory;
+
+        // The strings are borrowed; only their lengths are measured, once.
+        for (size_t i = 0; i != field_count; i++) instance->fields[i] = hypertext_utilities_make_field(fields[i].key, fields[i].value);
+        instance->field_count = instance->field_capacity = field_count;
     }
     else instance->fields = NULL;
 
@@ -55,6 +79,7 @@ uint8_t hypertext_Create_Request(hypertext_Instance* instance, uint8_t method, c
 
         instance->body = calloc(body_length + 1, sizeof(char));
         memcpy(instance->body, body, body_length * sizeof(char));
+        instance->body_length = body_length;
     }
     else instance->body = NULL;
 
@@ -75,9 +100,14 @@ uint8_t hypertext_Create_Response(hypertext_Instance* instance, uint8_t version,
     {
         if (fields == NULL) return hypertext_Result_Invalid_Parameters;
 
-        instance->field_count   = field_count;
-        instance->fields        = calloc(field_count, sizeof(hypertext_Header_Field));
-        memcpy(instance->fields, fields, sizeof(hypertext_Header_Field) * field_count);
+        for (size_t i = 0; i != field_count; i++) if (fields[i].key == NULL || fields[i].value == NULL) return hypertext_Result_Invalid_Parameters;
+
+        instance->fields = calloc(field_count, sizeof(hypertext_utilities_field));
+        if (instance->fields == NULL) return hypertext_Result_Out_Of_Memory;
+
+        // The strings are borrowed; only their lengths are measured, once.
+        for (size_t i = 0; i != field_count; i++) instance->fields[i] = hypertext_utilities_make_field(fields[i].key, fields[i].value);
+        instance->field_count = instance->field_capacity = field_count;
     }
     else instance->fields = NULL;
 
@@ -87,6 +117,7 @@ uint8_t hypertext_Create_Response(hypertext_Instance* instance, uint8_t version,
 
         instance->body = calloc(body_length + 1, sizeof(char));
         memcpy(instance->body, body, body_length * sizeof(char));
+        instance->body_length = body_length;
     }
     else instance->body = NULL;
 
@@ -94,3 +125,23 @@ uint8_t hypertext_Create_Response(hypertext_Instance* instance, uint8_t version,
 
     return hypertext_Result_Success;
 }
+
+uint8_t hypertext_Create_Request_Fields(hypertext_Instance* instance, uint8_t method, const char* path, size_t path_length, uint8_t version, const hypertext_Field* fields, size_t field_count, const char* body, size_t body_length)
+{
+    if (field_count != 0 && fields == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_Create_Request(instance, method, path, path_length, version, NULL, 0, body, body_length);
+    if (result != hypertext_Result_Success) return result;
+
+    return hypertext_utilities_create_fields(instance, fields, field_count);
+}
+
+uint8_t hypertext_Create_Response_Fields(hypertext_Instance* instance, uint8_t version, uint16_t code, const hypertext_Field* fields, size_t field_count, const char* body, size_t body_length)
+{
+    if (field_count != 0 && fields == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_Create_Response(instance, version, code, NULL, 0, body, body_length);
+    if (result != hypertext_Result_Success) return result;
+
+    return hypertext_utilities_create_fields(instance, fields, field_count);
+}
@@ -0,0 +1,236 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <string.h>
+#include <time.h>
+
+#if defined(_MSC_VER)
+#define hypertext_utilities_thread_local __declspec(thread)
+#else
+#define hypertext_utilities_thread_local _Thread_local
+#endif
+
+// The length of an IMF-fixdate, i.e. "Sun, 06 Nov 1994 08:49:37 GMT".
+#define hypertext_utilities_date_length 29
+
+static const char hypertext_utilities_day_names[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char hypertext_utilities_month_names[12][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+// Each thread formats the current date at most once per second.
+static hypertext_utilities_thread_local char hypertext_utilities_current_date[hypertext_utilities_date_length + 1];
+static hypertext_utilities_thread_local uint64_t hypertext_utilities_current_second = UINT64_MAX;
+
+// Days between 1970-01-01 and a date of the proleptic Gregorian calendar.
+static int64_t hypertext_utilities_days_from_civil(int64_t year, uint32_t month, uint32_t day)
+{
+    year -= month <= 2;
+
+    int64_t era         = (year >= 0 ? year : year - 399) / 400;
+    uint32_t year_of_era = (uint32_t)(year - era * 400);
+    uint32_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t day_of_era  = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+// The inverse of the above, for days since 1970-01-01.
+static void hypertext_utilities_civil_from_days(uint64_t days, uint32_t* year, uint32_t* month, uint32_t* day)
+{
+    days += 719468;
+
+    uint64_t era         = days / 146097;
+    uint32_t day_of_era  = (uint32_t)(days - era * 146097);
+    uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    uint32_t shifted     = (5 * day_of_year + 2) / 153;
+
+    *day   = day_of_year - (153 * shifted + 2) / 5 + 1;
+    *month = shifted < 10 ? shifted + 3 : shifted - 9;
+    *year  = (uint32_t)(era * 400) + year_of_era + (*month <= 2);
+}
+
+static bool hypertext_utilities_date_number(const char* text, size_t digits, uint32_t* output)
+{
+    uint32_t value = 0;
+
+    for (size_t i = 0; i != digits; i++)
+    {
+        if (text[i] < '0' || text[i] > '9') return false;
+
+        value = value * 10 + (uint32_t)(text[i] - '0');
+    }
+
+    *output = value;
+
+    return true;
+}
+
+static bool hypertext_utilities_date_month(const char* text, uint32_t* output)
+{
+    for (uint32_t i = 0; i != 12; i++)
+    {
+        if (memcmp(text, hypertext_utilities_month_names[i], 3) == 0)
+        {
+            *output = i + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Reads "HH:MM:SS" into seconds since midnight; a leap second is allowed.
+static bool hypertext_utilities_date_time(const char* text, uint32_t* output)
+{
+    uint32_t hour, minute, second;
+
+    if (text[2] != ':' || text[5] != ':') return false;
+    else if (!hypertext_utilities_date_number(text, 2, &hour) || !hypertext_utilities_date_number(text + 3, 2, &minute) || !hypertext_utilities_date_number(text + 6, 2, &second)) return false;
+    else if (hour > 23 || minute > 59 || second > 60) return false;
+
+    *output = hour * 3600 + minute * 60 + second;
+
+    return true;
+}
+
+static bool hypertext_utilities_date_compose(uint32_t year, uint32_t month, uint32_t day, uint32_t seconds, uint64_t* output)
+{
+    static const uint8_t lengths[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+    if (year < 1970 || day == 0 || day > lengths[month - 1] || (month == 2 && day == 29 && !leap)) return false;
+
+    *output = (uint64_t)hypertext_utilities_days_from_civil(year, month, day) * 86400 + seconds;
+
+    return true;
+}
+
+bool hypertext_utilities_parse_date(const char* text, size_t length, uint64_t* output)
+{
+    uint32_t year, month, day, seconds;
+
+    if (length < 24) return false;
+
+    // IMF-fixdate, i.e. "Sun, 06 Nov 1994 08:49:37 GMT"; as per RFC 9110, section 5.6.7.
+    if (text[3] == ',')
+    {
+        if (length != hypertext_utilities_date_length || text[4] != ' ' || text[7] != ' ' || text[11] != ' ' || text[16] != ' ' || memcmp(text + 25, " GMT", 4) != 0) return false;
+        else if (!hypertext_utilities_date_number(text + 5, 2, &day) || !hypertext_utilities_date_month(text + 8, &month) || !hypertext_utilities_date_number(text + 12, 4, &year) || !hypertext_utilities_date_time(text + 17, &seconds)) return false;
+
+        return hypertext_utilities_date_compose(year, month, day, seconds, output);
+    }
+
+    // asctime, i.e. "Sun Nov  6 08:49:37 1994", where the day may be padded with a space.
+    if (text[3] == ' ')
+    {
+        if (length != 24 || text[7] != ' ' || text[10] != ' ' || text[19] != ' ') return false;
+        else if (!hypertext_utilities_date_month(text + 4, &month) || !hypertext_utilities_date_number(text + 20, 4, &year) || !hypertext_utilities_date_time(text + 11, &seconds)) return false;
+        else if (text[8] == ' ' ? !hypertext_utilities_date_number(text + 9, 1, &day) : !hypertext_utilities_date_number(text + 8, 2, &day)) return false;
+
+        return hypertext_utilities_date_compose(year, month, day, seconds, output);
+    }
+
+    // RFC 850, i.e. "Sunday, 06-Nov-94 08:49:37 GMT", where the day name is spelled out.
+    const char* comma = memchr(text, ',', length < 10 ? length : 10);
+    if (comma == NULL || comma < text + 6) return false;
+
+    const char* rest = comma + 1;
+    if ((size_t)(text + length - rest) != 23 || rest[0] != ' ' || rest[3] != '-' || rest[7] != '-' || rest[10] != ' ' || memcmp(rest + 19, " GMT", 4) != 0) return false;
+    else if (!hypertext_utilities_date_number(rest + 1, 2, &day) || !hypertext_utilities_date_month(rest + 4, &month) || !hypertext_utilities_date_number(rest + 8, 2, &year) || !hypertext_utilities_date_time(rest + 11, &seconds)) return false;
+
+    // Two-digit years are pinned to 1970-2069 rather than to the current time; as per RFC 9110, section 5.6.7, this only misreads dates 50 years away.
+    year += year < 70 ? 2000 : 1900;
+
+    return hypertext_utilities_date_compose(year, month, day, seconds, output);
+}
+
+// Writes the 29 characters of an IMF-fixdate, without a terminator.
+static void hypertext_utilities_format_date(uint64_t time, char* output)
+{
+    uint64_t days    = time / 86400;
+    uint32_t seconds = (uint32_t)(time % 86400);
+    uint32_t year, month, day;
+
+    hypertext_utilities_civil_from_days(days, &year, &month, &day);
+
+    // 1970-01-01 was a Thursday.
+    memcpy(output, hypertext_utilities_day_names[(days + 4) % 7], 3);
+    memcpy(output + 3, ", 00 ", 5);
+    output[5] = (char)('0' + day / 10);
+    output[6] = (char)('0' + day % 10);
+
+    memcpy(output + 8, hypertext_utilities_month_names[month - 1], 3);
+    output[11] = ' ';
+    output[12] = (char)('0' + year / 1000);
+    output[13] = (char)('0' + year / 100 % 10);
+    output[14] = (char)('0' + year / 10 % 10);
+    output[15] = (char)('0' + year % 10);
+
+    memcpy(output + 16, " 00:00:00 GMT", 13);
+    output[17] = (char)('0' + seconds / 36000);
+    output[18] = (char)('0' + seconds / 3600 % 10);
+    output[20] = (char)('0' + seconds % 3600 / 600);
+    output[21] = (char)('0' + seconds % 3600 / 60 % 10);
+    output[23] = (char)('0' + seconds % 60 / 10);
+    output[24] = (char)('0' + seconds % 10);
+}
+
+uint8_t hypertext_Format_Date(uint64_t time, char* output)
+{
+    // IMF-fixdate only has room for four-digit years; 253402300800 is 10000-01-01.
+    if (output == NULL || time >= 253402300800ULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_utilities_format_date(time, output);
+    output[hypertext_utilities_date_length] = '\0';
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Current_Date(hypertext_View* output)
+{
+    if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint64_t now = (uint64_t)time(NULL);
+
+    if (now != hypertext_utilities_current_second)
+    {
+        hypertext_utilities_format_date(now, hypertext_utilities_current_date);
+        hypertext_utilities_current_second = now;
+    }
+
+    output->data   = hypertext_utilities_current_date;
+    output->length = hypertext_utilities_date_length;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Parse_Date(const char* input, size_t length, uint64_t* output)
+{
+    if (input == NULL || output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    return hypertext_utilities_parse_date(input, length, output) ? hypertext_Result_Success : hypertext_Result_Invalid_Parameters;
+}
@@ -0,0 +1,474 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#define hypertext_utilities_encoding_window 16384
+
+// Room in front of every chunk for its size line; the largest one is "ffffffffffffffff\r\n".
+#define hypertext_utilities_encoding_header 18
+
+enum hypertext_utilities_encoder_stage
+{
+    hypertext_utilities_encoder_head,
+    hypertext_utilities_encoder_body,
+    hypertext_utilities_encoder_end,
+    hypertext_utilities_encoder_done
+};
+
+struct hypertext_Encoder
+{
+    z_stream                    stream;
+    bool                        deflating;
+    uint8_t                     stage;
+    uint8_t                     encoding;
+    bool                        chunked;
+    hypertext_Instance*         response;
+    size_t                      offset;
+    char                        length[24];
+    hypertext_utilities_buffer  output;
+};
+
+static const char* hypertext_utilities_encoding_names[hypertext_Content_Encoding_Max] = { "identity", "gzip", "deflate" };
+
+static size_t hypertext_utilities_encoding_find(hypertext_Instance* instance, uint8_t name)
+{
+    for (size_t i = 0; i != instance->field_count; i++) if (hypertext_utilities_is_field(&instance->fields[i], name)) return i;
+
+    return SIZE_MAX;
+}
+
+static const char* hypertext_utilities_skip_whitespace(const char* input)
+{
+    while (*input == ' ' || *input == '\t') input++;
+
+    return input;
+}
+
+// Parses a qvalue as per RFC 9110, section 12.4.2, in thousandths.
+static uint16_t hypertext_utilities_parse_quality(const char* input, size_t length)
+{
+    if (length == 0 || (input[0] != '0' && input[0] != '1')) return 0;
+    else if (input[0] == '1') return 1000;
+
+    uint16_t quality = 0, scale = 100;
+    for (size_t i = 2; i < length && i < 5 && input[1] == '.'; i++, scale /= 10)
+    {
+        if (input[i] < '0' || input[i] > '9') break;
+        quality += (uint16_t)(input[i] - '0') * scale;
+    }
+
+    return quality;
+}
+
+static uint8_t hypertext_utilities_encoding_token(const char* token, size_t length)
+{
+    if (length == 6 && hypertext_utilities_equals_ignore_case(token, "x-gzip", 6)) return hypertext_Content_Encoding_Gzip;
+
+    for (uint8_t i = 0; i != hypertext_Content_Encoding_Max; i++) if (strlen(hypertext_utilities_encoding_names[i]) == length && hypertext_utilities_equals_ignore_case(token, hypertext_utilities_encoding_names[i], length)) return i;
+
+    return hypertext_Content_Encoding_Max;
+}
+
+uint8_t hypertext_Negotiate_Encoding(hypertext_Instance* request, uint8_t* output)
+{
+    if (!hypertext_utilities_is_valid_instance(request)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+
+    // Codings that weren't listed are only acceptable through "*".
+    int32_t quality[hypertext_Content_Encoding_Max] = { -1, -1, -1 }, wildcard = -1;
+
+    for (size_t i = 0; i != request->field_count; i++)
+    {
+        if (!hypertext_utilities_is_field(&request->fields[i], hypertext_utilities_known_Accept_Encoding)) continue;
+
+        for (const char* position = request->fields[i].value; *position != 0;)
+        {
+            position = hypertext_utilities_skip_whitespace(position);
+            if (*position == ',')
+            {
+                position++;
+                continue;
+            }
+
+            const char* token = position;
+            while (hypertext_utilities_is_token_character(*position)) position++;
+
+            size_t token_length = (size_t)(position - token);
+            if (token_length == 0) break;
+
+            int32_t value = 1000;
+
+            for (position = hypertext_utilities_skip_whitespace(position); *position == ';'; position = hypertext_utilities_skip_whitespace(position))
+            {
+                position = hypertext_utilities_skip_whitespace(position + 1);
+
+                const char* name = position;
+                while (hypertext_utilities_is_token_character(*position)) position++;
+
+                size_t name_length = (size_t)(position - name);
+                if (*position != '=') continue;
+
+                const char* parameter = ++position;
+                while (hypertext_utilities_is_token_character(*position)) position++;
+
+                if (name_length == 1 && (name[0] == 'q' || name[0] == 'Q')) value = hypertext_utilities_parse_quality(parameter, (size_t)(position - parameter));
+            }
+
+            uint8_t encoding = hypertext_utilities_encoding_token(token, token_length);
+
+            if (encoding != hypertext_Content_Encoding_Max) quality[encoding] = value;
+            else if (token_length == 1 && token[0] == '*') wildcard = value;
+
+            // Skip anything this parser didn't understand up to the next element.
+            while (*position != 0 && *position != ',') position++;
+        }
+    }
+
+    // An unlisted identity stays acceptable, but only as the last resort.
+    for (uint8_t i = 0; i != hypertext_Content_Encoding_Max; i++) if (quality[i] < 0) quality[i] = wildcard >= 0 ? wildcard : (i == hypertext_Content_Encoding_Identity ? 1 : 0);
+
+    // Compression wins ties; gzip is preferred over deflate, which many clients implement inconsistently.
+    uint8_t best = hypertext_Content_Encoding_Identity;
+    if (quality[hypertext_Content_Encoding_Deflate] > 0 && quality[hypertext_Content_Encoding_Deflate] >= quality[best]) best = hypertext_Content_Encoding_Deflate;
+    if (quality[hypertext_Content_Encoding_Gzip] > 0 && quality[hypertext_Content_Encoding_Gzip] >= quality[best]) best = hypertext_Content_Encoding_Gzip;
+
+    *output = best;
+
+    return hypertext_Result_Success;
+}
+
+hypertext_Encoder* hypertext_New_Encoder()
+{
+    return calloc(1, sizeof(hypertext_Encoder));
+}
+
+void hypertext_Destroy_Encoder(hypertext_Encoder* encoder)
+{
+    if (encoder == NULL) return;
+
+    if (encoder->deflating) deflateEnd(&encoder->stream);
+    hypertext_utilities_release(&encoder->output);
+
+    memset(encoder, 0, sizeof(hypertext_Encoder));
+}
+
+uint8_t hypertext_Start_Encoder(hypertext_Encoder* encoder, hypertext_Instance* response, uint8_t encoding, bool keep_desc, bool keep_compat)
+{
+    if (encoder == NULL || response == NULL || response->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+    else if (encoding >= hypertext_Content_Encoding_Max) return hypertext_Result_Invalid_Parameters;
+    else if (response->file_body || response->segments != NULL) return hypertext_Result_Unsupported;
+
+    hypertext_Destroy_Encoder(encoder);
+
+    hypertext_utilities_field* fields = calloc(response->field_count + 3, sizeof(hypertext_utilities_field));
+    if (fields == NULL) return hypertext_Result_Out_Of_Memory;
+
+    // The framing is decided here, so whatever the response said about it is replaced.
+    size_t count = 0;
+    bool vary = false;
+
+    for (size_t i = 0; i != response->field_count; i++)
+    {
+        const hypertext_utilities_field* field = &response->fields[i];
+
+        if (hypertext_utilities_is_field(field, hypertext_utilities_known_Content_Length) || hypertext_utilities_is_field(field, hypertext_utilities_known_Transfer_Encoding) || hypertext_utilities_is_field(field, hypertext_utilities_known_Content_Encoding)) continue;
+        else if (hypertext_utilities_is_field(field, hypertext_utilities_known_Vary)) vary = true;
+
+        fields[count++] = response->fields[i];
+    }
+
+    // HTTP/1.0 has no chunked coding, so a compressed body there ends with the connection.
+    encoder->encoding   = encoding;
+    encoder->chunked    = encoding != hypertext_Content_Encoding_Identity && response->version == hypertext_HTTP_Version_1_1;
+
+    if (encoding == hypertext_Content_Encoding_Identity)
+    {
+        snprintf(encoder->length, sizeof(encoder->length), "%zu", response->body_length);
+        fields[count++] = hypertext_utilities_make_field("Content-Length", encoder->length);
+    }
+    else
+    {
+        fields[count++] = hypertext_utilities_make_field("Content-Encoding", hypertext_utilities_encoding_names[encoding]);
+
+        if (!vary)              fields[count++] = hypertext_utilities_make_field("Vary", "Accept-Encoding");
+        if (encoder->chunked)   fields[count++] = hypertext_utilities_make_field("Transfer-Encoding", "chunked");
+    }
+
+    size_t length = 0;
+    uint8_t result = hypertext_utilities_output_head(response, fields, count, NULL, &length, keep_desc, keep_compat);
+
+    if (result == hypertext_Result_Success && !hypertext_utilities_reserve(&encoder->output, length)) result = hypertext_Result_Out_Of_Memory;
+    if (result == hypertext_Result_Success) result = hypertext_utilities_output_head(response, fields, count, encoder->output.data, &length, keep_desc, keep_compat);
+
+    free(fields);
+
+    if (result != hypertext_Result_Success) return result;
+    encoder->output.length = length;
+
+    if (encoding != hypertext_Content_Encoding_Identity)
+    {
+        // gzip wraps the stream in a gzip header; deflate uses the zlib format, as per RFC 9110, section 8.4.1.2.
+        if (deflateInit2(&encoder->stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, encoding == hypertext_Content_Encoding_Gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return hypertext_Result_Out_Of_Memory;
+        encoder->deflating = true;
+    }
+
+    encoder->response   = response;
+    encoder->stage      = hypertext_utilities_encoder_head;
+    encoder->offset     = 0;
+
+    return hypertext_Result_Success;
+}
+
+// Compresses the next windows of the body until some output is available, behind the room for a chunk size line.
+static uint8_t hypertext_utilities_encoder_deflate(hypertext_Encoder* encoder, size_t* produced)
+{
+    hypertext_Instance* response = encoder->response;
+    hypertext_utilities_buffer* output = &encoder->output;
+
+    *produced = 0;
+    output->length = 0;
+
+    while (*produced == 0 && encoder->stage == hypertext_utilities_encoder_body)
+    {
+        size_t window = response->body_length - encoder->offset;
+        if (window > hypertext_utilities_encoding_window) window = hypertext_utilities_encoding_window;
+
+        int flush = encoder->offset + window == response->body_length ? Z_FINISH : Z_NO_FLUSH;
+        int result;
+
+        encoder->stream.next_in     = (Bytef*)response->body + encoder->offset;
+        encoder->stream.avail_in    = (uInt)window;
+
+        do
+        {
+            if (!hypertext_utilities_reserve(output, hypertext_utilities_encoding_header + *produced + hypertext_utilities_encoding_window + 2)) return hypertext_Result_Out_Of_Memory;
+
+            size_t space = output->capacity - hypertext_utilities_encoding_header - *produced - 2;
+
+            encoder->stream.next_out    = (Bytef*)output->data + hypertext_utilities_encoding_header + *produced;
+            encoder->stream.avail_out   = (uInt)space;
+
+            result = deflate(&encoder->stream, flush);
+            if (result == Z_STREAM_ERROR) return hypertext_Result_Invalid_Parameters;
+
+            *produced += space - encoder->stream.avail_out;
+        }
+        while (encoder->stream.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+
+        encoder->offset += window;
+        if (flush == Z_FINISH) encoder->stage = hypertext_utilities_encoder_end;
+    }
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Pull_Encoder(hypertext_Encoder* encoder, hypertext_View* output)
+{
+    if (encoder == NULL || encoder->response == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_Instance* response = encoder->response;
+
+    output->data    = NULL;
+    output->length  = 0;
+
+    switch (encoder->stage)
+    {
+    case hypertext_utilities_encoder_head:
+        output->data    = encoder->output.data;
+        output->length  = encoder->output.length;
+
+        encoder->stage = hypertext_utilities_encoder_body;
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_encoder_body:
+        if (encoder->encoding == hypertext_Content_Encoding_Identity)
+        {
+            // Nothing to transform; hand out the body itself, one window at a time.
+            size_t window = response->body_length - encoder->offset;
+            if (window > hypertext_utilities_encoding_window) window = hypertext_utilities_encoding_window;
+
+            output->data    = response->body + encoder->offset;
+            output->length  = window;
+
+            encoder->offset += window;
+            if (encoder->offset == response->body_length) encoder->stage = hypertext_utilities_encoder_done;
+
+            return hypertext_Result_Success;
+        }
+        else
+        {
+            size_t produced;
+
+            uint8_t result = hypertext_utilities_encoder_deflate(encoder, &produced);
+            if (result != hypertext_Result_Success) return result;
+
+            if (produced != 0)
+            {
+                char* data = encoder->output.data + hypertext_utilities_encoding_header;
+
+                if (encoder->chunked)
+                {
+                    char line[hypertext_utilities_encoding_header + 1];
+                    int line_length = snprintf(line, sizeof(line), "%zx\r\n", produced);
+
+                    data -= line_length;
+                    memcpy(data, line, (size_t)line_length);
+                    memcpy(data + line_length + produced, "\r\n", 2);
+
+                    produced += (size_t)line_length + 2;
+                }
+
+                output->data    = data;
+                output->length  = produced;
+
+                return hypertext_Result_Success;
+            }
+        }
+
+        // fall through
+    case hypertext_utilities_encoder_end:
+        encoder->stage = hypertext_utilities_encoder_done;
+
+        if (encoder->chunked)
+        {
+            output->data    = "0\r\n\r\n";
+            output->length  = 5;
+        }
+
+        return hypertext_Result_Success;
+
+    default:
+        return hypertext_Result_Success;
+    }
+}
+
+uint8_t hypertext_Decode_Body(hypertext_Instance* instance, size_t limit)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (instance->file_body || instance->segments != NULL || instance->forward != NULL) return hypertext_Result_Unsupported;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t index = hypertext_utilities_encoding_find(instance, hypertext_utilities_known_Content_Encoding);
+    if (index == SIZE_MAX) return hypertext_Result_Not_Found;
+
+    // Codings stacked over several lines aren't undone.
+    for (size_t i = index + 1; i != instance->field_count; i++) if (hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Encoding)) return hypertext_Result_Unsupported;
+
+    const char* value = hypertext_utilities_skip_whitespace(instance->fields[index].value);
+
+    size_t value_length = strlen(value);
+    while (value_length != 0 && (value[value_length - 1] == ' ' || value[value_length - 1] == '\t')) value_length--;
+
+    uint8_t encoding = hypertext_utilities_encoding_token(value, value_length);
+    if (encoding == hypertext_Content_Encoding_Max) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_utilities_buffer output = { NULL, 0, 0 };
+
+    if (encoding != hypertext_Content_Encoding_Identity && instance->body_length != 0)
+    {
+        const uint8_t* body = (const uint8_t*)instance->body;
+
+        // Some peers send raw deflate data instead of the zlib format, which is told apart by its header check.
+        int bits = 15 + 16;
+        if (encoding == hypertext_Content_Encoding_Deflate) bits = instance->body_length >= 2 && (body[0] & 0x0F) == 8 && (body[0] << 8 | body[1]) % 31 == 0 ? 15 : -15;
+
+        z_stream stream;
+        memset(&stream, 0, sizeof(z_stream));
+
+        if (inflateInit2(&stream, bits) != Z_OK) return hypertext_Result_Out_Of_Memory;
+
+        stream.next_in  = (Bytef*)instance->body;
+        stream.avail_in = (uInt)instance->body_length;
+
+        uint8_t result = hypertext_Result_Success;
+
+        for (;;)
+        {
+            if (!hypertext_utilities_reserve(&output, hypertext_utilities_encoding_window))
+            {
+                result = hypertext_Result_Out_Of_Memory;
+                break;
+            }
+
+            stream.next_out     = (Bytef*)output.data + output.length;
+            stream.avail_out    = (uInt)(output.capacity - output.length);
+
+            int status = inflate(&stream, Z_NO_FLUSH);
+            output.length = output.capacity - stream.avail_out;
+
+            if (limit != 0 && output.length > limit) result = hypertext_Result_Out_Of_Memory;
+            else if (status == Z_STREAM_END)
+            {
+                // gzip allows several members one after another.
+                if (stream.avail_in == 0 || bits != 15 + 16) break;
+                else if (inflateReset(&stream) != Z_OK) result = hypertext_Result_Invalid_Parameters;
+            }
+            else if (status != Z_OK && status != Z_BUF_ERROR) result = hypertext_Result_Invalid_Parameters;
+            else if (status == Z_BUF_ERROR && stream.avail_in == 0) result = hypertext_Result_Invalid_Parameters;
+
+            if (result != hypertext_Result_Success) break;
+        }
+
+        inflateEnd(&stream);
+
+        if (result == hypertext_Result_Success && !hypertext_utilities_append(&output, "", 1)) result = hypertext_Result_Out_Of_Memory;
+        if (result != hypertext_Result_Success)
+        {
+            hypertext_utilities_release(&output);
+            return result;
+        }
+
+        free(instance->body);
+        instance->body          = output.data;
+        instance->body_length   = output.length - 1;
+
+        hypertext_utilities_reset_parameters(instance, hypertext_Parameter_Source_Body);
+    }
+
+    // The body is now identity-coded, so its old coding and length are stale.
+    size_t count = 0;
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        if (hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Encoding) || hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Length)) continue;
+
+        instance->fields[count++] = instance->fields[i];
+    }
+
+    instance->field_count = count;
+
+    return hypertext_Result_Success;
+}
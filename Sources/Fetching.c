@@ -22,9 +22,19 @@
 #include <hypertext.h>
 
 #include "Internals.h"
+#include "Utilities.h"
 
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define hypertext_utilities_sse2
+#endif
+
+// The amount of names looked for in one pass; an interned name's offset into the table is its hash, and it always fits in 16 bits.
+#define hypertext_utilities_fetch_group 16
+#define hypertext_utilities_fetch_none  UINT16_MAX
+
 uint8_t hypertext_Fetch_Method(hypertext_Instance* instance, uint8_t* output)
 {
     if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
@@ -35,6 +45,21 @@ uint8_t hypertext_Fetch_Method(hypertext_Instance* instance, uint8_t* output)
     return hypertext_Result_Success;
 }
 
+uint8_t hypertext_Fetch_Method_Token(hypertext_Instance* instance, hypertext_View* output)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    if (instance->method == hypertext_Method_Extension)
+    {
+        output->data    = instance->method_token;
+        output->length  = instance->method_token_length;
+        return hypertext_Result_Success;
+    }
+
+    return hypertext_utilities_fetch_method_token(instance->method, output) ? hypertext_Result_Success : hypertext_Result_Invalid_Method;
+}
+
 uint8_t hypertext_Fetch_Path(hypertext_Instance* instance, char* output, size_t* length)
 {
     if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
@@ -42,16 +67,35 @@ uint8_t hypertext_Fetch_Path(hypertext_Instance* instance, char* output, size_t*
 
     if (output == NULL)
     {
-        size_t path_length = strlen(instance->path);
-        memcpy(length, &path_length, sizeof(size_t));
+        memcpy(length, &instance->path_length, sizeof(size_t));
         return hypertext_Result_Success;
     }
 
-    strncpy(output, instance->path, *length > strlen(instance->path) ? *length : strlen(instance->path));
+    memcpy(output, instance->path, *length < instance->path_length ? *length : instance->path_length);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Target_Component(hypertext_Instance* instance, uint8_t component, hypertext_View* output)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || component >= hypertext_Target_Component_Max) return hypertext_Result_Invalid_Parameters;
+    else if (!instance->target[component].present) return hypertext_Result_Not_Found;
+
+    output->data    = instance->path + instance->target[component].offset;
+    output->length  = instance->target[component].length;
 
     return hypertext_Result_Success;
 }
 
+uint8_t hypertext_Fetch_Decoded_Target_Component(hypertext_Instance* instance, uint8_t component, hypertext_View* output)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || component >= hypertext_Target_Component_Max) return hypertext_Result_Invalid_Parameters;
+
+    return hypertext_utilities_decode_component(instance, component, output);
+}
+
 uint8_t hypertext_Fetch_Version(hypertext_Instance* instance, uint8_t* output)
 {
     if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
@@ -77,13 +121,220 @@ uint8_t hypertext_Fetch_Header_Field(hypertext_Instance* instance, hypertext_Hea
     if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
     else if (output == NULL || key_name == NULL || strlen(key_name) == 0) return hypertext_Result_Invalid_Parameters;
 
-    for (size_t i = 0; i != instance->field_count; i++) if (strcmp(instance->fields[i].key, key_name) == 0)
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t index = hypertext_utilities_find_field(instance, key_name, strlen(key_name));
+    if (index == SIZE_MAX) return hypertext_Result_Not_Found;
+
+    *output = (hypertext_Header_Field){ instance->fields[index].key, instance->fields[index].value };
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Header_Field_At(hypertext_Instance* instance, size_t index, hypertext_Header_Field* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+    else if (index >= instance->field_count) return hypertext_Result_Not_Found;
+
+    *output = (hypertext_Header_Field){ instance->fields[index].key, instance->fields[index].value };
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Field(hypertext_Instance* instance, const char* name, size_t length, hypertext_Field* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || name == NULL || length == 0) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t index = hypertext_utilities_find_field(instance, name, length);
+    if (index == SIZE_MAX) return hypertext_Result_Not_Found;
+
+    return hypertext_Fetch_Field_At(instance, index, output);
+}
+
+uint8_t hypertext_Fetch_Field_At(hypertext_Instance* instance, size_t index, hypertext_Field* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+    else if (index >= instance->field_count) return hypertext_Result_Not_Found;
+
+    const hypertext_utilities_field* field = &instance->fields[index];
+    *output = (hypertext_Field){ { field->key, field->key_length }, { field->value, field->value_length } };
+
+    return hypertext_Result_Success;
+}
+
+// Returns a bit for every wanted name whose interned offset equals the one given.
+inline static uint32_t hypertext_utilities_fetch_matches(const uint16_t* wanted, uint16_t offset)
+{
+#ifdef hypertext_utilities_sse2
+    const __m128i key   = _mm_set1_epi16((short)offset);
+    const __m128i low   = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)wanted), key);
+    const __m128i high  = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(wanted + 8)), key);
+
+    return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(low, high));
+#else
+    uint32_t matches = 0;
+
+    for (size_t i = 0; i != hypertext_utilities_fetch_group; i++) if (wanted[i] == offset) matches |= 1u << i;
+
+    return matches;
+#endif
+}
+
+// Fills in the first occurrence of up to a group's worth of names in a single walk over the fields; returns the bits of the names that weren't found.
+static uint32_t hypertext_utilities_fetch_group_of(hypertext_Instance* instance, const hypertext_View* names, size_t count, hypertext_Field* output)
+{
+    uint16_t wanted[hypertext_utilities_fetch_group];
+    uint32_t pending = 0;
+
+    for (size_t i = 0; i != hypertext_utilities_fetch_group; i++)
     {
-        memcpy(output, &instance->fields[i], sizeof(hypertext_Header_Field));
-        return hypertext_Result_Success;
+        // Names from hypertext_Intern_Name already are the interned copy, so looking them up again can be skipped.
+        const char* interned = i >= count ? NULL : hypertext_utilities_is_interned(names[i].data) ? names[i].data : hypertext_utilities_intern(names[i].data, names[i].length, false);
+
+        wanted[i] = interned != NULL ? (uint16_t)(interned - hypertext_utilities_name_storage) : hypertext_utilities_fetch_none;
+        if (i < count) pending |= 1u << i;
+    }
+
+    for (size_t i = 0; i != instance->field_count && pending != 0; i++)
+    {
+        const hypertext_utilities_field* field = &instance->fields[i];
+        uint32_t matches = 0;
+
+        // Interned keys only ever match by pointer; the rest are compared by length first, then by content.
+        if (hypertext_utilities_is_interned(field->key)) matches = hypertext_utilities_fetch_matches(wanted, (uint16_t)(field->key - hypertext_utilities_name_storage)) & pending;
+        else for (size_t name = 0; name != count; name++)
+        {
+            if ((pending & 1u << name) != 0 && field->key_length == names[name].length && hypertext_utilities_equals_ignore_case(field->key, names[name].data, names[name].length)) matches |= 1u << name;
+        }
+
+        if (matches == 0) continue;
+
+        for (size_t name = 0; name != count; name++) if ((matches & 1u << name) != 0) output[name] = (hypertext_Field){ { field->key, field->key_length }, { field->value, field->value_length } };
+
+        pending &= ~matches;
+    }
+
+    for (size_t name = 0; name != count; name++) if ((pending & 1u << name) != 0) output[name] = (hypertext_Field){ { NULL, 0 }, { NULL, 0 } };
+
+    return pending;
+}
+
+uint8_t hypertext_Fetch_Fields(hypertext_Instance* instance, const hypertext_View* names, size_t count, hypertext_Field* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (names == NULL || count == 0 || output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    for (size_t i = 0; i != count; i++) if (names[i].data == NULL || names[i].length == 0) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    bool missing = false;
+
+    for (size_t i = 0; i < count; i += hypertext_utilities_fetch_group)
+    {
+        size_t group = count - i < hypertext_utilities_fetch_group ? count - i : hypertext_utilities_fetch_group;
+        if (hypertext_utilities_fetch_group_of(instance, names + i, group, output + i) != 0) missing = true;
+    }
+
+    return missing ? hypertext_Result_Not_Found : hypertext_Result_Success;
+}
+
+uint8_t hypertext_Find_Next_Field(hypertext_Instance* instance, const char* name, size_t length, size_t* position, hypertext_Field* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (position == NULL || output == NULL || (name != NULL && length == 0)) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t index = name != NULL ? hypertext_utilities_next_field(instance, hypertext_utilities_intern(name, length, false), name, length, *position) : *position;
+    if (index >= instance->field_count) return hypertext_Result_Not_Found;
+
+    *position = index + 1;
+
+    return hypertext_Fetch_Field_At(instance, index, output);
+}
+
+uint8_t hypertext_Fetch_Field_Values(hypertext_Instance* instance, const char* name, size_t length, hypertext_View* output, size_t* count)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (name == NULL || length == 0 || count == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    const char* interned = hypertext_utilities_intern(name, length, false);
+    size_t found = 0;
+
+    for (size_t i = hypertext_utilities_next_field(instance, interned, name, length, 0); i != SIZE_MAX; i = hypertext_utilities_next_field(instance, interned, name, length, i + 1))
+    {
+        if (output != NULL && found == *count) break;
+        else if (output != NULL) output[found] = (hypertext_View){ instance->fields[i].value, instance->fields[i].value_length };
+
+        found++;
     }
 
-    return hypertext_Result_Not_Found;
+    if (found == 0) return hypertext_Result_Not_Found;
+
+    *count = found;
+
+    return hypertext_Result_Success;
+}
+
+size_t hypertext_utilities_join_field(hypertext_Instance* instance, const char* name, size_t length, char* output)
+{
+    const char* interned = hypertext_utilities_intern(name, length, false);
+    size_t total = SIZE_MAX;
+
+    for (size_t i = hypertext_utilities_next_field(instance, interned, name, length, 0); i != SIZE_MAX; i = hypertext_utilities_next_field(instance, interned, name, length, i + 1))
+    {
+        if (total == SIZE_MAX) total = 0;
+        else
+        {
+            if (output != NULL) memcpy(output + total, ", ", 2);
+            total += 2;
+        }
+
+        if (output != NULL) memcpy(output + total, instance->fields[i].value, instance->fields[i].value_length);
+        total += instance->fields[i].value_length;
+    }
+
+    return total;
+}
+
+uint8_t hypertext_Fetch_Joined_Field(hypertext_Instance* instance, const char* name, size_t length, char* output, size_t* output_length)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (name == NULL || length == 0 || output_length == NULL) return hypertext_Result_Invalid_Parameters;
+
+    // Set-Cookie values may contain commas themselves, so they can't be joined; as per RFC 9110, section 5.3.
+    if (length == 10 && hypertext_utilities_equals_ignore_case(name, "Set-Cookie", 10)) return hypertext_Result_Unsupported;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t joined = hypertext_utilities_join_field(instance, name, length, NULL);
+    if (joined == SIZE_MAX) return hypertext_Result_Not_Found;
+    else if (output != NULL && *output_length < joined) return hypertext_Result_Invalid_Parameters;
+
+    if (output != NULL) hypertext_utilities_join_field(instance, name, length, output);
+    *output_length = joined;
+
+    return hypertext_Result_Success;
 }
 
 uint8_t hypertext_Fetch_Header_Field_Count(hypertext_Instance* instance, size_t* count)
@@ -91,6 +342,9 @@ uint8_t hypertext_Fetch_Header_Field_Count(hypertext_Instance* instance, size_t*
     if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
     else if (count == NULL) return hypertext_Result_Invalid_Parameters;
 
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
     memcpy(count, &instance->field_count, sizeof(size_t));
 
     return hypertext_Result_Success;
@@ -100,16 +354,15 @@ uint8_t hypertext_Fetch_Body(hypertext_Instance* instance, char* output, size_t*
 {
     if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
     else if (length == NULL) return hypertext_Result_Invalid_Parameters;
-    else if (instance->body == NULL) return hypertext_Result_No_Body;
+    else if (instance->body == NULL && !instance->file_body) return hypertext_Result_No_Body;
 
     if (output == NULL)
     {
-        size_t body_length = strlen(instance->body);
-        memcpy(length, &body_length, sizeof(size_t));
+        memcpy(length, &instance->body_length, sizeof(size_t));
         return hypertext_Result_Success;
     }
 
-    strncpy(output, instance->body, *length > strlen(instance->path) ? *length : strlen(instance->path));
+    if (!hypertext_utilities_read_body(instance, 0, output, *length < instance->body_length ? *length : instance->body_length)) return hypertext_Result_IO_Error;
 
     return hypertext_Result_Success;
 }
@@ -0,0 +1,312 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    size_t                      start;
+    size_t                      length;
+    size_t                      name_length;
+    const char*                 interned;
+    bool                        removed;
+    bool                        replaced;
+    hypertext_utilities_field   replacement;
+} hypertext_utilities_forward_line;
+
+// The received message stays where it is; only the edits made since parsing are kept here.
+struct hypertext_utilities_forward
+{
+    const char*                         source;
+    size_t                              start_line;
+    size_t                              path_offset;
+    size_t                              path_length;
+    size_t                              fields_end;
+    size_t                              end;
+    bool                                path_changed;
+    hypertext_utilities_field*          inserted;
+    size_t                              inserted_count;
+    size_t                              inserted_capacity;
+    size_t                              line_count;
+    hypertext_utilities_forward_line    lines[];
+};
+
+typedef struct
+{
+    hypertext_View* output;
+    size_t          capacity;
+    size_t          count;
+} hypertext_utilities_forward_writer;
+
+// Returns the position following the next line feed, or SIZE_MAX if there's none before end.
+static size_t hypertext_utilities_forward_line_end(const char* input, size_t position, size_t end)
+{
+    const char* newline = memchr(input + position, '\n', end - position);
+
+    return newline != NULL ? (size_t)(newline - input) + 1 : SIZE_MAX;
+}
+
+static bool hypertext_utilities_forward_is_empty_line(const char* input, size_t position, size_t end)
+{
+    return input[position] == '\n' || (input[position] == '\r' && end - position > 1 && input[position + 1] == '\n');
+}
+
+static bool hypertext_utilities_forward_line_named(const hypertext_utilities_forward_line* line, const char* source, const char* interned, const char* name, size_t length)
+{
+    if (line->interned != NULL || interned != NULL) return line->interned == interned;
+
+    return line->name_length == length && hypertext_utilities_equals_ignore_case(source + line->start, name, length);
+}
+
+uint8_t hypertext_utilities_forward_start(hypertext_Instance* instance, const char* input, size_t length)
+{
+    // The parser accepted the message already, so all that's left is finding where its lines are.
+    size_t start_line = 0;
+    while (start_line != length && (input[start_line] == '\r' || input[start_line] == '\n')) start_line++;
+
+    size_t fields = hypertext_utilities_forward_line_end(input, start_line, length);
+    if (fields == SIZE_MAX) return hypertext_Result_Invalid_Parameters;
+
+    size_t count = 0, fields_end = fields;
+    while (fields_end != length && !hypertext_utilities_forward_is_empty_line(input, fields_end, length))
+    {
+        fields_end = hypertext_utilities_forward_line_end(input, fields_end, length);
+        if (fields_end == SIZE_MAX) return hypertext_Result_Invalid_Parameters;
+
+        count++;
+    }
+
+    hypertext_utilities_forward* forward = calloc(1, sizeof(hypertext_utilities_forward) + count * sizeof(hypertext_utilities_forward_line));
+    if (forward == NULL) return hypertext_Result_Out_Of_Memory;
+
+    forward->source         = input;
+    forward->start_line     = start_line;
+    forward->fields_end     = fields_end;
+    forward->end            = length;
+    forward->line_count     = count;
+
+    if (instance->type == hypertext_Instance_Content_Type_Request)
+    {
+        const char* space = memchr(input + start_line, ' ', fields - start_line);
+
+        forward->path_offset    = (size_t)(space - input) + 1;
+        forward->path_length    = instance->path_length;
+    }
+
+    for (size_t i = 0, position = fields; i != count; i++)
+    {
+        hypertext_utilities_forward_line* line = &forward->lines[i];
+        size_t next = hypertext_utilities_forward_line_end(input, position, fields_end);
+
+        line->start         = position;
+        line->length        = next - position;
+        line->name_length   = (size_t)((const char*)memchr(input + position, ':', line->length) - (input + position));
+        line->interned      = hypertext_utilities_intern(input + position, line->name_length, false);
+
+        position = next;
+    }
+
+    instance->forward = forward;
+
+    return hypertext_Result_Success;
+}
+
+void hypertext_utilities_forward_release(hypertext_Instance* instance)
+{
+    if (instance->forward == NULL) return;
+
+    free(instance->forward->inserted);
+    free(instance->forward);
+    instance->forward = NULL;
+}
+
+bool hypertext_utilities_forward_reserve(hypertext_Instance* instance, size_t additional)
+{
+    hypertext_utilities_forward* forward = instance->forward;
+    if (forward == NULL || forward->inserted_count + additional <= forward->inserted_capacity) return true;
+    else if (additional > SIZE_MAX / 2 / sizeof(hypertext_utilities_field) - forward->inserted_count) return false;
+
+    size_t capacity = forward->inserted_capacity != 0 ? forward->inserted_capacity * 2 : 4;
+    while (capacity < forward->inserted_count + additional) capacity *= 2;
+
+    hypertext_utilities_field* inserted = realloc(forward->inserted, sizeof(hypertext_utilities_field) * capacity);
+    if (inserted == NULL) return false;
+
+    forward->inserted           = inserted;
+    forward->inserted_capacity  = capacity;
+
+    return true;
+}
+
+// Drops every added field with this name but the first one, which is returned; NULL if there's none.
+static hypertext_utilities_field* hypertext_utilities_forward_prune(hypertext_utilities_forward* forward, const char* interned, const char* name, size_t length, bool keep_first)
+{
+    hypertext_utilities_field* first = NULL;
+    size_t count = 0;
+
+    for (size_t i = 0; i != forward->inserted_count; i++)
+    {
+        if (hypertext_utilities_field_named(&forward->inserted[i], interned, name, length))
+        {
+            if (!keep_first || first != NULL) continue;
+
+            first = &forward->inserted[count];
+        }
+
+        forward->inserted[count++] = forward->inserted[i];
+    }
+
+    forward->inserted_count = count;
+
+    return first;
+}
+
+// The field with this name now has exactly this value; the first line it came in on carries it, the others are dropped.
+void hypertext_utilities_forward_set(hypertext_Instance* instance, const hypertext_utilities_field* field)
+{
+    hypertext_utilities_forward* forward = instance->forward;
+    if (forward == NULL) return;
+
+    const char* interned = hypertext_utilities_is_interned(field->key) ? field->key : NULL;
+
+    bool placed = false;
+    for (size_t i = 0; i != forward->line_count; i++)
+    {
+        hypertext_utilities_forward_line* line = &forward->lines[i];
+        if (line->removed || !hypertext_utilities_forward_line_named(line, forward->source, interned, field->key, field->key_length)) continue;
+
+        line->removed       = placed;
+        line->replaced      = !placed;
+        line->replacement   = *field;
+        placed              = true;
+    }
+
+    // Space was reserved before the instance changed, so appending can't fail anymore.
+    hypertext_utilities_field* added = hypertext_utilities_forward_prune(forward, interned, field->key, field->key_length, !placed);
+    if (added != NULL) *added = *field;
+    else if (!placed) forward->inserted[forward->inserted_count++] = *field;
+}
+
+// Adds one more occurrence of a field, leaving the others as they are.
+void hypertext_utilities_forward_add(hypertext_Instance* instance, const hypertext_utilities_field* field)
+{
+    if (instance->forward != NULL) instance->forward->inserted[instance->forward->inserted_count++] = *field;
+}
+
+void hypertext_utilities_forward_remove(hypertext_Instance* instance, const char* name, size_t length)
+{
+    hypertext_utilities_forward* forward = instance->forward;
+    if (forward == NULL) return;
+
+    const char* interned = hypertext_utilities_intern(name, length, false);
+
+    hypertext_utilities_forward_prune(forward, interned, name, length, false);
+
+    for (size_t i = 0; i != forward->line_count; i++)
+    {
+        hypertext_utilities_forward_line* line = &forward->lines[i];
+        if (!hypertext_utilities_forward_line_named(line, forward->source, interned, name, length)) continue;
+
+        line->removed   = true;
+        line->replaced  = false;
+    }
+}
+
+void hypertext_utilities_forward_path(hypertext_Instance* instance)
+{
+    if (instance->forward != NULL) instance->forward->path_changed = true;
+}
+
+static void hypertext_utilities_forward_piece(hypertext_utilities_forward_writer* writer, const char* data, size_t length)
+{
+    if (length == 0) return;
+
+    if (writer->count < writer->capacity) writer->output[writer->count] = (hypertext_View){ data, length };
+    writer->count++;
+}
+
+static void hypertext_utilities_forward_field(hypertext_utilities_forward_writer* writer, const hypertext_utilities_field* field)
+{
+    hypertext_utilities_forward_piece(writer, field->key, field->key_length);
+    hypertext_utilities_forward_piece(writer, ": ", 2);
+    hypertext_utilities_forward_piece(writer, field->value, field->value_length);
+    hypertext_utilities_forward_piece(writer, "\r\n", 2);
+}
+
+// Untouched lines next to each other end up in a single view.
+static void hypertext_utilities_forward_write(hypertext_Instance* instance, hypertext_utilities_forward_writer* writer)
+{
+    const hypertext_utilities_forward* forward = instance->forward;
+    const char* source = forward->source;
+    size_t run = forward->start_line;
+
+    if (forward->path_changed)
+    {
+        hypertext_utilities_forward_piece(writer, source + run, forward->path_offset - run);
+        hypertext_utilities_forward_piece(writer, instance->path, instance->path_length);
+        run = forward->path_offset + forward->path_length;
+    }
+
+    for (size_t i = 0; i != forward->line_count; i++)
+    {
+        const hypertext_utilities_forward_line* line = &forward->lines[i];
+        if (!line->removed && !line->replaced) continue;
+
+        hypertext_utilities_forward_piece(writer, source + run, line->start - run);
+        if (line->replaced) hypertext_utilities_forward_field(writer, &line->replacement);
+
+        run = line->start + line->length;
+    }
+
+    if (forward->inserted_count != 0)
+    {
+        hypertext_utilities_forward_piece(writer, source + run, forward->fields_end - run);
+        for (size_t i = 0; i != forward->inserted_count; i++) hypertext_utilities_forward_field(writer, &forward->inserted[i]);
+
+        run = forward->fields_end;
+    }
+
+    // The empty line and the body go out exactly as they were received, chunked framing included.
+    hypertext_utilities_forward_piece(writer, source + run, forward->end - run);
+}
+
+uint8_t hypertext_Output_Forward(hypertext_Instance* instance, hypertext_View* output, size_t* count)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (count == NULL) return hypertext_Result_Invalid_Parameters;
+    else if (instance->forward == NULL) return hypertext_Result_Unsupported;
+
+    hypertext_utilities_forward_writer writer = { output, output != NULL ? *count : 0, 0 };
+    hypertext_utilities_forward_write(instance, &writer);
+
+    bool fits = writer.count <= writer.capacity;
+    *count = writer.count;
+
+    if (output != NULL && !fits) return hypertext_Result_Invalid_Parameters;
+
+    return hypertext_Result_Success;
+}
@@ -0,0 +1,261 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+typedef volatile long hypertext_utilities_counter;
+
+#define hypertext_utilities_counter_set(counter, value) (*(counter) = (value))
+#define hypertext_utilities_counter_increment(counter)  _InterlockedIncrement(counter)
+#define hypertext_utilities_counter_decrement(counter)  _InterlockedDecrement(counter)
+#else
+#include <stdatomic.h>
+
+typedef atomic_long hypertext_utilities_counter;
+
+#define hypertext_utilities_counter_set(counter, value) atomic_init(counter, value)
+#define hypertext_utilities_counter_increment(counter)  atomic_fetch_add_explicit(counter, 1, memory_order_relaxed)
+
+// The last release has to see every write made by the other owners before the block is freed.
+#define hypertext_utilities_counter_decrement(counter)  (atomic_fetch_sub_explicit(counter, 1, memory_order_acq_rel) - 1)
+#endif
+
+// Every array within the block starts at a multiple of this.
+#define hypertext_utilities_frozen_alignment 16
+
+struct hypertext_Frozen
+{
+    hypertext_utilities_counter references;
+    hypertext_Instance          instance;
+    char*                       output;
+    size_t                      output_length;
+};
+
+inline static size_t hypertext_utilities_frozen_align(size_t size)
+{
+    return (size + hypertext_utilities_frozen_alignment - 1) & ~(size_t)(hypertext_utilities_frozen_alignment - 1);
+}
+
+// Hands out consecutive pieces of the block; measuring only if the block doesn't exist yet.
+inline static void* hypertext_utilities_frozen_take(char* block, size_t* position, size_t size)
+{
+    void* piece = block != NULL ? block + *position : NULL;
+    *position += size;
+
+    return piece;
+}
+
+inline static char* hypertext_utilities_frozen_copy(char* block, size_t* position, const char* text, size_t length)
+{
+    char* copy = hypertext_utilities_frozen_take(block, position, length + 1);
+
+    if (copy != NULL)
+    {
+        if (length != 0) memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+
+    return copy;
+}
+
+// Moves a pointer into the original path or body over to the copy within the block.
+static const char* hypertext_utilities_frozen_rebase(const char* pointer, hypertext_Instance* original, hypertext_Instance* copy)
+{
+    if (original->path != NULL && pointer >= original->path && pointer <= original->path + original->path_length) return copy->path + (pointer - original->path);
+    else if (original->body != NULL && pointer >= original->body && pointer <= original->body + original->body_length) return copy->body + (pointer - original->body);
+
+    return pointer;
+}
+
+// Lays out the instance within block, or only measures it if block is NULL.
+static size_t hypertext_utilities_frozen_layout(hypertext_Instance* instance, char* block, size_t output_length)
+{
+    hypertext_Frozen* frozen = (hypertext_Frozen*)block;
+    hypertext_Instance* copy = frozen != NULL ? &frozen->instance : NULL;
+    size_t position = hypertext_utilities_frozen_align(sizeof(hypertext_Frozen));
+
+    hypertext_utilities_field* fields = hypertext_utilities_frozen_take(block, &position, hypertext_utilities_frozen_align(instance->field_count * sizeof(hypertext_utilities_field)));
+
+    hypertext_utilities_parameter* entries[hypertext_Parameter_Source_Max];
+    size_t* slots[hypertext_Parameter_Source_Max];
+    for (uint8_t i = 0; i != hypertext_Parameter_Source_Max; i++)
+    {
+        entries[i]  = hypertext_utilities_frozen_take(block, &position, hypertext_utilities_frozen_align(instance->parameters[i].count * sizeof(hypertext_utilities_parameter)));
+        slots[i]    = hypertext_utilities_frozen_take(block, &position, hypertext_utilities_frozen_align(instance->parameters[i].slot_count * sizeof(size_t)));
+    }
+
+    // Characters need no alignment, so they all follow the arrays.
+    if (copy != NULL)
+    {
+        memcpy(copy, instance, sizeof(hypertext_Instance));
+
+        copy->fields            = instance->field_count != 0 ? fields : NULL;
+        copy->field_capacity    = instance->field_count;
+        copy->field_text        = NULL;
+        copy->field_blocks      = NULL;
+        copy->segment_text      = NULL;
+        copy->field_source      = NULL;
+        copy->forward           = NULL;
+        copy->frozen            = true;
+    }
+
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        const hypertext_utilities_field* field = &instance->fields[i];
+
+        // Interned names outlive every instance, so the copy can keep pointing at them.
+        char* key   = hypertext_utilities_is_interned(field->key) ? field->key : hypertext_utilities_frozen_copy(block, &position, field->key, field->key_length);
+        char* value = hypertext_utilities_frozen_copy(block, &position, field->value, field->value_length);
+
+        if (copy != NULL) fields[i] = (hypertext_utilities_field){ key, value, field->key_length, field->value_length };
+    }
+
+    char* path          = instance->path != NULL ? hypertext_utilities_frozen_copy(block, &position, instance->path, instance->path_length) : NULL;
+    char* method_token  = instance->method_token != NULL ? hypertext_utilities_frozen_copy(block, &position, instance->method_token, instance->method_token_length) : NULL;
+    char* body          = instance->body != NULL ? hypertext_utilities_frozen_copy(block, &position, instance->body, instance->body_length) : NULL;
+
+    if (copy != NULL)
+    {
+        copy->path          = path;
+        copy->method_token  = method_token;
+        copy->body          = body;
+    }
+
+    for (uint8_t i = 0; i != hypertext_Target_Component_Max; i++)
+    {
+        hypertext_utilities_component* component = &instance->target[i];
+        char* decoded = component->decoded_data != NULL ? hypertext_utilities_frozen_copy(block, &position, component->decoded_data, component->decoded_length) : NULL;
+
+        if (copy != NULL) copy->target[i].decoded_data = decoded;
+    }
+
+    for (uint8_t i = 0; copy != NULL && i != hypertext_Parameter_Source_Max; i++)
+    {
+        hypertext_utilities_parameters* index = &instance->parameters[i];
+
+        copy->parameters[i].entries = index->count != 0 ? entries[i] : NULL;
+        copy->parameters[i].slots   = index->slot_count != 0 ? slots[i] : NULL;
+
+        if (index->slot_count != 0) memcpy(slots[i], index->slots, index->slot_count * sizeof(size_t));
+
+        for (size_t j = 0; j != index->count; j++)
+        {
+            entries[i][j] = index->entries[j];
+            entries[i][j].parameter.name.data   = hypertext_utilities_frozen_rebase(index->entries[j].parameter.name.data, instance, copy);
+            entries[i][j].parameter.value.data  = hypertext_utilities_frozen_rebase(index->entries[j].parameter.value.data, instance, copy);
+        }
+    }
+
+    char* output = hypertext_utilities_frozen_take(block, &position, output_length + 1);
+    if (frozen != NULL)
+    {
+        frozen->output          = output;
+        frozen->output_length   = output_length;
+    }
+
+    return position;
+}
+
+uint8_t hypertext_Freeze(hypertext_Instance* instance, bool keep_desc, bool keep_compat, hypertext_Frozen** output)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+    else if (instance->file_body || instance->segments != NULL) return hypertext_Result_Unsupported;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    // Everything that's otherwise computed on first use is computed now, so readers never write to the copy.
+    for (uint8_t i = 0; i != hypertext_Target_Component_Max; i++)
+    {
+        hypertext_View unused;
+        uint8_t result = hypertext_utilities_decode_component(instance, i, &unused);
+        if (result == hypertext_Result_Out_Of_Memory) return result;
+    }
+
+    for (uint8_t i = 0; i != hypertext_Parameter_Source_Max; i++) if (hypertext_utilities_build_parameters(instance, i) == hypertext_Result_Out_Of_Memory) return hypertext_Result_Out_Of_Memory;
+
+    size_t output_length = 0;
+    uint8_t result = instance->type == hypertext_Instance_Content_Type_Request ? hypertext_Output_Request(instance, NULL, &output_length, keep_compat) : hypertext_Output_Response(instance, NULL, &output_length, keep_desc, keep_compat);
+    if (result != hypertext_Result_Success) return result;
+
+    char* block = malloc(hypertext_utilities_frozen_layout(instance, NULL, output_length));
+    if (block == NULL) return hypertext_Result_Out_Of_Memory;
+
+    hypertext_utilities_frozen_layout(instance, block, output_length);
+
+    hypertext_Frozen* frozen = (hypertext_Frozen*)block;
+    hypertext_utilities_counter_set(&frozen->references, 1);
+
+    result = frozen->instance.type == hypertext_Instance_Content_Type_Request ? hypertext_Output_Request(&frozen->instance, frozen->output, &output_length, keep_compat) : hypertext_Output_Response(&frozen->instance, frozen->output, &output_length, keep_desc, keep_compat);
+    if (result != hypertext_Result_Success)
+    {
+        free(block);
+        return result;
+    }
+
+    frozen->output[output_length] = '\0';
+    *output = frozen;
+
+    return hypertext_Result_Success;
+}
+
+hypertext_Frozen* hypertext_Acquire_Frozen(hypertext_Frozen* frozen)
+{
+    if (frozen != NULL) hypertext_utilities_counter_increment(&frozen->references);
+
+    return frozen;
+}
+
+void hypertext_Release_Frozen(hypertext_Frozen* frozen)
+{
+    if (frozen != NULL && hypertext_utilities_counter_decrement(&frozen->references) == 0) free(frozen);
+}
+
+uint8_t hypertext_Fetch_Frozen_Instance(hypertext_Frozen* frozen, hypertext_Instance** output)
+{
+    if (frozen == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    *output = &frozen->instance;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Frozen_Output(hypertext_Frozen* frozen, hypertext_View* output)
+{
+    if (frozen == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    output->data    = frozen->output;
+    output->length  = frozen->output_length;
+
+    return hypertext_Result_Success;
+}
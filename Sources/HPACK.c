@@ -0,0 +1,680 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Huffman code as per RFC 7541, appendix B.
+static const uint32_t hypertext_utilities_huffman_codes[257] =
+{
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+    0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+    0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+    0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+    0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+    0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+    0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+    0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+    0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+    0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+    0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+    0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+    0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+    0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+    0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+    0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+    0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+    0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+    0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+    0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+    0x3fffffff
+};
+
+static const uint8_t hypertext_utilities_huffman_lengths[257] =
+{
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30
+};
+
+// Symbols sorted by code length and value; the code is canonical, so this is all the decoder needs.
+static const uint16_t hypertext_utilities_huffman_symbols[257] =
+{
+    48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51,
+    52, 53, 54, 55, 56, 57, 61, 65, 95, 98, 100, 102, 103, 104, 108, 109,
+    110, 112, 114, 117, 58, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
+    77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118,
+    119, 120, 121, 122, 38, 42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39,
+    43, 124, 35, 62, 0, 36, 64, 91, 93, 126, 94, 125, 60, 96, 123, 92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+    179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+    163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233, 1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+    158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142,
+    144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+    212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+    2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20,
+    21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 127, 220, 249, 10, 13, 22,
+    256
+};
+
+// First code, amount of codes and position within the sorted symbols, per code length.
+static const uint32_t hypertext_utilities_huffman_first[31] =
+{
+    0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x14, 0x5c, 0xf8, 0x0, 0x3f8, 0x7fa, 0xffa, 0x1ff8, 0x3ffc, 0x7ffc,
+    0x0, 0x0, 0x0, 0x7fff0, 0xfffe6, 0x1fffdc, 0x3fffd2, 0x7fffd8, 0xffffea, 0x1ffffec, 0x3ffffe0, 0x7ffffde, 0xfffffe2, 0x0, 0x3ffffffc
+};
+
+static const uint16_t hypertext_utilities_huffman_counts[31] =
+{
+    0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3,
+    0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 4
+};
+
+static const uint16_t hypertext_utilities_huffman_offsets[31] =
+{
+    0, 0, 0, 0, 0, 0, 10, 36, 68, 0, 74, 79, 82, 84, 90, 92,
+    0, 0, 0, 95, 98, 106, 119, 145, 174, 186, 190, 205, 224, 0, 253
+};
+
+typedef struct
+{
+    const char* name;
+    size_t      name_length;
+    const char* value;
+    size_t      value_length;
+} hypertext_utilities_hpack_static_entry;
+
+#define hypertext_utilities_hpack_entry(name, value) { name, sizeof(name) - 1, value, sizeof(value) - 1 }
+
+// Static table as per RFC 7541, appendix A; index 0 is unused.
+static const hypertext_utilities_hpack_static_entry hypertext_utilities_hpack_static[62] =
+{
+    hypertext_utilities_hpack_entry("", ""),
+    hypertext_utilities_hpack_entry(":authority", ""),
+    hypertext_utilities_hpack_entry(":method", "GET"),
+    hypertext_utilities_hpack_entry(":method", "POST"),
+    hypertext_utilities_hpack_entry(":path", "/"),
+    hypertext_utilities_hpack_entry(":path", "/index.html"),
+    hypertext_utilities_hpack_entry(":scheme", "http"),
+    hypertext_utilities_hpack_entry(":scheme", "https"),
+    hypertext_utilities_hpack_entry(":status", "200"),
+    hypertext_utilities_hpack_entry(":status", "204"),
+    hypertext_utilities_hpack_entry(":status", "206"),
+    hypertext_utilities_hpack_entry(":status", "304"),
+    hypertext_utilities_hpack_entry(":status", "400"),
+    hypertext_utilities_hpack_entry(":status", "404"),
+    hypertext_utilities_hpack_entry(":status", "500"),
+    hypertext_utilities_hpack_entry("accept-charset", ""),
+    hypertext_utilities_hpack_entry("accept-encoding", "gzip, deflate"),
+    hypertext_utilities_hpack_entry("accept-language", ""),
+    hypertext_utilities_hpack_entry("accept-ranges", ""),
+    hypertext_utilities_hpack_entry("accept", ""),
+    hypertext_utilities_hpack_entry("access-control-allow-origin", ""),
+    hypertext_utilities_hpack_entry("age", ""),
+    hypertext_utilities_hpack_entry("allow", ""),
+    hypertext_utilities_hpack_entry("authorization", ""),
+    hypertext_utilities_hpack_entry("cache-control", ""),
+    hypertext_utilities_hpack_entry("content-disposition", ""),
+    hypertext_utilities_hpack_entry("content-encoding", ""),
+    hypertext_utilities_hpack_entry("content-language", ""),
+    hypertext_utilities_hpack_entry("content-length", ""),
+    hypertext_utilities_hpack_entry("content-location", ""),
+    hypertext_utilities_hpack_entry("content-range", ""),
+    hypertext_utilities_hpack_entry("content-type", ""),
+    hypertext_utilities_hpack_entry("cookie", ""),
+    hypertext_utilities_hpack_entry("date", ""),
+    hypertext_utilities_hpack_entry("etag", ""),
+    hypertext_utilities_hpack_entry("expect", ""),
+    hypertext_utilities_hpack_entry("expires", ""),
+    hypertext_utilities_hpack_entry("from", ""),
+    hypertext_utilities_hpack_entry("host", ""),
+    hypertext_utilities_hpack_entry("if-match", ""),
+    hypertext_utilities_hpack_entry("if-modified-since", ""),
+    hypertext_utilities_hpack_entry("if-none-match", ""),
+    hypertext_utilities_hpack_entry("if-range", ""),
+    hypertext_utilities_hpack_entry("if-unmodified-since", ""),
+    hypertext_utilities_hpack_entry("last-modified", ""),
+    hypertext_utilities_hpack_entry("link", ""),
+    hypertext_utilities_hpack_entry("location", ""),
+    hypertext_utilities_hpack_entry("max-forwards", ""),
+    hypertext_utilities_hpack_entry("proxy-authenticate", ""),
+    hypertext_utilities_hpack_entry("proxy-authorization", ""),
+    hypertext_utilities_hpack_entry("range", ""),
+    hypertext_utilities_hpack_entry("referer", ""),
+    hypertext_utilities_hpack_entry("refresh", ""),
+    hypertext_utilities_hpack_entry("retry-after", ""),
+    hypertext_utilities_hpack_entry("server", ""),
+    hypertext_utilities_hpack_entry("set-cookie", ""),
+    hypertext_utilities_hpack_entry("strict-transport-security", ""),
+    hypertext_utilities_hpack_entry("transfer-encoding", ""),
+    hypertext_utilities_hpack_entry("user-agent", ""),
+    hypertext_utilities_hpack_entry("vary", ""),
+    hypertext_utilities_hpack_entry("via", ""),
+    hypertext_utilities_hpack_entry("www-authenticate", "")
+};
+
+#define hypertext_utilities_hpack_static_count  61
+#define hypertext_utilities_hpack_entry_overhead 32
+
+typedef struct
+{
+    char*   data;
+    size_t  name_length;
+    size_t  value_length;
+} hypertext_utilities_hpack_entry;
+
+struct hypertext_HPACK
+{
+    hypertext_utilities_hpack_entry*    entries;
+    size_t                              capacity;
+    size_t                              next;
+    size_t                              count;
+    size_t                              size;
+    size_t                              max_size;
+    size_t                              limit;
+    bool                                pending_update;
+    hypertext_utilities_buffer          buffer;
+    size_t*                             offsets;
+    hypertext_Header_Field*             fields;
+    size_t                              field_capacity;
+};
+
+static inline hypertext_utilities_hpack_entry* hypertext_utilities_hpack_dynamic(hypertext_HPACK* context, size_t position)
+{
+    return &context->entries[(context->next - 1 - position) & (context->capacity - 1)];
+}
+
+static void hypertext_utilities_hpack_evict(hypertext_HPACK* context, size_t max_size)
+{
+    while (context->count != 0 && context->size > max_size)
+    {
+        hypertext_utilities_hpack_entry* oldest = hypertext_utilities_hpack_dynamic(context, context->count - 1);
+
+        context->size -= oldest->name_length + oldest->value_length + hypertext_utilities_hpack_entry_overhead;
+        context->count--;
+
+        free(oldest->data);
+        oldest->data = NULL;
+    }
+}
+
+static bool hypertext_utilities_hpack_insert(hypertext_HPACK* context, const char* name, size_t name_length, const char* value, size_t value_length, bool lower)
+{
+    size_t size = name_length + value_length + hypertext_utilities_hpack_entry_overhead;
+
+    // An entry larger than the table empties it, but isn't added; as per RFC 7541, section 4.4.
+    if (size > context->max_size)
+    {
+        hypertext_utilities_hpack_evict(context, 0);
+        return true;
+    }
+
+    // The name may refer to an entry that's about to be evicted, so it's copied first.
+    char* data = malloc(name_length + value_length + 2);
+    if (data == NULL) return false;
+
+    for (size_t i = 0; i != name_length; i++) data[i] = lower ? hypertext_utilities_to_lower(name[i]) : name[i];
+    data[name_length] = 0;
+    memcpy(data + name_length + 1, value, value_length);
+    data[name_length + value_length + 1] = 0;
+
+    hypertext_utilities_hpack_evict(context, context->max_size - size);
+
+    if (context->count == context->capacity)
+    {
+        size_t capacity = context->capacity != 0 ? context->capacity * 2 : 16;
+
+        hypertext_utilities_hpack_entry* entries = calloc(capacity, sizeof(hypertext_utilities_hpack_entry));
+        if (entries == NULL)
+        {
+            free(data);
+            return false;
+        }
+
+        for (size_t i = 0; i != context->count; i++) entries[i] = *hypertext_utilities_hpack_dynamic(context, context->count - 1 - i);
+
+        free(context->entries);
+        context->entries    = entries;
+        context->capacity   = capacity;
+        context->next       = context->count;
+    }
+
+    hypertext_utilities_hpack_entry* entry = &context->entries[context->next & (context->capacity - 1)];
+    entry->data         = data;
+    entry->name_length  = name_length;
+    entry->value_length = value_length;
+
+    context->next = (context->next + 1) & (context->capacity - 1);
+    context->count++;
+    context->size += size;
+
+    return true;
+}
+
+// Resolves an index of the combined address space; 1 to 61 are static, everything above is dynamic.
+static bool hypertext_utilities_hpack_lookup(hypertext_HPACK* context, size_t index, hypertext_View* name, hypertext_View* value)
+{
+    if (index == 0) return false;
+    else if (index <= hypertext_utilities_hpack_static_count)
+    {
+        name->data      = hypertext_utilities_hpack_static[index].name;
+        name->length    = hypertext_utilities_hpack_static[index].name_length;
+        value->data     = hypertext_utilities_hpack_static[index].value;
+        value->length   = hypertext_utilities_hpack_static[index].value_length;
+
+        return true;
+    }
+    else if (index - hypertext_utilities_hpack_static_count > context->count) return false;
+
+    hypertext_utilities_hpack_entry* entry = hypertext_utilities_hpack_dynamic(context, index - hypertext_utilities_hpack_static_count - 1);
+
+    name->data      = entry->data;
+    name->length    = entry->name_length;
+    value->data     = entry->data + entry->name_length + 1;
+    value->length   = entry->value_length;
+
+    return true;
+}
+
+// Returns the best index for a field: a full match if possible, otherwise one with the same name.
+static size_t hypertext_utilities_hpack_find(hypertext_HPACK* context, const char* name, size_t name_length, const char* value, size_t value_length, bool* full)
+{
+    size_t name_match = 0;
+    *full = false;
+
+    for (size_t i = 1; i <= hypertext_utilities_hpack_static_count; i++)
+    {
+        const hypertext_utilities_hpack_static_entry* entry = &hypertext_utilities_hpack_static[i];
+        if (entry->name_length != name_length || !hypertext_utilities_equals_ignore_case(entry->name, name, name_length)) continue;
+
+        if (entry->value_length == value_length && memcmp(entry->value, value, value_length) == 0)
+        {
+            *full = true;
+            return i;
+        }
+        else if (name_match == 0) name_match = i;
+    }
+
+    for (size_t i = 0; i != context->count; i++)
+    {
+        hypertext_utilities_hpack_entry* entry = hypertext_utilities_hpack_dynamic(context, i);
+        if (entry->name_length != name_length || !hypertext_utilities_equals_ignore_case(entry->data, name, name_length)) continue;
+
+        if (entry->value_length == value_length && memcmp(entry->data + name_length + 1, value, value_length) == 0)
+        {
+            *full = true;
+            return hypertext_utilities_hpack_static_count + 1 + i;
+        }
+        else if (name_match == 0) name_match = hypertext_utilities_hpack_static_count + 1 + i;
+    }
+
+    return name_match;
+}
+
+static bool hypertext_utilities_hpack_encode_integer(hypertext_utilities_buffer* buffer, uint8_t prefix, uint8_t flags, size_t value)
+{
+    size_t limit = ((size_t)1 << prefix) - 1;
+    if (!hypertext_utilities_reserve(buffer, 1 + sizeof(size_t) * 2)) return false;
+
+    if (value < limit)
+    {
+        buffer->data[buffer->length++] = (char)(flags | value);
+        return true;
+    }
+
+    buffer->data[buffer->length++] = (char)(flags | limit);
+    value -= limit;
+
+    for (; value >= 128; value >>= 7) buffer->data[buffer->length++] = (char)((value & 127) | 128);
+    buffer->data[buffer->length++] = (char)value;
+
+    return true;
+}
+
+static bool hypertext_utilities_hpack_encode_string(hypertext_utilities_buffer* buffer, const char* input, size_t length, bool lower)
+{
+    size_t bits = 0;
+    for (size_t i = 0; i != length; i++) bits += hypertext_utilities_huffman_lengths[(uint8_t)(lower ? hypertext_utilities_to_lower(input[i]) : input[i])];
+
+    size_t huffman_length = (bits + 7) / 8;
+
+    if (huffman_length > length)
+    {
+        if (!hypertext_utilities_hpack_encode_integer(buffer, 7, 0, length) || !hypertext_utilities_reserve(buffer, length)) return false;
+
+        for (size_t i = 0; i != length; i++) buffer->data[buffer->length++] = lower ? hypertext_utilities_to_lower(input[i]) : input[i];
+
+        return true;
+    }
+
+    if (!hypertext_utilities_hpack_encode_integer(buffer, 7, 0x80, huffman_length) || !hypertext_utilities_reserve(buffer, huffman_length)) return false;
+
+    uint64_t accumulator = 0;
+    uint8_t pending = 0;
+
+    for (size_t i = 0; i != length; i++)
+    {
+        uint8_t symbol = (uint8_t)(lower ? hypertext_utilities_to_lower(input[i]) : input[i]);
+
+        accumulator = accumulator << hypertext_utilities_huffman_lengths[symbol] | hypertext_utilities_huffman_codes[symbol];
+        pending     += hypertext_utilities_huffman_lengths[symbol];
+
+        for (; pending >= 8; pending -= 8) buffer->data[buffer->length++] = (char)(accumulator >> (pending - 8));
+    }
+
+    // The last octet is padded with the most significant bits of the EOS symbol, which are all ones.
+    if (pending != 0) buffer->data[buffer->length++] = (char)(accumulator << (8 - pending) | (0xFF >> pending));
+
+    return true;
+}
+
+static bool hypertext_utilities_hpack_decode_integer(const uint8_t* input, size_t length, size_t* position, uint8_t prefix, size_t* output)
+{
+    size_t limit = ((size_t)1 << prefix) - 1;
+    size_t value = input[(*position)++] & limit;
+
+    if (value == limit)
+    {
+        uint8_t byte, shift = 0;
+        do
+        {
+            if (*position == length || shift > 21) return false;
+
+            byte    = input[(*position)++];
+            value   += (size_t)(byte & 127) << shift;
+            shift   += 7;
+        }
+        while (byte & 128);
+    }
+
+    *output = value;
+
+    return true;
+}
+
+static bool hypertext_utilities_hpack_decode_string(hypertext_utilities_buffer* buffer, const uint8_t* input, size_t length, size_t* position)
+{
+    if (*position == length) return false;
+
+    bool huffman = (input[*position] & 0x80) != 0;
+
+    size_t string_length;
+    if (!hypertext_utilities_hpack_decode_integer(input, length, position, 7, &string_length) || string_length > length - *position) return false;
+
+    const uint8_t* string = input + *position;
+    *position += string_length;
+
+    if (!huffman) return hypertext_utilities_append(buffer, string, string_length) && hypertext_utilities_append(buffer, "", 1);
+
+    // Every symbol is at least five bits long, so this is enough for the whole string.
+    if (!hypertext_utilities_reserve(buffer, string_length * 8 / 5 + 1)) return false;
+
+    uint32_t code = 0;
+    uint8_t bits = 0;
+
+    for (size_t i = 0; i != string_length; i++) for (int8_t bit = 7; bit >= 0; bit--)
+    {
+        code = code << 1 | ((string[i] >> bit) & 1);
+        if (++bits > 30) return false;
+
+        uint32_t offset = code - hypertext_utilities_huffman_first[bits];
+        if (offset >= hypertext_utilities_huffman_counts[bits]) continue;
+
+        uint16_t symbol = hypertext_utilities_huffman_symbols[hypertext_utilities_huffman_offsets[bits] + offset];
+        if (symbol == 256) return false;
+
+        buffer->data[buffer->length++] = (char)symbol;
+        code = 0;
+        bits = 0;
+    }
+
+    // Padding must be shorter than an octet and consist of ones only.
+    if (bits > 7 || code != ((uint32_t)1 << bits) - 1) return false;
+
+    buffer->data[buffer->length++] = 0;
+
+    return true;
+}
+
+static bool hypertext_utilities_hpack_is_valid_value(const char* value, size_t length)
+{
+    for (size_t i = 0; i != length; i++) if (value[i] == 0 || value[i] == '\r' || value[i] == '\n') return false;
+
+    return true;
+}
+
+hypertext_HPACK* hypertext_New_HPACK(size_t table_size)
+{
+    hypertext_HPACK* context = calloc(1, sizeof(hypertext_HPACK));
+    if (context == NULL) return NULL;
+
+    context->max_size   = table_size;
+    context->limit      = table_size;
+
+    return context;
+}
+
+void hypertext_Destroy_HPACK(hypertext_HPACK* context)
+{
+    if (context == NULL) return;
+
+    hypertext_utilities_hpack_evict(context, 0);
+    hypertext_utilities_release(&context->buffer);
+
+    free(context->entries);
+    free(context->offsets);
+    free(context->fields);
+
+    context->entries        = NULL;
+    context->capacity       = 0;
+    context->next           = 0;
+    context->offsets        = NULL;
+    context->fields         = NULL;
+    context->field_capacity = 0;
+    context->max_size       = context->limit;
+    context->pending_update = false;
+}
+
+uint8_t hypertext_Resize_HPACK(hypertext_HPACK* context, size_t table_size)
+{
+    if (context == NULL) return hypertext_Result_Invalid_Instance;
+
+    context->limit          = table_size;
+    context->max_size       = table_size;
+    context->pending_update = true;
+
+    hypertext_utilities_hpack_evict(context, table_size);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Encode_HPACK(hypertext_HPACK* context, const hypertext_Header_Field* fields, size_t field_count, hypertext_View* output)
+{
+    if (context == NULL) return hypertext_Result_Invalid_Instance;
+    else if ((fields == NULL && field_count != 0) || output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_utilities_buffer* buffer = &context->buffer;
+    buffer->length = 0;
+
+    if (context->pending_update)
+    {
+        if (!hypertext_utilities_hpack_encode_integer(buffer, 5, 0x20, context->max_size)) return hypertext_Result_Out_Of_Memory;
+        context->pending_update = false;
+    }
+
+    for (size_t i = 0; i != field_count; i++)
+    {
+        if (fields[i].key == NULL || fields[i].value == NULL) return hypertext_Result_Invalid_Parameters;
+
+        size_t name_length  = strlen(fields[i].key);
+        size_t value_length = strlen(fields[i].value);
+
+        bool full;
+        size_t index = hypertext_utilities_hpack_find(context, fields[i].key, name_length, fields[i].value, value_length, &full);
+
+        if (full)
+        {
+            if (!hypertext_utilities_hpack_encode_integer(buffer, 7, 0x80, index)) return hypertext_Result_Out_Of_Memory;
+            continue;
+        }
+
+        // Credentials are never indexed, so they can't be probed through the dynamic table.
+        bool sensitive  = (name_length == 13 && hypertext_utilities_equals_ignore_case(fields[i].key, "authorization", 13)) || (name_length == 19 && hypertext_utilities_equals_ignore_case(fields[i].key, "proxy-authorization", 19));
+        bool indexed    = !sensitive && name_length + value_length + hypertext_utilities_hpack_entry_overhead <= context->max_size;
+
+        bool result = indexed ? hypertext_utilities_hpack_encode_integer(buffer, 6, 0x40, index) : hypertext_utilities_hpack_encode_integer(buffer, 4, sensitive ? 0x10 : 0, index);
+
+        if (result && index == 0) result = hypertext_utilities_hpack_encode_string(buffer, fields[i].key, name_length, true);
+        if (result) result = hypertext_utilities_hpack_encode_string(buffer, fields[i].value, value_length, false);
+        if (result && indexed) result = hypertext_utilities_hpack_insert(context, fields[i].key, name_length, fields[i].value, value_length, true);
+
+        if (!result) return hypertext_Result_Out_Of_Memory;
+    }
+
+    output->data    = buffer->data;
+    output->length  = buffer->length;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Decode_HPACK(hypertext_HPACK* context, const char* input, size_t length, hypertext_Header_Field** fields, size_t* field_count)
+{
+    if (context == NULL) return hypertext_Result_Invalid_Instance;
+    else if ((input == NULL && length != 0) || fields == NULL || field_count == NULL) return hypertext_Result_Invalid_Parameters;
+
+    const uint8_t* block = (const uint8_t*)input;
+    hypertext_utilities_buffer* buffer = &context->buffer;
+
+    size_t position = 0, count = 0;
+    buffer->length = 0;
+
+    while (position != length)
+    {
+        uint8_t representation = block[position];
+        size_t index;
+
+        if ((representation & 0xE0) == 0x20)
+        {
+            // Table size updates are only allowed in front of the first field.
+            if (count != 0 || !hypertext_utilities_hpack_decode_integer(block, length, &position, 5, &index) || index > context->limit) return hypertext_Result_Invalid_Parameters;
+
+            context->max_size = index;
+            hypertext_utilities_hpack_evict(context, index);
+            continue;
+        }
+
+        if (count == context->field_capacity)
+        {
+            size_t capacity = context->field_capacity != 0 ? context->field_capacity * 2 : 16;
+
+            size_t* offsets = realloc(context->offsets, sizeof(size_t) * 2 * capacity);
+            if (offsets == NULL) return hypertext_Result_Out_Of_Memory;
+            context->offsets = offsets;
+
+            hypertext_Header_Field* array = realloc(context->fields, sizeof(hypertext_Header_Field) * capacity);
+            if (array == NULL) return hypertext_Result_Out_Of_Memory;
+            context->fields = array;
+
+            context->field_capacity = capacity;
+        }
+
+        size_t name_offset = buffer->length, value_offset;
+        hypertext_View name, value;
+
+        if (representation & 0x80)
+        {
+            if (!hypertext_utilities_hpack_decode_integer(block, length, &position, 7, &index) || !hypertext_utilities_hpack_lookup(context, index, &name, &value)) return hypertext_Result_Invalid_Parameters;
+
+            if (!hypertext_utilities_append(buffer, name.data, name.length) || !hypertext_utilities_append(buffer, "", 1)) return hypertext_Result_Out_Of_Memory;
+
+            value_offset = buffer->length;
+            if (!hypertext_utilities_append(buffer, value.data, value.length) || !hypertext_utilities_append(buffer, "", 1)) return hypertext_Result_Out_Of_Memory;
+        }
+        else
+        {
+            bool indexed = (representation & 0xC0) == 0x40;
+            if (!hypertext_utilities_hpack_decode_integer(block, length, &position, indexed ? 6 : 4, &index)) return hypertext_Result_Invalid_Parameters;
+
+            if (index != 0)
+            {
+                if (!hypertext_utilities_hpack_lookup(context, index, &name, &value)) return hypertext_Result_Invalid_Parameters;
+                if (!hypertext_utilities_append(buffer, name.data, name.length) || !hypertext_utilities_append(buffer, "", 1)) return hypertext_Result_Out_Of_Memory;
+            }
+            else if (!hypertext_utilities_hpack_decode_string(buffer, block, length, &position)) return hypertext_Result_Invalid_Parameters;
+
+            value_offset = buffer->length;
+            if (!hypertext_utilities_hpack_decode_string(buffer, block, length, &position)) return hypertext_Result_Invalid_Parameters;
+
+            if (indexed && !hypertext_utilities_hpack_insert(context, buffer->data + name_offset, value_offset - name_offset - 1, buffer->data + value_offset, buffer->length - value_offset - 1, false)) return hypertext_Result_Out_Of_Memory;
+        }
+
+        if (!hypertext_utilities_hpack_is_valid_value(buffer->data + name_offset, value_offset - name_offset - 1) || !hypertext_utilities_hpack_is_valid_value(buffer->data + value_offset, buffer->length - value_offset - 1)) return hypertext_Result_Invalid_Parameters;
+
+        context->offsets[count * 2]     = name_offset;
+        context->offsets[count * 2 + 1] = value_offset;
+        count++;
+    }
+
+    // The buffer may have moved while growing, so pointers are only taken once everything was decoded.
+    for (size_t i = 0; i != count; i++)
+    {
+        context->fields[i].key      = buffer->data + context->offsets[i * 2];
+        context->fields[i].value    = buffer->data + context->offsets[i * 2 + 1];
+    }
+
+    *fields         = context->fields;
+    *field_count    = count;
+
+    return hypertext_Result_Success;
+}
@@ -22,13 +22,15 @@
 #include <hypertext.h>
 
 #include "Internals.h"
+#include "Utilities.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-static inline void hypertext_utilities_free_and_null(void* data)
+static inline void hypertext_utilities_free_and_null(void** data)
 {
-    free(data);
-    data = NULL;
+    free(*data);
+    *data = NULL;
 }
 
 hypertext_Instance* hypertext_New()
@@ -43,15 +45,95 @@ hypertext_Instance* hypertext_New()
 
 void hypertext_Destroy(hypertext_Instance* instance)
 {
-    if (instance == NULL) return;
+    if (instance == NULL || instance->frozen) return;
 
-    instance->code          = 0;
-    instance->field_count   = 0;
-    instance->method        = hypertext_Method_Unknown;
-    instance->version       = 0;
-    instance->type          = hypertext_Instance_Content_Type_Unknown;
+    instance->body_length           = 0;
+    instance->code                  = 0;
+    instance->file_body             = false;
+    instance->file_descriptor       = 0;
+    instance->file_offset           = 0;
+    instance->field_count           = 0;
+    instance->field_capacity        = 0;
+    instance->field_source_length   = 0;
+    instance->method                = hypertext_Method_Unknown;
+    instance->method_token_length   = 0;
+    instance->path_length           = 0;
+    instance->segment_count         = 0;
+    instance->version               = 0;
+    instance->type                  = hypertext_Instance_Content_Type_Unknown;
 
-    if (instance->body      != NULL) hypertext_utilities_free_and_null(instance->body);
-    if (instance->fields    != NULL) hypertext_utilities_free_and_null(instance->fields);
-    if (instance->path      != NULL) hypertext_utilities_free_and_null(instance->path);
+    if (instance->body          != NULL) hypertext_utilities_free_and_null((void**)&instance->body);
+    if (instance->fields        != NULL) hypertext_utilities_free_and_null((void**)&instance->fields);
+    if (instance->field_source  != NULL) hypertext_utilities_free_and_null((void**)&instance->field_source);
+    if (instance->field_text    != NULL) hypertext_utilities_free_and_null((void**)&instance->field_text);
+
+    while (instance->field_blocks != NULL)
+    {
+        void* next;
+        memcpy(&next, instance->field_blocks, sizeof(void*));
+
+        free(instance->field_blocks);
+        instance->field_blocks = next;
+    }
+    if (instance->path          != NULL) hypertext_utilities_free_and_null((void**)&instance->path);
+    if (instance->method_token  != NULL) hypertext_utilities_free_and_null((void**)&instance->method_token);
+    if (instance->segments      != NULL) hypertext_utilities_free_and_null((void**)&instance->segments);
+    if (instance->segment_text  != NULL) hypertext_utilities_free_and_null((void**)&instance->segment_text);
+
+    hypertext_utilities_forward_release(instance);
+
+    hypertext_utilities_reset_target(instance);
+    for (uint8_t i = 0; i != hypertext_Parameter_Source_Max; i++) hypertext_utilities_reset_parameters(instance, i);
+}
+
+// Copies fields given with lengths into a block that lives as long as the instance's content; interned names aren't copied.
+uint8_t hypertext_utilities_copy_fields(hypertext_Instance* instance, const hypertext_Field* fields, size_t count, hypertext_utilities_field* output)
+{
+    size_t size = sizeof(void*);
+
+    for (size_t i = 0; i != count; i++)
+    {
+        const hypertext_View* name = &fields[i].name;
+        const hypertext_View* value = &fields[i].value;
+
+        if (name->data == NULL || name->length == 0 || (value->data == NULL && value->length != 0)) return hypertext_Result_Invalid_Parameters;
+
+        for (size_t j = 0; j != name->length; j++) if (!hypertext_utilities_is_token_character(name->data[j])) return hypertext_Result_Invalid_Parameters;
+
+        // A line break would end the field early and let the rest pass for another one.
+        if (value->length != 0 && (memchr(value->data, '\r', value->length) != NULL || memchr(value->data, '\n', value->length) != NULL)) return hypertext_Result_Invalid_Parameters;
+
+        output[i].key           = (char*)hypertext_utilities_intern(name->data, name->length, true);
+        output[i].key_length    = name->length;
+        output[i].value_length  = value->length;
+
+        size += (output[i].key == NULL ? name->length + 1 : 0) + value->length + 1;
+    }
+
+    char* block = malloc(size);
+    if (block == NULL) return hypertext_Result_Out_Of_Memory;
+
+    // Blocks are chained through their first bytes, so that hypertext_Destroy finds all of them.
+    memcpy(block, &instance->field_blocks, sizeof(void*));
+    instance->field_blocks = block;
+
+    char* text = block + sizeof(void*);
+
+    for (size_t i = 0; i != count; i++)
+    {
+        if (output[i].key == NULL)
+        {
+            output[i].key = text;
+            memcpy(text, fields[i].name.data, fields[i].name.length);
+            text += fields[i].name.length;
+            *text++ = '\0';
+        }
+
+        output[i].value = text;
+        if (fields[i].value.length != 0) memcpy(text, fields[i].value.data, fields[i].value.length);
+        text += fields[i].value.length;
+        *text++ = '\0';
+    }
+
+    return hypertext_Result_Success;
 }
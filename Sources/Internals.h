@@ -24,16 +24,75 @@
 
 #include <hypertext.h>
 
+#include "Utilities.h"
+
+// Fields carry the lengths of their key and value, which are set once when the field is parsed or created.
+typedef struct
+{
+    char*   key;
+    char*   value;
+    size_t  key_length;
+    size_t  value_length;
+} hypertext_utilities_field;
+
+typedef struct
+{
+    bool    present;
+    size_t  offset;
+    size_t  length;
+    bool    decoded;
+    char*   decoded_data;
+    size_t  decoded_length;
+} hypertext_utilities_component;
+
+typedef struct
+{
+    hypertext_Parameter parameter;
+    uint32_t            hash;
+    size_t              next;
+    size_t              last;
+} hypertext_utilities_parameter;
+
+typedef struct
+{
+    bool                            built;
+    hypertext_utilities_parameter*  entries;
+    size_t                          count;
+    size_t*                         slots;
+    size_t                          slot_count;
+} hypertext_utilities_parameters;
+
+typedef struct hypertext_utilities_forward hypertext_utilities_forward;
+
 struct hypertext_Instance
 {
-    char*                   body;
-    uint16_t                code;
-    hypertext_Header_Field* fields;
-    size_t                  field_count;
-    uint8_t                 method;
-    char*                   path;
-    uint8_t                 type;
-    uint8_t                 version;
+    char*                          body;
+    size_t                         body_length;
+    bool                           file_body;
+    int                            file_descriptor;
+    uint64_t                       file_offset;
+    hypertext_Segment*             segments;
+    size_t                         segment_count;
+    char*                          segment_text;
+    uint16_t                       code;
+    hypertext_utilities_field*     fields;
+    char*                          field_source;
+    size_t                         field_source_length;
+    char*                          field_text;
+    void*                          field_blocks;
+    size_t                         field_count;
+    size_t                         field_capacity;
+    uint8_t                        method;
+    hypertext_utilities_parameters parameters[hypertext_Parameter_Source_Max];
+    char*                          method_token;
+    size_t                         method_token_length;
+    char*                          path;
+    size_t                         path_length;
+    hypertext_utilities_component  target[hypertext_Target_Component_Max];
+    hypertext_utilities_forward*   forward;
+    uint8_t                        type;
+    uint8_t                        version;
+    bool                           frozen;
 };
 
 inline static bool hypertext_utilities_is_valid_instance(hypertext_Instance* instance)
@@ -44,4 +103,74 @@ inline static bool hypertext_utilities_is_valid_instance(hypertext_Instance* ins
     return false;
 }
 
+// Frozen instances are shared between threads and never change.
+inline static bool hypertext_utilities_is_mutable_instance(hypertext_Instance* instance)
+{
+    return hypertext_utilities_is_valid_instance(instance) && !instance->frozen;
+}
+
+uint8_t hypertext_utilities_split_fields(hypertext_Instance* instance);
+bool hypertext_utilities_parse_content_length(const char* value, size_t* output);
+
+// Requests parsed lazily keep their header block as it was received, until something looks at their fields.
+inline static uint8_t hypertext_utilities_ready_fields(hypertext_Instance* instance)
+{
+    return instance->field_source != NULL ? hypertext_utilities_split_fields(instance) : hypertext_Result_Success;
+}
+
+// Builds a field from null-terminated strings, pointing it at the interned copy of its name if there is one.
+inline static hypertext_utilities_field hypertext_utilities_make_field(const char* key, const char* value)
+{
+    hypertext_utilities_field field = { (char*)key, (char*)value, strlen(key), strlen(value) };
+
+    const char* name = hypertext_utilities_intern(key, field.key_length, true);
+    if (name != NULL) field.key = (char*)name;
+
+    return field;
+}
+
+// interned is the name's interned copy, or NULL if it has none; an interned key can then only match by pointer.
+inline static bool hypertext_utilities_field_named(const hypertext_utilities_field* field, const char* interned, const char* name, size_t length)
+{
+    if (field->key == interned) return true;
+    else if (hypertext_utilities_is_interned(field->key)) return false;
+
+    return field->key_length == length && hypertext_utilities_equals_ignore_case(field->key, name, length);
+}
+
+// Checks a field against one of the names the library looks for; an interned key means the table was seeded, so the name's interned copy is known by then.
+inline static bool hypertext_utilities_is_field(const hypertext_utilities_field* field, uint8_t name)
+{
+    const hypertext_View* known = &hypertext_utilities_known_names[name];
+
+    return hypertext_utilities_field_named(field, hypertext_utilities_is_interned(field->key) ? hypertext_utilities_known_interned[name] : NULL, known->data, known->length);
+}
+
+// Returns the index of the first field from start on with the given name, or SIZE_MAX if there's none; fields keep every occurrence of a name in the order they arrived.
+inline static size_t hypertext_utilities_next_field(hypertext_Instance* instance, const char* interned, const char* name, size_t length, size_t start)
+{
+    for (size_t i = start; i < instance->field_count; i++) if (hypertext_utilities_field_named(&instance->fields[i], interned, name, length)) return i;
+
+    return SIZE_MAX;
+}
+
+// Returns the index of the first field with the given name, or SIZE_MAX if there's none.
+inline static size_t hypertext_utilities_find_field(hypertext_Instance* instance, const char* name, size_t length)
+{
+    return hypertext_utilities_next_field(instance, hypertext_utilities_intern(name, length, false), name, length, 0);
+}
+
+uint8_t hypertext_utilities_output_head(hypertext_Instance* instance, const hypertext_utilities_field* fields, size_t field_count, char* output, size_t* length, bool keep_desc, bool keep_compat);
+size_t hypertext_utilities_join_field(hypertext_Instance* instance, const char* name, size_t length, char* output);
+uint8_t hypertext_utilities_copy_fields(hypertext_Instance* instance, const hypertext_Field* fields, size_t count, hypertext_utilities_field* output);
+
+// Instances parsed for forwarding keep track of their edits; for any other instance, recording an edit does nothing.
+uint8_t hypertext_utilities_forward_start(hypertext_Instance* instance, const char* input, size_t length);
+void hypertext_utilities_forward_release(hypertext_Instance* instance);
+bool hypertext_utilities_forward_reserve(hypertext_Instance* instance, size_t additional);
+void hypertext_utilities_forward_set(hypertext_Instance* instance, const hypertext_utilities_field* field);
+void hypertext_utilities_forward_add(hypertext_Instance* instance, const hypertext_utilities_field* field);
+void hypertext_utilities_forward_remove(hypertext_Instance* instance, const char* name, size_t length);
+void hypertext_utilities_forward_path(hypertext_Instance* instance);
+
 #endif
@@ -0,0 +1,132 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define hypertext_utilities_word(a, b, c, d, e, f, g) ((uint64_t)(a) | (uint64_t)(b) << 8 | (uint64_t)(c) << 16 | (uint64_t)(d) << 24 | (uint64_t)(e) << 32 | (uint64_t)(f) << 40 | (uint64_t)(g) << 48)
+
+typedef struct
+{
+    const char* token;
+    size_t      length;
+    uint64_t    word;
+} hypertext_utilities_method;
+
+// Indexed by method identifier; registered methods are appended behind hypertext_Method_Max.
+static hypertext_utilities_method hypertext_utilities_methods[UINT8_MAX] =
+{
+    [hypertext_Method_OPTIONS]  = { "OPTIONS",  7, hypertext_utilities_word('O', 'P', 'T', 'I', 'O', 'N', 'S') },
+    [hypertext_Method_GET]      = { "GET",      3, hypertext_utilities_word('G', 'E', 'T', 0, 0, 0, 0) },
+    [hypertext_Method_HEAD]     = { "HEAD",     4, hypertext_utilities_word('H', 'E', 'A', 'D', 0, 0, 0) },
+    [hypertext_Method_POST]     = { "POST",     4, hypertext_utilities_word('P', 'O', 'S', 'T', 0, 0, 0) },
+    [hypertext_Method_PUT]      = { "PUT",      3, hypertext_utilities_word('P', 'U', 'T', 0, 0, 0, 0) },
+    [hypertext_Method_DELETE]   = { "DELETE",   6, hypertext_utilities_word('D', 'E', 'L', 'E', 'T', 'E', 0) },
+    [hypertext_Method_TRACE]    = { "TRACE",    5, hypertext_utilities_word('T', 'R', 'A', 'C', 'E', 0, 0) },
+    [hypertext_Method_CONNECT]  = { "CONNECT",  7, hypertext_utilities_word('C', 'O', 'N', 'N', 'E', 'C', 'T') }
+};
+
+static uint8_t hypertext_utilities_method_count = hypertext_Method_Max;
+
+// Loads up to the first eight characters as a little-endian integer, padded with zeroes.
+static inline uint64_t hypertext_utilities_load_word(const char* token, size_t length)
+{
+    uint64_t word = 0;
+    memcpy(&word, token, length < sizeof(uint64_t) ? length : sizeof(uint64_t));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+
+    return word;
+}
+
+uint8_t hypertext_utilities_find_method(const char* token, size_t length)
+{
+    if (token == NULL || length == 0) return hypertext_Method_Unknown;
+
+    uint64_t word = hypertext_utilities_load_word(token, length);
+
+    // Standard tokens are shorter than eight characters, so the zero padding already rules out longer tokens.
+    uint8_t method = hypertext_Method_Unknown;
+    for (uint8_t i = hypertext_Method_OPTIONS; i != hypertext_Method_Max; i++) method |= (uint8_t)(-(uint8_t)(word == hypertext_utilities_methods[i].word) & i);
+
+    if (method != hypertext_Method_Unknown) return method;
+
+    for (uint8_t i = hypertext_Method_Max + 1; i <= hypertext_utilities_method_count; i++)
+    {
+        hypertext_utilities_method* entry = &hypertext_utilities_methods[i];
+        if (entry->word == word && entry->length == length && (length <= sizeof(uint64_t) || memcmp(entry->token, token, length) == 0)) return i;
+    }
+
+    return hypertext_Method_Extension;
+}
+
+bool hypertext_utilities_is_valid_method(uint8_t method)
+{
+    return (method != hypertext_Method_Unknown && method < hypertext_Method_Max) || (method > hypertext_Method_Max && method <= hypertext_utilities_method_count);
+}
+
+bool hypertext_utilities_fetch_method_token(uint8_t method, hypertext_View* output)
+{
+    if (!hypertext_utilities_is_valid_method(method)) return false;
+
+    output->data    = hypertext_utilities_methods[method].token;
+    output->length  = hypertext_utilities_methods[method].length;
+
+    return true;
+}
+
+uint8_t hypertext_Register_Method(const char* token, size_t length, uint8_t* output)
+{
+    if (token == NULL || length == 0 || output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    for (size_t i = 0; i != length; i++) if (!hypertext_utilities_is_token_character(token[i])) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t method = hypertext_utilities_find_method(token, length);
+    if (method != hypertext_Method_Extension)
+    {
+        *output = method;
+        return hypertext_Result_Already_Present;
+    }
+
+    if (hypertext_utilities_method_count + 1 >= hypertext_Method_Extension) return hypertext_Result_Out_Of_Memory;
+
+    char* copy = calloc(length + 1, sizeof(char));
+    if (copy == NULL) return hypertext_Result_Out_Of_Memory;
+
+    memcpy(copy, token, length);
+
+    method = ++hypertext_utilities_method_count;
+
+    hypertext_utilities_methods[method].token   = copy;
+    hypertext_utilities_methods[method].length  = length;
+    hypertext_utilities_methods[method].word    = hypertext_utilities_load_word(copy, length);
+
+    *output = method;
+
+    return hypertext_Result_Success;
+}
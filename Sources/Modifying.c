@@ -22,76 +22,274 @@
 #include <hypertext.h>
 
 #include "Internals.h"
+#include "Utilities.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+#define hypertext_utilities_fields_minimum 8
+
+// Makes room for more fields; the capacity doubles, so that adding fields one at a time only reallocates every so often.
+static bool hypertext_utilities_reserve_fields(hypertext_Instance* instance, size_t additional)
+{
+    if (instance->field_count + additional <= instance->field_capacity) return true;
+    else if (additional > SIZE_MAX / 2 / sizeof(hypertext_utilities_field) - instance->field_count) return false;
+
+    size_t capacity = instance->field_capacity > hypertext_utilities_fields_minimum / 2 ? instance->field_capacity * 2 : hypertext_utilities_fields_minimum;
+    while (capacity < instance->field_count + additional) capacity *= 2;
+
+    hypertext_utilities_field* fields = realloc(instance->fields, sizeof(hypertext_utilities_field) * capacity);
+    if (fields == NULL) return false;
+
+    instance->fields            = fields;
+    instance->field_capacity    = capacity;
+
+    return true;
+}
+
+// Returns the index of the first field before end that carries the same name, or SIZE_MAX.
+static size_t hypertext_utilities_index_of(hypertext_Instance* instance, const hypertext_utilities_field* field, size_t end)
+{
+    const char* interned = hypertext_utilities_is_interned(field->key) ? field->key : NULL;
+
+    for (size_t i = 0; i != end; i++) if (hypertext_utilities_field_named(&instance->fields[i], interned, field->key, field->key_length)) return i;
+
+    return SIZE_MAX;
+}
+
+static uint8_t hypertext_utilities_append_field(hypertext_Instance* instance, const hypertext_utilities_field* field)
+{
+    if (!hypertext_utilities_reserve_fields(instance, 1) || !hypertext_utilities_forward_reserve(instance, 1)) return hypertext_Result_Out_Of_Memory;
+
+    instance->fields[instance->field_count++] = *field;
+    hypertext_utilities_forward_set(instance, field);
+
+    return hypertext_Result_Success;
+}
+
+// Drops every field with this name from start on; the rest moves up in place, and the capacity stays for the next field to be added.
+static size_t hypertext_utilities_drop_fields(hypertext_Instance* instance, const char* interned, const char* name, size_t length, size_t start)
+{
+    size_t count = start;
+
+    for (size_t i = start; i != instance->field_count; i++) if (!hypertext_utilities_field_named(&instance->fields[i], interned, name, length)) instance->fields[count++] = instance->fields[i];
+
+    size_t dropped = instance->field_count - count;
+    instance->field_count = count;
+
+    return dropped;
+}
+
+static uint8_t hypertext_utilities_remove_field(hypertext_Instance* instance, const char* name, size_t length)
+{
+    if (hypertext_utilities_drop_fields(instance, hypertext_utilities_intern(name, length, false), name, length, 0) == 0) return hypertext_Result_Not_Found;
+
+    hypertext_utilities_forward_remove(instance, name, length);
+
+    return hypertext_Result_Success;
+}
+
 uint8_t hypertext_Add_Field(hypertext_Instance* instance, hypertext_Header_Field* input)
 {
-    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
     else if (input == NULL || input->key == NULL || input->value == NULL) return hypertext_Result_Invalid_Parameters;
 
-    for (size_t i = 0; i != instance->field_count; i++) if (instance->fields[i].key == input->key) return hypertext_Result_Already_Present;
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    hypertext_utilities_field field = hypertext_utilities_make_field(input->key, input->value);
+    if (hypertext_utilities_index_of(instance, &field, instance->field_count) != SIZE_MAX) return hypertext_Result_Already_Present;
+
+    return hypertext_utilities_append_field(instance, &field);
+}
+
+uint8_t hypertext_Add_Fields(hypertext_Instance* instance, hypertext_Header_Field* input, size_t count)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL && count != 0) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
 
-    instance->field_count++;
+    for (size_t i = 0; i != count; i++) if (input[i].key == NULL || input[i].value == NULL) return hypertext_Result_Invalid_Parameters;
 
-    instance->fields = realloc(instance->fields, sizeof(hypertext_Header_Field) * instance->field_count);
+    if (!hypertext_utilities_reserve_fields(instance, count) || !hypertext_utilities_forward_reserve(instance, count)) return hypertext_Result_Out_Of_Memory;
 
-    memcpy(&instance->fields[instance->field_count], input, sizeof(hypertext_Header_Field));
+    // The fields are built right behind the existing ones, and only counted once none of them turned out to be a duplicate.
+    hypertext_utilities_field* pending = instance->fields + instance->field_count;
+
+    for (size_t i = 0; i != count; i++)
+    {
+        pending[i] = hypertext_utilities_make_field(input[i].key, input[i].value);
+        if (hypertext_utilities_index_of(instance, &pending[i], instance->field_count + i) != SIZE_MAX) return hypertext_Result_Already_Present;
+    }
+
+    instance->field_count += count;
+
+    for (size_t i = 0; i != count; i++) hypertext_utilities_forward_set(instance, &pending[i]);
 
     return hypertext_Result_Success;
 }
 
+uint8_t hypertext_Set_Field(hypertext_Instance* instance, hypertext_Header_Field* input)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL || input->key == NULL || input->value == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    hypertext_utilities_field field = hypertext_utilities_make_field(input->key, input->value);
+
+    size_t index = hypertext_utilities_index_of(instance, &field, instance->field_count);
+    if (index == SIZE_MAX) return hypertext_utilities_append_field(instance, &field);
+
+    // Later occurrences go, so that the name is left with this value alone.
+    instance->fields[index] = field;
+    hypertext_utilities_drop_fields(instance, hypertext_utilities_is_interned(field.key) ? field.key : NULL, field.key, field.key_length, index + 1);
+    hypertext_utilities_forward_set(instance, &field);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Add_Repeated_Field(hypertext_Instance* instance, hypertext_Header_Field* input)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL || input->key == NULL || input->value == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+    else if (!hypertext_utilities_reserve_fields(instance, 1) || !hypertext_utilities_forward_reserve(instance, 1)) return hypertext_Result_Out_Of_Memory;
+
+    hypertext_utilities_field field = hypertext_utilities_make_field(input->key, input->value);
+
+    instance->fields[instance->field_count++] = field;
+    hypertext_utilities_forward_add(instance, &field);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Append_Field(hypertext_Instance* instance, const hypertext_Field* input)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    // Checking first keeps a duplicate from taking up a copy.
+    if (input->name.data != NULL && hypertext_utilities_find_field(instance, input->name.data, input->name.length) != SIZE_MAX) return hypertext_Result_Already_Present;
+
+    hypertext_utilities_field field;
+
+    uint8_t result = hypertext_utilities_copy_fields(instance, input, 1, &field);
+    if (result != hypertext_Result_Success) return result;
+
+    return hypertext_utilities_append_field(instance, &field);
+}
+
 uint8_t hypertext_Remove_Field(hypertext_Instance* instance, const char* input)
 {
-    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
     else if (input == NULL) return hypertext_Result_Invalid_Parameters;
 
-    bool found = false;
-    for (size_t i = 0; i != instance->field_count; i++) if (instance->fields[i].key == input)
-    {
-        found = true;
-        break;
-    }
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
+
+    return hypertext_utilities_remove_field(instance, input, strlen(input));
+}
+
+uint8_t hypertext_Strip_Hop_Fields(hypertext_Instance* instance)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
 
-    if (!found) return hypertext_Result_Not_Found;
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
 
-    hypertext_Header_Field* field_copy = calloc(instance->field_count - 1, sizeof(hypertext_Header_Field));
+    static const char* const hop_fields[] = { "Connection", "Keep-Alive", "Proxy-Connection", "TE", "Upgrade" };
 
-    size_t pos = 0;
-    for (size_t pos2 = 0; pos2 != instance->field_count; pos2++)
+    // Fields named by Connection go first, while its values are still at hand; as per RFC 9110, section 7.6.1.
+    // Connection itself is never removed on the way, so its n-th occurrence stays the n-th while the fields around it move.
+    const char* connection = hypertext_utilities_intern("Connection", 10, false);
+
+    for (size_t occurrence = 0;; occurrence++)
     {
-        if (instance->fields[pos2].key == input) continue;
+        size_t index = hypertext_utilities_next_field(instance, connection, "Connection", 10, 0);
+        for (size_t i = 0; i != occurrence && index != SIZE_MAX; i++) index = hypertext_utilities_next_field(instance, connection, "Connection", 10, index + 1);
 
-        memcpy(&field_copy[pos], &instance->fields[pos2], sizeof(hypertext_Header_Field));
-        pos++;
-    }
+        if (index == SIZE_MAX) break;
+
+        const char* cursor = instance->fields[index].value;
+        const char* item;
+        size_t length;
 
-    instance->field_count--;
+        while (hypertext_utilities_next_item(&cursor, &item, &length))
+        {
+            // The body is passed on as it is, so the fields framing it have to stay; same for Host.
+            if ((length == 4 && hypertext_utilities_equals_ignore_case(item, "Host", 4)) || (length == 10 && hypertext_utilities_equals_ignore_case(item, "Connection", 10)) || (length == 14 && hypertext_utilities_equals_ignore_case(item, "Content-Length", 14)) || (length == 17 && hypertext_utilities_equals_ignore_case(item, "Transfer-Encoding", 17))) continue;
 
-    instance->fields = realloc(instance->fields, sizeof(hypertext_Header_Field) * instance->field_count);
-    for (size_t i = 0; i != instance->field_count; i++) memcpy(&instance->fields[i], &field_copy[i], sizeof(hypertext_Header_Field));
+            hypertext_utilities_remove_field(instance, item, length);
+        }
+    }
 
-    free(field_copy);
+    for (size_t i = 0; i != sizeof(hop_fields) / sizeof(hop_fields[0]); i++) hypertext_utilities_remove_field(instance, hop_fields[i], strlen(hop_fields[i]));
 
     return hypertext_Result_Success;
 }
 
 uint8_t hypertext_Set_Body(hypertext_Instance* instance, const char* body, size_t length)
 {
-    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (instance->forward != NULL) return hypertext_Result_Unsupported;
     else if (body == NULL || length == 0) return hypertext_Result_Invalid_Parameters;
 
-    if (strlen(instance->body) < length) instance->body = realloc(instance->body, sizeof(char) * length);
+    char* copy = calloc(length + 1, sizeof(char));
+    if (copy == NULL) return hypertext_Result_Out_Of_Memory;
+
+    memcpy(copy, body, length);
+
+    free(instance->body);
+    instance->body          = copy;
+    instance->body_length   = length;
+    instance->file_body     = false;
+
+    hypertext_utilities_reset_segments(instance);
+
+    hypertext_utilities_reset_parameters(instance, hypertext_Parameter_Source_Body);
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Set_Body_File(hypertext_Instance* instance, int descriptor, uint64_t offset, size_t length)
+{
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (instance->forward != NULL) return hypertext_Result_Unsupported;
+    else if (descriptor < 0 || length == 0) return hypertext_Result_Invalid_Parameters;
+
+#if defined(_WIN32)
+    (void)offset;
+    return hypertext_Result_Unsupported;
+#else
+    free(instance->body);
+
+    instance->body              = NULL;
+    instance->body_length       = length;
+    instance->file_body         = true;
+    instance->file_descriptor   = descriptor;
+    instance->file_offset       = offset;
 
-    strncpy(instance->body, body, length);
+    hypertext_utilities_reset_segments(instance);
+
+    hypertext_utilities_reset_parameters(instance, hypertext_Parameter_Source_Body);
 
     return hypertext_Result_Success;
+#endif
 }
 
 uint8_t hypertext_Set_Code(hypertext_Instance* instance, uint16_t code)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+    if (instance == NULL || instance->frozen || instance->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+    else if (instance->forward != NULL) return hypertext_Result_Unsupported;
     else if (code < 100) return hypertext_Result_Invalid_Parameters;
 
     instance->code = code;
@@ -101,8 +299,16 @@ uint8_t hypertext_Set_Code(hypertext_Instance* instance, uint16_t code)
 
 uint8_t hypertext_Set_Method(hypertext_Instance* instance, uint8_t method)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
-    else if (method == hypertext_Method_Unknown || method >= hypertext_Method_Max) return hypertext_Result_Invalid_Parameters;
+    if (instance == NULL || instance->frozen || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (instance->forward != NULL) return hypertext_Result_Unsupported;
+    else if (!hypertext_utilities_is_valid_method(method)) return hypertext_Result_Invalid_Parameters;
+
+    if (instance->method_token != NULL)
+    {
+        free(instance->method_token);
+        instance->method_token          = NULL;
+        instance->method_token_length   = 0;
+    }
 
     instance->method = method;
 
@@ -111,19 +317,28 @@ uint8_t hypertext_Set_Method(hypertext_Instance* instance, uint8_t method)
 
 uint8_t hypertext_Set_Path(hypertext_Instance* instance, const char* path, size_t length)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    if (instance == NULL || instance->frozen || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
     else if (path == NULL) return hypertext_Result_Invalid_Parameters;
 
-    if (strlen(instance->path) < length) instance->path = realloc(instance->path, sizeof(char) * length);
+    char* copy = calloc(length + 1, sizeof(char));
+    if (copy == NULL) return hypertext_Result_Out_Of_Memory;
+
+    memcpy(copy, path, length);
+
+    free(instance->path);
+    instance->path          = copy;
+    instance->path_length   = length;
 
-    strncpy(instance->path, path, length);
+    hypertext_utilities_scan_target(instance);
+    hypertext_utilities_forward_path(instance);
 
     return hypertext_Result_Success;
 }
 
 uint8_t hypertext_Set_Version(hypertext_Instance* instance, uint8_t version)
 {
-    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    if (!hypertext_utilities_is_mutable_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (instance->forward != NULL) return hypertext_Result_Unsupported;
     else if (version == hypertext_HTTP_Version_Unknown || version >= hypertext_HTTP_Version_Max) return hypertext_Result_Invalid_Parameters;
 
     instance->version = version;
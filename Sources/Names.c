@@ -0,0 +1,239 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Utilities.h"
+
+#include <string.h>
+
+// One process-wide table maps every header name to a single copy, whatever its case, so that names can be compared by pointer.
+// Names are never removed; the table and its storage have fixed sizes, so lookups can go without a lock while inserts take one.
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static SRWLOCK hypertext_utilities_names_lock = SRWLOCK_INIT;
+static INIT_ONCE hypertext_utilities_names_once = INIT_ONCE_STATIC_INIT;
+
+#define hypertext_utilities_names_acquire()         AcquireSRWLockExclusive(&hypertext_utilities_names_lock)
+#define hypertext_utilities_names_release()         ReleaseSRWLockExclusive(&hypertext_utilities_names_lock)
+#define hypertext_utilities_names_load(slot)        ((const char*)ReadPointerAcquire((PVOID volatile*)(slot)))
+#define hypertext_utilities_names_store(slot, name) WritePointerRelease((PVOID volatile*)(slot), (PVOID)(name))
+
+typedef PVOID volatile hypertext_utilities_name_pointer;
+#else
+#include <pthread.h>
+#include <stdatomic.h>
+
+static pthread_mutex_t hypertext_utilities_names_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hypertext_utilities_names_once = PTHREAD_ONCE_INIT;
+
+#define hypertext_utilities_names_acquire()         pthread_mutex_lock(&hypertext_utilities_names_lock)
+#define hypertext_utilities_names_release()         pthread_mutex_unlock(&hypertext_utilities_names_lock)
+#define hypertext_utilities_names_load(slot)        atomic_load_explicit(slot, memory_order_acquire)
+#define hypertext_utilities_names_store(slot, name) atomic_store_explicit(slot, name, memory_order_release)
+
+typedef _Atomic(const char*) hypertext_utilities_name_pointer;
+#endif
+
+#define hypertext_utilities_names_slots     2048
+#define hypertext_utilities_names_limit     1024
+#define hypertext_utilities_names_longest   64
+
+typedef struct
+{
+    uint32_t                            hash;
+    hypertext_utilities_name_pointer    name;
+} hypertext_utilities_name_slot;
+
+char hypertext_utilities_name_storage[hypertext_utilities_name_storage_size];
+
+static size_t hypertext_utilities_names_used;
+static size_t hypertext_utilities_names_count;
+static hypertext_utilities_name_slot hypertext_utilities_names[hypertext_utilities_names_slots];
+
+// The spelling of these names is the one every other spelling maps to.
+static const char* const hypertext_utilities_standard_names[] =
+{
+    "Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges",
+    "Access-Control-Allow-Credentials", "Access-Control-Allow-Headers", "Access-Control-Allow-Methods", "Access-Control-Allow-Origin",
+    "Access-Control-Expose-Headers", "Access-Control-Max-Age", "Access-Control-Request-Headers", "Access-Control-Request-Method",
+    "Age", "Allow", "Alt-Svc", "Authorization", "Cache-Control", "Connection", "Content-Disposition", "Content-Encoding",
+    "Content-Language", "Content-Length", "Content-Location", "Content-Range", "Content-Security-Policy", "Content-Type", "Cookie",
+    "Date", "DNT", "Early-Data", "ETag", "Expect", "Expires", "Forwarded", "From", "Host", "If-Match", "If-Modified-Since",
+    "If-None-Match", "If-Range", "If-Unmodified-Since", "Keep-Alive", "Last-Modified", "Link", "Location", "Max-Forwards", "Origin",
+    "Pragma", "Priority", "Proxy-Authenticate", "Proxy-Authorization", "Proxy-Connection", "Range", "Referer", "Referrer-Policy",
+    "Refresh", "Retry-After", "Sec-Fetch-Dest", "Sec-Fetch-Mode", "Sec-Fetch-Site", "Sec-Fetch-User", "Sec-WebSocket-Accept",
+    "Sec-WebSocket-Extensions", "Sec-WebSocket-Key", "Sec-WebSocket-Protocol", "Sec-WebSocket-Version", "Server", "Set-Cookie",
+    "Strict-Transport-Security", "TE", "Trailer", "Transfer-Encoding", "Upgrade", "Upgrade-Insecure-Requests", "User-Agent", "Vary",
+    "Via", "Warning", "WWW-Authenticate", "X-Content-Type-Options", "X-Forwarded-For", "X-Forwarded-Host", "X-Forwarded-Proto",
+    "X-Frame-Options", "X-Real-IP", "X-Requested-With"
+};
+
+#define hypertext_utilities_known(name) { name, sizeof(name) - 1 }
+
+const hypertext_View hypertext_utilities_known_names[hypertext_utilities_known_Max] =
+{
+    [hypertext_utilities_known_Accept_Encoding]     = hypertext_utilities_known("Accept-Encoding"),
+    [hypertext_utilities_known_Age]                 = hypertext_utilities_known("Age"),
+    [hypertext_utilities_known_Cache_Control]       = hypertext_utilities_known("Cache-Control"),
+    [hypertext_utilities_known_Connection]          = hypertext_utilities_known("Connection"),
+    [hypertext_utilities_known_Content_Encoding]    = hypertext_utilities_known("Content-Encoding"),
+    [hypertext_utilities_known_Content_Length]      = hypertext_utilities_known("Content-Length"),
+    [hypertext_utilities_known_Content_Range]       = hypertext_utilities_known("Content-Range"),
+    [hypertext_utilities_known_Content_Type]        = hypertext_utilities_known("Content-Type"),
+    [hypertext_utilities_known_Date]                = hypertext_utilities_known("Date"),
+    [hypertext_utilities_known_Expires]             = hypertext_utilities_known("Expires"),
+    [hypertext_utilities_known_If_Match]            = hypertext_utilities_known("If-Match"),
+    [hypertext_utilities_known_If_Modified_Since]   = hypertext_utilities_known("If-Modified-Since"),
+    [hypertext_utilities_known_If_None_Match]       = hypertext_utilities_known("If-None-Match"),
+    [hypertext_utilities_known_If_Range]            = hypertext_utilities_known("If-Range"),
+    [hypertext_utilities_known_If_Unmodified_Since] = hypertext_utilities_known("If-Unmodified-Since"),
+    [hypertext_utilities_known_Pragma]              = hypertext_utilities_known("Pragma"),
+    [hypertext_utilities_known_Range]               = hypertext_utilities_known("Range"),
+    [hypertext_utilities_known_Set_Cookie]          = hypertext_utilities_known("Set-Cookie"),
+    [hypertext_utilities_known_Transfer_Encoding]   = hypertext_utilities_known("Transfer-Encoding"),
+    [hypertext_utilities_known_Vary]                = hypertext_utilities_known("Vary"),
+};
+
+const char* hypertext_utilities_known_interned[hypertext_utilities_known_Max];
+
+static uint32_t hypertext_utilities_name_hash(const char* name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i != length; i++) hash = (hash ^ (uint8_t)hypertext_utilities_to_lower(name[i])) * 16777619u;
+
+    return hash;
+}
+
+// Returns the slot holding the name, or the empty slot it belongs in.
+static hypertext_utilities_name_slot* hypertext_utilities_name_find(const char* name, size_t length, uint32_t hash, const char** found)
+{
+    for (size_t index = hash & (hypertext_utilities_names_slots - 1);; index = (index + 1) & (hypertext_utilities_names_slots - 1))
+    {
+        hypertext_utilities_name_slot* slot = &hypertext_utilities_names[index];
+        const char* candidate = hypertext_utilities_names_load(&slot->name);
+
+        if (candidate == NULL || (slot->hash == hash && hypertext_utilities_equals_ignore_case(candidate, name, length) && candidate[length] == '\0'))
+        {
+            *found = candidate;
+            return slot;
+        }
+    }
+}
+
+// Expects the lock to be held.
+static const char* hypertext_utilities_name_insert(const char* name, size_t length, uint32_t hash)
+{
+    const char* found;
+    hypertext_utilities_name_slot* slot = hypertext_utilities_name_find(name, length, hash, &found);
+
+    if (found != NULL) return found;
+    else if (hypertext_utilities_names_count == hypertext_utilities_names_limit || hypertext_utilities_names_used + length + 1 > hypertext_utilities_name_storage_size) return NULL;
+
+    char* copy = hypertext_utilities_name_storage + hypertext_utilities_names_used;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+
+    hypertext_utilities_names_used += length + 1;
+    hypertext_utilities_names_count++;
+
+    // The hash has to be in place before the name is published.
+    slot->hash = hash;
+    hypertext_utilities_names_store(&slot->name, copy);
+
+    return copy;
+}
+
+#if defined(_WIN32)
+static BOOL CALLBACK hypertext_utilities_names_seed(PINIT_ONCE once, PVOID parameter, PVOID* context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+#else
+static void hypertext_utilities_names_seed()
+{
+#endif
+    hypertext_utilities_names_acquire();
+
+    for (size_t i = 0; i != sizeof(hypertext_utilities_standard_names) / sizeof(hypertext_utilities_standard_names[0]); i++)
+    {
+        size_t length = strlen(hypertext_utilities_standard_names[i]);
+        hypertext_utilities_name_insert(hypertext_utilities_standard_names[i], length, hypertext_utilities_name_hash(hypertext_utilities_standard_names[i], length));
+    }
+
+    // Every known name is a standard one, so each has its copy now.
+    for (size_t i = 0; i != hypertext_utilities_known_Max; i++)
+    {
+        const hypertext_View* known = &hypertext_utilities_known_names[i];
+        hypertext_utilities_name_find(known->data, known->length, hypertext_utilities_name_hash(known->data, known->length), &hypertext_utilities_known_interned[i]);
+    }
+
+    hypertext_utilities_names_release();
+
+#if defined(_WIN32)
+    return TRUE;
+#endif
+}
+
+const char* hypertext_utilities_intern(const char* name, size_t length, bool insert)
+{
+    if (name == NULL || length == 0 || length > hypertext_utilities_names_longest) return NULL;
+
+    for (size_t i = 0; i != length; i++) if (!hypertext_utilities_is_token_character(name[i])) return NULL;
+
+#if defined(_WIN32)
+    InitOnceExecuteOnce(&hypertext_utilities_names_once, hypertext_utilities_names_seed, NULL, NULL);
+#else
+    pthread_once(&hypertext_utilities_names_once, hypertext_utilities_names_seed);
+#endif
+
+    uint32_t hash = hypertext_utilities_name_hash(name, length);
+
+    const char* found;
+    hypertext_utilities_name_find(name, length, hash, &found);
+
+    if (found != NULL || !insert) return found;
+
+    hypertext_utilities_names_acquire();
+    found = hypertext_utilities_name_insert(name, length, hash);
+    hypertext_utilities_names_release();
+
+    return found;
+}
+
+uint8_t hypertext_Intern_Name(const char* input, size_t length, const char** output)
+{
+    if (input == NULL || length == 0 || output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    for (size_t i = 0; i != length; i++) if (!hypertext_utilities_is_token_character(input[i])) return hypertext_Result_Invalid_Parameters;
+
+    if (length > hypertext_utilities_names_longest) return hypertext_Result_Unsupported;
+
+    const char* name = hypertext_utilities_intern(input, length, true);
+    if (name == NULL) return hypertext_Result_Out_Of_Memory;
+
+    *output = name;
+
+    return hypertext_Result_Success;
+}
@@ -28,54 +28,44 @@
 #include <stdlib.h>
 #include <string.h>
 
-uint8_t hypertext_Output_Request(hypertext_Instance* instance, char* output, size_t* length, bool keep_compat)
+// Writes one field along with its line ending; the lengths were measured when the field was set, and values may hold null characters.
+static size_t hypertext_utilities_output_field(char* output, const hypertext_utilities_field* field, bool keep_compat)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
-    else if (length == NULL) return hypertext_Result_Invalid_Parameters;
+    char* position = output;
 
-    char* method_str = calloc(9, sizeof(char));
-    switch (instance->method)
-    {
-    case hypertext_Method_OPTIONS:
-        snprintf(method_str, 9, "OPTIONS");
-        break;
+    memcpy(position, field->key, field->key_length);
+    position += field->key_length;
 
-    case hypertext_Method_GET:
-        snprintf(method_str, 9, "GET");
-        break;
+    *position++ = ':';
+    if (keep_compat) *position++ = ' ';
 
-    case hypertext_Method_HEAD:
-        snprintf(method_str, 9, "HEAD");
-        break;
+    memcpy(position, field->value, field->value_length);
+    position += field->value_length;
 
-    case hypertext_Method_POST:
-        snprintf(method_str, 9, "POST");
-        break;
+    if (keep_compat) *position++ = '\r';
+    *position++ = '\n';
 
-    case hypertext_Method_PUT:
-        snprintf(method_str, 9, "PUT");
-        break;
+    return (size_t)(position - output);
+}
 
-    case hypertext_Method_DELETE:
-        snprintf(method_str, 9, "DELETE");
-        break;
+uint8_t hypertext_Output_Request(hypertext_Instance* instance, char* output, size_t* length, bool keep_compat)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (length == NULL) return hypertext_Result_Invalid_Parameters;
 
-    case hypertext_Method_TRACE:
-        snprintf(method_str, 9, "TRACE");
-        break;
+    uint8_t ready = hypertext_utilities_ready_fields(instance);
+    if (ready != hypertext_Result_Success) return ready;
 
-    case hypertext_Method_CONNECT:
-        snprintf(method_str, 9, "CONNECT");
-        break;
-    }
+    hypertext_View method;
+    if (hypertext_Fetch_Method_Token(instance, &method) != hypertext_Result_Success) return hypertext_Result_Invalid_Method;
 
-    size_t out_len = strlen(method_str) + strlen(instance->path) + (keep_compat ? 12 : 11);
+    size_t out_len = method.length + instance->path_length + (keep_compat ? 12 : 11);
 
-    if (instance->field_count != 0 || instance->fields != NULL) for (size_t i = 0; i != instance->field_count; i++) out_len += strlen(instance->fields[i].key) + strlen(instance->fields[i].value) + (keep_compat ? 4 : 2);
+    for (size_t i = 0; i != instance->field_count; i++) out_len += instance->fields[i].key_length + instance->fields[i].value_length + (keep_compat ? 4 : 2);
 
     out_len += keep_compat ? 2 : 1;
 
-    if (instance->body != NULL) out_len += strlen(instance->body);
+    out_len += instance->body_length;
 
     if (*length == 0) memcpy(length, &out_len, sizeof(size_t));
     else if (*length != out_len) return hypertext_Result_Invalid_Parameters;
@@ -101,13 +91,20 @@ uint8_t hypertext_Output_Request(hypertext_Instance* instance, char* output, siz
             break;
         }
 
-        snprintf(out_str, out_len + 1, "%s %s HTTP/%s%s", method_str, instance->path, ver_str, term);
+        size_t position = snprintf(out_str, out_len + 1, "%.*s %s HTTP/%s%s", (int)method.length, method.data, instance->path, ver_str, term);
 
-        if (instance->field_count != 0 && instance->fields != NULL) for (size_t i = 0; i != instance->field_count; i++) snprintf(out_str, out_len + 1, "%s%s:%s%s%s", out_str, instance->fields[i].key, keep_compat ? " " : "", instance->fields[i].value, term);
+        for (size_t i = 0; i != instance->field_count; i++) position += hypertext_utilities_output_field(out_str + position, &instance->fields[i], keep_compat);
 
-        snprintf(out_str, out_len + 1, "%s%s", out_str, term);
+        position += snprintf(out_str + position, out_len + 1 - position, "%s", term);
 
-        if (instance->body != NULL && strlen(instance->body) > 0) snprintf(out_str, out_len + 1, "%s%s", out_str, instance->body);
+        if (instance->body_length != 0 && !hypertext_utilities_read_body(instance, 0, out_str + position, instance->body_length))
+        {
+            free(ver_str);
+            free(term);
+            free(out_str);
+
+            return hypertext_Result_IO_Error;
+        }
 
         memcpy(output, out_str, sizeof(char) * out_len);
 
@@ -116,15 +113,12 @@ uint8_t hypertext_Output_Request(hypertext_Instance* instance, char* output, siz
         free(out_str);
     }
 
-    free(method_str);
-
     return hypertext_Result_Success;
 }
 
-uint8_t hypertext_Output_Response(hypertext_Instance* instance, char* output, size_t* length, bool keep_desc, bool keep_compat)
+// Serializes a response with the given fields and body length rather than its own, so a frozen instance shared between threads is only ever read.
+static uint8_t hypertext_utilities_output_response(hypertext_Instance* instance, const hypertext_utilities_field* fields, size_t field_count, size_t body_length, char* output, size_t* length, bool keep_desc, bool keep_compat)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
-
     char* description = NULL;
 
     if (keep_desc)
@@ -295,13 +289,13 @@ uint8_t hypertext_Output_Response(hypertext_Instance* instance, char* output, si
         }
     }
 
-    size_t out_len = (keep_desc ? strlen(description) : 0) + 15 + (keep_compat ? 2 : 1);
+    size_t out_len = (keep_desc ? strlen(description) + 1 : 0) + 12 + (keep_compat ? 2 : 1);
 
-    if (instance->field_count != 0 && instance->fields != NULL) for (size_t i = 0; i != instance->field_count; i++) out_len += strlen(instance->fields[i].key) + strlen(instance->fields[i].value) + (keep_compat ? 4 : 2);
+    for (size_t i = 0; i != field_count; i++) out_len += fields[i].key_length + fields[i].value_length + (keep_compat ? 4 : 2);
 
     out_len += keep_compat ? 2 : 1;
 
-    if (instance->body != NULL) out_len += strlen(instance->body);
+    out_len += body_length;
 
     if (*length == 0) memcpy(length, &out_len, sizeof(size_t));
     else if (*length != out_len) return hypertext_Result_Invalid_Parameters;
@@ -327,16 +321,24 @@ uint8_t hypertext_Output_Response(hypertext_Instance* instance, char* output, si
             break;
         }
 
-        snprintf(out_str, out_len + 1, "HTTP/%s %d", ver_str, instance->code);
-        if (keep_desc) snprintf(out_str, out_len + 1, "%s %s", out_str, description);
+        size_t position = snprintf(out_str, out_len + 1, "HTTP/%s %d", ver_str, instance->code);
+        if (keep_desc) position += snprintf(out_str + position, out_len + 1 - position, " %s", description);
 
-        snprintf(out_str, out_len + 1, "%s%s", out_str, term);
+        position += snprintf(out_str + position, out_len + 1 - position, "%s", term);
 
-        if (instance->field_count != 0 && instance->fields != 0) for (size_t i = 0; i != instance->field_count; i++) snprintf(out_str, out_len + 1, "%s%s:%s%s%s", out_str, instance->fields[i].key, keep_compat ? " " : "", instance->fields[i].value, term);
+        for (size_t i = 0; i != field_count; i++) position += hypertext_utilities_output_field(out_str + position, &fields[i], keep_compat);
 
-        snprintf(out_str, out_len + 1, "%s%s", out_str, term);
+        position += snprintf(out_str + position, out_len + 1 - position, "%s", term);
 
-        if (instance->body != NULL && strlen(instance->body) > 0) snprintf(out_str, out_len + 1, "%s%s", out_str, instance->body);
+        if (body_length != 0 && !hypertext_utilities_read_body(instance, 0, out_str + position, body_length))
+        {
+            free(ver_str);
+            free(term);
+            free(out_str);
+            if (keep_desc) free(description);
+
+            return hypertext_Result_IO_Error;
+        }
 
         memcpy(output, out_str, sizeof(char) * out_len);
 
@@ -349,3 +351,41 @@ uint8_t hypertext_Output_Response(hypertext_Instance* instance, char* output, si
 
     return hypertext_Result_Success;
 }
+
+uint8_t hypertext_Output_Response(hypertext_Instance* instance, char* output, size_t* length, bool keep_desc, bool keep_compat)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+
+    return hypertext_utilities_output_response(instance, instance->fields, instance->field_count, instance->body_length, output, length, keep_desc, keep_compat);
+}
+
+uint8_t hypertext_utilities_output_head(hypertext_Instance* instance, const hypertext_utilities_field* fields, size_t field_count, char* output, size_t* length, bool keep_desc, bool keep_compat)
+{
+    // Nothing is read from the body while its length is 0.
+    return hypertext_utilities_output_response(instance, fields, field_count, 0, output, length, keep_desc, keep_compat);
+}
+
+uint8_t hypertext_Output_Response_Head(hypertext_Instance* instance, char* output, size_t* length, bool keep_desc, bool keep_compat)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+    else if (length == NULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_utilities_field* fields = calloc(instance->field_count + 1, sizeof(hypertext_utilities_field));
+    if (fields == NULL) return hypertext_Result_Out_Of_Memory;
+
+    size_t count = 0;
+    for (size_t i = 0; i != instance->field_count; i++) if (!hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Length) && !hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Transfer_Encoding)) fields[count++] = instance->fields[i];
+
+    // Informational and 204 responses can't carry a Content-Length field; as per RFC 9110, section 8.6.
+    char content_length[24];
+    if (instance->code >= 200 && instance->code != hypertext_Status_No_Content)
+    {
+        snprintf(content_length, sizeof(content_length), "%zu", instance->body_length);
+        fields[count++] = hypertext_utilities_make_field("Content-Length", content_length);
+    }
+
+    uint8_t result = hypertext_utilities_output_head(instance, fields, count, output, length, keep_desc, keep_compat);
+    free(fields);
+
+    return result;
+}
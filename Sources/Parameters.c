@@ -0,0 +1,295 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define hypertext_utilities_fnv_offset  2166136261u
+#define hypertext_utilities_fnv_prime   16777619u
+
+static const char hypertext_utilities_form_type[] = "application/x-www-form-urlencoded";
+
+// Returns the next decoded character of an urlencoded string, or -1 once the end has been reached.
+static inline int16_t hypertext_utilities_next_decoded(const char* input, size_t length, size_t* position)
+{
+    if (*position >= length) return -1;
+
+    char character = input[(*position)++];
+    if (character == '+') return ' ';
+    else if (character == '%' && *position + 1 < length)
+    {
+        int8_t high = hypertext_utilities_hex_value(input[*position]);
+        int8_t low  = hypertext_utilities_hex_value(input[*position + 1]);
+
+        if (high != -1 && low != -1)
+        {
+            *position += 2;
+            return (uint8_t)(high << 4 | low);
+        }
+    }
+
+    return (uint8_t)character;
+}
+
+static uint32_t hypertext_utilities_hash_name(const char* name, size_t length, bool encoded)
+{
+    uint32_t hash = hypertext_utilities_fnv_offset;
+
+    if (encoded)
+    {
+        size_t position = 0;
+        for (int16_t character; (character = hypertext_utilities_next_decoded(name, length, &position)) != -1;) hash = (hash ^ (uint8_t)character) * hypertext_utilities_fnv_prime;
+    }
+    else for (size_t i = 0; i != length; i++) hash = (hash ^ (uint8_t)name[i]) * hypertext_utilities_fnv_prime;
+
+    return hash;
+}
+
+// Compares an encoded name against another one, which may either be encoded or plain.
+static bool hypertext_utilities_names_equal(const hypertext_View* encoded, const char* other, size_t other_length, bool other_encoded)
+{
+    size_t position = 0, other_position = 0;
+
+    while (true)
+    {
+        int16_t character = hypertext_utilities_next_decoded(encoded->data, encoded->length, &position);
+
+        int16_t other_character = -1;
+        if (other_encoded) other_character = hypertext_utilities_next_decoded(other, other_length, &other_position);
+        else if (other_position < other_length) other_character = (uint8_t)other[other_position++];
+
+        if (character != other_character) return false;
+        else if (character == -1) return true;
+    }
+}
+
+static bool hypertext_utilities_fetch_source(hypertext_Instance* instance, uint8_t source, hypertext_View* output)
+{
+    if (source == hypertext_Parameter_Source_Query)
+    {
+        if (instance->type != hypertext_Instance_Content_Type_Request || !instance->target[hypertext_Target_Component_Query].present) return false;
+
+        output->data    = instance->path + instance->target[hypertext_Target_Component_Query].offset;
+        output->length  = instance->target[hypertext_Target_Component_Query].length;
+
+        return true;
+    }
+
+    if (instance->body == NULL || instance->segments != NULL) return false;
+
+    output->data    = instance->body;
+    output->length  = instance->body_length;
+
+    return true;
+}
+
+static bool hypertext_utilities_is_form(hypertext_Instance* instance)
+{
+    size_t type_length = sizeof(hypertext_utilities_form_type) - 1;
+
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        if (!hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Type)) continue;
+
+        const char* value = instance->fields[i].value;
+        if (instance->fields[i].value_length < type_length || !hypertext_utilities_equals_ignore_case(value, hypertext_utilities_form_type, type_length)) return false;
+
+        return instance->fields[i].value_length == type_length || value[type_length] == ';' || value[type_length] == ' ';
+    }
+
+    return true;
+}
+
+uint8_t hypertext_utilities_build_parameters(hypertext_Instance* instance, uint8_t source)
+{
+    hypertext_utilities_parameters* index = &instance->parameters[source];
+    if (index->built) return hypertext_Result_Success;
+
+    if (source == hypertext_Parameter_Source_Body)
+    {
+        uint8_t ready = hypertext_utilities_ready_fields(instance);
+        if (ready != hypertext_Result_Success) return ready;
+        else if (!hypertext_utilities_is_form(instance)) return hypertext_Result_Invalid_Parameters;
+    }
+
+    hypertext_View input;
+    if (!hypertext_utilities_fetch_source(instance, source, &input))
+    {
+        index->built = true;
+        return hypertext_Result_Success;
+    }
+
+    size_t count = 0;
+    for (size_t i = 0, start = 0; i <= input.length; i++) if (i == input.length || input.data[i] == '&')
+    {
+        if (i != start) count++;
+        start = i + 1;
+    }
+
+    if (count != 0)
+    {
+        size_t slot_count = 4;
+        while (slot_count < count * 2) slot_count *= 2;
+
+        index->entries  = calloc(count, sizeof(hypertext_utilities_parameter));
+        index->slots    = calloc(slot_count, sizeof(size_t));
+
+        if (index->entries == NULL || index->slots == NULL)
+        {
+            hypertext_utilities_reset_parameters(instance, source);
+            return hypertext_Result_Out_Of_Memory;
+        }
+
+        index->slot_count = slot_count;
+
+        for (size_t i = 0, start = 0; i <= input.length; i++) if (i == input.length || input.data[i] == '&')
+        {
+            if (i == start)
+            {
+                start = i + 1;
+                continue;
+            }
+
+            const char* pair    = input.data + start;
+            size_t length       = i - start;
+            const char* equals  = memchr(pair, '=', length);
+
+            hypertext_utilities_parameter* entry = &index->entries[index->count];
+
+            entry->parameter.name.data      = pair;
+            entry->parameter.name.length    = equals != NULL ? (size_t)(equals - pair) : length;
+            entry->parameter.value.data     = equals != NULL ? equals + 1 : pair + length;
+            entry->parameter.value.length   = equals != NULL ? length - entry->parameter.name.length - 1 : 0;
+            entry->hash                     = hypertext_utilities_hash_name(entry->parameter.name.data, entry->parameter.name.length, true);
+            entry->next                     = SIZE_MAX;
+            entry->last                     = index->count;
+
+            // Each distinct name owns one slot pointing to its first occurrence; later occurrences are chained behind it.
+            size_t slot = entry->hash & (slot_count - 1);
+            for (; index->slots[slot] != 0; slot = (slot + 1) & (slot_count - 1))
+            {
+                hypertext_utilities_parameter* head = &index->entries[index->slots[slot] - 1];
+                if (head->hash != entry->hash || !hypertext_utilities_names_equal(&head->parameter.name, entry->parameter.name.data, entry->parameter.name.length, true)) continue;
+
+                index->entries[head->last].next = index->count;
+                head->last                      = index->count;
+                break;
+            }
+
+            if (index->slots[slot] == 0) index->slots[slot] = index->count + 1;
+
+            index->count++;
+            start = i + 1;
+        }
+    }
+
+    index->built = true;
+
+    return hypertext_Result_Success;
+}
+
+void hypertext_utilities_reset_parameters(hypertext_Instance* instance, uint8_t source)
+{
+    free(instance->parameters[source].entries);
+    free(instance->parameters[source].slots);
+
+    memset(&instance->parameters[source], 0, sizeof(hypertext_utilities_parameters));
+}
+
+uint8_t hypertext_Fetch_Parameter_Count(hypertext_Instance* instance, uint8_t source, size_t* count)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (count == NULL || source >= hypertext_Parameter_Source_Max) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_utilities_build_parameters(instance, source);
+    if (result != hypertext_Result_Success) return result;
+
+    *count = instance->parameters[source].count;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Fetch_Parameter(hypertext_Instance* instance, uint8_t source, size_t index, hypertext_Parameter* output)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || source >= hypertext_Parameter_Source_Max) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_utilities_build_parameters(instance, source);
+    if (result != hypertext_Result_Success) return result;
+    else if (index >= instance->parameters[source].count) return hypertext_Result_Not_Found;
+
+    memcpy(output, &instance->parameters[source].entries[index].parameter, sizeof(hypertext_Parameter));
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Find_Parameter(hypertext_Instance* instance, uint8_t source, const char* name, size_t length, size_t* index)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (name == NULL || index == NULL || source >= hypertext_Parameter_Source_Max) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_utilities_build_parameters(instance, source);
+    if (result != hypertext_Result_Success) return result;
+
+    hypertext_utilities_parameters* parameters = &instance->parameters[source];
+    if (parameters->count == 0) return hypertext_Result_Not_Found;
+
+    uint32_t hash = hypertext_utilities_hash_name(name, length, false);
+
+    for (size_t slot = hash & (parameters->slot_count - 1); parameters->slots[slot] != 0; slot = (slot + 1) & (parameters->slot_count - 1))
+    {
+        size_t position = parameters->slots[slot] - 1;
+
+        hypertext_utilities_parameter* head = &parameters->entries[position];
+        if (head->hash != hash || !hypertext_utilities_names_equal(&head->parameter.name, name, length, false)) continue;
+
+        while (position != SIZE_MAX && position < *index) position = parameters->entries[position].next;
+        if (position == SIZE_MAX) return hypertext_Result_Not_Found;
+
+        *index = position;
+        return hypertext_Result_Success;
+    }
+
+    return hypertext_Result_Not_Found;
+}
+
+uint8_t hypertext_Decode_View(const hypertext_View* input, char* output, size_t* length, bool plus_as_space)
+{
+    if (input == NULL || length == NULL || (input->data == NULL && input->length != 0)) return hypertext_Result_Invalid_Parameters;
+
+    size_t decoded_length = hypertext_utilities_percent_decode(input->data, input->length, NULL, plus_as_space);
+
+    if (output == NULL)
+    {
+        *length = decoded_length;
+        return hypertext_Result_Success;
+    }
+    else if (*length < decoded_length) return hypertext_Result_Invalid_Parameters;
+
+    *length = hypertext_utilities_percent_decode(input->data, input->length, output, plus_as_space);
+
+    return hypertext_Result_Success;
+}
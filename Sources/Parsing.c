@@ -27,151 +27,592 @@
 #include <stdlib.h>
 #include <string.h>
 
-uint8_t hypertext_Parse_Request(hypertext_Instance* instance, const char* input, size_t length)
+// Header lines are collected on the stack first; longer heads fall back to the heap.
+#define hypertext_utilities_parse_lines 64
+
+typedef struct
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
-    else if (input == NULL) return hypertext_Result_Invalid_Parameters;
+    size_t      name;
+    size_t      name_length;
+    size_t      value;
+    size_t      value_length;
+    const char* interned;
+} hypertext_utilities_line;
+
+inline static bool hypertext_utilities_parse_is_space(char character)
+{
+    return character == ' ' || character == '\t';
+}
+
+// Returns the position after the line feed ending the line at position, or SIZE_MAX if there's none before end.
+inline static size_t hypertext_utilities_parse_line_end(const char* input, size_t position, size_t end)
+{
+    const char* newline = memchr(input + position, '\n', end - position);
+
+    return newline != NULL ? (size_t)(newline - input) + 1 : SIZE_MAX;
+}
 
-    instance->type = hypertext_Instance_Content_Type_Request;
+// Checks for "\n" or "\r\n" at position, and skips it.
+inline static bool hypertext_utilities_parse_newline(const char* input, size_t* position, size_t end)
+{
+    if (*position < end && input[*position] == '\r') (*position)++;
+    if (*position >= end || input[*position] != '\n') return false;
+
+    (*position)++;
+
+    return true;
+}
 
-    char* methodstr     = calloc(8, sizeof(char));
-    uint8_t methodlen   = 0;
-    for (; methodlen != 8; methodlen++)
+static uint8_t hypertext_utilities_parse_version(hypertext_Instance* instance, const char* input, size_t* position, size_t end)
+{
+    if (end - *position < 8 || memcmp(input + *position, "HTTP/", 5) != 0) return hypertext_Result_Invalid_Parameters;
+
+    const char* version = input + *position + 5;
+
+    if      (memcmp(version, "1.0", 3) == 0) instance->version = hypertext_HTTP_Version_1_0;
+    else if (memcmp(version, "1.1", 3) == 0) instance->version = hypertext_HTTP_Version_1_1;
+    else return hypertext_Result_Invalid_Version;
+
+    *position += 8;
+
+    return hypertext_Result_Success;
+}
+
+static uint8_t hypertext_utilities_parse_request_line(hypertext_Instance* instance, const char* input, size_t* position, size_t end)
+{
+    size_t methodlen = 0;
+    while (methodlen != end && hypertext_utilities_is_token_character(input[methodlen])) methodlen++;
+
+    if (methodlen == 0 || methodlen == end || input[methodlen] != ' ') return hypertext_Result_Invalid_Method;
+
+    instance->method = hypertext_utilities_find_method(input, methodlen);
+    if (instance->method == hypertext_Method_Extension)
     {
-        if (input[methodlen] ==  ' ' || input[methodlen] == 0) break;
+        instance->method_token = calloc(methodlen + 1, sizeof(char));
+        if (instance->method_token == NULL) return hypertext_Result_Out_Of_Memory;
 
-        methodstr[methodlen] = input[methodlen];
+        memcpy(instance->method_token, input, methodlen);
+        instance->method_token_length = methodlen;
     }
 
-    instance->method = UINT8_MAX;
-    if      (strcmp(methodstr, "OPTIONS") == 0)    instance->method = hypertext_Method_OPTIONS;
-    else if (strcmp(methodstr, "GET") == 0)        instance->method = hypertext_Method_GET;
-    else if (strcmp(methodstr, "HEAD") == 0)       instance->method = hypertext_Method_HEAD;
-    else if (strcmp(methodstr, "POST") == 0)       instance->method = hypertext_Method_POST;
-    else if (strcmp(methodstr, "PUT") == 0)        instance->method = hypertext_Method_PUT;
-    else if (strcmp(methodstr, "DELETE") == 0)     instance->method = hypertext_Method_DELETE;
-    else if (strcmp(methodstr, "TRACE") == 0)      instance->method = hypertext_Method_TRACE;
-    else if (strcmp(methodstr, "CONNECT") == 0)    instance->method = hypertext_Method_CONNECT;
-
-    free(methodstr);
-    if (instance->method == UINT8_MAX) return hypertext_Result_Invalid_Method;
+    // Remember where the query and fragment begin while looking for the end of the target.
+    const char* target  = input + methodlen + 1;
+    size_t available    = end - methodlen - 1;
+    size_t pathlen      = 0, query = SIZE_MAX, fragment = SIZE_MAX;
+    for (; pathlen != available && target[pathlen] != ' '; pathlen++)
+    {
+        if (target[pathlen] == 0 || target[pathlen] == '\r' || target[pathlen] == '\n') return hypertext_Result_Invalid_Parameters;
+        else if (target[pathlen] == '?' && query == SIZE_MAX && fragment == SIZE_MAX) query = pathlen;
+        else if (target[pathlen] == '#' && fragment == SIZE_MAX) fragment = pathlen;
+    }
 
-    size_t pathlen = 1;
-    for (; pathlen != SIZE_MAX; pathlen++) if (input[methodlen + pathlen + 1] ==  ' ') break;
+    if (pathlen == 0 || pathlen == available) return hypertext_Result_Invalid_Parameters;
 
     instance->path = calloc(pathlen + 1, sizeof(char));
-    memcpy(instance->path, hypertext_utilities_cut_text(input, methodlen + 1, methodlen + pathlen + 1), pathlen);
+    if (instance->path == NULL) return hypertext_Result_Out_Of_Memory;
+
+    memcpy(instance->path, target, pathlen);
+    instance->path_length = pathlen;
 
-    char* http_prefix = calloc(6, sizeof(char));
-    memcpy(http_prefix, hypertext_utilities_cut_text(input, methodlen + pathlen + 2, methodlen + pathlen + 7), 5);
+    hypertext_utilities_split_target(instance, query, fragment);
 
-    int32_t result = strcmp(http_prefix, "HTTP/");
-    free(http_prefix);
+    *position = methodlen + pathlen + 2;
 
-    if (result != 0) return hypertext_Result_Invalid_Parameters;
+    uint8_t result = hypertext_utilities_parse_version(instance, input, position, end);
+    if (result != hypertext_Result_Success) return result;
+    else if (!hypertext_utilities_parse_newline(input, position, end)) return hypertext_Result_Invalid_Parameters;
 
-    char* ver_str = calloc(4, sizeof(char));
-    memcpy(ver_str, hypertext_utilities_cut_text(input, methodlen + pathlen + 7, methodlen + pathlen + 10), 3);
+    return hypertext_Result_Success;
+}
 
-    if      (strcmp(ver_str, "1.0") == 0) instance->version = hypertext_HTTP_Version_1_0;
-    else if (strcmp(ver_str, "1.1") == 0) instance->version = hypertext_HTTP_Version_1_1;
-    else
+static uint8_t hypertext_utilities_parse_status_line(hypertext_Instance* instance, const char* input, size_t* position, size_t end)
+{
+    uint8_t result = hypertext_utilities_parse_version(instance, input, position, end);
+    if (result != hypertext_Result_Success) return result;
+    else if (end - *position < 4 || input[*position] != ' ') return hypertext_Result_Invalid_Parameters;
+
+    uint16_t code = 0;
+    for (size_t i = 1; i != 4; i++)
     {
-        free(ver_str);
-        return hypertext_Result_Invalid_Version;
+        char digit = input[*position + i];
+        if (digit < '0' || digit > '9') return hypertext_Result_Invalid_Parameters;
+
+        code = code * 10 + (uint16_t)(digit - '0');
+    }
+
+    if (code < 100) return hypertext_Result_Invalid_Parameters;
+
+    instance->code  = code;
+    *position      += 4;
+
+    // The reason phrase is optional and isn't kept; as per RFC 9112, section 4.
+    if (*position < end && input[*position] == ' ')
+    {
+        size_t line_end = hypertext_utilities_parse_line_end(input, *position, end);
+        *position = line_end != SIZE_MAX ? line_end : end;
+
+        return hypertext_Result_Success;
     }
+    else if (!hypertext_utilities_parse_newline(input, position, end) && *position != end) return hypertext_Result_Invalid_Parameters;
+
+    return hypertext_Result_Success;
+}
+
+// Checks the field line at position and moves past it; name_length is left at 0 once the empty line ending the block is reached.
+static uint8_t hypertext_utilities_parse_field_line(const char* input, size_t* position, size_t end, hypertext_utilities_line* line)
+{
+    size_t line_end     = hypertext_utilities_parse_line_end(input, *position, end);
+    size_t next         = line_end != SIZE_MAX ? line_end : end;
+    size_t content_end  = line_end != SIZE_MAX ? line_end - 1 : end;
+
+    line->name_length = 0;
+
+    if (content_end > *position && input[content_end - 1] == '\r') content_end--;
+    if (content_end == *position) return hypertext_Result_Success;
+
+    // Folded lines are obsolete and rejected; as per RFC 9112, section 5.2.
+    size_t name_end = *position;
+    while (name_end != content_end && hypertext_utilities_is_token_character(input[name_end])) name_end++;
+
+    if (name_end == *position || name_end == content_end || input[name_end] != ':') return hypertext_Result_Invalid_Parameters;
+
+    size_t value = name_end + 1, value_end = content_end;
+    while (value != value_end && hypertext_utilities_parse_is_space(input[value])) value++;
+    while (value_end != value && hypertext_utilities_parse_is_space(input[value_end - 1])) value_end--;
+
+    for (size_t i = value; i != value_end; i++) if (input[i] == '\0' || input[i] == '\r') return hypertext_Result_Invalid_Parameters;
+
+    line->name          = *position;
+    line->name_length   = name_end - *position;
+    line->value         = value;
+    line->value_length  = value_end - value;
+
+    *position = next;
 
-    free(ver_str);
+    return hypertext_Result_Success;
+}
+
+// Splits the header block into fields stored in one allocation, one for every line in the order they arrived; interned names aren't copied.
+static uint8_t hypertext_utilities_parse_fields(hypertext_Instance* instance, const char* input, size_t position, size_t end)
+{
+    hypertext_utilities_line stack[hypertext_utilities_parse_lines];
+    hypertext_utilities_line* lines = stack;
+    size_t line_count = 0, line_capacity = hypertext_utilities_parse_lines, text_length = 0;
+    uint8_t result = hypertext_Result_Success;
+
+    while (position < end)
+    {
+        hypertext_utilities_line parsed;
+
+        result = hypertext_utilities_parse_field_line(input, &position, end, &parsed);
+        if (result != hypertext_Result_Success || parsed.name_length == 0) break;
 
-    size_t padding = methodlen + pathlen + 10;
-    if (input[padding] == '\r') padding++;
+        if (line_count == line_capacity)
+        {
+            hypertext_utilities_line* grown = lines == stack ? malloc(line_capacity * 2 * sizeof(hypertext_utilities_line)) : realloc(lines, line_capacity * 2 * sizeof(hypertext_utilities_line));
+            if (grown == NULL)
+            {
+                result = hypertext_Result_Out_Of_Memory;
+                break;
+            }
+
+            if (lines == stack) memcpy(grown, stack, sizeof(stack));
+
+            lines           = grown;
+            line_capacity  *= 2;
+        }
 
-    if (input[padding] != '\n') return hypertext_Result_Invalid_Parameters;
+        hypertext_utilities_line* line = &lines[line_count++];
 
-    padding++;
+        *line           = parsed;
+        line->interned  = hypertext_utilities_intern(input + line->name, line->name_length, true);
 
-    size_t header_offset    = hypertext_utilities_parse_headers(hypertext_utilities_cut_text(input, padding, strlen(input)), NULL, &instance->field_count);
-    size_t body_offset      = 0;
-    if (header_offset != 0)
+        text_length += (line->interned != NULL ? 0 : line->name_length + 1) + line->value_length + 1;
+    }
+
+    if (result == hypertext_Result_Success && line_count != 0)
     {
-        instance->fields    = calloc(instance->field_count, sizeof(hypertext_Header_Field));
-        body_offset         = hypertext_utilities_parse_headers(hypertext_utilities_cut_text(input, padding, strlen(input)), instance->fields, &instance->field_count);
+        instance->fields            = calloc(line_count, sizeof(hypertext_utilities_field));
+        instance->field_capacity    = line_count;
+        instance->field_text        = malloc(text_length);
+
+        if (instance->fields == NULL || instance->field_text == NULL) result = hypertext_Result_Out_Of_Memory;
     }
-    else instance->fields = NULL;
 
-    if (length != 0)
+    if (result == hypertext_Result_Success && line_count != 0)
     {
-        if (length > strlen(input) - body_offset) length = strlen(input) - body_offset;
+        char* text = instance->field_text;
 
-        instance->body = calloc(length + 1, sizeof(char));
-        memcpy(instance->body, hypertext_utilities_cut_text(input, padding + body_offset + 1, padding + body_offset + length), sizeof(char) * length);
+        for (size_t i = 0; i != line_count; i++)
+        {
+            hypertext_utilities_field* field = &instance->fields[instance->field_count++];
+            field->key_length = lines[i].name_length;
+
+            if (lines[i].interned != NULL) field->key = (char*)lines[i].interned;
+            else
+            {
+                field->key = text;
+                memcpy(text, input + lines[i].name, lines[i].name_length);
+                text += lines[i].name_length;
+                *text++ = '\0';
+            }
+
+            field->value        = text;
+            field->value_length = lines[i].value_length;
+            memcpy(text, input + lines[i].value, lines[i].value_length);
+            text += lines[i].value_length;
+            *text++ = '\0';
+        }
     }
-    else instance->body = NULL;
 
-    return hypertext_Result_Success;
+    if (lines != stack) free(lines);
+
+    return result;
 }
 
-uint8_t hypertext_Parse_Response(hypertext_Instance* instance, const char* input, size_t length)
+// Only checks the header block and keeps a copy of it, to be split once the fields are needed.
+static uint8_t hypertext_utilities_parse_lazy_fields(hypertext_Instance* instance, const char* input, size_t position, size_t end)
 {
-    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
-    else if (input == NULL) return hypertext_Result_Invalid_Parameters;
+    size_t start = position;
 
-    instance->type = hypertext_Instance_Content_Type_Response;
+    while (position < end)
+    {
+        hypertext_utilities_line line;
+
+        uint8_t result = hypertext_utilities_parse_field_line(input, &position, end, &line);
+        if (result != hypertext_Result_Success) return result;
+        else if (line.name_length == 0) break;
+
+        // The body can't be framed without these, so messages carrying them are split right away.
+        const char* name = input + line.name;
+        if ((line.name_length == 14 && hypertext_utilities_equals_ignore_case(name, "Content-Length", 14)) || (line.name_length == 17 && hypertext_utilities_equals_ignore_case(name, "Transfer-Encoding", 17))) return hypertext_utilities_parse_fields(instance, input, start, end);
+    }
 
-    char* http_prefix = calloc(6, sizeof(char));
-    memcpy(http_prefix, hypertext_utilities_cut_text(input, 0, 5), 5);
+    if (position == start) return hypertext_Result_Success;
 
-    int32_t result = strcmp(http_prefix, "HTTP/");
-    free(http_prefix);
+    instance->field_source = malloc(position - start);
+    if (instance->field_source == NULL) return hypertext_Result_Out_Of_Memory;
 
-    if (result != 0) return hypertext_Result_Invalid_Parameters;
+    memcpy(instance->field_source, input + start, position - start);
+    instance->field_source_length = position - start;
 
-    char* val_str = calloc(4, sizeof(char));
-    memcpy(val_str, hypertext_utilities_cut_text(input, 5, 8), 3);
+    return hypertext_Result_Success;
+}
 
-    if      (strcmp(val_str, "1.0") == 0) instance->version = hypertext_HTTP_Version_1_0;
-    else if (strcmp(val_str, "1.1") == 0) instance->version = hypertext_HTTP_Version_1_1;
-    else
+uint8_t hypertext_utilities_split_fields(hypertext_Instance* instance)
+{
+    // The lines were checked while parsing, so running out of memory is all that can go wrong here.
+    uint8_t result = hypertext_utilities_parse_fields(instance, instance->field_source, 0, instance->field_source_length);
+    if (result != hypertext_Result_Success)
     {
-        free(val_str);
-        return hypertext_Result_Invalid_Version;
+        free(instance->fields);
+        free(instance->field_text);
+
+        instance->fields            = NULL;
+        instance->field_text        = NULL;
+        instance->field_count       = 0;
+        instance->field_capacity    = 0;
+
+        return result;
     }
 
-    memcpy(val_str, hypertext_utilities_cut_text(input, 9, 12), 3);
-    unsigned long status_int = strtoul(val_str, NULL, 0);
-    free(val_str);
-    if (status_int > UINT16_MAX || status_int < 100) return hypertext_Result_Invalid_Parameters;
+    free(instance->field_source);
+    instance->field_source          = NULL;
+    instance->field_source_length   = 0;
 
-    instance->code = (uint16_t)status_int;
+    return hypertext_Result_Success;
+}
 
-    uint32_t padding = 13;
-    for (; padding != UINT32_MAX; padding++)
+// Parses the start line and the fields; head is set to the length of both, including the empty line.
+static uint8_t hypertext_utilities_parse_head(hypertext_Instance* instance, const char* input, size_t size, bool bounded, bool lazy, size_t* head)
+{
+    // Finding the empty line first keeps everything below from reading past the head.
+    size_t end = SIZE_MAX;
+    for (size_t line_end = hypertext_utilities_parse_line_end(input, 0, size); line_end != SIZE_MAX; line_end = hypertext_utilities_parse_line_end(input, line_end, size))
     {
-        if (input[padding] == '\r') continue;
-        else if (input[padding] == '\n')
+        size_t position = line_end;
+
+        if (hypertext_utilities_parse_newline(input, &position, size))
         {
-            padding++;
+            end = position;
             break;
         }
+        else if (position == size) break;
     }
 
-    size_t header_offset    = hypertext_utilities_parse_headers(hypertext_utilities_cut_text(input, padding, strlen(input)), NULL, &instance->field_count);
-    size_t body_offset      = 0;
-    if (header_offset != 0)
+    if (end == SIZE_MAX)
     {
-        instance->fields = calloc(instance->field_count, sizeof(hypertext_Header_Field));
-        body_offset = hypertext_utilities_parse_headers(hypertext_utilities_cut_text(input, padding, strlen(input)), instance->fields, &instance->field_count);
+        if (bounded) return hypertext_Result_Incomplete;
+
+        end = size;
     }
-    else instance->fields = NULL;
 
-    if (length != 0)
+    size_t position = 0;
+    uint8_t result = instance->type == hypertext_Instance_Content_Type_Request ? hypertext_utilities_parse_request_line(instance, input, &position, end) : hypertext_utilities_parse_status_line(instance, input, &position, end);
+    if (result != hypertext_Result_Success) return result;
+
+    result = lazy ? hypertext_utilities_parse_lazy_fields(instance, input, position, end) : hypertext_utilities_parse_fields(instance, input, position, end);
+    if (result != hypertext_Result_Success) return result;
+
+    *head = end;
+
+    return hypertext_Result_Success;
+}
+
+static bool hypertext_utilities_parse_store_body(hypertext_Instance* instance, const char* body, size_t length)
+{
+    if (length == 0) return true;
+
+    instance->body = malloc(length + 1);
+    if (instance->body == NULL) return false;
+
+    if (body != NULL) memcpy(instance->body, body, length);
+
+    instance->body[length]  = '\0';
+    instance->body_length   = length;
+
+    return true;
+}
+
+// Reads a Content-Length value; a list of equal numbers is accepted, as some senders repeat it.
+bool hypertext_utilities_parse_content_length(const char* value, size_t* output)
+{
+    bool found = false;
+
+    while (true)
     {
-        if (length > strlen(input) - body_offset) length = strlen(input) - body_offset;
+        while (hypertext_utilities_parse_is_space(*value)) value++;
 
-        instance->body = calloc(length + 1, sizeof(char));
-        memcpy(instance->body, hypertext_utilities_cut_text(input, padding + body_offset, padding + body_offset + length), length);
+        size_t length = 0;
+        const char* digits = value;
+        for (; *value >= '0' && *value <= '9'; value++)
+        {
+            if (length > (SIZE_MAX - 9) / 10) return false;
+
+            length = length * 10 + (size_t)(*value - '0');
+        }
+
+        if (value == digits || (found && length != *output)) return false;
+
+        found   = true;
+        *output = length;
+
+        while (hypertext_utilities_parse_is_space(*value)) value++;
+
+        if (*value == '\0') return true;
+        else if (*value++ != ',') return false;
     }
-    else instance->fields = NULL;
+}
+
+// Walks a chunked body; output can be NULL to only measure it. Chunk extensions and trailer fields are skipped.
+static uint8_t hypertext_utilities_parse_chunks(const char* input, size_t size, char* output, size_t* length, size_t* consumed)
+{
+    size_t position = 0, total = 0;
+
+    while (true)
+    {
+        size_t chunk = 0, start = position;
+        for (int8_t digit; position != size && (digit = hypertext_utilities_hex_value(input[position])) >= 0; position++)
+        {
+            if (chunk > (SIZE_MAX >> 4)) return hypertext_Result_Invalid_Parameters;
+
+            chunk = chunk << 4 | (size_t)digit;
+        }
+
+        if (position == size) return hypertext_Result_Incomplete;
+        else if (position == start || (input[position] != ';' && input[position] != '\r' && input[position] != '\n' && !hypertext_utilities_parse_is_space(input[position]))) return hypertext_Result_Invalid_Parameters;
+
+        position = hypertext_utilities_parse_line_end(input, position, size);
+        if (position == SIZE_MAX) return hypertext_Result_Incomplete;
+        else if (chunk == 0) break;
+        else if (size - position <= chunk) return hypertext_Result_Incomplete;
+
+        if (output != NULL) memcpy(output + total, input + position, chunk);
+
+        total       += chunk;
+        position    += chunk;
+
+        size_t after = position;
+        if (!hypertext_utilities_parse_newline(input, &after, size)) return after == size ? hypertext_Result_Incomplete : hypertext_Result_Invalid_Parameters;
+
+        position = after;
+    }
+
+    while (true)
+    {
+        size_t line_end = hypertext_utilities_parse_line_end(input, position, size);
+        if (line_end == SIZE_MAX) return hypertext_Result_Incomplete;
+
+        bool empty = line_end - position == 1 || (line_end - position == 2 && input[position] == '\r');
+        position = line_end;
+
+        if (empty) break;
+    }
+
+    *length     = total;
+    *consumed   = position;
 
     return hypertext_Result_Success;
 }
+
+// Frames the body as per RFC 9112, section 6.3, and sets consumed to its length on the wire.
+static uint8_t hypertext_utilities_parse_framed_body(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    const char* transfer_encoding   = NULL;
+    bool content_length             = false, valid_length = true;
+    size_t length                   = 0;
+
+    // Repeated fields are kept apart; every Content-Length has to agree, and the last Transfer-Encoding holds the final coding.
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        if (hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Transfer_Encoding)) transfer_encoding = instance->fields[i].value;
+        else if (hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Length))
+        {
+            size_t value = 0;
+            if (!hypertext_utilities_parse_content_length(instance->fields[i].value, &value) || (content_length && value != length)) valid_length = false;
+
+            content_length  = true;
+            length          = value;
+        }
+    }
+
+    bool request = instance->type == hypertext_Instance_Content_Type_Request;
+
+    *consumed = 0;
+    if (!request && (instance->code < 200 || instance->code == hypertext_Status_No_Content || instance->code == hypertext_Status_Not_Modified)) return hypertext_Result_Success;
+
+    if (transfer_encoding != NULL)
+    {
+        // Chunked has to be the final coding; anything else can only be delimited by closing the connection.
+        const char* last = transfer_encoding + strlen(transfer_encoding);
+        while (last != transfer_encoding && last[-1] != ',') last--;
+        while (hypertext_utilities_parse_is_space(*last)) last++;
+
+        if (strlen(last) == 7 && hypertext_utilities_equals_ignore_case(last, "chunked", 7))
+        {
+            size_t body_length;
+            uint8_t result = hypertext_utilities_parse_chunks(input, size, NULL, &body_length, consumed);
+            if (result != hypertext_Result_Success) return result;
+            else if (!hypertext_utilities_parse_store_body(instance, NULL, body_length)) return hypertext_Result_Out_Of_Memory;
+
+            return body_length != 0 ? hypertext_utilities_parse_chunks(input, size, instance->body, &body_length, consumed) : hypertext_Result_Success;
+        }
+        else if (request) return hypertext_Result_Invalid_Parameters;
+    }
+    else if (content_length)
+    {
+        if (!valid_length) return hypertext_Result_Invalid_Parameters;
+        else if (length > size) return hypertext_Result_Incomplete;
+
+        *consumed = length;
+        return hypertext_utilities_parse_store_body(instance, input, length) ? hypertext_Result_Success : hypertext_Result_Out_Of_Memory;
+    }
+    else if (request) return hypertext_Result_Success;
+
+    // Without any framing a response's body lasts until the connection closes, which here is the end of the input.
+    *consumed = size;
+    return hypertext_utilities_parse_store_body(instance, input, size) ? hypertext_Result_Success : hypertext_Result_Out_Of_Memory;
+}
+
+static uint8_t hypertext_utilities_parse_buffer(hypertext_Instance* instance, uint8_t type, const char* input, size_t size, bool lazy, size_t* consumed)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL && size != 0) return hypertext_Result_Invalid_Parameters;
+
+    // Empty lines before a message are skipped; as per RFC 9112, section 2.2.
+    size_t skipped = 0;
+    while (skipped != size && (input[skipped] == '\r' || input[skipped] == '\n')) skipped++;
+
+    if (skipped == size) return hypertext_Result_Incomplete;
+
+    instance->type = type;
+
+    size_t head = 0, body = 0;
+    uint8_t result = hypertext_utilities_parse_head(instance, input + skipped, size - skipped, true, lazy, &head);
+    if (result == hypertext_Result_Success) result = hypertext_utilities_parse_framed_body(instance, input + skipped + head, size - skipped - head, &body);
+
+    if (result != hypertext_Result_Success)
+    {
+        hypertext_Destroy(instance);
+        return result;
+    }
+
+    if (consumed != NULL) *consumed = skipped + head + body;
+
+    return hypertext_Result_Success;
+}
+
+static uint8_t hypertext_utilities_parse_text(hypertext_Instance* instance, uint8_t type, const char* input, size_t length)
+{
+    if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Unknown) return hypertext_Result_Invalid_Instance;
+    else if (input == NULL) return hypertext_Result_Invalid_Parameters;
+
+    instance->type = type;
+
+    size_t size = strlen(input), head = 0;
+    uint8_t result = hypertext_utilities_parse_head(instance, input, size, false, false, &head);
+
+    // Whatever follows the head is the body, up to the given length.
+    size_t body_length = size - head;
+    if (length != 0 && length < body_length) body_length = length;
+
+    if (result == hypertext_Result_Success && !hypertext_utilities_parse_store_body(instance, input + head, body_length)) result = hypertext_Result_Out_Of_Memory;
+
+    if (result != hypertext_Result_Success) hypertext_Destroy(instance);
+
+    return result;
+}
+
+uint8_t hypertext_Parse_Request(hypertext_Instance* instance, const char* input, size_t length)
+{
+    return hypertext_utilities_parse_text(instance, hypertext_Instance_Content_Type_Request, input, length);
+}
+
+uint8_t hypertext_Parse_Response(hypertext_Instance* instance, const char* input, size_t length)
+{
+    return hypertext_utilities_parse_text(instance, hypertext_Instance_Content_Type_Response, input, length);
+}
+
+uint8_t hypertext_Parse_Request_Buffer(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    return hypertext_utilities_parse_buffer(instance, hypertext_Instance_Content_Type_Request, input, size, false, consumed);
+}
+
+uint8_t hypertext_Parse_Request_Lazy(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    return hypertext_utilities_parse_buffer(instance, hypertext_Instance_Content_Type_Request, input, size, true, consumed);
+}
+
+uint8_t hypertext_Parse_Response_Buffer(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    return hypertext_utilities_parse_buffer(instance, hypertext_Instance_Content_Type_Response, input, size, false, consumed);
+}
+
+static uint8_t hypertext_utilities_parse_forward(hypertext_Instance* instance, uint8_t type, const char* input, size_t size, size_t* consumed)
+{
+    size_t length = 0;
+
+    uint8_t result = hypertext_utilities_parse_buffer(instance, type, input, size, false, &length);
+    if (result != hypertext_Result_Success) return result;
+
+    result = hypertext_utilities_forward_start(instance, input, length);
+    if (result != hypertext_Result_Success)
+    {
+        hypertext_Destroy(instance);
+        return result;
+    }
+
+    if (consumed != NULL) *consumed = length;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Parse_Request_Forward(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    return hypertext_utilities_parse_forward(instance, hypertext_Instance_Content_Type_Request, input, size, consumed);
+}
+
+uint8_t hypertext_Parse_Response_Forward(hypertext_Instance* instance, const char* input, size_t size, size_t* consumed)
+{
+    return hypertext_utilities_parse_forward(instance, hypertext_Instance_Content_Type_Response, input, size, consumed);
+}
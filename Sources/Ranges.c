@@ -0,0 +1,361 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Ranges closer than this are sent as one; a multipart part header costs about as much.
+#define hypertext_utilities_ranges_gap      80
+#define hypertext_utilities_ranges_boundary 26
+
+inline static bool hypertext_utilities_ranges_is_space(char character)
+{
+    return character == ' ' || character == '\t';
+}
+
+static const char* hypertext_utilities_ranges_skip(const char* cursor)
+{
+    while (hypertext_utilities_ranges_is_space(*cursor)) cursor++;
+
+    return cursor;
+}
+
+// Reads a decimal number, saturating instead of overflowing; false if there's no digit.
+static bool hypertext_utilities_ranges_number(const char** cursor, uint64_t* output)
+{
+    const char* position = *cursor;
+    uint64_t value = 0;
+
+    while (*position >= '0' && *position <= '9')
+    {
+        uint8_t digit = (uint8_t)(*position++ - '0');
+        value = value > (UINT64_MAX - digit) / 10 ? UINT64_MAX : value * 10 + digit;
+    }
+
+    if (position == *cursor) return false;
+
+    *cursor = position;
+    *output = value;
+
+    return true;
+}
+
+inline static bool hypertext_utilities_ranges_near(uint64_t last, uint64_t first)
+{
+    return first <= last || first - last <= hypertext_utilities_ranges_gap;
+}
+
+// Inserts a range into the sorted set, merging it with every range it overlaps or nearly touches.
+static bool hypertext_utilities_ranges_insert(hypertext_Range* ranges, size_t* count, size_t capacity, hypertext_Range range)
+{
+    size_t first = 0;
+    while (first != *count && !hypertext_utilities_ranges_near(ranges[first].last, range.first)) first++;
+
+    size_t last = first;
+    while (last != *count && hypertext_utilities_ranges_near(range.last, ranges[last].first))
+    {
+        if (ranges[last].first < range.first) range.first = ranges[last].first;
+        if (ranges[last].last > range.last) range.last = ranges[last].last;
+
+        last++;
+    }
+
+    if (first == last)
+    {
+        if (*count == capacity) return false;
+
+        memmove(&ranges[first + 1], &ranges[first], (*count - first) * sizeof(hypertext_Range));
+        (*count)++;
+    }
+    else if (last - first > 1)
+    {
+        memmove(&ranges[first + 1], &ranges[last], (*count - last) * sizeof(hypertext_Range));
+        *count -= last - first - 1;
+    }
+
+    ranges[first] = range;
+
+    return true;
+}
+
+// Checks an If-Range value against the representation's validators; as per RFC 9110, section 13.1.5.
+static bool hypertext_utilities_ranges_validate(const char* condition, const char* entity_tag, const char* last_modified)
+{
+    condition = hypertext_utilities_ranges_skip(condition);
+
+    size_t length = strlen(condition);
+    while (length != 0 && hypertext_utilities_ranges_is_space(condition[length - 1])) length--;
+
+    // Weak entity tags never match; strong ones are compared character by character.
+    if (condition[0] == '"') return entity_tag != NULL && entity_tag[0] == '"' && strlen(entity_tag) == length && memcmp(condition, entity_tag, length) == 0;
+    else if (condition[0] == 'W' && condition[1] == '/') return false;
+
+    return last_modified != NULL && strlen(last_modified) == length && memcmp(condition, last_modified, length) == 0;
+}
+
+uint8_t hypertext_Fetch_Ranges(hypertext_Instance* request, uint64_t size, const char* entity_tag, const char* last_modified, hypertext_Range* output, size_t* count)
+{
+    if (request == NULL || request->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL || count == NULL || *count == 0) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t ready = hypertext_utilities_ready_fields(request);
+    if (ready != hypertext_Result_Success) return ready;
+
+    size_t capacity = *count;
+    *count = 0;
+
+    const char* range       = NULL;
+    const char* condition   = NULL;
+
+    for (size_t i = 0; i != request->field_count; i++)
+    {
+        if (hypertext_utilities_is_field(&request->fields[i], hypertext_utilities_known_Range)) range = request->fields[i].value;
+        else if (hypertext_utilities_is_field(&request->fields[i], hypertext_utilities_known_If_Range)) condition = request->fields[i].value;
+    }
+
+    // Ranges only apply to GET; as per RFC 9110, section 14.2.
+    if (range == NULL || request->method != hypertext_Method_GET || size == 0) return hypertext_Result_Success;
+    else if (condition != NULL && !hypertext_utilities_ranges_validate(condition, entity_tag, last_modified)) return hypertext_Result_Success;
+
+    const char* cursor = hypertext_utilities_ranges_skip(range);
+    if (!hypertext_utilities_equals_ignore_case(cursor, "bytes=", 6)) return hypertext_Result_Success;
+
+    cursor += 6;
+
+    // Anything malformed makes the whole field be ignored, so the full representation is sent instead.
+    bool specified = false;
+    while (true)
+    {
+        cursor = hypertext_utilities_ranges_skip(cursor);
+
+        if (*cursor == ',')
+        {
+            cursor++;
+            continue;
+        }
+        else if (*cursor == '\0') break;
+
+        hypertext_Range entry;
+        bool satisfiable;
+
+        if (*cursor == '-')
+        {
+            uint64_t suffix;
+
+            cursor++;
+            if (!hypertext_utilities_ranges_number(&cursor, &suffix)) return hypertext_Result_Success;
+
+            satisfiable = suffix != 0;
+            entry.first = suffix >= size ? 0 : size - suffix;
+            entry.last  = size - 1;
+        }
+        else
+        {
+            if (!hypertext_utilities_ranges_number(&cursor, &entry.first) || *cursor++ != '-') return hypertext_Result_Success;
+
+            entry.last = UINT64_MAX;
+            if (*cursor >= '0' && *cursor <= '9')
+            {
+                hypertext_utilities_ranges_number(&cursor, &entry.last);
+                if (entry.last < entry.first) return hypertext_Result_Success;
+            }
+
+            satisfiable = entry.first < size;
+            if (entry.last >= size) entry.last = size - 1;
+        }
+
+        cursor = hypertext_utilities_ranges_skip(cursor);
+        if (*cursor != ',' && *cursor != '\0') return hypertext_Result_Success;
+
+        specified = true;
+
+        // Too many separate pieces are served as a whole rather than as a huge multipart body.
+        if (satisfiable && !hypertext_utilities_ranges_insert(output, count, capacity, entry))
+        {
+            *count = 0;
+            return hypertext_Result_Success;
+        }
+    }
+
+    if (specified && *count == 0) return hypertext_Result_Not_Satisfiable;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Set_Ranges(hypertext_Instance* response, const hypertext_Range* ranges, size_t count)
+{
+    if (response == NULL || response->frozen || response->type != hypertext_Instance_Content_Type_Response) return hypertext_Result_Invalid_Instance;
+    else if (count != 0 && ranges == NULL) return hypertext_Result_Invalid_Parameters;
+    else if (response->segment_text != NULL) return hypertext_Result_Already_Present;
+    else if (response->forward != NULL) return hypertext_Result_Unsupported;
+
+    uint64_t size = response->body_length;
+    for (size_t i = 0; i != count; i++) if (ranges[i].first > ranges[i].last || ranges[i].last >= size) return hypertext_Result_Invalid_Parameters;
+
+    const char* type = NULL;
+    for (size_t i = 0; i != response->field_count; i++) if (hypertext_utilities_is_field(&response->fields[i], hypertext_utilities_known_Content_Type)) type = response->fields[i].value;
+
+    bool multipart = count > 1;
+
+    char boundary[hypertext_utilities_ranges_boundary + 1];
+    if (multipart)
+    {
+        // The boundary only has to be absent from the parts; mixing in the address and the time keeps it from being predictable by the content's author.
+        uint64_t state = (uint64_t)(uintptr_t)response ^ (uint64_t)time(NULL) ^ size;
+        state += 0x9E3779B97F4A7C15u;
+        state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9u;
+        state = (state ^ (state >> 27)) * 0x94D049BB133111EBu;
+        state ^= state >> 31;
+
+        snprintf(boundary, sizeof(boundary), "hypertext_%016llx", (unsigned long long)state);
+    }
+
+    // Every piece of text goes into one buffer, which has to stay put as long as the fields point into it.
+    hypertext_utilities_buffer text = { NULL, 0, 0 };
+    size_t* offsets = calloc(count * 2 + 2, sizeof(size_t));
+    if (offsets == NULL) return hypertext_Result_Out_Of_Memory;
+
+    char line[160];
+    bool success = true;
+
+    if (count == 0) snprintf(line, sizeof(line), "bytes */%llu", (unsigned long long)size);
+    else if (!multipart) snprintf(line, sizeof(line), "bytes %llu-%llu/%llu", (unsigned long long)ranges[0].first, (unsigned long long)ranges[0].last, (unsigned long long)size);
+    else snprintf(line, sizeof(line), "multipart/byteranges; boundary=%s", boundary);
+
+    success = hypertext_utilities_append(&text, line, strlen(line) + 1);
+
+    for (size_t i = 0; multipart && success && i != count; i++)
+    {
+        offsets[i * 2] = text.length;
+
+        snprintf(line, sizeof(line), "%s--%s\r\n", i == 0 ? "" : "\r\n", boundary);
+        success = hypertext_utilities_append(&text, line, strlen(line));
+
+        if (success && type != NULL) success = hypertext_utilities_append(&text, "Content-Type: ", 14) && hypertext_utilities_append(&text, type, strlen(type)) && hypertext_utilities_append(&text, "\r\n", 2);
+
+        snprintf(line, sizeof(line), "Content-Range: bytes %llu-%llu/%llu\r\n\r\n", (unsigned long long)ranges[i].first, (unsigned long long)ranges[i].last, (unsigned long long)size);
+        if (success) success = hypertext_utilities_append(&text, line, strlen(line));
+
+        offsets[i * 2 + 1] = text.length;
+    }
+
+    if (multipart && success)
+    {
+        offsets[count * 2] = text.length;
+
+        snprintf(line, sizeof(line), "\r\n--%s--\r\n", boundary);
+        success = hypertext_utilities_append(&text, line, strlen(line));
+
+        offsets[count * 2 + 1] = text.length;
+    }
+
+    size_t segment_count = multipart ? count * 2 + 1 : count;
+    hypertext_Segment* segments = success && segment_count != 0 ? calloc(segment_count, sizeof(hypertext_Segment)) : NULL;
+    hypertext_utilities_field* fields = success ? calloc(response->field_count + 2, sizeof(hypertext_utilities_field)) : NULL;
+
+    if (!success || fields == NULL || (segment_count != 0 && segments == NULL))
+    {
+        hypertext_utilities_release(&text);
+        free(offsets);
+        free(segments);
+        free(fields);
+
+        return hypertext_Result_Out_Of_Memory;
+    }
+
+    size_t field_count = 0;
+    for (size_t i = 0; i != response->field_count; i++)
+    {
+        const hypertext_utilities_field* field = &response->fields[i];
+
+        if (hypertext_utilities_is_field(field, hypertext_utilities_known_Content_Range) || hypertext_utilities_is_field(field, hypertext_utilities_known_Content_Length)) continue;
+        else if (multipart && hypertext_utilities_is_field(field, hypertext_utilities_known_Content_Type)) continue;
+
+        fields[field_count++] = response->fields[i];
+    }
+
+    fields[field_count++] = hypertext_utilities_make_field(multipart ? "Content-Type" : "Content-Range", text.data);
+
+    // The parts point into the original body, whichever kind it is; nothing is copied.
+    size_t length = 0;
+    for (size_t i = 0; i != count; i++)
+    {
+        hypertext_Segment* header = multipart ? &segments[i * 2] : NULL;
+        hypertext_Segment* part = multipart ? &segments[i * 2 + 1] : &segments[i];
+
+        if (header != NULL)
+        {
+            header->data        = text.data + offsets[i * 2];
+            header->descriptor  = -1;
+            header->length      = offsets[i * 2 + 1] - offsets[i * 2];
+            length             += header->length;
+        }
+
+        part->data          = response->file_body ? NULL : response->body + ranges[i].first;
+        part->descriptor    = response->file_body ? response->file_descriptor : -1;
+        part->offset        = response->file_body ? response->file_offset + ranges[i].first : 0;
+        part->length        = (size_t)(ranges[i].last - ranges[i].first + 1);
+        length             += part->length;
+    }
+
+    if (multipart)
+    {
+        hypertext_Segment* closing = &segments[count * 2];
+
+        closing->data       = text.data + offsets[count * 2];
+        closing->descriptor = -1;
+        closing->length     = offsets[count * 2 + 1] - offsets[count * 2];
+        length             += closing->length;
+    }
+
+    free(offsets);
+    free(response->fields);
+
+    response->fields            = fields;
+    response->field_count       = field_count;
+    response->field_capacity    = field_count;
+    response->segment_text  = text.data;
+    response->segments      = segments;
+    response->segment_count = segment_count;
+    response->body_length   = length;
+
+    if (count == 0)
+    {
+        // An unsatisfiable request gets no part of the representation at all.
+        free(response->body);
+
+        response->body      = NULL;
+        response->file_body = false;
+        response->code      = hypertext_Status_Requested_Range_Not_Satisfiable;
+    }
+    else response->code = hypertext_Status_Partial_Content;
+
+    hypertext_utilities_reset_parameters(response, hypertext_Parameter_Source_Body);
+
+    return hypertext_Result_Success;
+}
@@ -0,0 +1,477 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum hypertext_utilities_route_kind
+{
+    hypertext_utilities_route_kind_static,
+    hypertext_utilities_route_kind_parameter,
+    hypertext_utilities_route_kind_wildcard
+};
+
+typedef struct
+{
+    uint8_t method;
+    void*   data;
+} hypertext_utilities_route_handler;
+
+// A node of the radix tree while routes are being added.
+typedef struct hypertext_utilities_route_draft
+{
+    uint8_t                                     kind;
+    char*                                       text;
+    size_t                                      text_length;
+    struct hypertext_utilities_route_draft**    children;
+    size_t                                      child_count;
+    struct hypertext_utilities_route_draft*     parameter;
+    struct hypertext_utilities_route_draft*     wildcard;
+    hypertext_utilities_route_handler*          handlers;
+    size_t                                      handler_count;
+} hypertext_utilities_route_draft;
+
+// A node of the compiled tree. Static children are stored next to each other; all text lives in one pool.
+typedef struct
+{
+    uint8_t     kind;
+    char        first;
+    uint32_t    text;
+    uint32_t    text_length;
+    uint32_t    children;
+    uint32_t    child_count;
+    uint32_t    parameter;
+    uint32_t    wildcard;
+    uint32_t    handlers;
+    uint32_t    handler_count;
+} hypertext_utilities_route_node;
+
+struct hypertext_Router
+{
+    hypertext_utilities_route_draft*    root;
+    bool                                compiled;
+    hypertext_utilities_route_node*     nodes;
+    size_t                              node_count;
+    hypertext_utilities_route_handler*  handlers;
+    size_t                              handler_count;
+    char*                               pool;
+    size_t                              pool_length;
+};
+
+#define hypertext_utilities_no_node UINT32_MAX
+
+static hypertext_utilities_route_draft* hypertext_utilities_new_draft(uint8_t kind, const char* text, size_t length)
+{
+    hypertext_utilities_route_draft* draft = calloc(1, sizeof(hypertext_utilities_route_draft));
+    if (draft == NULL) return NULL;
+
+    draft->kind         = kind;
+    draft->text         = calloc(length + 1, sizeof(char));
+    draft->text_length  = length;
+
+    if (draft->text == NULL)
+    {
+        free(draft);
+        return NULL;
+    }
+
+    memcpy(draft->text, text, length);
+
+    return draft;
+}
+
+static void hypertext_utilities_free_draft(hypertext_utilities_route_draft* draft)
+{
+    if (draft == NULL) return;
+
+    for (size_t i = 0; i != draft->child_count; i++) hypertext_utilities_free_draft(draft->children[i]);
+
+    hypertext_utilities_free_draft(draft->parameter);
+    hypertext_utilities_free_draft(draft->wildcard);
+
+    free(draft->children);
+    free(draft->handlers);
+    free(draft->text);
+    free(draft);
+}
+
+static void hypertext_utilities_free_compiled(hypertext_Router* router)
+{
+    free(router->nodes);
+    free(router->handlers);
+    free(router->pool);
+
+    router->nodes           = NULL;
+    router->node_count      = 0;
+    router->handlers        = NULL;
+    router->handler_count   = 0;
+    router->pool            = NULL;
+    router->pool_length     = 0;
+    router->compiled        = false;
+}
+
+// Descends along a static piece of a pattern, splitting nodes on their common prefix.
+static hypertext_utilities_route_draft* hypertext_utilities_insert_static(hypertext_utilities_route_draft* node, const char* text, size_t length)
+{
+    while (length != 0)
+    {
+        hypertext_utilities_route_draft* child = NULL;
+        size_t position = 0;
+
+        for (; position != node->child_count; position++) if (node->children[position]->text[0] == text[0])
+        {
+            child = node->children[position];
+            break;
+        }
+
+        if (child == NULL)
+        {
+            child = hypertext_utilities_new_draft(hypertext_utilities_route_kind_static, text, length);
+            if (child == NULL) return NULL;
+
+            hypertext_utilities_route_draft** children = realloc(node->children, sizeof(hypertext_utilities_route_draft*) * (node->child_count + 1));
+            if (children == NULL)
+            {
+                hypertext_utilities_free_draft(child);
+                return NULL;
+            }
+
+            // Children are kept sorted by their first character.
+            position = 0;
+            while (position != node->child_count && (uint8_t)children[position]->text[0] < (uint8_t)text[0]) position++;
+
+            memmove(&children[position + 1], &children[position], sizeof(hypertext_utilities_route_draft*) * (node->child_count - position));
+            children[position] = child;
+
+            node->children = children;
+            node->child_count++;
+
+            return child;
+        }
+
+        size_t common = 0;
+        while (common != length && common != child->text_length && child->text[common] == text[common]) common++;
+
+        if (common != child->text_length)
+        {
+            hypertext_utilities_route_draft* tail = hypertext_utilities_new_draft(hypertext_utilities_route_kind_static, child->text + common, child->text_length - common);
+            hypertext_utilities_route_draft** tail_children = calloc(1, sizeof(hypertext_utilities_route_draft*));
+
+            if (tail == NULL || tail_children == NULL)
+            {
+                hypertext_utilities_free_draft(tail);
+                free(tail_children);
+                return NULL;
+            }
+
+            tail->children      = child->children;
+            tail->child_count   = child->child_count;
+            tail->parameter     = child->parameter;
+            tail->wildcard      = child->wildcard;
+            tail->handlers      = child->handlers;
+            tail->handler_count = child->handler_count;
+
+            tail_children[0]        = tail;
+            child->children         = tail_children;
+            child->child_count      = 1;
+            child->parameter        = NULL;
+            child->wildcard         = NULL;
+            child->handlers         = NULL;
+            child->handler_count    = 0;
+            child->text_length      = common;
+            child->text[common]     = 0;
+        }
+
+        node    = child;
+        text    += common;
+        length  -= common;
+    }
+
+    return node;
+}
+
+static hypertext_utilities_route_draft* hypertext_utilities_insert_capture(hypertext_utilities_route_draft** slot, uint8_t kind, const char* name, size_t length)
+{
+    if (*slot == NULL) *slot = hypertext_utilities_new_draft(kind, name, length);
+    else if ((*slot)->text_length != length || memcmp((*slot)->text, name, length) != 0) return NULL;
+
+    return *slot;
+}
+
+hypertext_Router* hypertext_New_Router()
+{
+    return calloc(1, sizeof(hypertext_Router));
+}
+
+void hypertext_Destroy_Router(hypertext_Router* router)
+{
+    if (router == NULL) return;
+
+    hypertext_utilities_free_compiled(router);
+    hypertext_utilities_free_draft(router->root);
+
+    router->root = NULL;
+}
+
+uint8_t hypertext_Add_Route(hypertext_Router* router, uint8_t method, const char* pattern, size_t length, void* data)
+{
+    if (router == NULL) return hypertext_Result_Invalid_Instance;
+    else if (pattern == NULL || length == 0 || pattern[0] != '/' || (method != hypertext_Method_Unknown && !hypertext_utilities_is_valid_method(method))) return hypertext_Result_Invalid_Parameters;
+
+    if (router->root == NULL) router->root = hypertext_utilities_new_draft(hypertext_utilities_route_kind_static, "", 0);
+    if (router->root == NULL) return hypertext_Result_Out_Of_Memory;
+
+    hypertext_utilities_route_draft* node = router->root;
+    size_t captures = 0;
+
+    for (size_t position = 0; position != length;)
+    {
+        if (node == NULL) return hypertext_Result_Out_Of_Memory;
+
+        // Captures always start a segment.
+        if ((pattern[position] == ':' || pattern[position] == '*') && pattern[position - 1] == '/')
+        {
+            bool wildcard   = pattern[position] == '*';
+            size_t end      = position + 1;
+            while (end != length && pattern[end] != '/') end++;
+
+            if (++captures > hypertext_Route_Max_Captures || (wildcard && end != length) || (!wildcard && end == position + 1)) return hypertext_Result_Invalid_Parameters;
+
+            hypertext_utilities_route_draft** slot = wildcard ? &node->wildcard : &node->parameter;
+            bool existed = *slot != NULL;
+
+            node = hypertext_utilities_insert_capture(slot, wildcard ? hypertext_utilities_route_kind_wildcard : hypertext_utilities_route_kind_parameter, pattern + position + 1, end - position - 1);
+            if (node == NULL) return existed ? hypertext_Result_Invalid_Parameters : hypertext_Result_Out_Of_Memory;
+
+            position = end;
+            continue;
+        }
+
+        size_t end = position;
+        while (end != length && !((pattern[end] == ':' || pattern[end] == '*') && pattern[end - 1] == '/')) end++;
+
+        node        = hypertext_utilities_insert_static(node, pattern + position, end - position);
+        position    = end;
+    }
+
+    if (node == NULL) return hypertext_Result_Out_Of_Memory;
+
+    for (size_t i = 0; i != node->handler_count; i++) if (node->handlers[i].method == method) return hypertext_Result_Already_Present;
+
+    hypertext_utilities_route_handler* handlers = realloc(node->handlers, sizeof(hypertext_utilities_route_handler) * (node->handler_count + 1));
+    if (handlers == NULL) return hypertext_Result_Out_Of_Memory;
+
+    handlers[node->handler_count].method    = method;
+    handlers[node->handler_count].data      = data;
+
+    node->handlers = handlers;
+    node->handler_count++;
+
+    hypertext_utilities_free_compiled(router);
+
+    return hypertext_Result_Success;
+}
+
+static void hypertext_utilities_measure_draft(hypertext_utilities_route_draft* draft, size_t* nodes, size_t* handlers, size_t* pool)
+{
+    if (draft == NULL) return;
+
+    *nodes      += 1;
+    *handlers   += draft->handler_count;
+    *pool       += draft->text_length;
+
+    for (size_t i = 0; i != draft->child_count; i++) hypertext_utilities_measure_draft(draft->children[i], nodes, handlers, pool);
+
+    hypertext_utilities_measure_draft(draft->parameter, nodes, handlers, pool);
+    hypertext_utilities_measure_draft(draft->wildcard, nodes, handlers, pool);
+}
+
+// Fills the node at "index"; its children are reserved as one block so they can be scanned sequentially.
+static void hypertext_utilities_flatten_draft(hypertext_Router* router, hypertext_utilities_route_draft* draft, uint32_t index)
+{
+    hypertext_utilities_route_node* node = &router->nodes[index];
+
+    node->kind          = draft->kind;
+    node->first         = draft->text_length != 0 ? draft->text[0] : 0;
+    node->text          = (uint32_t)router->pool_length;
+    node->text_length   = (uint32_t)draft->text_length;
+    node->handlers      = (uint32_t)router->handler_count;
+    node->handler_count = (uint32_t)draft->handler_count;
+    node->children      = (uint32_t)router->node_count;
+    node->child_count   = (uint32_t)draft->child_count;
+    node->parameter     = hypertext_utilities_no_node;
+    node->wildcard      = hypertext_utilities_no_node;
+
+    memcpy(router->pool + router->pool_length, draft->text, draft->text_length);
+    router->pool_length += draft->text_length;
+
+    if (draft->handler_count != 0) memcpy(router->handlers + router->handler_count, draft->handlers, sizeof(hypertext_utilities_route_handler) * draft->handler_count);
+    router->handler_count += draft->handler_count;
+
+    router->node_count += draft->child_count;
+    if (draft->parameter != NULL) node->parameter = (uint32_t)router->node_count++;
+    if (draft->wildcard != NULL) node->wildcard = (uint32_t)router->node_count++;
+
+    uint32_t children = node->children, parameter = node->parameter, wildcard = node->wildcard;
+
+    for (size_t i = 0; i != draft->child_count; i++) hypertext_utilities_flatten_draft(router, draft->children[i], children + (uint32_t)i);
+
+    if (draft->parameter != NULL) hypertext_utilities_flatten_draft(router, draft->parameter, parameter);
+    if (draft->wildcard != NULL) hypertext_utilities_flatten_draft(router, draft->wildcard, wildcard);
+}
+
+uint8_t hypertext_Compile_Router(hypertext_Router* router)
+{
+    if (router == NULL) return hypertext_Result_Invalid_Instance;
+
+    hypertext_utilities_free_compiled(router);
+
+    if (router->root == NULL)
+    {
+        router->compiled = true;
+        return hypertext_Result_Success;
+    }
+
+    size_t nodes = 0, handlers = 0, pool = 0;
+    hypertext_utilities_measure_draft(router->root, &nodes, &handlers, &pool);
+
+    if (nodes >= hypertext_utilities_no_node || pool > UINT32_MAX) return hypertext_Result_Out_Of_Memory;
+
+    router->nodes       = calloc(nodes, sizeof(hypertext_utilities_route_node));
+    router->handlers    = calloc(handlers + 1, sizeof(hypertext_utilities_route_handler));
+    router->pool        = calloc(pool + 1, sizeof(char));
+
+    if (router->nodes == NULL || router->handlers == NULL || router->pool == NULL)
+    {
+        hypertext_utilities_free_compiled(router);
+        return hypertext_Result_Out_Of_Memory;
+    }
+
+    router->node_count = 1;
+    hypertext_utilities_flatten_draft(router, router->root, 0);
+
+    router->compiled = true;
+
+    return hypertext_Result_Success;
+}
+
+static bool hypertext_utilities_match_node(const hypertext_Router* router, uint32_t index, uint8_t method, const char* path, size_t length, size_t position, hypertext_Route_Match* output, bool* method_mismatch)
+{
+    const hypertext_utilities_route_node* node = &router->nodes[index];
+    size_t capture_count = output->capture_count;
+
+    switch (node->kind)
+    {
+    case hypertext_utilities_route_kind_static:
+        if (length - position < node->text_length || memcmp(path + position, router->pool + node->text, node->text_length) != 0) return false;
+
+        position += node->text_length;
+        break;
+
+    case hypertext_utilities_route_kind_parameter:
+    {
+        const char* end = memchr(path + position, '/', length - position);
+        size_t value_length = end != NULL ? (size_t)(end - path) - position : length - position;
+        if (value_length == 0) return false;
+
+        hypertext_Parameter* capture = &output->captures[output->capture_count++];
+        capture->name.data      = router->pool + node->text;
+        capture->name.length    = node->text_length;
+        capture->value.data     = path + position;
+        capture->value.length   = value_length;
+
+        position += value_length;
+        break;
+    }
+
+    case hypertext_utilities_route_kind_wildcard:
+    {
+        hypertext_Parameter* capture = &output->captures[output->capture_count++];
+        capture->name.data      = router->pool + node->text;
+        capture->name.length    = node->text_length;
+        capture->value.data     = path + position;
+        capture->value.length   = length - position;
+
+        position = length;
+        break;
+    }
+    }
+
+    if (position == length && node->handler_count != 0)
+    {
+        const hypertext_utilities_route_handler* handlers = &router->handlers[node->handlers];
+        const hypertext_utilities_route_handler* fallback = NULL;
+
+        for (uint32_t i = 0; i != node->handler_count; i++)
+        {
+            if (handlers[i].method == method)
+            {
+                output->data = handlers[i].data;
+                return true;
+            }
+            else if (handlers[i].method == hypertext_Method_Unknown) fallback = &handlers[i];
+        }
+
+        if (fallback != NULL)
+        {
+            output->data = fallback->data;
+            return true;
+        }
+
+        *method_mismatch = true;
+    }
+
+    if (position != length) for (uint32_t i = 0; i != node->child_count; i++) if (router->nodes[node->children + i].first == path[position])
+    {
+        if (hypertext_utilities_match_node(router, node->children + i, method, path, length, position, output, method_mismatch)) return true;
+        break;
+    }
+
+    if (node->parameter != hypertext_utilities_no_node && position != length && hypertext_utilities_match_node(router, node->parameter, method, path, length, position, output, method_mismatch)) return true;
+    if (node->wildcard != hypertext_utilities_no_node && hypertext_utilities_match_node(router, node->wildcard, method, path, length, position, output, method_mismatch)) return true;
+
+    output->capture_count = capture_count;
+
+    return false;
+}
+
+uint8_t hypertext_Match_Route(hypertext_Router* router, hypertext_Instance* instance, hypertext_Route_Match* output)
+{
+    if (router == NULL || !router->compiled) return hypertext_Result_Invalid_Instance;
+    else if (instance == NULL || instance->type != hypertext_Instance_Content_Type_Request) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_View path;
+    if (router->node_count == 0 || hypertext_Fetch_Target_Component(instance, hypertext_Target_Component_Path, &path) != hypertext_Result_Success) return hypertext_Result_Not_Found;
+
+    output->data            = NULL;
+    output->capture_count   = 0;
+
+    bool method_mismatch = false;
+    if (hypertext_utilities_match_node(router, 0, instance->method, path.data, path.length, 0, output, &method_mismatch)) return hypertext_Result_Success;
+
+    return method_mismatch ? hypertext_Result_Invalid_Method : hypertext_Result_Not_Found;
+}
@@ -0,0 +1,196 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+#endif
+
+#define hypertext_utilities_send_vectors 16
+
+const hypertext_Segment* hypertext_utilities_body_segments(hypertext_Instance* instance, hypertext_Segment* single, size_t* count)
+{
+    if (instance->segments != NULL)
+    {
+        *count = instance->segment_count;
+        return instance->segments;
+    }
+
+    single->data        = instance->file_body ? NULL : instance->body;
+    single->descriptor  = instance->file_body ? instance->file_descriptor : -1;
+    single->offset      = instance->file_body ? instance->file_offset : 0;
+    single->length      = instance->body_length;
+
+    *count = instance->body_length != 0 ? 1 : 0;
+    return single;
+}
+
+void hypertext_utilities_reset_segments(hypertext_Instance* instance)
+{
+    // The text stays, as the fields set along with the segments may still point into it.
+    free(instance->segments);
+
+    instance->segments      = NULL;
+    instance->segment_count = 0;
+}
+
+bool hypertext_utilities_read_body(hypertext_Instance* instance, size_t offset, char* output, size_t length)
+{
+    hypertext_Segment single;
+    size_t count;
+    const hypertext_Segment* segments = hypertext_utilities_body_segments(instance, &single, &count);
+
+    for (size_t i = 0; i != count && length != 0; i++)
+    {
+        if (offset >= segments[i].length)
+        {
+            offset -= segments[i].length;
+            continue;
+        }
+
+        size_t piece = segments[i].length - offset;
+        if (piece > length) piece = length;
+
+        if (segments[i].data != NULL) memcpy(output, segments[i].data + offset, piece);
+        else
+        {
+#if defined(_WIN32)
+            return false;
+#else
+            for (size_t done = 0; done != piece;)
+            {
+                ssize_t result = pread(segments[i].descriptor, output + done, piece - done, (off_t)(segments[i].offset + offset + done));
+
+                if (result < 0 && errno == EINTR) continue;
+                else if (result <= 0) return false;
+
+                done += (size_t)result;
+            }
+#endif
+        }
+
+        output += piece;
+        length -= piece;
+        offset  = 0;
+    }
+
+    return length == 0;
+}
+
+uint8_t hypertext_Fetch_Segments(hypertext_Instance* instance, hypertext_Segment* output, size_t* count)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (count == NULL) return hypertext_Result_Invalid_Parameters;
+
+    hypertext_Segment single;
+    size_t available;
+    const hypertext_Segment* segments = hypertext_utilities_body_segments(instance, &single, &available);
+
+    if (available == 0) return hypertext_Result_No_Body;
+    else if (output == NULL)
+    {
+        *count = available;
+        return hypertext_Result_Success;
+    }
+
+    if (*count > available) *count = available;
+    memcpy(output, segments, *count * sizeof(hypertext_Segment));
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Send_Body(hypertext_Instance* instance, int descriptor, size_t* offset)
+{
+    if (!hypertext_utilities_is_valid_instance(instance)) return hypertext_Result_Invalid_Instance;
+    else if (offset == NULL || *offset > instance->body_length) return hypertext_Result_Invalid_Parameters;
+
+#if defined(_WIN32)
+    (void)descriptor;
+    return hypertext_Result_Unsupported;
+#else
+    hypertext_Segment single;
+    size_t count;
+    const hypertext_Segment* segments = hypertext_utilities_body_segments(instance, &single, &count);
+
+    size_t index = 0;
+    size_t start = 0;
+
+    while (*offset != instance->body_length)
+    {
+        while (start + segments[index].length <= *offset) start += segments[index++].length;
+
+        const hypertext_Segment* segment = &segments[index];
+        size_t skip = *offset - start;
+        ssize_t result;
+
+        if (segment->data != NULL)
+        {
+            // Neighbouring memory pieces, like the part headers of a multipart body, go out in one call.
+            struct iovec vectors[hypertext_utilities_send_vectors];
+            int vector_count = 0;
+
+            vectors[vector_count++] = (struct iovec){ (void*)(segment->data + skip), segment->length - skip };
+            for (size_t i = index + 1; i != count && vector_count != hypertext_utilities_send_vectors && segments[i].data != NULL; i++) vectors[vector_count++] = (struct iovec){ (void*)segments[i].data, segments[i].length };
+
+            result = writev(descriptor, vectors, vector_count);
+        }
+        else
+        {
+#if defined(__linux__)
+            // The kernel copies from the page cache straight into the socket.
+            off_t position = (off_t)(segment->offset + skip);
+            result = sendfile(descriptor, segment->descriptor, &position, segment->length - skip);
+#else
+            char buffer[65536];
+            size_t remaining = segment->length - skip;
+            if (remaining > sizeof(buffer)) remaining = sizeof(buffer);
+
+            result = pread(segment->descriptor, buffer, remaining, (off_t)(segment->offset + skip));
+            if (result > 0) result = write(descriptor, buffer, (size_t)result);
+#endif
+        }
+
+        if (result < 0 && errno == EINTR) continue;
+        else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return hypertext_Result_Incomplete;
+        else if (result <= 0) return hypertext_Result_IO_Error;
+
+        *offset += (size_t)result;
+    }
+
+    return hypertext_Result_Success;
+#endif
+}
@@ -0,0 +1,1062 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define hypertext_utilities_session_preface         "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+#define hypertext_utilities_session_preface_length  24
+#define hypertext_utilities_session_frame_header    9
+#define hypertext_utilities_session_frame_size      16384
+#define hypertext_utilities_session_window          65535
+#define hypertext_utilities_session_max_window      0x7FFFFFFF
+#define hypertext_utilities_session_table_size      4096
+#define hypertext_utilities_session_max_streams     100
+#define hypertext_utilities_session_max_block       65536
+
+// Frame types as per RFC 9113, section 6.
+enum hypertext_utilities_frame
+{
+    hypertext_utilities_frame_data,
+    hypertext_utilities_frame_headers,
+    hypertext_utilities_frame_priority,
+    hypertext_utilities_frame_reset,
+    hypertext_utilities_frame_settings,
+    hypertext_utilities_frame_push_promise,
+    hypertext_utilities_frame_ping,
+    hypertext_utilities_frame_goaway,
+    hypertext_utilities_frame_window_update,
+    hypertext_utilities_frame_continuation
+};
+
+enum hypertext_utilities_frame_flag
+{
+    hypertext_utilities_frame_flag_end_stream   = 0x01,
+    hypertext_utilities_frame_flag_ack          = 0x01,
+    hypertext_utilities_frame_flag_end_headers  = 0x04,
+    hypertext_utilities_frame_flag_padded       = 0x08,
+    hypertext_utilities_frame_flag_priority     = 0x20
+};
+
+enum hypertext_utilities_setting
+{
+    hypertext_utilities_setting_header_table_size = 1,
+    hypertext_utilities_setting_enable_push,
+    hypertext_utilities_setting_max_concurrent_streams,
+    hypertext_utilities_setting_initial_window_size,
+    hypertext_utilities_setting_max_frame_size,
+    hypertext_utilities_setting_max_header_list_size
+};
+
+enum hypertext_utilities_stream_state
+{
+    hypertext_utilities_stream_receiving,   // The request's header block or body is still arriving.
+    hypertext_utilities_stream_received,    // The request is complete and waits for a response.
+    hypertext_utilities_stream_sending,     // The response's header block was sent, its body waits for flow control.
+    hypertext_utilities_stream_reset        // Reset by the peer after the request was handed out; kept until a response is submitted.
+};
+
+typedef struct
+{
+    uint32_t                    id;
+    uint8_t                     state;
+    bool                        delivered;
+    hypertext_Instance*         request;
+    char*                       strings[3];
+    hypertext_utilities_buffer  body;
+    int64_t                     window;
+    int64_t                     receive_window;
+    size_t                      unconsumed;
+    hypertext_utilities_buffer  pending;
+    size_t                      sent;
+} hypertext_utilities_stream;
+
+struct hypertext_Session
+{
+    bool                            announced;
+    bool                            preface;
+    bool                            settings;
+    bool                            closing;
+    bool                            closed;
+    bool                            failed;
+    bool                            drained;
+    bool                            acknowledged;
+    hypertext_utilities_buffer      input;
+    hypertext_utilities_buffer      output;
+    hypertext_HPACK*                encoder;
+    hypertext_HPACK*                decoder;
+    hypertext_utilities_buffer      block;
+    uint32_t                        block_stream;
+    bool                            block_end;
+    uint32_t                        last_stream;
+    int64_t                         send_window;
+    uint32_t                        initial_window;
+    uint32_t                        max_frame_size;
+    int64_t                         receive_window;
+    uint32_t                        stream_window;
+    size_t                          limit;
+    size_t                          table_size;
+    hypertext_utilities_stream*     streams;
+    size_t                          stream_count;
+    size_t                          stream_capacity;
+};
+
+static inline uint32_t hypertext_utilities_read_32(const uint8_t* input)
+{
+    return (uint32_t)input[0] << 24 | (uint32_t)input[1] << 16 | (uint32_t)input[2] << 8 | input[3];
+}
+
+static inline void hypertext_utilities_write_32(uint8_t* output, uint32_t value)
+{
+    output[0] = (uint8_t)(value >> 24);
+    output[1] = (uint8_t)(value >> 16);
+    output[2] = (uint8_t)(value >> 8);
+    output[3] = (uint8_t)value;
+}
+
+static void hypertext_utilities_session_defaults(hypertext_Session* session)
+{
+    session->send_window    = hypertext_utilities_session_window;
+    session->initial_window = hypertext_utilities_session_window;
+    session->max_frame_size = hypertext_utilities_session_frame_size;
+    session->receive_window = hypertext_utilities_session_window;
+    session->stream_window  = session->limit < hypertext_utilities_session_max_window ? (uint32_t)session->limit : hypertext_utilities_session_max_window;
+    session->table_size     = hypertext_utilities_session_table_size;
+}
+
+static bool hypertext_utilities_session_frame(hypertext_Session* session, uint8_t type, uint8_t flags, uint32_t stream, const void* payload, size_t length)
+{
+    hypertext_utilities_buffer* output = &session->output;
+
+    // Whatever was handed out by hypertext_Drain_Session is gone by now.
+    if (session->drained)
+    {
+        output->length      = 0;
+        session->drained    = false;
+    }
+
+    if (!hypertext_utilities_reserve(output, hypertext_utilities_session_frame_header + length)) return false;
+
+    uint8_t* header = (uint8_t*)output->data + output->length;
+    header[0] = (uint8_t)(length >> 16);
+    header[1] = (uint8_t)(length >> 8);
+    header[2] = (uint8_t)length;
+    header[3] = type;
+    header[4] = flags;
+    hypertext_utilities_write_32(header + 5, stream & hypertext_utilities_session_max_window);
+
+    output->length += hypertext_utilities_session_frame_header;
+
+    return hypertext_utilities_append(output, payload, length);
+}
+
+static bool hypertext_utilities_session_integer_frame(hypertext_Session* session, uint8_t type, uint32_t stream, uint32_t value)
+{
+    uint8_t payload[4];
+    hypertext_utilities_write_32(payload, value);
+
+    return hypertext_utilities_session_frame(session, type, 0, stream, payload, sizeof(payload));
+}
+
+// Sends a GOAWAY frame and refuses to process any further input; used for connection errors.
+static uint8_t hypertext_utilities_session_fail(hypertext_Session* session, uint32_t error)
+{
+    if (!session->closed)
+    {
+        uint8_t payload[8];
+        hypertext_utilities_write_32(payload, session->last_stream);
+        hypertext_utilities_write_32(payload + 4, error);
+
+        hypertext_utilities_session_frame(session, hypertext_utilities_frame_goaway, 0, 0, payload, sizeof(payload));
+    }
+
+    session->closing    = true;
+    session->closed     = true;
+    session->failed     = true;
+
+    return hypertext_Result_Invalid_Parameters;
+}
+
+// Creates the compression contexts and queues the server's SETTINGS frame, which is its connection preface.
+static uint8_t hypertext_utilities_session_prepare(hypertext_Session* session)
+{
+    if (session->encoder == NULL) session->encoder = hypertext_New_HPACK(hypertext_utilities_session_table_size);
+    if (session->decoder == NULL) session->decoder = hypertext_New_HPACK(hypertext_utilities_session_table_size);
+
+    if (session->encoder == NULL || session->decoder == NULL) return hypertext_Result_Out_Of_Memory;
+    else if (session->announced) return hypertext_Result_Success;
+
+    // Each stream's window is its body limit, so the peer can't send more than a request may hold.
+    uint8_t payload[12] = { 0, hypertext_utilities_setting_max_concurrent_streams, 0, 0, 0, 0, 0, hypertext_utilities_setting_initial_window_size };
+    hypertext_utilities_write_32(payload + 2, hypertext_utilities_session_max_streams);
+    hypertext_utilities_write_32(payload + 8, session->stream_window);
+
+    if (!hypertext_utilities_session_frame(session, hypertext_utilities_frame_settings, 0, 0, payload, sizeof(payload))) return hypertext_Result_Out_Of_Memory;
+
+    // The connection's window has to cover all streams at once; otherwise bodies that aren't complete yet could wait on each other forever.
+    int64_t window = (int64_t)session->stream_window * hypertext_utilities_session_max_streams;
+    if (window > hypertext_utilities_session_max_window) window = hypertext_utilities_session_max_window;
+
+    if (window > session->receive_window && !hypertext_utilities_session_integer_frame(session, hypertext_utilities_frame_window_update, 0, (uint32_t)(window - session->receive_window))) return hypertext_Result_Out_Of_Memory;
+    else if (window > session->receive_window) session->receive_window = window;
+
+    session->announced = true;
+
+    return hypertext_Result_Success;
+}
+
+static size_t hypertext_utilities_session_find(hypertext_Session* session, uint32_t id)
+{
+    for (size_t i = 0; i != session->stream_count; i++) if (session->streams[i].id == id) return i;
+
+    return SIZE_MAX;
+}
+
+static void hypertext_utilities_session_release(hypertext_utilities_stream* stream)
+{
+    if (stream->request != NULL)
+    {
+        hypertext_Destroy(stream->request);
+        free(stream->request);
+    }
+
+    for (uint8_t i = 0; i != 3; i++) free(stream->strings[i]);
+
+    hypertext_utilities_release(&stream->body);
+    hypertext_utilities_release(&stream->pending);
+
+    memset(stream, 0, sizeof(hypertext_utilities_stream));
+}
+
+static void hypertext_utilities_session_remove(hypertext_Session* session, size_t index)
+{
+    hypertext_utilities_session_release(&session->streams[index]);
+
+    memmove(&session->streams[index], &session->streams[index + 1], sizeof(hypertext_utilities_stream) * (session->stream_count - index - 1));
+    session->stream_count--;
+}
+
+// Gives flow-control credit back to the peer; for the connection if stream is NULL.
+static bool hypertext_utilities_session_credit(hypertext_Session* session, hypertext_utilities_stream* stream, size_t amount)
+{
+    if (amount == 0) return true;
+    else if (!hypertext_utilities_session_integer_frame(session, hypertext_utilities_frame_window_update, stream != NULL ? stream->id : 0, (uint32_t)amount)) return false;
+
+    if (stream != NULL) stream->receive_window += (int64_t)amount;
+    else session->receive_window += (int64_t)amount;
+
+    return true;
+}
+
+// A request that was already handed out stays valid until its response is submitted.
+static void hypertext_utilities_session_close(hypertext_Session* session, size_t index)
+{
+    // Nobody reads what the stream still buffers, so the connection gets its credit back.
+    if (hypertext_utilities_session_credit(session, NULL, session->streams[index].unconsumed)) session->streams[index].unconsumed = 0;
+
+    if (session->streams[index].delivered && session->streams[index].state == hypertext_utilities_stream_received) session->streams[index].state = hypertext_utilities_stream_reset;
+    else hypertext_utilities_session_remove(session, index);
+}
+
+// Closes the stream and tells the peer about it; used for stream errors.
+static void hypertext_utilities_session_reset(hypertext_Session* session, uint32_t id, uint32_t error)
+{
+    size_t index = hypertext_utilities_session_find(session, id);
+    if (index != SIZE_MAX) hypertext_utilities_session_close(session, index);
+
+    hypertext_utilities_session_integer_frame(session, hypertext_utilities_frame_reset, id, error);
+}
+
+static size_t hypertext_utilities_session_active(hypertext_Session* session)
+{
+    size_t count = 0;
+    for (size_t i = 0; i != session->stream_count; i++) if (session->streams[i].state != hypertext_utilities_stream_reset) count++;
+
+    return count;
+}
+
+// Field names have to be lower case tokens; connection-specific fields don't exist in HTTP/2.
+static bool hypertext_utilities_session_is_valid_field(const hypertext_Header_Field* field)
+{
+    size_t length = strlen(field->key);
+    if (length == 0) return false;
+
+    for (size_t i = 0; i != length; i++) if (!hypertext_utilities_is_token_character(field->key[i]) || (field->key[i] >= 'A' && field->key[i] <= 'Z')) return false;
+
+    if (strcmp(field->key, "connection") == 0 || strcmp(field->key, "keep-alive") == 0 || strcmp(field->key, "proxy-connection") == 0 || strcmp(field->key, "transfer-encoding") == 0 || strcmp(field->key, "upgrade") == 0) return false;
+    else if (strcmp(field->key, "te") == 0 && strcmp(field->value, "trailers") != 0) return false;
+
+    return true;
+}
+
+static bool hypertext_utilities_session_is_connection_field(const char* key)
+{
+    const char* names[] = { "connection", "keep-alive", "proxy-connection", "transfer-encoding", "upgrade" };
+
+    for (size_t i = 0; i != sizeof(names) / sizeof(const char*); i++) if (strlen(key) == strlen(names[i]) && hypertext_utilities_equals_ignore_case(key, names[i], strlen(key))) return true;
+
+    return false;
+}
+
+// Copies the decoded fields into one block owned by the stream; interned names aren't copied.
+static char* hypertext_utilities_session_copy(const hypertext_Header_Field* fields, size_t count, hypertext_utilities_field* output)
+{
+    size_t size = 0;
+    for (size_t i = 0; i != count; i++)
+    {
+        output[i].key_length    = strlen(fields[i].key);
+        output[i].value_length  = strlen(fields[i].value);
+        output[i].key           = (char*)hypertext_utilities_intern(fields[i].key, output[i].key_length, true);
+
+        size += (output[i].key != NULL ? 0 : output[i].key_length + 1) + output[i].value_length + 1;
+    }
+
+    char* strings = malloc(size != 0 ? size : 1);
+    if (strings == NULL) return NULL;
+
+    char* position = strings;
+    for (size_t i = 0; i != count; i++)
+    {
+        size_t key_length = output[i].key_length + 1, value_length = output[i].value_length + 1;
+
+        if (output[i].key == NULL)
+        {
+            output[i].key = memcpy(position, fields[i].key, key_length);
+            position += key_length;
+        }
+
+        output[i].value = memcpy(position, fields[i].value, value_length);
+        position += value_length;
+    }
+
+    return strings;
+}
+
+// Materializes a request header block into an instance. Returns 0 or the error code to reset the stream with.
+static uint32_t hypertext_utilities_session_request(hypertext_utilities_stream* stream, const hypertext_Header_Field* fields, size_t count)
+{
+    const char* pseudo[4] = { NULL };
+    const char* names[4] = { ":method", ":scheme", ":authority", ":path" };
+
+    size_t regular = 0;
+    bool host = false;
+
+    for (size_t i = 0; i != count; i++)
+    {
+        if (fields[i].key[0] == ':')
+        {
+            // Pseudo-header fields have to come first and appear only once.
+            size_t j = 0;
+            while (j != 4 && strcmp(fields[i].key, names[j]) != 0) j++;
+
+            if (regular != 0 || j == 4 || pseudo[j] != NULL) return hypertext_Session_Error_Protocol;
+            pseudo[j] = fields[i].value;
+        }
+        else if (!hypertext_utilities_session_is_valid_field(&fields[i])) return hypertext_Session_Error_Protocol;
+        else
+        {
+            if (strcmp(fields[i].key, "host") == 0) host = true;
+            regular++;
+        }
+    }
+
+    const char* method = pseudo[0], * scheme = pseudo[1], * authority = pseudo[2], * path = pseudo[3];
+    if (method == NULL) return hypertext_Session_Error_Protocol;
+
+    size_t method_length = strlen(method);
+    for (size_t i = 0; i != method_length; i++) if (!hypertext_utilities_is_token_character(method[i])) return hypertext_Session_Error_Protocol;
+
+    // CONNECT only carries the authority, which becomes the target; as per RFC 9113, section 8.5.
+    if (method_length == 7 && memcmp(method, "CONNECT", 7) == 0)
+    {
+        if (authority == NULL || scheme != NULL || path != NULL) return hypertext_Session_Error_Protocol;
+        path = authority;
+    }
+    else if (method_length == 0 || scheme == NULL || path == NULL || path[0] == 0) return hypertext_Session_Error_Protocol;
+
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL) return hypertext_Session_Error_Internal;
+
+    stream->request = instance;
+
+    // The authority is exposed as a Host field, like it would be within an HTTP/1.1 request.
+    size_t extra = authority != NULL && !host ? 1 : 0;
+
+    instance->type      = hypertext_Instance_Content_Type_Request;
+    instance->version   = hypertext_HTTP_Version_1_1;
+    instance->method    = hypertext_utilities_find_method(method, method_length);
+
+    if (instance->method == hypertext_Method_Extension)
+    {
+        instance->method_token = calloc(method_length + 1, sizeof(char));
+        if (instance->method_token == NULL) return hypertext_Session_Error_Internal;
+
+        memcpy(instance->method_token, method, method_length);
+        instance->method_token_length = method_length;
+    }
+
+    instance->path_length   = strlen(path);
+    instance->path          = calloc(instance->path_length + 1, sizeof(char));
+    if (instance->path == NULL) return hypertext_Session_Error_Internal;
+
+    memcpy(instance->path, path, instance->path_length);
+    hypertext_utilities_scan_target(instance);
+
+    if (regular + extra == 0) return 0;
+
+    instance->fields = calloc(regular + extra, sizeof(hypertext_utilities_field));
+    if (instance->fields == NULL) return hypertext_Session_Error_Internal;
+
+    stream->strings[0] = hypertext_utilities_session_copy(fields + (count - regular), regular, instance->fields + extra);
+    if (stream->strings[0] == NULL) return hypertext_Session_Error_Internal;
+
+    if (extra != 0)
+    {
+        hypertext_Header_Field field = { "host", (char*)authority };
+
+        stream->strings[1] = hypertext_utilities_session_copy(&field, 1, instance->fields);
+        if (stream->strings[1] == NULL) return hypertext_Session_Error_Internal;
+    }
+
+    instance->field_count = instance->field_capacity = regular + extra;
+
+    return 0;
+}
+
+// Appends a trailing header block to the request's fields. Returns 0 or the error code to reset the stream with.
+static uint32_t hypertext_utilities_session_trailers(hypertext_utilities_stream* stream, const hypertext_Header_Field* fields, size_t count)
+{
+    for (size_t i = 0; i != count; i++) if (fields[i].key[0] == ':' || !hypertext_utilities_session_is_valid_field(&fields[i])) return hypertext_Session_Error_Protocol;
+
+    hypertext_Instance* instance = stream->request;
+    if (count == 0) return 0;
+
+    hypertext_utilities_field* array = realloc(instance->fields, sizeof(hypertext_utilities_field) * (instance->field_count + count));
+    if (array == NULL) return hypertext_Session_Error_Internal;
+    instance->fields            = array;
+    instance->field_capacity    = instance->field_count + count;
+
+    stream->strings[2] = hypertext_utilities_session_copy(fields, count, instance->fields + instance->field_count);
+    if (stream->strings[2] == NULL) return hypertext_Session_Error_Internal;
+
+    instance->field_count += count;
+
+    return 0;
+}
+
+// Hands the body over to the request once the peer ended the stream.
+static void hypertext_utilities_session_complete(hypertext_utilities_stream* stream)
+{
+    if (stream->body.length != 0 && hypertext_utilities_append(&stream->body, "", 1))
+    {
+        stream->request->body           = stream->body.data;
+        stream->request->body_length    = stream->body.length - 1;
+
+        stream->body.data       = NULL;
+        stream->body.length     = 0;
+        stream->body.capacity   = 0;
+    }
+
+    stream->state = hypertext_utilities_stream_received;
+}
+
+// Answers a request whose body exceeds the limit with 413 and asks the peer to stop sending it; as per RFC 9113, section 8.1.
+static uint8_t hypertext_utilities_session_refuse(hypertext_Session* session, uint32_t id)
+{
+    hypertext_Header_Field status = { ":status", "413" };
+    hypertext_View block;
+
+    // The block has to be sent once it's encoded; otherwise both dynamic tables would differ.
+    if (hypertext_Encode_HPACK(session->encoder, &status, 1, &block) != hypertext_Result_Success) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+    else if (!hypertext_utilities_session_frame(session, hypertext_utilities_frame_headers, hypertext_utilities_frame_flag_end_stream | hypertext_utilities_frame_flag_end_headers, id, block.data, block.length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+    hypertext_utilities_session_reset(session, id, hypertext_Session_Error_None);
+    return hypertext_Result_Success;
+}
+
+// Checks whether the request announced a body above the limit, so it can be refused before any of it arrives.
+static bool hypertext_utilities_session_is_too_large(hypertext_Session* session, const hypertext_utilities_stream* stream)
+{
+    hypertext_Instance* instance = stream->request;
+
+    for (size_t i = 0; i != instance->field_count; i++)
+    {
+        size_t length;
+        if (hypertext_utilities_is_field(&instance->fields[i], hypertext_utilities_known_Content_Length) && hypertext_utilities_parse_content_length(instance->fields[i].value, &length) && length > session->limit) return true;
+    }
+
+    return false;
+}
+
+static uint8_t hypertext_utilities_session_headers(hypertext_Session* session, uint32_t id, bool end)
+{
+    hypertext_Header_Field* fields;
+    size_t count;
+
+    // The block is always decoded, even for refused streams; otherwise both dynamic tables would differ.
+    if (hypertext_Decode_HPACK(session->decoder, session->block.data, session->block.length, &fields, &count) != hypertext_Result_Success) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Compression);
+
+    session->block.length = 0;
+    session->block_stream = 0;
+
+    size_t index = hypertext_utilities_session_find(session, id);
+    uint32_t error;
+
+    if (index == SIZE_MAX)
+    {
+        if (session->closing) return hypertext_Result_Success;
+        else if (hypertext_utilities_session_active(session) >= hypertext_utilities_session_max_streams)
+        {
+            hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Refused_Stream);
+            return hypertext_Result_Success;
+        }
+
+        if (session->stream_count == session->stream_capacity)
+        {
+            size_t capacity = session->stream_capacity != 0 ? session->stream_capacity * 2 : 8;
+
+            hypertext_utilities_stream* streams = realloc(session->streams, sizeof(hypertext_utilities_stream) * capacity);
+            if (streams == NULL) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+            session->streams            = streams;
+            session->stream_capacity    = capacity;
+        }
+
+        index = session->stream_count++;
+
+        hypertext_utilities_stream* stream = &session->streams[index];
+        memset(stream, 0, sizeof(hypertext_utilities_stream));
+
+        // Until the peer acknowledged the settings, it may still assume the default window.
+        stream->id              = id;
+        stream->window          = session->initial_window;
+        stream->receive_window  = session->acknowledged ? session->stream_window : hypertext_utilities_session_window;
+
+        error = hypertext_utilities_session_request(stream, fields, count);
+    }
+    else if (!end) error = hypertext_Session_Error_Protocol;
+    else error = hypertext_utilities_session_trailers(&session->streams[index], fields, count);
+
+    if (error != 0) hypertext_utilities_session_reset(session, id, error);
+    else if (end) hypertext_utilities_session_complete(&session->streams[index]);
+    else if (hypertext_utilities_session_is_too_large(session, &session->streams[index])) return hypertext_utilities_session_refuse(session, id);
+
+    return hypertext_Result_Success;
+}
+
+// Removes the padding of DATA and HEADERS frames.
+static bool hypertext_utilities_session_unpad(uint8_t flags, const uint8_t** payload, size_t* length)
+{
+    if (!(flags & hypertext_utilities_frame_flag_padded)) return true;
+    else if (*length == 0 || (*payload)[0] >= *length) return false;
+
+    *length     -= 1 + (*payload)[0];
+    *payload    += 1;
+
+    return true;
+}
+
+static uint8_t hypertext_utilities_session_settings(hypertext_Session* session, const uint8_t* payload, size_t length)
+{
+    for (size_t i = 0; i != length; i += 6)
+    {
+        uint16_t identifier = (uint16_t)(payload[i] << 8 | payload[i + 1]);
+        uint32_t value      = hypertext_utilities_read_32(payload + i + 2);
+
+        switch (identifier)
+        {
+        case hypertext_utilities_setting_header_table_size:
+        {
+            // The encoder may use any size up to the peer's limit, but never more than the default.
+            size_t size = value < hypertext_utilities_session_table_size ? value : hypertext_utilities_session_table_size;
+            if (size != session->table_size && hypertext_Resize_HPACK(session->encoder, size) == hypertext_Result_Success) session->table_size = size;
+
+            break;
+        }
+
+        case hypertext_utilities_setting_enable_push:
+            if (value > 1) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+            break;
+
+        case hypertext_utilities_setting_initial_window_size:
+        {
+            if (value > hypertext_utilities_session_max_window) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Flow_Control);
+
+            // Changing the initial size applies to all open streams; as per RFC 9113, section 6.9.2.
+            int64_t delta = (int64_t)value - session->initial_window;
+            for (size_t j = 0; j != session->stream_count; j++)
+            {
+                session->streams[j].window += delta;
+                if (session->streams[j].window > hypertext_utilities_session_max_window) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Flow_Control);
+            }
+
+            session->initial_window = value;
+            break;
+        }
+
+        case hypertext_utilities_setting_max_frame_size:
+            if (value < hypertext_utilities_session_frame_size || value > 0xFFFFFF) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+            session->max_frame_size = value;
+            break;
+        }
+    }
+
+    session->settings = true;
+
+    if (!hypertext_utilities_session_frame(session, hypertext_utilities_frame_settings, hypertext_utilities_frame_flag_ack, 0, NULL, 0)) return hypertext_Result_Out_Of_Memory;
+
+    return hypertext_Result_Success;
+}
+
+static uint8_t hypertext_utilities_session_process(hypertext_Session* session, uint8_t type, uint8_t flags, uint32_t id, const uint8_t* payload, size_t length)
+{
+    // The client preface ends with a SETTINGS frame and header blocks can't be interrupted.
+    if (!session->settings && type != hypertext_utilities_frame_settings) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+    else if ((session->block_stream != 0) != (type == hypertext_utilities_frame_continuation) || (session->block_stream != 0 && id != session->block_stream)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+    size_t index = id != 0 ? hypertext_utilities_session_find(session, id) : SIZE_MAX;
+
+    switch (type)
+    {
+    case hypertext_utilities_frame_data:
+    {
+        if (id == 0 || id > session->last_stream) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+        // The whole frame counts against both windows, including the padding; as per RFC 9113, section 6.9.1.
+        if ((int64_t)length > session->receive_window) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Flow_Control);
+        session->receive_window -= (int64_t)length;
+
+        size_t frame_length = length;
+        if (!hypertext_utilities_session_unpad(flags, &payload, &length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+        if (index == SIZE_MAX || session->streams[index].state != hypertext_utilities_stream_receiving)
+        {
+            if (!hypertext_utilities_session_credit(session, NULL, frame_length)) return hypertext_Result_Out_Of_Memory;
+
+            hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Stream_Closed);
+            return hypertext_Result_Success;
+        }
+
+        // Received data is only given back once the application fetched the request; closing the stream gives it back too.
+        hypertext_utilities_stream* stream = &session->streams[index];
+        stream->unconsumed += frame_length;
+
+        if ((int64_t)frame_length > stream->receive_window)
+        {
+            hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Flow_Control);
+            return hypertext_Result_Success;
+        }
+        else if (length > session->limit - stream->body.length) return hypertext_utilities_session_refuse(session, id);
+
+        stream->receive_window -= (int64_t)frame_length;
+        if (!hypertext_utilities_append(&stream->body, payload, length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+        // The padding never reaches the application, so its credit is returned right away.
+        size_t padding = frame_length - length;
+        bool end = (flags & hypertext_utilities_frame_flag_end_stream) != 0;
+
+        stream->unconsumed -= padding;
+        if (!hypertext_utilities_session_credit(session, NULL, padding) || (!end && !hypertext_utilities_session_credit(session, stream, padding))) return hypertext_Result_Out_Of_Memory;
+
+        if (end) hypertext_utilities_session_complete(stream);
+
+        return hypertext_Result_Success;
+    }
+
+    case hypertext_utilities_frame_headers:
+    {
+        // Clients only open odd streams, each one above the previous one.
+        if (id == 0 || id % 2 == 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (index == SIZE_MAX)
+        {
+            if (id <= session->last_stream) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Stream_Closed);
+            session->last_stream = id;
+        }
+        else if (session->streams[index].state != hypertext_utilities_stream_receiving) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Stream_Closed);
+
+        if (!hypertext_utilities_session_unpad(flags, &payload, &length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+        if (flags & hypertext_utilities_frame_flag_priority)
+        {
+            if (length < 5) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+            payload += 5;
+            length  -= 5;
+        }
+
+        session->block.length   = 0;
+        session->block_end      = (flags & hypertext_utilities_frame_flag_end_stream) != 0;
+
+        if (!hypertext_utilities_append(&session->block, payload, length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+        if (flags & hypertext_utilities_frame_flag_end_headers) return hypertext_utilities_session_headers(session, id, session->block_end);
+
+        session->block_stream = id;
+        return hypertext_Result_Success;
+    }
+
+    case hypertext_utilities_frame_continuation:
+        if (session->block.length + length > hypertext_utilities_session_max_block) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Enhance_Your_Calm);
+        else if (!hypertext_utilities_append(&session->block, payload, length)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+        if (flags & hypertext_utilities_frame_flag_end_headers) return hypertext_utilities_session_headers(session, id, session->block_end);
+
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_frame_priority:
+        if (id == 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (length != 5) hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Frame_Size);
+
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_frame_reset:
+        if (id == 0 || id > session->last_stream) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (length != 4) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+
+        if (index != SIZE_MAX) hypertext_utilities_session_close(session, index);
+
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_frame_settings:
+        if (id != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if ((flags & hypertext_utilities_frame_flag_ack) && length != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+        else if (flags & hypertext_utilities_frame_flag_ack)
+        {
+            // Streams opened before the acknowledgement started out with the default window; as per RFC 9113, section 6.9.2.
+            if (!session->acknowledged) for (size_t j = 0; j != session->stream_count; j++) session->streams[j].receive_window += (int64_t)session->stream_window - hypertext_utilities_session_window;
+
+            session->acknowledged = true;
+            return hypertext_Result_Success;
+        }
+        else if (length % 6 != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+
+        return hypertext_utilities_session_settings(session, payload, length);
+
+    case hypertext_utilities_frame_push_promise:
+        return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+    case hypertext_utilities_frame_ping:
+        if (id != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (length != 8) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+
+        if (!(flags & hypertext_utilities_frame_flag_ack) && !hypertext_utilities_session_frame(session, hypertext_utilities_frame_ping, hypertext_utilities_frame_flag_ack, 0, payload, 8)) return hypertext_Result_Out_Of_Memory;
+
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_frame_goaway:
+        if (id != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (length < 8) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+
+        session->closing = true;
+        return hypertext_Result_Success;
+
+    case hypertext_utilities_frame_window_update:
+    {
+        if (length != 4) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+
+        uint32_t increment = hypertext_utilities_read_32(payload) & hypertext_utilities_session_max_window;
+
+        if (id == 0)
+        {
+            if (increment == 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+
+            session->send_window += increment;
+            if (session->send_window > hypertext_utilities_session_max_window) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Flow_Control);
+        }
+        else if (id > session->last_stream) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (index != SIZE_MAX)
+        {
+            session->streams[index].window += increment;
+
+            if (increment == 0) hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Protocol);
+            else if (session->streams[index].window > hypertext_utilities_session_max_window) hypertext_utilities_session_reset(session, id, hypertext_Session_Error_Flow_Control);
+        }
+
+        return hypertext_Result_Success;
+    }
+
+    // Unknown frame types have to be ignored.
+    default:
+        return hypertext_Result_Success;
+    }
+}
+
+// Sends as much of the pending response bodies as both flow-control windows allow.
+static bool hypertext_utilities_session_flush(hypertext_Session* session)
+{
+    for (size_t i = 0; i < session->stream_count && session->send_window > 0;)
+    {
+        hypertext_utilities_stream* stream = &session->streams[i];
+        if (stream->state != hypertext_utilities_stream_sending)
+        {
+            i++;
+            continue;
+        }
+
+        while (stream->sent != stream->pending.length && stream->window > 0 && session->send_window > 0)
+        {
+            size_t chunk = stream->pending.length - stream->sent;
+            if (chunk > (size_t)stream->window)         chunk = (size_t)stream->window;
+            if (chunk > (size_t)session->send_window)   chunk = (size_t)session->send_window;
+            if (chunk > session->max_frame_size)        chunk = session->max_frame_size;
+
+            uint8_t flags = stream->sent + chunk == stream->pending.length ? hypertext_utilities_frame_flag_end_stream : 0;
+            if (!hypertext_utilities_session_frame(session, hypertext_utilities_frame_data, flags, stream->id, stream->pending.data + stream->sent, chunk)) return false;
+
+            stream->sent            += chunk;
+            stream->window          -= (int64_t)chunk;
+            session->send_window    -= (int64_t)chunk;
+        }
+
+        if (stream->sent == stream->pending.length) hypertext_utilities_session_remove(session, i);
+        else i++;
+    }
+
+    return true;
+}
+
+hypertext_Session* hypertext_New_Session(size_t limit)
+{
+    if (limit == 0) return NULL;
+
+    hypertext_Session* session = calloc(1, sizeof(hypertext_Session));
+    if (session == NULL) return NULL;
+
+    session->limit = limit;
+    hypertext_utilities_session_defaults(session);
+
+    return session;
+}
+
+void hypertext_Destroy_Session(hypertext_Session* session)
+{
+    if (session == NULL) return;
+
+    for (size_t i = 0; i != session->stream_count; i++) hypertext_utilities_session_release(&session->streams[i]);
+    free(session->streams);
+
+    hypertext_Destroy_HPACK(session->encoder);
+    hypertext_Destroy_HPACK(session->decoder);
+
+    free(session->encoder);
+    free(session->decoder);
+
+    hypertext_utilities_release(&session->input);
+    hypertext_utilities_release(&session->output);
+    hypertext_utilities_release(&session->block);
+
+    size_t limit = session->limit;
+
+    memset(session, 0, sizeof(hypertext_Session));
+
+    session->limit = limit;
+    hypertext_utilities_session_defaults(session);
+}
+
+uint8_t hypertext_Feed_Session(hypertext_Session* session, const char* input, size_t length)
+{
+    if (session == NULL) return hypertext_Result_Invalid_Instance;
+    else if ((input == NULL && length != 0) || session->failed) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_utilities_session_prepare(session);
+    if (result != hypertext_Result_Success) return result;
+    else if (!hypertext_utilities_append(&session->input, input, length)) return hypertext_Result_Out_Of_Memory;
+
+    const uint8_t* data = (const uint8_t*)session->input.data;
+    size_t available = session->input.length, position = 0;
+
+    if (!session->preface)
+    {
+        size_t compared = available < hypertext_utilities_session_preface_length ? available : hypertext_utilities_session_preface_length;
+        if (memcmp(data, hypertext_utilities_session_preface, compared) != 0) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Protocol);
+        else if (compared != hypertext_utilities_session_preface_length) return hypertext_Result_Success;
+
+        session->preface    = true;
+        position            = hypertext_utilities_session_preface_length;
+    }
+
+    while (result == hypertext_Result_Success && available - position >= hypertext_utilities_session_frame_header)
+    {
+        const uint8_t* header = data + position;
+
+        size_t frame_length = (size_t)header[0] << 16 | (size_t)header[1] << 8 | header[2];
+        if (frame_length > hypertext_utilities_session_frame_size)
+        {
+            result = hypertext_utilities_session_fail(session, hypertext_Session_Error_Frame_Size);
+            break;
+        }
+        else if (available - position - hypertext_utilities_session_frame_header < frame_length) break;
+
+        uint32_t id = hypertext_utilities_read_32(header + 5) & hypertext_utilities_session_max_window;
+        result = hypertext_utilities_session_process(session, header[3], header[4], id, header + hypertext_utilities_session_frame_header, frame_length);
+
+        position += hypertext_utilities_session_frame_header + frame_length;
+    }
+
+    // Keep the beginning of an incomplete frame for the next call.
+    memmove(session->input.data, session->input.data + position, available - position);
+    session->input.length = available - position;
+
+    if (result == hypertext_Result_Success && !hypertext_utilities_session_flush(session)) return hypertext_Result_Out_Of_Memory;
+
+    return result;
+}
+
+uint8_t hypertext_Fetch_Session_Request(hypertext_Session* session, uint32_t* stream, hypertext_Instance** request)
+{
+    if (session == NULL) return hypertext_Result_Invalid_Instance;
+    else if (stream == NULL || request == NULL) return hypertext_Result_Invalid_Parameters;
+
+    for (size_t i = 0; i != session->stream_count; i++)
+    {
+        hypertext_utilities_stream* entry = &session->streams[i];
+        if (entry->state != hypertext_utilities_stream_received || entry->delivered) continue;
+
+        // The application has the body now, so the peer may send that much again.
+        if (!hypertext_utilities_session_credit(session, NULL, entry->unconsumed)) return hypertext_Result_Out_Of_Memory;
+
+        entry->unconsumed   = 0;
+        entry->delivered    = true;
+
+        *stream     = entry->id;
+        *request    = entry->request;
+
+        return hypertext_Result_Success;
+    }
+
+    return hypertext_Result_Not_Found;
+}
+
+uint8_t hypertext_Submit_Session_Response(hypertext_Session* session, uint32_t stream, hypertext_Instance* response)
+{
+    if (session == NULL) return hypertext_Result_Invalid_Instance;
+    else if (response == NULL || response->type != hypertext_Instance_Content_Type_Response || response->code < 100 || response->code > 999) return hypertext_Result_Invalid_Parameters;
+    else if (session->failed) return hypertext_Result_Invalid_Parameters;
+
+    size_t index = hypertext_utilities_session_find(session, stream);
+    if (index == SIZE_MAX || !session->streams[index].delivered) return hypertext_Result_Not_Found;
+    else if (session->streams[index].state == hypertext_utilities_stream_reset)
+    {
+        hypertext_utilities_session_remove(session, index);
+        return hypertext_Result_Not_Found;
+    }
+    else if (session->streams[index].state != hypertext_utilities_stream_received) return hypertext_Result_Already_Present;
+
+    // The body is copied first; once the header block is encoded, it has to be sent.
+    hypertext_utilities_stream* entry = &session->streams[index];
+
+    if (!hypertext_utilities_reserve(&entry->pending, response->body_length)) return hypertext_Result_Out_Of_Memory;
+    else if (!hypertext_utilities_read_body(response, 0, entry->pending.data, response->body_length)) return hypertext_Result_IO_Error;
+
+    entry->pending.length = response->body_length;
+
+    hypertext_Header_Field* fields = calloc(response->field_count + 1, sizeof(hypertext_Header_Field));
+    if (fields == NULL) return hypertext_Result_Out_Of_Memory;
+
+    char status[6];
+    snprintf(status, sizeof(status), "%u", response->code);
+
+    fields[0].key   = ":status";
+    fields[0].value = status;
+
+    size_t count = 1;
+    for (size_t i = 0; i != response->field_count; i++) if (!hypertext_utilities_session_is_connection_field(response->fields[i].key)) fields[count++] = (hypertext_Header_Field){ response->fields[i].key, response->fields[i].value };
+
+    hypertext_View block;
+    uint8_t result = hypertext_Encode_HPACK(session->encoder, fields, count, &block);
+    free(fields);
+
+    if (result != hypertext_Result_Success) return result;
+
+    bool end = response->body_length == 0;
+
+    for (size_t offset = 0; offset != block.length;)
+    {
+        size_t chunk = block.length - offset < session->max_frame_size ? block.length - offset : session->max_frame_size;
+
+        uint8_t type    = offset == 0 ? hypertext_utilities_frame_headers : hypertext_utilities_frame_continuation;
+        uint8_t flags   = (offset == 0 && end ? hypertext_utilities_frame_flag_end_stream : 0) | (offset + chunk == block.length ? hypertext_utilities_frame_flag_end_headers : 0);
+
+        if (!hypertext_utilities_session_frame(session, type, flags, stream, block.data + offset, chunk)) return hypertext_utilities_session_fail(session, hypertext_Session_Error_Internal);
+
+        offset += chunk;
+    }
+
+    if (end)
+    {
+        hypertext_utilities_session_remove(session, index);
+        return hypertext_Result_Success;
+    }
+
+    // The request isn't needed anymore.
+    hypertext_Destroy(entry->request);
+    free(entry->request);
+
+    entry->request  = NULL;
+    entry->state    = hypertext_utilities_stream_sending;
+
+    return hypertext_utilities_session_flush(session) ? hypertext_Result_Success : hypertext_Result_Out_Of_Memory;
+}
+
+uint8_t hypertext_Drain_Session(hypertext_Session* session, hypertext_View* output)
+{
+    if (session == NULL) return hypertext_Result_Invalid_Instance;
+    else if (output == NULL) return hypertext_Result_Invalid_Parameters;
+
+    uint8_t result = hypertext_utilities_session_prepare(session);
+    if (result != hypertext_Result_Success) return result;
+
+    if (session->drained) session->output.length = 0;
+
+    output->data    = session->output.data;
+    output->length  = session->output.length;
+
+    session->drained = true;
+
+    return hypertext_Result_Success;
+}
+
+uint8_t hypertext_Close_Session(hypertext_Session* session, uint32_t error)
+{
+    if (session == NULL) return hypertext_Result_Invalid_Instance;
+    else if (session->closed) return hypertext_Result_Already_Present;
+
+    uint8_t result = hypertext_utilities_session_prepare(session);
+    if (result != hypertext_Result_Success) return result;
+
+    uint8_t payload[8];
+    hypertext_utilities_write_32(payload, session->last_stream);
+    hypertext_utilities_write_32(payload + 4, error);
+
+    if (!hypertext_utilities_session_frame(session, hypertext_utilities_frame_goaway, 0, 0, payload, sizeof(payload))) return hypertext_Result_Out_Of_Memory;
+
+    session->closing    = true;
+    session->closed     = true;
+
+    return hypertext_Result_Success;
+}
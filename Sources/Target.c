@@ -0,0 +1,166 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include "Internals.h"
+#include "Utilities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define hypertext_utilities_sse2
+#endif
+
+bool hypertext_utilities_has_escapes(const char* input, size_t length, bool plus)
+{
+    size_t i = 0;
+
+#ifdef hypertext_utilities_sse2
+    const __m128i percent   = _mm_set1_epi8('%');
+    const __m128i plus_sign = _mm_set1_epi8(plus ? '+' : '%');
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(input + i));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, percent), _mm_cmpeq_epi8(block, plus_sign))) != 0) return true;
+    }
+#endif
+
+    for (; i != length; i++) if (input[i] == '%' || (plus && input[i] == '+')) return true;
+
+    return false;
+}
+
+size_t hypertext_utilities_percent_decode(const char* input, size_t length, char* output, bool plus)
+{
+    size_t position = 0;
+
+    for (size_t i = 0; i != length; i++)
+    {
+        if (input[i] == '%' && i + 2 < length)
+        {
+            int8_t high = hypertext_utilities_hex_value(input[i + 1]);
+            int8_t low  = hypertext_utilities_hex_value(input[i + 2]);
+
+            // Malformed escapes are kept as they are.
+            if (high != -1 && low != -1)
+            {
+                if (output != NULL) output[position] = (char)(high << 4 | low);
+                position++;
+                i += 2;
+                continue;
+            }
+        }
+
+        if (output != NULL) output[position] = plus && input[i] == '+' ? ' ' : input[i];
+        position++;
+    }
+
+    return position;
+}
+
+void hypertext_utilities_split_target(hypertext_Instance* instance, size_t query, size_t fragment)
+{
+    hypertext_utilities_reset_target(instance);
+    hypertext_utilities_reset_parameters(instance, hypertext_Parameter_Source_Query);
+
+    size_t path_end = query < fragment ? query : fragment;
+    if (path_end > instance->path_length) path_end = instance->path_length;
+
+    instance->target[hypertext_Target_Component_Path].present   = true;
+    instance->target[hypertext_Target_Component_Path].offset    = 0;
+    instance->target[hypertext_Target_Component_Path].length    = path_end;
+
+    if (query < fragment && query < instance->path_length)
+    {
+        size_t query_end = fragment < instance->path_length ? fragment : instance->path_length;
+
+        instance->target[hypertext_Target_Component_Query].present  = true;
+        instance->target[hypertext_Target_Component_Query].offset   = query + 1;
+        instance->target[hypertext_Target_Component_Query].length   = query_end - query - 1;
+    }
+
+    if (fragment < instance->path_length)
+    {
+        instance->target[hypertext_Target_Component_Fragment].present   = true;
+        instance->target[hypertext_Target_Component_Fragment].offset    = fragment + 1;
+        instance->target[hypertext_Target_Component_Fragment].length    = instance->path_length - fragment - 1;
+    }
+}
+
+void hypertext_utilities_scan_target(hypertext_Instance* instance)
+{
+    const char* fragment    = memchr(instance->path, '#', instance->path_length);
+    size_t fragment_offset  = fragment != NULL ? (size_t)(fragment - instance->path) : SIZE_MAX;
+
+    const char* query       = memchr(instance->path, '?', fragment != NULL ? fragment_offset : instance->path_length);
+    size_t query_offset     = query != NULL ? (size_t)(query - instance->path) : SIZE_MAX;
+
+    hypertext_utilities_split_target(instance, query_offset, fragment_offset);
+}
+
+void hypertext_utilities_reset_target(hypertext_Instance* instance)
+{
+    for (uint8_t i = 0; i != hypertext_Target_Component_Max; i++)
+    {
+        free(instance->target[i].decoded_data);
+        memset(&instance->target[i], 0, sizeof(hypertext_utilities_component));
+    }
+}
+
+uint8_t hypertext_utilities_decode_component(hypertext_Instance* instance, uint8_t component, hypertext_View* output)
+{
+    hypertext_utilities_component* entry = &instance->target[component];
+    if (!entry->present) return hypertext_Result_Not_Found;
+
+    const char* raw = instance->path + entry->offset;
+    bool plus       = component == hypertext_Target_Component_Query;
+
+    if (!entry->decoded)
+    {
+        if (hypertext_utilities_has_escapes(raw, entry->length, plus))
+        {
+            char* decoded = calloc(entry->length + 1, sizeof(char));
+            if (decoded == NULL) return hypertext_Result_Out_Of_Memory;
+
+            entry->decoded_length   = hypertext_utilities_percent_decode(raw, entry->length, decoded, plus);
+            entry->decoded_data     = decoded;
+        }
+
+        entry->decoded = true;
+    }
+
+    if (entry->decoded_data != NULL)
+    {
+        output->data    = entry->decoded_data;
+        output->length  = entry->decoded_length;
+    }
+    else
+    {
+        output->data    = raw;
+        output->length  = entry->length;
+    }
+
+    return hypertext_Result_Success;
+}
@@ -25,85 +25,78 @@
 #include <stdlib.h>
 #include <string.h>
 
-static int64_t hypertext_utilities_contains_item(hypertext_Header_Field* fields, size_t field_count, const char* name)
+// "tchar" as per RFC 7230, section 3.2.6.
+const bool hypertext_utilities_token_characters[256] =
 {
-    if (fields != NULL && field_count >= 2 && name != NULL) for (size_t i = 0; i != field_count; i++) if (strcmp(fields[i].key, name) == 0) return i;
+    ['!'] = true, ['#'] = true, ['$'] = true, ['%'] = true, ['&'] = true, ['\''] = true, ['*'] = true, ['+'] = true,
+    ['-'] = true, ['.'] = true, ['^'] = true, ['_'] = true, ['`'] = true, ['|'] = true, ['~'] = true,
 
-    return -1;
+    ['0'] = true, ['1'] = true, ['2'] = true, ['3'] = true, ['4'] = true, ['5'] = true, ['6'] = true, ['7'] = true, ['8'] = true, ['9'] = true,
+
+    ['A'] = true, ['B'] = true, ['C'] = true, ['D'] = true, ['E'] = true, ['F'] = true, ['G'] = true, ['H'] = true, ['I'] = true,
+    ['J'] = true, ['K'] = true, ['L'] = true, ['M'] = true, ['N'] = true, ['O'] = true, ['P'] = true, ['Q'] = true, ['R'] = true,
+    ['S'] = true, ['T'] = true, ['U'] = true, ['V'] = true, ['W'] = true, ['X'] = true, ['Y'] = true, ['Z'] = true,
+
+    ['a'] = true, ['b'] = true, ['c'] = true, ['d'] = true, ['e'] = true, ['f'] = true, ['g'] = true, ['h'] = true, ['i'] = true,
+    ['j'] = true, ['k'] = true, ['l'] = true, ['m'] = true, ['n'] = true, ['o'] = true, ['p'] = true, ['q'] = true, ['r'] = true,
+    ['s'] = true, ['t'] = true, ['u'] = true, ['v'] = true, ['w'] = true, ['x'] = true, ['y'] = true, ['z'] = true
+};
+
+bool hypertext_utilities_reserve(hypertext_utilities_buffer* buffer, size_t additional)
+{
+    if (buffer->capacity - buffer->length >= additional) return true;
+
+    size_t capacity = buffer->capacity != 0 ? buffer->capacity : 64;
+    while (capacity - buffer->length < additional)
+    {
+        if (capacity > SIZE_MAX / 2) return false;
+        capacity *= 2;
+    }
+
+    char* data = realloc(buffer->data, capacity);
+    if (data == NULL) return false;
+
+    buffer->data        = data;
+    buffer->capacity    = capacity;
+
+    return true;
 }
 
-const char* hypertext_utilities_cut_text(const char* text, size_t start, size_t end)
+bool hypertext_utilities_append(hypertext_utilities_buffer* buffer, const void* data, size_t length)
 {
-    if (start >= end) return NULL;
+    if (!hypertext_utilities_reserve(buffer, length)) return false;
 
-    char* slice = calloc(end - start + 1, sizeof(char));
-    memcpy(slice, text + start, sizeof(char) * (end - start));
+    if (length != 0) memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
 
-    return slice;
+    return true;
 }
 
-size_t hypertext_utilities_parse_headers(const char* input, hypertext_Header_Field* fields, size_t* field_count)
+void hypertext_utilities_release(hypertext_utilities_buffer* buffer)
 {
-    if (input == NULL || field_count == NULL || strlen(input) <= 1 || input[0] == '\n' || (input[0] == '\r' && input[1] == '\n') || (fields == NULL && *field_count != 0)) return 0;
+    free(buffer->data);
 
-    size_t padding = 0, count = 1, key_length, value_padding, value_length;
-    int64_t position;
+    buffer->data        = NULL;
+    buffer->length      = 0;
+    buffer->capacity    = 0;
+}
 
-    hypertext_Header_Field* i_fields = calloc(count, sizeof(hypertext_Header_Field));
+// Steps to the next element of a comma-separated list; as per RFC 9110, section 5.6.1.
+bool hypertext_utilities_next_item(const char** cursor, const char** item, size_t* length)
+{
+    const char* position = *cursor;
+    while (*position == ' ' || *position == '\t' || *position == ',') position++;
 
-    do
-    {
-        key_length      = 0;
-        value_padding   = 1;
-        value_length    = 0;
-
-        if (input[padding] == '\n' || (input[padding] == '\r' && input[padding + 1] == '\n')) break;
-
-        while (input[padding + key_length] != ':') key_length++;
-        if (input[padding + key_length + value_padding] == ' ') value_padding++;
-        while (input[padding + key_length + value_padding + value_length] != '\n' && (input[padding + key_length + value_padding + value_length] != '\r' && input[padding + key_length + value_padding + value_length + 1] != '\n')) value_length++;
-
-        position = hypertext_utilities_contains_item(i_fields, count - 1, hypertext_utilities_cut_text(input, padding, padding + key_length));
-        if (position != -1)
-        {
-            size_t old_value_length = strlen(i_fields[position].value);
-            i_fields[position].value = realloc(i_fields[position].value, old_value_length + value_length + 3);
-            strncat(i_fields[position].value, ", ", 3);
-            strncat(i_fields[position].value, hypertext_utilities_cut_text(input, padding + key_length + value_padding, padding + key_length + value_padding + value_length), value_length);
-        }
-        else
-        {
-            hypertext_Header_Field field =
-            {
-                .key    = calloc(key_length + 1, sizeof(char)),
-                .value  = calloc(value_length + 1, sizeof(char))
-            };
-
-            strncpy(field.key, hypertext_utilities_cut_text(input, padding, padding + key_length), key_length);
-            strncpy(field.value, hypertext_utilities_cut_text(input, padding + key_length + value_padding, padding + key_length + value_padding + value_length), value_length);
-
-            memcpy(&i_fields[count - 1], &field, sizeof(field));
-
-            count++;
-            i_fields = realloc(i_fields, sizeof(hypertext_Header_Field) * count);
-        }
-
-        padding += key_length + value_padding + value_length + 1;
-        if (input[padding - 1] == '\r') padding++;
-    }
-    while (padding <= strlen(input));
+    if (*position == '\0') return false;
 
-    count--;
+    const char* end = position;
+    while (*end != '\0' && *end != ',') end++;
 
-    if (*field_count == 0)
-    {
-        memcpy(field_count, &count, sizeof(size_t));
-        return padding + 1;
-    }
+    *cursor = end;
+    while (end[-1] == ' ' || end[-1] == '\t') end--;
 
-    if ((count - 1) > *field_count) return 0;
+    *item   = position;
+    *length = (size_t)(end - position);
 
-    memcpy(fields, i_fields, sizeof(hypertext_Header_Field) * count);
-    free(i_fields);
-    return padding + 1;
+    return true;
 }
@@ -24,7 +24,109 @@
 
 #include <hypertext.h>
 
-const char* hypertext_utilities_cut_text(const char* text, size_t start, size_t end);
-size_t hypertext_utilities_parse_headers(const char* input, hypertext_Header_Field* fields, size_t* field_count);
+#include <string.h>
+
+typedef struct
+{
+    char*   data;
+    size_t  length;
+    size_t  capacity;
+} hypertext_utilities_buffer;
+
+extern const bool hypertext_utilities_token_characters[256];
+
+inline static bool hypertext_utilities_is_token_character(char character)
+{
+    return hypertext_utilities_token_characters[(uint8_t)character];
+}
+
+inline static int8_t hypertext_utilities_hex_value(char character)
+{
+    if (character >= '0' && character <= '9') return character - '0';
+    else if (character >= 'a' && character <= 'f') return character - 'a' + 10;
+    else if (character >= 'A' && character <= 'F') return character - 'A' + 10;
+
+    return -1;
+}
+
+inline static char hypertext_utilities_to_lower(char character)
+{
+    return character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+}
+
+inline static bool hypertext_utilities_equals_ignore_case(const char* first, const char* second, size_t length)
+{
+    for (size_t i = 0; i != length; i++) if (hypertext_utilities_to_lower(first[i]) != hypertext_utilities_to_lower(second[i])) return false;
+
+    return true;
+}
+
+#define hypertext_utilities_name_storage_size 32768
+
+extern char hypertext_utilities_name_storage[hypertext_utilities_name_storage_size];
+
+// Returns the single copy of a header name, adding it if insert is set; NULL if the name isn't a token, is too long or the table is full.
+const char* hypertext_utilities_intern(const char* name, size_t length, bool insert);
+
+inline static bool hypertext_utilities_is_interned(const char* name)
+{
+    return (uintptr_t)name - (uintptr_t)hypertext_utilities_name_storage < hypertext_utilities_name_storage_size;
+}
+
+// Names the library looks for itself; their interned copies are filled in when the table is seeded, before any name is interned.
+enum hypertext_utilities_known_name
+{
+    hypertext_utilities_known_Accept_Encoding,
+    hypertext_utilities_known_Age,
+    hypertext_utilities_known_Cache_Control,
+    hypertext_utilities_known_Connection,
+    hypertext_utilities_known_Content_Encoding,
+    hypertext_utilities_known_Content_Length,
+    hypertext_utilities_known_Content_Range,
+    hypertext_utilities_known_Content_Type,
+    hypertext_utilities_known_Date,
+    hypertext_utilities_known_Expires,
+    hypertext_utilities_known_If_Match,
+    hypertext_utilities_known_If_Modified_Since,
+    hypertext_utilities_known_If_None_Match,
+    hypertext_utilities_known_If_Range,
+    hypertext_utilities_known_If_Unmodified_Since,
+    hypertext_utilities_known_Pragma,
+    hypertext_utilities_known_Range,
+    hypertext_utilities_known_Set_Cookie,
+    hypertext_utilities_known_Transfer_Encoding,
+    hypertext_utilities_known_Vary,
+    hypertext_utilities_known_Max
+};
+
+extern const hypertext_View hypertext_utilities_known_names[hypertext_utilities_known_Max];
+extern const char* hypertext_utilities_known_interned[hypertext_utilities_known_Max];
+
+bool hypertext_utilities_reserve(hypertext_utilities_buffer* buffer, size_t additional);
+bool hypertext_utilities_append(hypertext_utilities_buffer* buffer, const void* data, size_t length);
+void hypertext_utilities_release(hypertext_utilities_buffer* buffer);
+
+bool hypertext_utilities_next_item(const char** cursor, const char** item, size_t* length);
+
+const hypertext_Segment* hypertext_utilities_body_segments(hypertext_Instance* instance, hypertext_Segment* single, size_t* count);
+void hypertext_utilities_reset_segments(hypertext_Instance* instance);
+
+bool hypertext_utilities_parse_date(const char* text, size_t length, uint64_t* output);
+
+bool hypertext_utilities_read_body(hypertext_Instance* instance, size_t offset, char* output, size_t length);
+
+uint8_t hypertext_utilities_find_method(const char* token, size_t length);
+bool hypertext_utilities_is_valid_method(uint8_t method);
+bool hypertext_utilities_fetch_method_token(uint8_t method, hypertext_View* output);
+
+bool hypertext_utilities_has_escapes(const char* input, size_t length, bool plus);
+size_t hypertext_utilities_percent_decode(const char* input, size_t length, char* output, bool plus);
+void hypertext_utilities_split_target(hypertext_Instance* instance, size_t query, size_t fragment);
+void hypertext_utilities_scan_target(hypertext_Instance* instance);
+void hypertext_utilities_reset_target(hypertext_Instance* instance);
+uint8_t hypertext_utilities_decode_component(hypertext_Instance* instance, uint8_t component, hypertext_View* output);
+
+uint8_t hypertext_utilities_build_parameters(hypertext_Instance* instance, uint8_t source);
+void hypertext_utilities_reset_parameters(hypertext_Instance* instance, uint8_t source);
 
 #endif
@@ -0,0 +1,213 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static hypertext_Instance* parse(const char* input, bool request)
+{
+    hypertext_Instance* instance = hypertext_New();
+    uint8_t result = request ? hypertext_Parse_Request(instance, input, 0) : hypertext_Parse_Response(instance, input, strlen(input));
+
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Parsing \"%.24s\" failed; code %d.\n", input, result);
+        exit(1);
+    }
+
+    return instance;
+}
+
+static void discard(hypertext_Instance* instance)
+{
+    hypertext_Destroy(instance);
+    free(instance);
+}
+
+static uint8_t store(hypertext_Cache* cache, const char* request_text, const char* response_text, uint64_t now)
+{
+    hypertext_Instance* request  = parse(request_text, true);
+    hypertext_Instance* response = parse(response_text, false);
+
+    uint8_t result = hypertext_Store_Cache(cache, request, response, now, true, true);
+
+    discard(request);
+    discard(response);
+
+    return result;
+}
+
+// Returns the stored status code, or zero on a miss.
+static uint16_t lookup(hypertext_Cache* cache, const char* request_text, uint64_t now)
+{
+    hypertext_Instance* request = parse(request_text, true);
+    hypertext_Frozen* frozen = NULL;
+    uint16_t code = 0;
+
+    if (hypertext_Lookup_Cache(cache, request, now, &frozen) == hypertext_Result_Success)
+    {
+        hypertext_Instance* shared = NULL;
+        hypertext_Fetch_Frozen_Instance(frozen, &shared);
+        hypertext_Fetch_Code(shared, &code);
+        hypertext_Release_Frozen(frozen);
+    }
+
+    discard(request);
+
+    return code;
+}
+
+int main()
+{
+    hypertext_Cache* cache = hypertext_New_Cache(1 << 20);
+    if (cache == NULL)
+    {
+        printf("Error: hypertext_New_Cache failed.\n");
+        return 1;
+    }
+
+    const char* gzip = "GET /index HTTP/1.1\r\nHost: a\r\nAccept-Encoding: gzip\r\n\r\n";
+    const char* brotli = "GET /index HTTP/1.1\r\nHost: a\r\nAccept-Encoding: br\r\n\r\n";
+
+    uint8_t result = store(cache, gzip, "HTTP/1.1 200 OK\r\nCache-Control: public, max-age=60\r\nVary: Accept-Encoding\r\nContent-Length: 5\r\n\r\nhello", 1000);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Store_Cache failed; code %d.\n", result);
+        return 1;
+    }
+
+    if (lookup(cache, gzip, 1030) != 200 || lookup(cache, brotli, 1030) != 0)
+    {
+        printf("Error: The Vary field wasn't part of the key.\n");
+        return 1;
+    }
+    else if (lookup(cache, gzip, 1060) != 0)
+    {
+        printf("Error: A stale response was served.\n");
+        return 1;
+    }
+    else if (lookup(cache, "GET /index HTTP/1.1\r\nAccept-Encoding: gzip\r\nCache-Control: no-cache\r\n\r\n", 1030) != 0)
+    {
+        printf("Error: A no-cache request was served.\n");
+        return 1;
+    }
+
+    // A newer response for the same variant replaces the old one.
+    store(cache, gzip, "HTTP/1.1 404 Not Found\r\nCache-Control: max-age=60\r\nVary: Accept-Encoding\r\n\r\n", 1010);
+    if (lookup(cache, gzip, 1030) != 404)
+    {
+        printf("Error: The stored response wasn't replaced.\n");
+        return 1;
+    }
+
+    // Expires counts from Date, not from when the response was stored.
+    result = store(cache, "GET /dated HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nDate: Sun, 06 Nov 1994 08:49:37 GMT\r\nExpires: Sun, 06 Nov 1994 08:50:37 GMT\r\nAge: 10\r\n\r\n", 5000);
+    if (result != hypertext_Result_Success || lookup(cache, "GET /dated HTTP/1.1\r\n\r\n", 5049) != 200 || lookup(cache, "GET /dated HTTP/1.1\r\n\r\n", 5050) != 0)
+    {
+        printf("Error: The Expires lifetime doesn't match.\n");
+        return 1;
+    }
+
+    const char* refused[][2] =
+    {
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nCache-Control: no-store, max-age=60\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\nSet-Cookie: a=b\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\nVary: *\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nExpires: 0\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\n\r\n", "HTTP/1.1 500 Internal Server Error\r\nCache-Control: max-age=60\r\n\r\n" },
+        { "GET /a HTTP/1.1\r\nAuthorization: Basic YTpi\r\n\r\n", "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\n\r\n" },
+        { "POST /a HTTP/1.1\r\n\r\n", "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\n\r\n" }
+    };
+
+    for (size_t i = 0; i != sizeof(refused) / sizeof(refused[0]); i++)
+    {
+        result = store(cache, refused[i][0], refused[i][1], 1000);
+        if (result != hypertext_Result_Unsupported)
+        {
+            printf("Error: Response %zu was stored; code %d.\n", i, result);
+            return 1;
+        }
+    }
+
+    if (hypertext_Invalidate_Cache(cache, "/index", 6) != hypertext_Result_Success || lookup(cache, gzip, 1030) != 0 || hypertext_Invalidate_Cache(cache, "/index", 6) != hypertext_Result_Not_Found)
+    {
+        printf("Error: hypertext_Invalidate_Cache failed.\n");
+        return 1;
+    }
+
+    // Destroying the content only resets the cache.
+    const char* kept = "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\n\r\n";
+
+    if (store(cache, brotli, kept, 1000) != hypertext_Result_Success || lookup(cache, brotli, 1030) != 200)
+    {
+        printf("Error: A response couldn't be stored before resetting the cache.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Cache(cache);
+
+    if (lookup(cache, brotli, 1030) != 0 || store(cache, brotli, kept, 1000) != hypertext_Result_Success || lookup(cache, brotli, 1030) != 200)
+    {
+        printf("Error: The cache wasn't usable after being reset.\n");
+        return 1;
+    }
+
+    hypertext_Free_Cache(cache);
+
+    // With room for one response per shard, older ones have to go.
+    cache = hypertext_New_Cache(16 * 400);
+
+    char request[64];
+    size_t hits = 0;
+
+    for (size_t i = 0; i != 256; i++)
+    {
+        snprintf(request, sizeof(request), "GET /%zu HTTP/1.1\r\n\r\n", i);
+
+        result = store(cache, request, "HTTP/1.1 200 OK\r\nCache-Control: max-age=60\r\nContent-Length: 4\r\n\r\nbody", 1000);
+        if (result != hypertext_Result_Success || lookup(cache, request, 1000) != 200)
+        {
+            printf("Error: Storing request %zu failed; code %d.\n", i, result);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i != 256; i++)
+    {
+        snprintf(request, sizeof(request), "GET /%zu HTTP/1.1\r\n\r\n", i);
+        if (lookup(cache, request, 1000) == 200) hits++;
+    }
+
+    if (hits == 0 || hits > 16)
+    {
+        printf("Error: %zu responses survived eviction.\n", hits);
+        return 1;
+    }
+
+    hypertext_Free_Cache(cache);
+
+    printf("Success.\n");
+    return 0;
+}
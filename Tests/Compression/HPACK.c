@@ -0,0 +1,200 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    const char*             block;
+    size_t                  length;
+    hypertext_Header_Field  fields[8];
+    size_t                  field_count;
+} example;
+
+// Requests with Huffman coding, as per RFC 7541, appendix C.4.
+const example requests[] =
+{
+    {
+        "\x82\x86\x84\x41\x8c\xf1\xe3\xc2\xe5\xf2\x3a\x6b\xa0\xab\x90\xf4\xff", 17,
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } }, 4
+    },
+    {
+        "\x82\x86\x84\xbe\x58\x86\xa8\xeb\x10\x64\x9c\xbf", 12,
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } }, 5
+    },
+    {
+        "\x82\x87\x85\xbf\x40\x88\x25\xa8\x49\xe9\x5b\xa9\x7d\x7f\x89\x25\xa8\x49\xe9\x5b\xb8\xe8\xb4\xbf", 24,
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } }, 5
+    }
+};
+
+// Responses with Huffman coding and a table size of 256, which forces evictions; as per RFC 7541, appendix C.6.
+const example responses[] =
+{
+    {
+        "\x48\x82\x64\x02\x58\x85\xae\xc3\x77\x1a\x4b\x61\x96\xd0\x7a\xbe\x94\x10\x54\xd4\x44\xa8\x20\x05\x95\x04\x0b\x81\x66\xe0\x82\xa6\x2d\x1b\xff"
+        "\x6e\x91\x9d\x29\xad\x17\x18\x63\xc7\x8f\x0b\x97\xc8\xe9\xae\x82\xae\x43\xd3", 54,
+        { { ":status", "302" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } }, 4
+    },
+    {
+        "\x48\x83\x64\x0e\xff\xc1\xc0\xbf", 8,
+        { { ":status", "307" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } }, 4
+    },
+    {
+        "\x88\xc1\x61\x96\xd0\x7a\xbe\x94\x10\x54\xd4\x44\xa8\x20\x05\x95\x04\x0b\x81\x66\xe0\x84\xa6\x2d\x1b\xff\xc0\x5a\x83\x9b\xd9\xab\x77\xad\x94"
+        "\xe7\x82\x1d\xd7\xf2\xe6\xc7\xb3\x35\xdf\xdf\xcd\x5b\x39\x60\xd5\xaf\x27\x08\x7f\x36\x72\xc1\xab\x27\x0f\xb5\x29\x1f\x95\x87\x31\x60\x65\xc0"
+        "\x03\xed\x4e\xe5\xb1\x06\x3d\x50\x07", 79,
+        {
+            { ":status", "200" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:22 GMT" }, { "location", "https://www.example.com" },
+            { "content-encoding", "gzip" }, { "set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1" }
+        }, 6
+    }
+};
+
+static int run(const char* name, const example* examples, size_t count, size_t table_size)
+{
+    hypertext_HPACK* encoder = hypertext_New_HPACK(table_size);
+    hypertext_HPACK* decoder = hypertext_New_HPACK(table_size);
+
+    if (encoder == NULL || decoder == NULL)
+    {
+        printf("Error: Failed to create the %s contexts.\n", name);
+        return 1;
+    }
+
+    for (size_t i = 0; i != count; i++)
+    {
+        hypertext_Header_Field* fields;
+        size_t field_count;
+
+        uint8_t result = hypertext_Decode_HPACK(decoder, examples[i].block, examples[i].length, &fields, &field_count);
+        if (result != hypertext_Result_Success)
+        {
+            printf("Error: Decoding %s block %zu failed with code %d.\n", name, i, result);
+            return 1;
+        }
+        else if (field_count != examples[i].field_count)
+        {
+            printf("Error: %s block %zu decoded into %zu fields instead of %zu.\n", name, i, field_count, examples[i].field_count);
+            return 1;
+        }
+
+        for (size_t j = 0; j != field_count; j++) if (strcmp(fields[j].key, examples[i].fields[j].key) != 0 || strcmp(fields[j].value, examples[i].fields[j].value) != 0)
+        {
+            printf("Error: %s block %zu field %zu is \"%s: %s\".\n", name, i, j, fields[j].key, fields[j].value);
+            return 1;
+        }
+
+        hypertext_View output;
+
+        result = hypertext_Encode_HPACK(encoder, examples[i].fields, examples[i].field_count, &output);
+        if (result != hypertext_Result_Success)
+        {
+            printf("Error: Encoding %s block %zu failed with code %d.\n", name, i, result);
+            return 1;
+        }
+        else if (output.length != examples[i].length || memcmp(output.data, examples[i].block, output.length) != 0)
+        {
+            printf("Error: %s block %zu was encoded differently (%zu bytes).\n", name, i, output.length);
+            return 1;
+        }
+    }
+
+    hypertext_Destroy_HPACK(encoder);
+    hypertext_Destroy_HPACK(decoder);
+
+    free(encoder);
+    free(decoder);
+
+    return 0;
+}
+
+int main()
+{
+    if (run("request", requests, sizeof(requests) / sizeof(example), 4096) != 0 || run("response", responses, sizeof(responses) / sizeof(example), 256) != 0) return 1;
+
+    hypertext_HPACK* encoder = hypertext_New_HPACK(4096);
+    hypertext_HPACK* decoder = hypertext_New_HPACK(4096);
+
+    hypertext_Header_Field sent[] =
+    {
+        { ":status", "200" },
+        { "Content-Type", "text/plain" },
+        { "Authorization", "secret" },
+        { "x-binary", "\x7f\xff\x80" }
+    };
+
+    hypertext_Header_Field* fields;
+    size_t field_count;
+    hypertext_View output;
+
+    // Shrinking the table has to be announced in front of the next block.
+    hypertext_Resize_HPACK(encoder, 128);
+
+    for (uint8_t round = 0; round != 2; round++)
+    {
+        if (hypertext_Encode_HPACK(encoder, sent, 4, &output) != hypertext_Result_Success || hypertext_Decode_HPACK(decoder, output.data, output.length, &fields, &field_count) != hypertext_Result_Success || field_count != 4)
+        {
+            printf("Error: Round trip %d failed.\n", round);
+            return 1;
+        }
+        else if (round == 0 && (uint8_t)output.data[0] != 0x3f)
+        {
+            printf("Error: Missing the dynamic table size update.\n");
+            return 1;
+        }
+        else if (strcmp(fields[1].key, "content-type") != 0 || strcmp(fields[2].value, "secret") != 0 || strcmp(fields[3].value, "\x7f\xff\x80") != 0)
+        {
+            printf("Error: Round trip %d returned \"%s\", \"%s\" and \"%s\".\n", round, fields[1].key, fields[2].value, fields[3].value);
+            return 1;
+        }
+    }
+
+    // The second round refers to "content-type" through the dynamic table, but "authorization" is always sent as a never-indexed literal.
+    if (output.length != 1 + 1 + 2 + 5 + 1)
+    {
+        printf("Error: Second round trip took %zu bytes.\n", output.length);
+        return 1;
+    }
+
+    // Index 0, an index beyond the dynamic table, bad padding and a late size update are all compression errors.
+    const char* invalid[] = { "\x80", "\xff\x00", "\x40\x81\x00\x81\x00", "\x82\x3f\x00" };
+    const size_t lengths[] = { 1, 2, 5, 3 };
+
+    for (size_t i = 0; i != 4; i++) if (hypertext_Decode_HPACK(decoder, invalid[i], lengths[i], &fields, &field_count) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: Invalid block %zu was accepted.\n", i);
+        return 1;
+    }
+
+    hypertext_Destroy_HPACK(encoder);
+    hypertext_Destroy_HPACK(decoder);
+
+    free(encoder);
+    free(decoder);
+
+    printf("Success.\n");
+    return 0;
+}
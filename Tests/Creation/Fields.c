@@ -0,0 +1,336 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* request = "GET / HTTP/1.1\r\nhost: example.org\r\nX-Custom-Name: 1\r\nx-custom-name: 2\r\nACCEPT: */*\r\n\r\n";
+
+const char* intern(const char* name)
+{
+    const char* output = NULL;
+    if (hypertext_Intern_Name(name, strlen(name), &output) != hypertext_Result_Success) return NULL;
+
+    return output;
+}
+
+int main()
+{
+    const char* host = intern("Host");
+    const char* custom = intern("x-custom-name");
+
+    if (host == NULL || strcmp(host, "Host") != 0 || intern("hOST") != host || custom == NULL || intern("X-CUSTOM-NAME") != custom || strcmp(custom, "x-custom-name") != 0)
+    {
+        printf("Error: Names weren't interned to a single copy.\n");
+        return 1;
+    }
+
+    const char* output = NULL;
+    char long_name[100];
+    memset(long_name, 'a', sizeof(long_name));
+
+    if (hypertext_Intern_Name("Bad Name", 8, &output) != hypertext_Result_Invalid_Parameters || hypertext_Intern_Name(long_name, sizeof(long_name), &output) != hypertext_Result_Unsupported)
+    {
+        printf("Error: Invalid or overlong names were interned.\n");
+        return 1;
+    }
+
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL || hypertext_Parse_Request(instance, request, strlen(request)) != hypertext_Result_Success)
+    {
+        printf("Error: The request couldn't be parsed.\n");
+        return 1;
+    }
+
+    hypertext_Header_Field field;
+    size_t count = 0;
+    hypertext_Fetch_Header_Field_Count(instance, &count);
+
+    if (count != 4 || hypertext_Fetch_Header_Field_At(instance, 0, &field) != hypertext_Result_Success || field.key != host || hypertext_Fetch_Header_Field_At(instance, 2, &field) != hypertext_Result_Success || field.key != custom || strcmp(field.value, "2") != 0)
+    {
+        printf("Error: Parsed fields don't point at the interned names.\n");
+        return 1;
+    }
+
+    if (hypertext_Fetch_Header_Field(instance, &field, "accept") != hypertext_Result_Success || strcmp(field.key, "Accept") != 0 || strcmp(field.value, "*/*") != 0)
+    {
+        printf("Error: A field couldn't be fetched by another spelling of its name.\n");
+        return 1;
+    }
+
+    hypertext_Header_Field duplicate    = { "HOST", "other.org" };
+    hypertext_Header_Field added        = { "Cache-Control", "no-cache" };
+    hypertext_Header_Field overlong     = { long_name, "x" };
+    long_name[sizeof(long_name) - 1] = '\0';
+
+    if (hypertext_Add_Field(instance, &duplicate) != hypertext_Result_Already_Present || hypertext_Add_Field(instance, &added) != hypertext_Result_Success || hypertext_Add_Field(instance, &overlong) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Add_Field didn't find duplicates or failed to add.\n");
+        return 1;
+    }
+
+    if (hypertext_Add_Field(instance, &(hypertext_Header_Field){ "AAAA", "y" }) != hypertext_Result_Success || hypertext_Add_Field(instance, &overlong) != hypertext_Result_Already_Present)
+    {
+        printf("Error: Names without an interned copy weren't compared by content.\n");
+        return 1;
+    }
+
+    hypertext_View mixed_names[] = { { long_name, strlen(long_name) }, { "CACHE-CONTROL", 13 } };
+    hypertext_Field mixed[2];
+
+    if (hypertext_Fetch_Fields(instance, mixed_names, 2, mixed) != hypertext_Result_Success || mixed[0].value.length != 1 || mixed[0].value.data[0] != 'x' || mixed[1].value.length != 8 || memcmp(mixed[1].value.data, "no-cache", 8) != 0)
+    {
+        printf("Error: hypertext_Fetch_Fields didn't find names with and without an interned copy.\n");
+        return 1;
+    }
+
+    hypertext_Fetch_Header_Field_Count(instance, &count);
+
+    if (count != 7 || hypertext_Fetch_Header_Field_At(instance, 4, &field) != hypertext_Result_Success || field.key != intern("cache-control") || strcmp(field.value, "no-cache") != 0)
+    {
+        printf("Error: hypertext_Add_Field didn't append the field.\n");
+        return 1;
+    }
+
+    if (hypertext_Remove_Field(instance, "X-Custom-Name") != hypertext_Result_Success || hypertext_Remove_Field(instance, "x-custom-name") != hypertext_Result_Not_Found || hypertext_Remove_Field(instance, "Not-Present-Anywhere") != hypertext_Result_Not_Found || hypertext_Remove_Field(instance, long_name) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Remove_Field removed the wrong fields.\n");
+        return 1;
+    }
+
+    const char* order[] = { "Host", "Accept", "Cache-Control", "AAAA" };
+    hypertext_Fetch_Header_Field_Count(instance, &count);
+
+    for (size_t i = 0; i != 4; i++) if (count != 4 || hypertext_Fetch_Header_Field_At(instance, i, &field) != hypertext_Result_Success || strcmp(field.key, order[i]) != 0)
+    {
+        printf("Error: Removing fields didn't keep the order of the rest.\n");
+        return 1;
+    }
+
+    hypertext_Frozen* frozen = NULL;
+    if (hypertext_Freeze(instance, true, true, &frozen) != hypertext_Result_Success)
+    {
+        printf("Error: The instance couldn't be frozen.\n");
+        return 1;
+    }
+
+    hypertext_Instance* shared = NULL;
+    hypertext_Fetch_Frozen_Instance(frozen, &shared);
+
+    if (hypertext_Fetch_Header_Field_At(shared, 0, &field) != hypertext_Result_Success || field.key != host)
+    {
+        printf("Error: The frozen copy doesn't point at the interned name.\n");
+        return 1;
+    }
+
+    hypertext_Release_Frozen(frozen);
+    hypertext_Destroy(instance);
+
+    hypertext_Field sized[] =
+    {
+        { { "content-type", 12 }, { "text/plain; charset=utf-8", 10 } },
+        { { "X-Binary", 8 }, { "a\0b", 3 } }
+    };
+
+    const char expected[] = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nX-Binary: a\0b\r\nx-added: 1\r\n\r\nHi";
+    char rendered[sizeof(expected) - 1];
+    size_t length = 0;
+
+    hypertext_Field line_break = { { "X-Split", 7 }, { "1\r\nX-Injected: 2", 17 } };
+    hypertext_Field bad_name = { { "X Bad", 5 }, { "1", 1 } };
+
+    if (hypertext_Create_Response_Fields(instance, hypertext_HTTP_Version_1_1, 200, (hypertext_Field[]){ line_break }, 1, NULL, 0) != hypertext_Result_Invalid_Parameters || hypertext_Create_Response_Fields(instance, hypertext_HTTP_Version_1_1, 200, sized, 2, "Hi", 2) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Create_Response_Fields accepted a line break or failed.\n");
+        return 1;
+    }
+
+    if (hypertext_Append_Field(instance, &(hypertext_Field){ { "x-added", 7 }, { "1", 1 } }) != hypertext_Result_Success || hypertext_Append_Field(instance, &(hypertext_Field){ { "X-BINARY", 8 }, { "c", 1 } }) != hypertext_Result_Already_Present || hypertext_Append_Field(instance, &line_break) != hypertext_Result_Invalid_Parameters || hypertext_Append_Field(instance, &bad_name) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: hypertext_Append_Field didn't add, find duplicates or validate.\n");
+        return 1;
+    }
+
+    hypertext_Field sized_field;
+
+    if (hypertext_Fetch_Field(instance, "x-binary", 8, &sized_field) != hypertext_Result_Success || sized_field.value.length != 3 || memcmp(sized_field.value.data, "a\0b", 3) != 0 || hypertext_Fetch_Field_At(instance, 0, &sized_field) != hypertext_Result_Success || sized_field.name.length != 12 || memcmp(sized_field.name.data, "Content-Type", 12) != 0 || sized_field.value.length != 10)
+    {
+        printf("Error: Fields weren't fetched along with their lengths.\n");
+        return 1;
+    }
+
+    if (hypertext_Output_Response(instance, NULL, &length, true, true) != hypertext_Result_Success || length != sizeof(rendered) || hypertext_Output_Response(instance, rendered, &length, true, true) != hypertext_Result_Success || memcmp(rendered, expected, sizeof(rendered)) != 0)
+    {
+        printf("Error: The output didn't use the lengths of the fields.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    if (hypertext_Parse_Request(instance, request, strlen(request)) != hypertext_Result_Success || hypertext_Fetch_Field(instance, "X-Custom-Name", 13, &sized_field) != hypertext_Result_Success || sized_field.value.length != 1 || hypertext_Fetch_Field(instance, "X-Custom-Nam", 12, &sized_field) != hypertext_Result_Not_Found)
+    {
+        printf("Error: The lengths of parsed fields are wrong.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    hypertext_Header_Field batch[] = { { "Server", "hypertext" }, { "Vary", "Accept" }, { "X-Batch", "1" }, { "x-batch", "2" } };
+
+    if (hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, 200, NULL, 0, NULL, 0) != hypertext_Result_Success || hypertext_Add_Fields(instance, batch, 4) != hypertext_Result_Already_Present || hypertext_Fetch_Header_Field_Count(instance, &count) != hypertext_Result_Success || count != 0)
+    {
+        printf("Error: hypertext_Add_Fields added part of a batch with a duplicate.\n");
+        return 1;
+    }
+
+    if (hypertext_Add_Fields(instance, batch, 3) != hypertext_Result_Success || hypertext_Add_Fields(instance, batch + 1, 1) != hypertext_Result_Already_Present)
+    {
+        printf("Error: hypertext_Add_Fields failed to add a batch.\n");
+        return 1;
+    }
+
+    // Middleware adding and stripping fields over and over; the order of the rest has to hold.
+    for (size_t round = 0; round != 100; round++)
+    {
+        if (hypertext_Set_Field(instance, &(hypertext_Header_Field){ "vary", "Accept-Encoding" }) != hypertext_Result_Success || hypertext_Set_Field(instance, &(hypertext_Header_Field){ "X-Round", "1" }) != hypertext_Result_Success || hypertext_Add_Field(instance, &(hypertext_Header_Field){ "X-Temporary", "1" }) != hypertext_Result_Success || hypertext_Remove_Field(instance, "X-Temporary") != hypertext_Result_Success || hypertext_Remove_Field(instance, "x-round") != hypertext_Result_Success)
+        {
+            printf("Error: Setting, adding or removing fields failed in round %zu.\n", round);
+            return 1;
+        }
+    }
+
+    const char* values[] = { "hypertext", "Accept-Encoding", "1" };
+    hypertext_Fetch_Header_Field_Count(instance, &count);
+
+    for (size_t i = 0; i != 3; i++) if (count != 3 || hypertext_Fetch_Header_Field_At(instance, i, &field) != hypertext_Result_Success || strcmp(field.key, batch[i].key) != 0 || strcmp(field.value, values[i]) != 0)
+    {
+        printf("Error: hypertext_Set_Field didn't replace the value in place.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    const char* repeated = "GET / HTTP/1.1\r\nVia: 1.0 a\r\nHost: example.org\r\nvia: 1.1 b\r\nVIA: 1.1 c\r\n\r\n";
+    const char* hops[] = { "1.0 a", "1.1 b", "1.1 c" };
+
+    if (hypertext_Parse_Request(instance, repeated, strlen(repeated)) != hypertext_Result_Success || hypertext_Fetch_Header_Field_Count(instance, &count) != hypertext_Result_Success || count != 4)
+    {
+        printf("Error: Repeated fields weren't kept apart.\n");
+        return 1;
+    }
+
+    size_t position = 0;
+    size_t found = 0;
+
+    while (hypertext_Find_Next_Field(instance, "via", 3, &position, &sized_field) == hypertext_Result_Success)
+    {
+        if (found == 3 || sized_field.value.length != strlen(hops[found]) || memcmp(sized_field.value.data, hops[found], sized_field.value.length) != 0)
+        {
+            printf("Error: hypertext_Find_Next_Field didn't walk the occurrences in order.\n");
+            return 1;
+        }
+
+        found++;
+    }
+
+    hypertext_View views[3];
+    size_t view_count = 2;
+
+    if (found != 3 || hypertext_Fetch_Field_Values(instance, "Via", 3, NULL, &count) != hypertext_Result_Success || count != 3 || hypertext_Fetch_Field_Values(instance, "Via", 3, views, &view_count) != hypertext_Result_Success || view_count != 2 || views[1].length != 5 || memcmp(views[1].data, "1.1 b", 5) != 0 || hypertext_Fetch_Field_Values(instance, "X-None", 6, views, &view_count) != hypertext_Result_Not_Found)
+    {
+        printf("Error: hypertext_Fetch_Field_Values returned the wrong values.\n");
+        return 1;
+    }
+
+    char joined[32];
+    const char expected_joined[] = "1.0 a, 1.1 b, 1.1 c";
+
+    length = 4;
+
+    if (hypertext_Fetch_Joined_Field(instance, "via", 3, joined, &length) != hypertext_Result_Invalid_Parameters || hypertext_Fetch_Joined_Field(instance, "via", 3, NULL, &length) != hypertext_Result_Success || length != sizeof(expected_joined) - 1 || hypertext_Fetch_Joined_Field(instance, "via", 3, joined, &length) != hypertext_Result_Success || memcmp(joined, expected_joined, length) != 0)
+    {
+        printf("Error: hypertext_Fetch_Joined_Field didn't join the values.\n");
+        return 1;
+    }
+
+    // More names than fit in a single pass, with repeats and missing ones among them.
+    hypertext_View wanted[18];
+    hypertext_Field fetched[18];
+
+    for (size_t i = 0; i != 18; i++) wanted[i] = (hypertext_View){ "X-Filler", 8 };
+    wanted[0] = (hypertext_View){ "HOST", 4 };
+    wanted[1] = (hypertext_View){ "via", 3 };
+    wanted[2] = (hypertext_View){ "Via", 3 };
+    wanted[17] = (hypertext_View){ host, 4 };
+
+    if (hypertext_Fetch_Fields(instance, wanted, 18, fetched) != hypertext_Result_Not_Found || fetched[0].value.length != 11 || memcmp(fetched[0].value.data, "example.org", 11) != 0 || fetched[1].value.length != 5 || memcmp(fetched[1].value.data, "1.0 a", 5) != 0 || fetched[2].value.data != fetched[1].value.data || fetched[3].name.data != NULL || fetched[16].value.length != 0 || fetched[17].value.data != fetched[0].value.data)
+    {
+        printf("Error: hypertext_Fetch_Fields didn't fill in the first occurrence of every name.\n");
+        return 1;
+    }
+
+    if (hypertext_Fetch_Fields(instance, wanted + 1, 1, fetched) != hypertext_Result_Success || hypertext_Fetch_Fields(instance, (hypertext_View[]){ { "", 0 } }, 1, fetched) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: hypertext_Fetch_Fields didn't check its names.\n");
+        return 1;
+    }
+
+    if (hypertext_Set_Field(instance, &(hypertext_Header_Field){ "Via", "1.1 d" }) != hypertext_Result_Success || hypertext_Fetch_Header_Field_Count(instance, &count) != hypertext_Result_Success || count != 2 || hypertext_Fetch_Header_Field_At(instance, 0, &field) != hypertext_Result_Success || strcmp(field.value, "1.1 d") != 0)
+    {
+        printf("Error: hypertext_Set_Field didn't collapse the repeated field in place.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    const char cookies[] = "HTTP/1.1 200 OK\r\nSet-Cookie: a=1; Expires=Wed, 21 Oct 2015 07:28:00 GMT\r\nSet-Cookie: b=2\r\n\r\n";
+    char cookie_output[sizeof(cookies) - 1];
+
+    if (hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, 200, NULL, 0, NULL, 0) != hypertext_Result_Success || hypertext_Add_Repeated_Field(instance, &(hypertext_Header_Field){ "Set-Cookie", "a=1; Expires=Wed, 21 Oct 2015 07:28:00 GMT" }) != hypertext_Result_Success || hypertext_Add_Repeated_Field(instance, &(hypertext_Header_Field){ "set-cookie", "b=2" }) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Add_Repeated_Field failed.\n");
+        return 1;
+    }
+
+    length = 0;
+
+    if (hypertext_Fetch_Joined_Field(instance, "Set-Cookie", 10, NULL, &length) != hypertext_Result_Unsupported || hypertext_Output_Response(instance, NULL, &length, true, true) != hypertext_Result_Success || length != sizeof(cookie_output) || hypertext_Output_Response(instance, cookie_output, &length, true, true) != hypertext_Result_Success || memcmp(cookie_output, cookies, length) != 0)
+    {
+        printf("Error: Set-Cookie fields were joined or not written one per line.\n");
+        return 1;
+    }
+
+    if (hypertext_Remove_Field(instance, "SET-COOKIE") != hypertext_Result_Success || hypertext_Fetch_Header_Field_Count(instance, &count) != hypertext_Result_Success || count != 0)
+    {
+        printf("Error: hypertext_Remove_Field didn't remove every occurrence.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    printf("Success.\n");
+
+    return 0;
+}
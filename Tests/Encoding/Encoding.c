@@ -0,0 +1,228 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <zlib.h>
+
+typedef struct
+{
+    const char* accept;
+    uint8_t     expected;
+} negotiation;
+
+const negotiation negotiations[] =
+{
+    { NULL,                             hypertext_Content_Encoding_Identity },
+    { "gzip, deflate, br",              hypertext_Content_Encoding_Gzip },
+    { "deflate;q=0.9, gzip;q=0.5",      hypertext_Content_Encoding_Deflate },
+    { "gzip;q=0, deflate;q=0",          hypertext_Content_Encoding_Identity },
+    { "*",                              hypertext_Content_Encoding_Gzip },
+    { "br, identity;q=1",               hypertext_Content_Encoding_Identity },
+    { "x-gzip;q=0.001, identity;q=0.5", hypertext_Content_Encoding_Identity },
+    { "x-gzip ; q=0.001",               hypertext_Content_Encoding_Gzip }
+};
+
+// Collects all pieces of an encoder and removes the chunked framing.
+static size_t collect(hypertext_Encoder* encoder, char* head, char* body)
+{
+    hypertext_View piece;
+    size_t head_length = 0, body_length = 0;
+
+    hypertext_Pull_Encoder(encoder, &piece);
+    memcpy(head, piece.data, piece.length);
+    head[piece.length] = 0;
+    head_length = piece.length;
+
+    char* framed = malloc(1 << 20);
+    size_t framed_length = 0;
+
+    while (hypertext_Pull_Encoder(encoder, &piece) == hypertext_Result_Success && piece.length != 0)
+    {
+        memcpy(framed + framed_length, piece.data, piece.length);
+        framed_length += piece.length;
+    }
+
+    if (strstr(head, "Transfer-Encoding: chunked") == NULL)
+    {
+        memcpy(body, framed, framed_length);
+        free(framed);
+        return framed_length;
+    }
+
+    for (size_t position = 0; position < framed_length;)
+    {
+        size_t size = strtoul(framed + position, NULL, 16);
+        position = (size_t)(strstr(framed + position, "\r\n") - framed) + 2;
+
+        memcpy(body + body_length, framed + position, size);
+        body_length     += size;
+        position        += size + 2;
+    }
+
+    free(framed);
+    (void)head_length;
+
+    return body_length;
+}
+
+int main()
+{
+    hypertext_Instance* instance = hypertext_New();
+
+    for (size_t i = 0; i != sizeof(negotiations) / sizeof(negotiation); i++)
+    {
+        hypertext_Header_Field field = { "Accept-Encoding", (char*)negotiations[i].accept };
+
+        hypertext_Create_Request(instance, hypertext_Method_GET, "/", 1, hypertext_HTTP_Version_1_1, &field, negotiations[i].accept != NULL ? 1 : 0, NULL, 0);
+
+        uint8_t encoding = hypertext_Content_Encoding_Max;
+        hypertext_Negotiate_Encoding(instance, &encoding);
+
+        if (encoding != negotiations[i].expected)
+        {
+            printf("Error: \"%s\" picked %d instead of %d.\n", negotiations[i].accept, encoding, negotiations[i].expected);
+            return 1;
+        }
+
+        hypertext_Destroy(instance);
+    }
+
+    // A body spanning several windows.
+    size_t text_length = 100000;
+    char* text = malloc(text_length);
+    for (size_t i = 0; i != text_length; i++) text[i] = "hypertext streams bodies in windows. "[i % 37] + (char)(i % 1009 == 0);
+
+    char* head = malloc(4096);
+    char* body = malloc(1 << 20);
+
+    hypertext_Header_Field fields[] = { { "Content-Type", "text/plain" }, { "Content-Length", "5" } };
+    hypertext_Encoder* encoder = hypertext_New_Encoder();
+
+    hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 2, text, text_length);
+
+    if (hypertext_Start_Encoder(encoder, instance, hypertext_Content_Encoding_Gzip, true, true) != hypertext_Result_Success)
+    {
+        printf("Error: Failed to start the encoder.\n");
+        return 1;
+    }
+
+    size_t body_length = collect(encoder, head, body);
+
+    if (strncmp(head, "HTTP/1.1 200 OK\r\n", 17) != 0 || strstr(head, "Content-Encoding: gzip\r\n") == NULL || strstr(head, "Vary: Accept-Encoding\r\n") == NULL || strstr(head, "Content-Length") != NULL || strcmp(head + strlen(head) - 4, "\r\n\r\n") != 0)
+    {
+        printf("Error: Unexpected head:\n%s\n", head);
+        return 1;
+    }
+    else if (body_length == 0 || body_length >= text_length / 4)
+    {
+        printf("Error: The compressed body has %zu bytes.\n", body_length);
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    // Decoding the output yields the original body again.
+    hypertext_Header_Field encoded[] = { { "Content-Encoding", "gzip" }, { "Content-Length", "0" }, { "Content-Type", "text/plain" } };
+    hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, encoded, 3, body, body_length);
+
+    size_t field_count = 0, length = 0;
+
+    if (hypertext_Decode_Body(instance, 0) != hypertext_Result_Success || hypertext_Fetch_Body(instance, NULL, &length) != hypertext_Result_Success || length != text_length || hypertext_Fetch_Body(instance, body, &length) != hypertext_Result_Success || memcmp(body, text, text_length) != 0)
+    {
+        printf("Error: The gzip body didn't decode into the original one.\n");
+        return 1;
+    }
+    else if (hypertext_Fetch_Header_Field_Count(instance, &field_count) != hypertext_Result_Success || field_count != 1)
+    {
+        printf("Error: Content-Encoding and Content-Length should be gone.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    // Raw deflate data is accepted as well, and the limit applies.
+    uLongf compressed_length = compressBound(text_length);
+    char* compressed = malloc(compressed_length);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+
+    stream.next_in      = (Bytef*)text;
+    stream.avail_in     = (uInt)text_length;
+    stream.next_out     = (Bytef*)compressed;
+    stream.avail_out    = (uInt)compressed_length;
+
+    deflate(&stream, Z_FINISH);
+    compressed_length = stream.total_out;
+    deflateEnd(&stream);
+
+    hypertext_Header_Field deflated = { "Content-Encoding", " deflate " };
+
+    hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, &deflated, 1, compressed, compressed_length);
+    if (hypertext_Decode_Body(instance, text_length - 1) != hypertext_Result_Out_Of_Memory || hypertext_Decode_Body(instance, text_length) != hypertext_Result_Success)
+    {
+        printf("Error: Raw deflate data or the limit didn't work.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    // Identity and HTTP/1.0 use Content-Length and a close-delimited body respectively.
+    hypertext_Create_Response(instance, hypertext_HTTP_Version_1_0, hypertext_Status_OK, fields, 2, text, text_length);
+
+    hypertext_Start_Encoder(encoder, instance, hypertext_Content_Encoding_Identity, true, true);
+    body_length = collect(encoder, head, body);
+
+    if (strstr(head, "Content-Length: 100000\r\n") == NULL || body_length != text_length || memcmp(body, text, text_length) != 0)
+    {
+        printf("Error: Identity output is wrong:\n%s\n", head);
+        return 1;
+    }
+
+    hypertext_Start_Encoder(encoder, instance, hypertext_Content_Encoding_Deflate, true, true);
+    body_length = collect(encoder, head, body);
+
+    uLongf inflated_length = text_length;
+    if (strstr(head, "Transfer-Encoding") != NULL || strstr(head, "Content-Length") != NULL || uncompress((Bytef*)compressed, &inflated_length, (Bytef*)body, body_length) != Z_OK || inflated_length != text_length)
+    {
+        printf("Error: HTTP/1.0 deflate output is wrong:\n%s\n", head);
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    hypertext_Destroy_Encoder(encoder);
+
+    free(instance);
+    free(encoder);
+    free(compressed);
+    free(text);
+    free(head);
+    free(body);
+
+    printf("Success.\n");
+    return 0;
+}
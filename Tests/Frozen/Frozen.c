@@ -0,0 +1,214 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define thread_count 4
+
+const char* request = "GET /some%20file?x=1&y=%41 HTTP/1.1\r\nHost: www.example.org\r\n\r\n";
+
+static bool equals(hypertext_View* view, const char* text)
+{
+    return view->length == strlen(text) && memcmp(view->data, text, view->length) == 0;
+}
+
+const char* full_response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\ncached";
+const char* head_response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 6\r\n\r\n";
+
+// Serializes the shared response over and over; any thread seeing another's output in progress fails.
+static bool output_shared(hypertext_Instance* shared)
+{
+    char output[128];
+
+    for (size_t i = 0; i != 2000; i++)
+    {
+        size_t length = 0;
+        if (hypertext_Output_Response(shared, NULL, &length, true, true) != hypertext_Result_Success || length != strlen(full_response) || hypertext_Output_Response(shared, output, &length, true, true) != hypertext_Result_Success || memcmp(output, full_response, length) != 0) return false;
+
+        length = 0;
+        if (hypertext_Output_Response_Head(shared, NULL, &length, true, true) != hypertext_Result_Success || length != strlen(head_response) || hypertext_Output_Response_Head(shared, output, &length, true, true) != hypertext_Result_Success || memcmp(output, head_response, length) != 0) return false;
+    }
+
+    return true;
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI output_thread(LPVOID argument)
+{
+    return output_shared(argument) ? 0 : 1;
+}
+#else
+static void* output_thread(void* argument)
+{
+    return output_shared(argument) ? NULL : argument;
+}
+#endif
+
+// Frozen instances are documented as safe to output from many threads at once.
+static bool output_from_threads(hypertext_Instance* shared)
+{
+    bool succeeded = true;
+
+#if defined(_WIN32)
+    HANDLE threads[thread_count];
+    for (size_t i = 0; i != thread_count; i++) threads[i] = CreateThread(NULL, 0, output_thread, shared, 0, NULL);
+
+    for (size_t i = 0; i != thread_count; i++)
+    {
+        DWORD code = 1;
+
+        WaitForSingleObject(threads[i], INFINITE);
+        GetExitCodeThread(threads[i], &code);
+        CloseHandle(threads[i]);
+
+        if (code != 0) succeeded = false;
+    }
+#else
+    pthread_t threads[thread_count];
+    for (size_t i = 0; i != thread_count; i++) pthread_create(&threads[i], NULL, output_thread, shared);
+
+    for (size_t i = 0; i != thread_count; i++)
+    {
+        void* failed = NULL;
+
+        pthread_join(threads[i], &failed);
+        if (failed != NULL) succeeded = false;
+    }
+#endif
+
+    return succeeded;
+}
+
+int main()
+{
+    hypertext_Instance* instance = hypertext_New();
+    uint8_t result = hypertext_Parse_Request(instance, request, 0);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed; code %d.\n", result);
+        return 1;
+    }
+
+    hypertext_Frozen* frozen = NULL;
+    result = hypertext_Freeze(instance, false, true, &frozen);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Freeze failed; code %d.\n", result);
+        return 1;
+    }
+
+    // The frozen copy doesn't depend on the original in any way.
+    hypertext_Destroy(instance);
+    free(instance);
+
+    hypertext_View view;
+    if (hypertext_Fetch_Frozen_Output(frozen, &view) != hypertext_Result_Success || !equals(&view, request))
+    {
+        printf("Error: The frozen output doesn't match.\n");
+        return 1;
+    }
+
+    hypertext_Instance* shared = NULL;
+    hypertext_Fetch_Frozen_Instance(frozen, &shared);
+
+    if (hypertext_Fetch_Decoded_Target_Component(shared, hypertext_Target_Component_Path, &view) != hypertext_Result_Success || !equals(&view, "/some file"))
+    {
+        printf("Error: The frozen path wasn't decoded.\n");
+        return 1;
+    }
+
+    size_t index = 0;
+    hypertext_Parameter parameter;
+    if (hypertext_Find_Parameter(shared, hypertext_Parameter_Source_Query, "y", 1, &index) != hypertext_Result_Success || hypertext_Fetch_Parameter(shared, hypertext_Parameter_Source_Query, index, &parameter) != hypertext_Result_Success || !equals(&parameter.value, "%41"))
+    {
+        printf("Error: The frozen query parameters don't match.\n");
+        return 1;
+    }
+
+    hypertext_Header_Field field;
+    if (hypertext_Fetch_Header_Field(shared, &field, "Host") != hypertext_Result_Success || strcmp(field.value, "www.example.org") != 0)
+    {
+        printf("Error: The frozen header field doesn't match.\n");
+        return 1;
+    }
+
+    if (hypertext_Set_Path(shared, "/", 1) != hypertext_Result_Invalid_Instance || hypertext_Set_Version(shared, hypertext_HTTP_Version_1_0) != hypertext_Result_Invalid_Instance)
+    {
+        printf("Error: A frozen instance was modified.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(shared);
+    if (hypertext_Fetch_Header_Field(shared, &field, "Host") != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Destroy emptied a frozen instance.\n");
+        return 1;
+    }
+
+    hypertext_Release_Frozen(frozen);
+
+    instance = hypertext_New();
+    hypertext_Header_Field fields[] = { { "Content-Type", "text/plain" } };
+    hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 1, "cached", 6);
+
+    result = hypertext_Freeze(instance, true, true, &frozen);
+    hypertext_Destroy(instance);
+    free(instance);
+
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Freezing a response failed; code %d.\n", result);
+        return 1;
+    }
+
+    hypertext_Frozen* second = hypertext_Acquire_Frozen(frozen);
+    hypertext_Release_Frozen(frozen);
+
+    if (hypertext_Fetch_Frozen_Output(second, &view) != hypertext_Result_Success || !equals(&view, full_response))
+    {
+        printf("Error: The frozen response doesn't match.\n");
+        return 1;
+    }
+
+    hypertext_Fetch_Frozen_Instance(second, &shared);
+
+    if (!output_from_threads(shared))
+    {
+        printf("Error: Outputting a frozen response from several threads at once didn't give the same output.\n");
+        return 1;
+    }
+
+    hypertext_Release_Frozen(second);
+
+    printf("Success.\n");
+    return 0;
+}
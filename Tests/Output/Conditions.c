@@ -0,0 +1,143 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    const char* request;
+    uint16_t    code;
+} case_t;
+
+const case_t cases[] =
+{
+    { "GET / HTTP/1.1\r\n\r\n",                                                                 0 },
+    { "GET / HTTP/1.1\r\nIf-None-Match: \"v2\"\r\n\r\n",                                        hypertext_Status_Not_Modified },
+    { "GET / HTTP/1.1\r\nIf-None-Match: W/\"v2\"\r\n\r\n",                                      hypertext_Status_Not_Modified },
+    { "GET / HTTP/1.1\r\nIf-None-Match: \"v1\", \"v,3\"\r\n\r\n",                               0 },
+    { "HEAD / HTTP/1.1\r\nIf-None-Match: *\r\n\r\n",                                            hypertext_Status_Not_Modified },
+    { "PUT / HTTP/1.1\r\nIf-None-Match: *\r\n\r\n",                                             hypertext_Status_Precondition_Failed },
+    { "PUT / HTTP/1.1\r\nIf-Match: \"v1\", \"v2\"\r\n\r\n",                                     0 },
+    { "PUT / HTTP/1.1\r\nIf-Match: W/\"v2\"\r\n\r\n",                                           hypertext_Status_Precondition_Failed },
+    { "PUT / HTTP/1.1\r\nIf-Match: \"v1\"\r\n\r\n",                                             hypertext_Status_Precondition_Failed },
+    { "GET / HTTP/1.1\r\nIf-Match: \"v1\"\r\nIf-None-Match: \"v2\"\r\n\r\n",                    hypertext_Status_Precondition_Failed },
+    { "GET / HTTP/1.1\r\nIf-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n",             hypertext_Status_Not_Modified },
+    { "GET / HTTP/1.1\r\nIf-Modified-Since: Sat, 05 Nov 1994 08:49:37 GMT\r\n\r\n",             0 },
+    { "GET / HTTP/1.1\r\nIf-Modified-Since: yesterday\r\n\r\n",                                 0 },
+    { "POST / HTTP/1.1\r\nIf-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n",            0 },
+    { "GET / HTTP/1.1\r\nIf-None-Match: \"v1\"\r\nIf-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n", 0 },
+    { "PUT / HTTP/1.1\r\nIf-Unmodified-Since: Sat, 05 Nov 1994 08:49:37 GMT\r\n\r\n",           hypertext_Status_Precondition_Failed },
+    { "PUT / HTTP/1.1\r\nIf-Unmodified-Since: Mon, 07 Nov 1994 08:49:37 GMT\r\n\r\n",           0 },
+    { "PUT / HTTP/1.1\r\nIf-Match: \"v2\"\r\nIf-Unmodified-Since: Sat, 05 Nov 1994 08:49:37 GMT\r\n\r\n", 0 }
+};
+
+const char* entity_tag    = "\"v2\"";
+const char* last_modified = "Sun, 06 Nov 1994 08:49:37 GMT";
+
+char* output_response(hypertext_Instance* instance)
+{
+    size_t length = 0;
+    if (hypertext_Output_Response(instance, NULL, &length, true, true) != hypertext_Result_Success) return NULL;
+
+    char* output = calloc(length + 1, sizeof(char));
+    if (hypertext_Output_Response(instance, output, &length, true, true) != hypertext_Result_Success)
+    {
+        free(output);
+        return NULL;
+    }
+
+    return output;
+}
+
+int main()
+{
+    for (size_t i = 0; i != sizeof(cases) / sizeof(case_t); i++)
+    {
+        hypertext_Instance* request = hypertext_New();
+        uint8_t result = hypertext_Parse_Request(request, cases[i].request, 0);
+        if (result != hypertext_Result_Success)
+        {
+            printf("Error: hypertext_Parse_Request failed for case %zu; code %d.\n", i, result);
+            return 1;
+        }
+
+        uint16_t code = 1;
+        result = hypertext_Evaluate_Conditions(request, entity_tag, last_modified, &code);
+        if (result != hypertext_Result_Success || code != cases[i].code)
+        {
+            printf("Error: Case %zu evaluated to %d instead of %d; code %d.\n", i, code, cases[i].code, result);
+            return 1;
+        }
+
+        hypertext_Destroy(request);
+        free(request);
+    }
+
+    const char* expected[] =
+    {
+        "HTTP/1.1 304 Not Modified\r\nETag: \"v2\"\r\nLast-Modified: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n",
+        "HTTP/1.1 412 Precondition Failed\r\nContent-Length: 0\r\n\r\n"
+    };
+    const uint16_t codes[] = { hypertext_Status_Not_Modified, hypertext_Status_Precondition_Failed };
+
+    hypertext_Instance* request = hypertext_New();
+    hypertext_Parse_Request(request, cases[1].request, 0);
+
+    for (size_t i = 0; i != 2; i++)
+    {
+        hypertext_Instance* response = hypertext_New();
+        uint8_t result = hypertext_Create_Conditional_Response(response, request, codes[i], entity_tag, last_modified);
+        if (result != hypertext_Result_Success)
+        {
+            printf("Error: hypertext_Create_Conditional_Response failed; code %d.\n", result);
+            return 1;
+        }
+
+        char* output = output_response(response);
+        if (output == NULL || strcmp(output, expected[i]) != 0)
+        {
+            printf("Error: The %d response doesn't match:\n%s\n", codes[i], output != NULL ? output : "(null)");
+            return 1;
+        }
+
+        free(output);
+        hypertext_Destroy(response);
+        free(response);
+    }
+
+    hypertext_Instance* response = hypertext_New();
+    if (hypertext_Create_Conditional_Response(response, request, hypertext_Status_OK, entity_tag, last_modified) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: A 200 was accepted as a conditional response.\n");
+        return 1;
+    }
+
+    free(response);
+    hypertext_Destroy(request);
+    free(request);
+
+    printf("Success.\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    const char* input;
+    uint8_t     result;
+    uint64_t    time;
+} case_t;
+
+const case_t cases[] =
+{
+    { "Sun, 06 Nov 1994 08:49:37 GMT",  hypertext_Result_Success,               784111777 },
+    { "Sunday, 06-Nov-94 08:49:37 GMT", hypertext_Result_Success,               784111777 },
+    { "Sun Nov  6 08:49:37 1994",       hypertext_Result_Success,               784111777 },
+    { "Wed, 21 Oct 2015 07:28:00 GMT",  hypertext_Result_Success,               1445412480 },
+    { "Tue, 29 Feb 2000 00:00:00 GMT",  hypertext_Result_Success,               951782400 },
+    { "Wednesday, 01-Jan-30 00:00:00 GMT", hypertext_Result_Success,            1893456000 },
+    { "Thu Jan 01 00:00:00 1970",       hypertext_Result_Success,               0 },
+    { "Thu, 29 Feb 2001 00:00:00 GMT",  hypertext_Result_Invalid_Parameters,    0 },
+    { "Sun, 06 Nov 1994 08:49:37 UTC",  hypertext_Result_Invalid_Parameters,    0 },
+    { "Sun, 06 Nov 1994 24:00:00 GMT",  hypertext_Result_Invalid_Parameters,    0 },
+    { "Sun, 6 Nov 1994 08:49:37 GMT",   hypertext_Result_Invalid_Parameters,    0 },
+    { "Sun, 06 Nev 1994 08:49:37 GMT",  hypertext_Result_Invalid_Parameters,    0 },
+    { "Mon, 01 Jan 1900 00:00:00 GMT",  hypertext_Result_Invalid_Parameters,    0 },
+    { "Sun Nov  6 08:49:37 94",         hypertext_Result_Invalid_Parameters,    0 },
+    { "1994-11-06T08:49:37Z",           hypertext_Result_Invalid_Parameters,    0 }
+};
+
+int main()
+{
+    for (size_t i = 0; i != sizeof(cases) / sizeof(case_t); i++)
+    {
+        uint64_t time = 0;
+        uint8_t result = hypertext_Parse_Date(cases[i].input, strlen(cases[i].input), &time);
+
+        if (result != cases[i].result || time != cases[i].time)
+        {
+            printf("Error: Parsing \"%s\" returned %d and %llu.\n", cases[i].input, result, (unsigned long long)time);
+            return 1;
+        }
+    }
+
+    char output[30];
+    if (hypertext_Format_Date(784111777, output) != hypertext_Result_Success || strcmp(output, "Sun, 06 Nov 1994 08:49:37 GMT") != 0)
+    {
+        printf("Error: hypertext_Format_Date output \"%s\".\n", output);
+        return 1;
+    }
+    else if (hypertext_Format_Date(253402300800ULL, output) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: The year 10000 was formatted.\n");
+        return 1;
+    }
+
+    // Every formatted date has to parse back to the same time.
+    for (uint64_t time = 0; time < 253402300800ULL; time += 86400 * 17 + 3917)
+    {
+        uint64_t parsed = 0;
+
+        hypertext_Format_Date(time, output);
+        if (hypertext_Parse_Date(output, strlen(output), &parsed) != hypertext_Result_Success || parsed != time)
+        {
+            printf("Error: \"%s\" doesn't round-trip to %llu.\n", output, (unsigned long long)time);
+            return 1;
+        }
+    }
+
+    hypertext_View view;
+    uint64_t now = (uint64_t)time(NULL), current = 0;
+
+    if (hypertext_Fetch_Current_Date(&view) != hypertext_Result_Success || hypertext_Parse_Date(view.data, view.length, &current) != hypertext_Result_Success || current < now || current > now + 1)
+    {
+        printf("Error: hypertext_Fetch_Current_Date doesn't match the current time.\n");
+        return 1;
+    }
+
+    printf("Success.\n");
+    return 0;
+}
@@ -0,0 +1,174 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+const char contents[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+int check_sent(int descriptor, const char* expected, size_t length)
+{
+    char received[512] = { 0 };
+    size_t total = 0;
+
+    while (total != length)
+    {
+        ssize_t result = read(descriptor, received + total, sizeof(received) - total);
+        if (result <= 0) return 1;
+
+        total += (size_t)result;
+    }
+
+    return memcmp(received, expected, length) != 0;
+}
+
+int main()
+{
+    FILE* file = tmpfile();
+    if (file == NULL || fwrite(contents, 1, sizeof(contents) - 1, file) != sizeof(contents) - 1 || fflush(file) != 0)
+    {
+        printf("Error: Couldn't create the temporary file.\n");
+        return 1;
+    }
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    {
+        printf("Error: Couldn't create the socket pair.\n");
+        return 1;
+    }
+
+    hypertext_Instance* instance = hypertext_New();
+    hypertext_Header_Field fields[] =
+    {
+        { "Content-Type",   "text/plain" },
+        { "Content-Length", "1000" }
+    };
+
+    uint8_t result = hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 2, NULL, 0);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Creating the response failed with %d.\n", result);
+        return 1;
+    }
+
+    result = hypertext_Set_Body_File(instance, fileno(file), 10, 16);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Setting the file body failed with %d.\n", result);
+        return 1;
+    }
+
+    size_t length = 0;
+    result = hypertext_Output_Response_Head(instance, NULL, &length, true, true);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Measuring the head failed with %d.\n", result);
+        return 1;
+    }
+
+    char* head = calloc(length + 1, sizeof(char));
+    result = hypertext_Output_Response_Head(instance, head, &length, true, true);
+    if (result != hypertext_Result_Success || strstr(head, "Content-Length: 16\r\n") == NULL || strstr(head, "1000") != NULL || strstr(head, "abcdef") != NULL)
+    {
+        printf("Error: The head doesn't match (%d).\n%s\n", result, head);
+        return 1;
+    }
+
+    free(head);
+
+    size_t offset = 0;
+    result = hypertext_Send_Body(instance, sockets[0], &offset);
+    if (result != hypertext_Result_Success || offset != 16 || check_sent(sockets[1], "abcdefghijklmnop", 16))
+    {
+        printf("Error: Sending the file body failed with %d after %zu bytes.\n", result, offset);
+        return 1;
+    }
+
+    char body[16];
+    length = sizeof(body);
+    result = hypertext_Fetch_Body(instance, body, &length);
+    if (result != hypertext_Result_Success || memcmp(body, "abcdefghijklmnop", 16) != 0)
+    {
+        printf("Error: Fetching the file body failed with %d.\n", result);
+        return 1;
+    }
+
+    result = hypertext_Set_Body(instance, "memory", 6);
+    offset = 2;
+    if (result == hypertext_Result_Success) result = hypertext_Send_Body(instance, sockets[0], &offset);
+    if (result != hypertext_Result_Success || offset != 6 || check_sent(sockets[1], "mory", 4))
+    {
+        printf("Error: Resuming a memory body failed with %d.\n", result);
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    instance = hypertext_New();
+    hypertext_Range ranges[] = { { 0, 1 }, { 20, 25 } };
+
+    result = hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 1, NULL, 0);
+    if (result == hypertext_Result_Success) result = hypertext_Set_Body_File(instance, fileno(file), 10, 26);
+    if (result == hypertext_Result_Success) result = hypertext_Set_Ranges(instance, ranges, 2);
+
+    char ranged[512] = { 0 };
+    length = sizeof(ranged);
+    if (result == hypertext_Result_Success) result = hypertext_Fetch_Body(instance, ranged, &length);
+    if (result != hypertext_Result_Success || strstr(ranged, "\r\n\r\nab\r\n--") == NULL || strstr(ranged, "\r\n\r\nuvwxyz\r\n--") == NULL)
+    {
+        printf("Error: Reading the ranged file body failed with %d.\n%s\n", result, ranged);
+        return 1;
+    }
+
+    length = strlen(ranged);
+    offset = 0;
+    result = hypertext_Send_Body(instance, sockets[0], &offset);
+    if (result != hypertext_Result_Success || offset != length || check_sent(sockets[1], ranged, length))
+    {
+        printf("Error: Sending the ranged file body failed with %d after %zu bytes.\n", result, offset);
+        return 1;
+    }
+
+    if (hypertext_Set_Body_File(instance, -1, 0, 16) != hypertext_Result_Invalid_Parameters)
+    {
+        printf("Error: An invalid descriptor was accepted.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    close(sockets[0]);
+    close(sockets[1]);
+    fclose(file);
+
+    printf("Success.\n");
+    return 0;
+}
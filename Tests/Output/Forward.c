@@ -0,0 +1,196 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Joins the pieces of a forwarded message; returns NULL if fetching them fails.
+char* output_forward(hypertext_Instance* instance, size_t* pieces)
+{
+    size_t count = 0;
+    if (hypertext_Output_Forward(instance, NULL, &count) != hypertext_Result_Success) return NULL;
+
+    hypertext_View* views = calloc(count + 1, sizeof(hypertext_View));
+    if (hypertext_Output_Forward(instance, views, &count) != hypertext_Result_Success)
+    {
+        free(views);
+        return NULL;
+    }
+
+    size_t length = 0;
+    for (size_t i = 0; i != count; i++) length += views[i].length;
+
+    char* output = calloc(length + 1, sizeof(char));
+    for (size_t i = 0, position = 0; i != count; i++)
+    {
+        memcpy(output + position, views[i].data, views[i].length);
+        position += views[i].length;
+    }
+
+    free(views);
+    if (pieces != NULL) *pieces = count;
+
+    return output;
+}
+
+int main()
+{
+    const char* input =
+        "\r\nPOST /old?x=1 HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Connection: keep-alive, X-Hop, Content-Length\r\n"
+        "X-Hop: 1\r\n"
+        "Accept: */*\r\n"
+        "Keep-Alive: timeout=5\r\n"
+        "Cookie: a=1\r\n"
+        "Cookie: b=2\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello"
+        "GET /next HTTP/1.1\r\n\r\n";
+
+    hypertext_Instance* instance = hypertext_New();
+    size_t consumed = 0, pieces = 0;
+
+    uint8_t result = hypertext_Parse_Request_Forward(instance, input, strlen(input), &consumed);
+    if (result != hypertext_Result_Success)
+    {
+        printf("Error: Parsing the request for forwarding failed (%u).\n", result);
+        return 1;
+    }
+    else if (consumed != strlen(input) - strlen("GET /next HTTP/1.1\r\n\r\n"))
+    {
+        printf("Error: Forwarding consumed %zu characters.\n", consumed);
+        return 1;
+    }
+
+    // Without any edits, the message goes out as a single piece pointing at the input.
+    hypertext_View view;
+    size_t count = 1;
+    if (hypertext_Output_Forward(instance, &view, &count) != hypertext_Result_Success || count != 1 || view.data != input + 2 || view.length != consumed - 2)
+    {
+        printf("Error: An untouched message wasn't passed on as it was.\n");
+        return 1;
+    }
+
+    if (hypertext_Strip_Hop_Fields(instance) != hypertext_Result_Success)
+    {
+        printf("Error: Stripping hop-by-hop fields failed.\n");
+        return 1;
+    }
+
+    hypertext_Header_Field via = { "Via", "1.1 proxy" };
+    hypertext_Header_Field cookie = { "cookie", "c=3" };
+    hypertext_Header_Field accept = { "Accept", "text/html" };
+    hypertext_Header_Field added = { "X-Forwarded-For", "192.0.2.1" };
+
+    if (hypertext_Add_Field(instance, &via) != hypertext_Result_Success || hypertext_Add_Repeated_Field(instance, &(hypertext_Header_Field){ "via", "1.1 edge" }) != hypertext_Result_Success || hypertext_Set_Field(instance, &cookie) != hypertext_Result_Success || hypertext_Remove_Field(instance, "accept") != hypertext_Result_Success || hypertext_Add_Field(instance, &accept) != hypertext_Result_Success || hypertext_Add_Field(instance, &added) != hypertext_Result_Success || hypertext_Remove_Field(instance, "X-Forwarded-For") != hypertext_Result_Success || hypertext_Set_Path(instance, "/new", 4) != hypertext_Result_Success)
+    {
+        printf("Error: Editing the forwarded request failed.\n");
+        return 1;
+    }
+
+    const char* expected =
+        "POST /new HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "Cookie: c=3\r\n"
+        "Content-Length: 5\r\n"
+        "Via: 1.1 proxy\r\n"
+        "Via: 1.1 edge\r\n"
+        "Accept: text/html\r\n"
+        "\r\n"
+        "hello";
+
+    char* output = output_forward(instance, &pieces);
+    if (output == NULL || strcmp(output, expected) != 0)
+    {
+        printf("Error: The forwarded request doesn't match:\n%s\n", output != NULL ? output : "(none)");
+        return 1;
+    }
+
+    free(output);
+
+    // The instance itself sees the same edits.
+    hypertext_Field field;
+    if (hypertext_Fetch_Field(instance, "Cookie", 6, &field) != hypertext_Result_Success || field.value.length != 3 || memcmp(field.value.data, "c=3", 3) != 0 || hypertext_Fetch_Field(instance, "X-Hop", 5, &field) != hypertext_Result_Not_Found)
+    {
+        printf("Error: The instance's fields don't match the forwarded request.\n");
+        return 1;
+    }
+
+    if (hypertext_Set_Body(instance, "other", 5) != hypertext_Result_Unsupported || hypertext_Set_Method(instance, hypertext_Method_PUT) != hypertext_Result_Unsupported)
+    {
+        printf("Error: The body or method of a forwarded request could be changed.\n");
+        return 1;
+    }
+
+    count = 1;
+    if (hypertext_Output_Forward(instance, &view, &count) != hypertext_Result_Invalid_Parameters || count != pieces)
+    {
+        printf("Error: Too little room for the pieces wasn't reported.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    // Responses keep their status line and chunked bodies untouched; bare line feeds stay as they are.
+    const char* response_input = "HTTP/1.1 200 OK\nTransfer-Encoding: chunked\nUpgrade: h2c\nServer: origin\n\n5\r\nhello\r\n0\r\n\r\n";
+
+    result = hypertext_Parse_Response_Forward(instance, response_input, strlen(response_input), &consumed);
+    if (result != hypertext_Result_Success || consumed != strlen(response_input))
+    {
+        printf("Error: Parsing the response for forwarding failed (%u).\n", result);
+        return 1;
+    }
+
+    hypertext_Header_Field server = { "Server", "proxy" };
+    if (hypertext_Strip_Hop_Fields(instance) != hypertext_Result_Success || hypertext_Set_Field(instance, &server) != hypertext_Result_Success || hypertext_Set_Code(instance, 404) != hypertext_Result_Unsupported)
+    {
+        printf("Error: Editing the forwarded response failed.\n");
+        return 1;
+    }
+
+    output = output_forward(instance, NULL);
+    if (output == NULL || strcmp(output, "HTTP/1.1 200 OK\nTransfer-Encoding: chunked\nServer: proxy\r\n\n5\r\nhello\r\n0\r\n\r\n") != 0)
+    {
+        printf("Error: The forwarded response doesn't match:\n%s\n", output != NULL ? output : "(none)");
+        return 1;
+    }
+
+    free(output);
+    hypertext_Destroy(instance);
+
+    // Instances that weren't parsed for forwarding have nothing to pass on.
+    if (hypertext_Parse_Request_Buffer(instance, "GET / HTTP/1.1\r\n\r\n", 18, NULL) != hypertext_Result_Success || hypertext_Output_Forward(instance, NULL, &count) != hypertext_Result_Unsupported)
+    {
+        printf("Error: Forwarding an instance that wasn't parsed for it didn't fail.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    printf("Success.\n");
+    return 0;
+}
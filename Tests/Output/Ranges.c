@@ -0,0 +1,208 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    uint8_t         method;
+    const char*     range;
+    const char*     condition;
+    uint64_t        size;
+    size_t          capacity;
+    uint8_t         result;
+    size_t          count;
+    hypertext_Range ranges[3];
+} case_t;
+
+const case_t cases[] =
+{
+    { hypertext_Method_GET,  "bytes=0-9, 500-509, -10",  NULL,           1000,   4, hypertext_Result_Success,            3, { { 0, 9 }, { 500, 509 }, { 990, 999 } } },
+    { hypertext_Method_GET,  "bytes=500-509,0-4,3-9",    NULL,           1000,   4, hypertext_Result_Success,            2, { { 0, 9 }, { 500, 509 } } },
+    { hypertext_Method_GET,  "bytes=0-1,50-51",          NULL,           1000,   4, hypertext_Result_Success,            1, { { 0, 51 } } },
+    { hypertext_Method_GET,  "bytes=-100",               NULL,           36,     4, hypertext_Result_Success,            1, { { 0, 35 } } },
+    { hypertext_Method_GET,  "bytes=30-",                NULL,           36,     4, hypertext_Result_Success,            1, { { 30, 35 } } },
+    { hypertext_Method_GET,  "bytes=30-99999999999999999999", NULL,      36,     4, hypertext_Result_Success,            1, { { 30, 35 } } },
+    { hypertext_Method_GET,  "bytes=50-60, -0",          NULL,           36,     4, hypertext_Result_Not_Satisfiable,    0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=5-2",                NULL,           36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=1-2;3",              NULL,           36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "items=0-1",                NULL,           36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=,",                  NULL,           36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=0-0,200-200,400-400", NULL,          1000,   2, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_POST, "bytes=0-1",                NULL,           36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=0-1",                "\"v1\"",       36,     4, hypertext_Result_Success,            1, { { 0, 1 } } },
+    { hypertext_Method_GET,  "bytes=0-1",                "\"v2\"",       36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=0-1",                "W/\"v1\"",     36,     4, hypertext_Result_Success,            0, { { 0, 0 } } },
+    { hypertext_Method_GET,  "bytes=0-1",                "Mon, 21 Oct 2013 20:13:21 GMT", 36, 4, hypertext_Result_Success, 1, { { 0, 1 } } }
+};
+
+const char body[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+hypertext_Instance* create_response()
+{
+    hypertext_Instance* instance = hypertext_New();
+    hypertext_Header_Field fields[] =
+    {
+        { "Content-Type",   "text/plain" },
+        { "Content-Length", "36" }
+    };
+
+    if (hypertext_Create_Response(instance, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 2, body, sizeof(body) - 1) != hypertext_Result_Success) return NULL;
+
+    return instance;
+}
+
+char* output_response(hypertext_Instance* instance)
+{
+    size_t length = 0;
+    if (hypertext_Output_Response(instance, NULL, &length, false, true) != hypertext_Result_Success) return NULL;
+
+    char* output = calloc(length + 1, sizeof(char));
+    if (hypertext_Output_Response(instance, output, &length, false, true) != hypertext_Result_Success)
+    {
+        free(output);
+        return NULL;
+    }
+
+    return output;
+}
+
+int main()
+{
+    for (size_t i = 0; i != sizeof(cases) / sizeof(case_t); i++)
+    {
+        hypertext_Header_Field fields[] =
+        {
+            { "Range",      (char*)cases[i].range },
+            { "If-Range",   (char*)cases[i].condition }
+        };
+
+        hypertext_Instance* request = hypertext_New();
+        uint8_t result = hypertext_Create_Request(request, cases[i].method, "/", 1, hypertext_HTTP_Version_1_1, fields, cases[i].condition != NULL ? 2 : 1, NULL, 0);
+        if (result != hypertext_Result_Success)
+        {
+            printf("Error: Creating request %zu failed with %d.\n", i, result);
+            return 1;
+        }
+
+        hypertext_Range ranges[4];
+        size_t count = cases[i].capacity;
+
+        result = hypertext_Fetch_Ranges(request, cases[i].size, "\"v1\"", "Mon, 21 Oct 2013 20:13:21 GMT", ranges, &count);
+        if (result != cases[i].result || count != cases[i].count)
+        {
+            printf("Error: \"%s\" returned %d with %zu ranges.\n", cases[i].range, result, count);
+            return 1;
+        }
+
+        for (size_t j = 0; j != count; j++) if (ranges[j].first != cases[i].ranges[j].first || ranges[j].last != cases[i].ranges[j].last)
+        {
+            printf("Error: Range %zu of \"%s\" is %llu-%llu.\n", j, cases[i].range, (unsigned long long)ranges[j].first, (unsigned long long)ranges[j].last);
+            return 1;
+        }
+
+        hypertext_Destroy(request);
+        free(request);
+    }
+
+    hypertext_Instance* response = create_response();
+    hypertext_Range single = { 10, 15 };
+
+    uint8_t result = hypertext_Set_Ranges(response, &single, 1);
+    char* output = output_response(response);
+    if (result != hypertext_Result_Success || output == NULL || strcmp(output, "HTTP/1.1 206\r\nContent-Type: text/plain\r\nContent-Range: bytes 10-15/36\r\n\r\nabcdef") != 0)
+    {
+        printf("Error: The single range response doesn't match (%d).\n%s\n", result, output);
+        return 1;
+    }
+
+    free(output);
+
+    if (hypertext_Set_Ranges(response, &single, 1) != hypertext_Result_Already_Present)
+    {
+        printf("Error: Ranges were applied twice.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(response);
+    free(response);
+
+    response = create_response();
+    hypertext_Range multiple[] = { { 0, 1 }, { 30, 35 } };
+
+    result = hypertext_Set_Ranges(response, multiple, 2);
+
+    hypertext_Segment segments[8];
+    size_t count = 8;
+    if (result == hypertext_Result_Success) result = hypertext_Fetch_Segments(response, segments, &count);
+    if (result != hypertext_Result_Success || count != 5 || segments[1].length != 2 || memcmp(segments[1].data, "01", 2) != 0 || segments[3].length != 6 || memcmp(segments[3].data, "uvwxyz", 6) != 0)
+    {
+        printf("Error: The multipart segments don't match (%d, %zu).\n", result, count);
+        return 1;
+    }
+
+    hypertext_Header_Field type;
+    result = hypertext_Fetch_Header_Field(response, &type, "Content-Type");
+    if (result != hypertext_Result_Success || strncmp(type.value, "multipart/byteranges; boundary=", 31) != 0)
+    {
+        printf("Error: The multipart type doesn't match (%d).\n", result);
+        return 1;
+    }
+
+    const char* boundary = type.value + 31;
+    char expected[512];
+    snprintf(expected, sizeof(expected), "--%s\r\nContent-Type: text/plain\r\nContent-Range: bytes 0-1/36\r\n\r\n01\r\n--%s\r\nContent-Type: text/plain\r\nContent-Range: bytes 30-35/36\r\n\r\nuvwxyz\r\n--%s--\r\n", boundary, boundary, boundary);
+
+    size_t length = 0;
+    hypertext_Fetch_Body(response, NULL, &length);
+
+    char* content = calloc(length + 1, sizeof(char));
+    result = hypertext_Fetch_Body(response, content, &length);
+    if (result != hypertext_Result_Success || strcmp(content, expected) != 0)
+    {
+        printf("Error: The multipart body doesn't match (%d).\n%s\n", result, content);
+        return 1;
+    }
+
+    free(content);
+    hypertext_Destroy(response);
+    free(response);
+
+    response = create_response();
+    result = hypertext_Set_Ranges(response, NULL, 0);
+    output = output_response(response);
+    if (result != hypertext_Result_Success || output == NULL || strcmp(output, "HTTP/1.1 416\r\nContent-Type: text/plain\r\nContent-Range: bytes */36\r\n\r\n") != 0)
+    {
+        printf("Error: The unsatisfiable response doesn't match (%d).\n%s\n", result, output);
+        return 1;
+    }
+
+    free(output);
+    hypertext_Destroy(response);
+    free(response);
+
+    printf("Success.\n");
+    return 0;
+}
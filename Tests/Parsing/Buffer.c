@@ -0,0 +1,232 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char pipeline[] =
+    "\r\n"
+    "POST /upload HTTP/1.1\r\nHost: example.org\r\nContent-Length: 5\r\nAccept: a\r\naccept:  b \r\n\r\nhello"
+    "PUT /chunks HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n4;name=value\r\nWiki\r\n5\r\npedia\r\n0\r\nTrailer: x\r\n\r\n"
+    "GET /last HTTP/1.0\n\n";
+
+const char responses[] =
+    "HTTP/1.1 100 Continue\r\n\r\n"
+    "HTTP/1.1 204\r\nContent-Length: 10\r\n\r\n"
+    "HTTP/1.1 200 OK\r\nContent-Length: 3, 3\r\n\r\nabc"
+    "HTTP/1.0 200 OK\r\n\r\nuntil the end";
+
+const char* invalid[] =
+{
+    "GET /\r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / HTTP/1.1\r\n folded: line\r\n\r\n",
+    "GET / HTTP/1.1\r\nNo colon\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 1, 2\r\n\r\nab",
+    "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nz\r\n",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n0\r\n\r\n",
+    "GET / HTTP/1.1\r\nX-Split: a\rContent-Length: 5\r\n\r\nhello"
+};
+
+const char lazy[] =
+    "GET /health HTTP/1.1\r\nHost: example.org\r\nAccept: a\r\naccept: b\r\n\r\n"
+    "POST /form HTTP/1.1\r\ncontent-length: 3\r\n\r\na=1"
+    "GET / HTTP/1.1\r\n\r\n";
+
+int check_body(hypertext_Instance* instance, const char* expected)
+{
+    size_t length = 0;
+    uint8_t result = hypertext_Fetch_Body(instance, NULL, &length);
+
+    if (expected == NULL) return result != hypertext_Result_No_Body;
+    else if (result != hypertext_Result_Success || length != strlen(expected)) return 1;
+
+    char body[64] = { 0 };
+    hypertext_Fetch_Body(instance, body, &length);
+
+    return strcmp(body, expected) != 0;
+}
+
+int main()
+{
+    hypertext_Instance* instance = hypertext_New();
+    const char* bodies[] = { "hello", "Wikipedia", NULL };
+    size_t position = 0;
+
+    for (size_t i = 0; i != 3; i++)
+    {
+        // Every cut before the end of the message has to ask for more input.
+        size_t consumed = 0;
+        for (size_t cut = 0; position + cut < sizeof(pipeline) - 1; cut++)
+        {
+            uint8_t result = hypertext_Parse_Request_Buffer(instance, pipeline + position, cut, &consumed);
+            if (result == hypertext_Result_Success) break;
+            else if (result != hypertext_Result_Incomplete)
+            {
+                printf("Error: Request %zu cut after %zu characters returned %d.\n", i, cut, result);
+                return 1;
+            }
+        }
+
+        hypertext_Destroy(instance);
+
+        uint8_t result = hypertext_Parse_Request_Buffer(instance, pipeline + position, sizeof(pipeline) - 1 - position, &consumed);
+        if (result != hypertext_Result_Success || check_body(instance, bodies[i]))
+        {
+            printf("Error: Request %zu returned %d or has the wrong body.\n", i, result);
+            return 1;
+        }
+
+        position += consumed;
+
+        if (i == 0)
+        {
+            hypertext_Header_Field field;
+            size_t count = 0;
+
+            hypertext_Fetch_Header_Field_Count(instance, &count);
+            if (count != 4 || hypertext_Fetch_Header_Field_At(instance, 2, &field) != hypertext_Result_Success || strcmp(field.key, "Accept") != 0 || strcmp(field.value, "a") != 0 || hypertext_Fetch_Header_Field_At(instance, 3, &field) != hypertext_Result_Success || strcmp(field.key, "Accept") != 0 || strcmp(field.value, "b") != 0)
+            {
+                printf("Error: The repeated field wasn't kept apart.\n");
+                return 1;
+            }
+
+            if (hypertext_Fetch_Header_Field_At(instance, 4, &field) != hypertext_Result_Not_Found)
+            {
+                printf("Error: A field past the end was found.\n");
+                return 1;
+            }
+        }
+
+        hypertext_Destroy(instance);
+    }
+
+    if (position != sizeof(pipeline) - 1)
+    {
+        printf("Error: The pipeline wasn't consumed entirely; %zu characters are left.\n", sizeof(pipeline) - 1 - position);
+        return 1;
+    }
+
+    const uint16_t codes[] = { 100, 204, 200, 200 };
+    const char* response_bodies[] = { NULL, NULL, "abc", "until the end" };
+    position = 0;
+
+    for (size_t i = 0; i != 4; i++)
+    {
+        size_t consumed = 0;
+        uint16_t code = 0;
+
+        uint8_t result = hypertext_Parse_Response_Buffer(instance, responses + position, sizeof(responses) - 1 - position, &consumed);
+        hypertext_Fetch_Code(instance, &code);
+        if (result != hypertext_Result_Success || code != codes[i] || check_body(instance, response_bodies[i]))
+        {
+            printf("Error: Response %zu returned %d with code %d or has the wrong body.\n", i, result, code);
+            return 1;
+        }
+
+        position += consumed;
+        hypertext_Destroy(instance);
+    }
+
+    for (size_t i = 0; i != sizeof(invalid) / sizeof(const char*); i++)
+    {
+        uint8_t result = hypertext_Parse_Request_Buffer(instance, invalid[i], strlen(invalid[i]), NULL);
+        if (result == hypertext_Result_Success || result == hypertext_Result_Incomplete)
+        {
+            printf("Error: Invalid request %zu returned %d.\n", i, result);
+            return 1;
+        }
+
+        result = hypertext_Parse_Request_Lazy(instance, invalid[i], strlen(invalid[i]), NULL);
+        if (result == hypertext_Result_Success || result == hypertext_Result_Incomplete)
+        {
+            printf("Error: Invalid request %zu returned %d when parsed lazily.\n", i, result);
+            return 1;
+        }
+    }
+
+    // Lazily parsed requests behave the same once their fields are looked at.
+    const char* lazy_bodies[] = { NULL, "a=1", NULL };
+    const size_t lazy_counts[] = { 3, 1, 0 };
+    position = 0;
+
+    for (size_t i = 0; i != 3; i++)
+    {
+        size_t consumed = 0, count = SIZE_MAX;
+        char path[16] = { 0 };
+        size_t path_length = sizeof(path) - 1;
+
+        uint8_t result = hypertext_Parse_Request_Lazy(instance, lazy + position, sizeof(lazy) - 1 - position, &consumed);
+        if (result != hypertext_Result_Success || check_body(instance, lazy_bodies[i]) || hypertext_Fetch_Path(instance, path, &path_length) != hypertext_Result_Success)
+        {
+            printf("Error: Lazy request %zu returned %d or has the wrong body.\n", i, result);
+            return 1;
+        }
+
+        hypertext_Fetch_Header_Field_Count(instance, &count);
+        if (count != lazy_counts[i])
+        {
+            printf("Error: Lazy request %zu has %zu fields.\n", i, count);
+            return 1;
+        }
+
+        if (i == 0)
+        {
+            char joined[4];
+            size_t joined_length = sizeof(joined);
+            hypertext_Header_Field added = { "X-Checked", "yes" };
+
+            if (strcmp(path, "/health") != 0 || hypertext_Fetch_Joined_Field(instance, "ACCEPT", 6, joined, &joined_length) != hypertext_Result_Success || joined_length != 4 || memcmp(joined, "a, b", 4) != 0)
+            {
+                printf("Error: The lazy request's fields weren't split like the others.\n");
+                return 1;
+            }
+
+            if (hypertext_Add_Field(instance, &added) != hypertext_Result_Success || hypertext_Fetch_Header_Field_Count(instance, &count) != hypertext_Result_Success || count != 4)
+            {
+                printf("Error: A field couldn't be added to the lazy request.\n");
+                return 1;
+            }
+        }
+
+        position += consumed;
+        hypertext_Destroy(instance);
+    }
+
+    // Requests that are destroyed untouched never split their fields at all.
+    if (hypertext_Parse_Request_Lazy(instance, lazy, sizeof(lazy) - 1, NULL) != hypertext_Result_Success)
+    {
+        printf("Error: The lazy request couldn't be parsed again.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    free(instance);
+
+    printf("Success.\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    const char* path;
+    const char* body;
+    bool        keep_alive;
+} case_t;
+
+const char* input =
+    "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+    "POST /b HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+    "GET /c HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"
+    "\r\nGET /d HTTP/1.1\r\nConnection: Keep-Alive, close\r\n\r\n"
+    "GET /e HTTP/1.1\r\n\r\n";
+
+const case_t cases[] =
+{
+    { "/a", NULL,       true },
+    { "/b", "hello",    true },
+    { "/c", NULL,       true },
+    { "/d", NULL,       false }
+};
+
+static bool check(hypertext_Instance* instance, const case_t* expected)
+{
+    char text[16] = { 0 };
+    size_t length = 0;
+
+    if (hypertext_Fetch_Path(instance, NULL, &length) != hypertext_Result_Success || length != strlen(expected->path)) return false;
+
+    hypertext_Fetch_Path(instance, text, &length);
+    if (memcmp(text, expected->path, length) != 0) return false;
+
+    uint8_t result = hypertext_Fetch_Body(instance, NULL, &length);
+    if (expected->body == NULL) return result == hypertext_Result_No_Body || (result == hypertext_Result_Success && length == 0);
+    else if (result != hypertext_Result_Success || length != strlen(expected->body)) return false;
+
+    hypertext_Fetch_Body(instance, text, &length);
+
+    return memcmp(text, expected->body, length) == 0;
+}
+
+int main()
+{
+    hypertext_Connection* connection = hypertext_New_Connection(1 << 16);
+    hypertext_Instance* instance = hypertext_New();
+    size_t found = 0, size = strlen(input);
+
+    // One byte at a time, so every message is split at every possible point.
+    for (size_t i = 0; i != size; i++)
+    {
+        char* space;
+        size_t length;
+
+        if (hypertext_Fetch_Connection_Space(connection, 1, &space, &length) != hypertext_Result_Success || length == 0)
+        {
+            printf("Error: hypertext_Fetch_Connection_Space failed.\n");
+            return 1;
+        }
+
+        *space = input[i];
+        hypertext_Commit_Connection(connection, 1);
+
+        bool keep_alive = false;
+        uint8_t result;
+
+        while ((result = hypertext_Next_Request(connection, instance, &keep_alive)) == hypertext_Result_Success)
+        {
+            if (found == sizeof(cases) / sizeof(case_t) || !check(instance, &cases[found]) || keep_alive != cases[found].keep_alive)
+            {
+                printf("Error: Request %zu doesn't match.\n", found);
+                return 1;
+            }
+
+            found++;
+            hypertext_Destroy(instance);
+        }
+
+        if (result != hypertext_Result_Incomplete && !(result == hypertext_Result_Not_Found && found == 4))
+        {
+            printf("Error: hypertext_Next_Request failed after %zu bytes; code %d.\n", i + 1, result);
+            return 1;
+        }
+    }
+
+    if (found != 4)
+    {
+        printf("Error: Only %zu requests were found.\n", found);
+        return 1;
+    }
+
+    hypertext_Destroy_Connection(connection);
+
+    // HTTP/1.0 closes by default; whatever follows is never parsed.
+    const char* closing = "GET /x HTTP/1.0\r\n\r\nGET /y HTTP/1.1\r\n\r\n";
+    bool keep_alive = true;
+
+    hypertext_Feed_Connection(connection, closing, strlen(closing));
+    if (hypertext_Next_Request(connection, instance, &keep_alive) != hypertext_Result_Success || keep_alive || hypertext_Next_Request(connection, NULL, NULL) != hypertext_Result_Invalid_Instance)
+    {
+        printf("Error: HTTP/1.0 was kept alive.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+    if (hypertext_Next_Request(connection, instance, &keep_alive) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A request after a closing one was parsed.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Connection(connection);
+
+    const char* malformed = "GET /x HTTP/1.1\r\nNo colon\r\n\r\n";
+    hypertext_Feed_Connection(connection, malformed, strlen(malformed));
+    if (hypertext_Next_Request(connection, instance, NULL) != hypertext_Result_Invalid_Parameters || hypertext_Next_Request(connection, instance, NULL) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A malformed request didn't stop the connection.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Connection(connection);
+    free(connection);
+
+    // Nothing beyond the limit is ever buffered.
+    connection = hypertext_New_Connection(32);
+
+    char* space;
+    size_t length;
+
+    if (hypertext_Feed_Connection(connection, closing, 20) != hypertext_Result_Success || hypertext_Fetch_Connection_Space(connection, 13, &space, &length) != hypertext_Result_Out_Of_Memory || hypertext_Fetch_Connection_Space(connection, 12, &space, &length) != hypertext_Result_Success || length != 12)
+    {
+        printf("Error: The buffer limit wasn't kept.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Connection(connection);
+    free(connection);
+    free(instance);
+
+    printf("Success.\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* patch_example       = "PATCH /items/7 HTTP/1.1\r\nHost: www.example.org\r\n\r\n";
+const char* extension_example   = "PROPFIND /collection HTTP/1.1\r\nHost: www.example.org\r\n\r\n";
+
+int main()
+{
+    uint8_t patch = hypertext_Method_Unknown;
+    if (hypertext_Register_Method("PATCH", 5, &patch) != hypertext_Result_Success || patch <= hypertext_Method_Max)
+    {
+        printf("Error: hypertext_Register_Method failed to register PATCH.\n");
+        return 1;
+    }
+
+    uint8_t again = hypertext_Method_Unknown;
+    if (hypertext_Register_Method("PATCH", 5, &again) != hypertext_Result_Already_Present || again != patch)
+    {
+        printf("Error: hypertext_Register_Method registered PATCH twice.\n");
+        return 1;
+    }
+
+    if (hypertext_Register_Method("GET", 3, &again) != hypertext_Result_Already_Present || again != hypertext_Method_GET)
+    {
+        printf("Error: hypertext_Register_Method didn't recognize GET.\n");
+        return 1;
+    }
+
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL)
+    {
+        printf("Error: The resulting instance was null.\n");
+        return 1;
+    }
+
+    uint8_t code = hypertext_Parse_Request(instance, patch_example, 0);
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed on a registered method; code %d.\n", code);
+        return code;
+    }
+
+    uint8_t method = hypertext_Method_Unknown;
+    hypertext_Fetch_Method(instance, &method);
+    if (method != patch)
+    {
+        printf("Error: The registered method wasn't recognized.\n");
+        return 1;
+    }
+
+    size_t length = 0;
+    hypertext_Output_Request(instance, NULL, &length, true);
+
+    char* output = calloc(length + 1, sizeof(char));
+    hypertext_Output_Request(instance, output, &length, true);
+
+    if (strncmp(output, "PATCH /items/7 HTTP/1.1", 23) != 0)
+    {
+        printf("Error: hypertext_Output_Request didn't emit the registered method.\n");
+        return 1;
+    }
+
+    free(output);
+    hypertext_Destroy(instance);
+
+    code = hypertext_Parse_Request(instance, extension_example, 0);
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed on an unregistered method; code %d.\n", code);
+        return code;
+    }
+
+    hypertext_View token;
+    hypertext_Fetch_Method(instance, &method);
+    hypertext_Fetch_Method_Token(instance, &token);
+    if (method != hypertext_Method_Extension || token.length != 8 || memcmp(token.data, "PROPFIND", 8) != 0)
+    {
+        printf("Error: The unregistered method token wasn't kept.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    if (hypertext_Parse_Request(instance, "GE(T / HTTP/1.1\r\n\r\n", 0) != hypertext_Result_Invalid_Method)
+    {
+        printf("Error: hypertext_Parse_Request accepted an invalid method token.\n");
+        return 1;
+    }
+
+    printf("Success.\n");
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* example = "GET /search?q=hyper+text&tag=c&page=2&tag=http&t%61g=parser&empty HTTP/1.1\r\nHost: www.example.org\r\n\r\n";
+
+static bool equals(hypertext_View* view, const char* text)
+{
+    return view->length == strlen(text) && memcmp(view->data, text, view->length) == 0;
+}
+
+int main()
+{
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL)
+    {
+        printf("Error: The resulting instance was null.\n");
+        return 1;
+    }
+
+    uint8_t code = hypertext_Parse_Request(instance, example, 0);
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed; code %d.\n", code);
+        return code;
+    }
+
+    size_t count = 0;
+    hypertext_Fetch_Parameter_Count(instance, hypertext_Parameter_Source_Query, &count);
+    if (count != 6)
+    {
+        printf("Error: Expected 6 query parameters, got %zu.\n", count);
+        return 1;
+    }
+
+    hypertext_Parameter parameter;
+    hypertext_Fetch_Parameter(instance, hypertext_Parameter_Source_Query, 0, &parameter);
+
+    char decoded[32];
+    size_t length = sizeof(decoded);
+    hypertext_Decode_View(&parameter.value, decoded, &length, true);
+    if (!equals(&parameter.name, "q") || length != 10 || memcmp(decoded, "hyper text", 10) != 0)
+    {
+        printf("Error: The first query parameter is incorrect.\n");
+        return 1;
+    }
+
+    const char* tags[3]     = { "c", "http", "parser" };
+    size_t index            = 0;
+    for (size_t i = 0; i != 3; i++, index++)
+    {
+        if (hypertext_Find_Parameter(instance, hypertext_Parameter_Source_Query, "tag", 3, &index) != hypertext_Result_Success)
+        {
+            printf("Error: Occurrence %zu of a repeated parameter wasn't found.\n", i);
+            return 1;
+        }
+
+        hypertext_Fetch_Parameter(instance, hypertext_Parameter_Source_Query, index, &parameter);
+        if (!equals(&parameter.value, tags[i]))
+        {
+            printf("Error: Occurrence %zu of a repeated parameter is incorrect.\n", i);
+            return 1;
+        }
+    }
+
+    if (hypertext_Find_Parameter(instance, hypertext_Parameter_Source_Query, "tag", 3, &index) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A repeated parameter was found too often.\n");
+        return 1;
+    }
+
+    index = 0;
+    if (hypertext_Find_Parameter(instance, hypertext_Parameter_Source_Query, "empty", 5, &index) != hypertext_Result_Success || index != 5)
+    {
+        printf("Error: A parameter without a value wasn't found.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    hypertext_Header_Field fields[1]    = { { "Content-Type", "application/x-www-form-urlencoded; charset=utf-8" } };
+    const char* body                    = "user=apfel&password=a%26b";
+
+    code = hypertext_Create_Request(instance, hypertext_Method_POST, "/login", 6, hypertext_HTTP_Version_1_1, fields, 1, body, strlen(body));
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Create_Request failed; code %d.\n", code);
+        return code;
+    }
+
+    index = 0;
+    hypertext_Find_Parameter(instance, hypertext_Parameter_Source_Body, "password", 8, &index);
+    hypertext_Fetch_Parameter(instance, hypertext_Parameter_Source_Body, index, &parameter);
+
+    length = sizeof(decoded);
+    hypertext_Decode_View(&parameter.value, decoded, &length, true);
+    if (length != 3 || memcmp(decoded, "a&b", 3) != 0)
+    {
+        printf("Error: The form body was parsed incorrectly.\n");
+        return 1;
+    }
+
+    printf("Success.\n");
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    return 0;
+}
@@ -71,6 +71,8 @@ int main()
 
     if (strcmp(example, output) == 0) printf("Warning: hypertext_Output_Request that's the same as the input.\n");
 
+    free(output);
+
     hypertext_Destroy(instance);
     free(instance);
 
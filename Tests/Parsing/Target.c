@@ -0,0 +1,105 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* example = "GET /files/a%20b.txt?name=J%C3%B6rg+Doe&sort=asc#top HTTP/1.1\r\nHost: www.example.org\r\n\r\n";
+
+static bool equals(hypertext_View* view, const char* text)
+{
+    return view->length == strlen(text) && memcmp(view->data, text, view->length) == 0;
+}
+
+int main()
+{
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL)
+    {
+        printf("Error: The resulting instance was null.\n");
+        return 1;
+    }
+
+    uint8_t code = hypertext_Parse_Request(instance, example, 0);
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed; code %d.\n", code);
+        return code;
+    }
+
+    hypertext_View path, query, fragment;
+    hypertext_Fetch_Target_Component(instance, hypertext_Target_Component_Path, &path);
+    hypertext_Fetch_Target_Component(instance, hypertext_Target_Component_Query, &query);
+    hypertext_Fetch_Target_Component(instance, hypertext_Target_Component_Fragment, &fragment);
+
+    if (!equals(&path, "/files/a%20b.txt") || !equals(&query, "name=J%C3%B6rg+Doe&sort=asc") || !equals(&fragment, "top"))
+    {
+        printf("Error: The request target was split incorrectly.\n");
+        return 1;
+    }
+
+    hypertext_View decoded;
+    hypertext_Fetch_Decoded_Target_Component(instance, hypertext_Target_Component_Path, &decoded);
+    if (!equals(&decoded, "/files/a b.txt"))
+    {
+        printf("Error: The path was decoded incorrectly.\n");
+        return 1;
+    }
+
+    hypertext_Fetch_Decoded_Target_Component(instance, hypertext_Target_Component_Query, &decoded);
+    if (!equals(&decoded, "name=J\xC3\xB6rg Doe&sort=asc"))
+    {
+        printf("Error: The query was decoded incorrectly.\n");
+        return 1;
+    }
+
+    hypertext_Fetch_Decoded_Target_Component(instance, hypertext_Target_Component_Fragment, &decoded);
+    if (decoded.data != fragment.data)
+    {
+        printf("Error: A fragment without escapes was copied.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(instance);
+
+    code = hypertext_Parse_Request(instance, "GET /plain HTTP/1.1\r\n\r\n", 0);
+    if (code != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Parse_Request failed; code %d.\n", code);
+        return code;
+    }
+
+    if (hypertext_Fetch_Target_Component(instance, hypertext_Target_Component_Query, &query) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A query was found in a target without one.\n");
+        return 1;
+    }
+
+    printf("Success.\n");
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    return 0;
+}
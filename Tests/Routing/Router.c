@@ -0,0 +1,156 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    uint8_t     method;
+    const char* pattern;
+} route;
+
+const route routes[] =
+{
+    { hypertext_Method_GET,     "/" },
+    { hypertext_Method_GET,     "/users" },
+    { hypertext_Method_GET,     "/users/me" },
+    { hypertext_Method_GET,     "/users/:id" },
+    { hypertext_Method_PUT,     "/users/:id" },
+    { hypertext_Method_GET,     "/users/:id/files/*path" },
+    { hypertext_Method_GET,     "/user-agents" },
+    { hypertext_Method_Unknown, "/static/*file" }
+};
+
+hypertext_Instance* instance = NULL;
+
+// The captures point into the request, so it is only destroyed once the next one gets parsed.
+static uint8_t match(hypertext_Router* router, const char* request, hypertext_Route_Match* output)
+{
+    hypertext_Destroy(instance);
+    hypertext_Parse_Request(instance, request, 0);
+
+    return hypertext_Match_Route(router, instance, output);
+}
+
+static bool equals(hypertext_View* view, const char* text)
+{
+    return view->length == strlen(text) && memcmp(view->data, text, view->length) == 0;
+}
+
+int main()
+{
+    hypertext_Router* router = hypertext_New_Router();
+    instance = hypertext_New();
+    if (router == NULL || instance == NULL)
+    {
+        printf("Error: The resulting router or instance was null.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i != sizeof(routes) / sizeof(route); i++) if (hypertext_Add_Route(router, routes[i].method, routes[i].pattern, strlen(routes[i].pattern), (void*)&routes[i]) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Add_Route failed for \"%s\".\n", routes[i].pattern);
+        return 1;
+    }
+
+    char pattern[32];
+    for (size_t i = 0; i != 1000; i++)
+    {
+        snprintf(pattern, sizeof(pattern), "/generated/%zu/:name", i);
+        hypertext_Add_Route(router, hypertext_Method_GET, pattern, strlen(pattern), NULL);
+    }
+
+    if (hypertext_Add_Route(router, hypertext_Method_GET, "/users", 6, NULL) != hypertext_Result_Already_Present)
+    {
+        printf("Error: A duplicate route was accepted.\n");
+        return 1;
+    }
+
+    if (hypertext_Compile_Router(router) != hypertext_Result_Success)
+    {
+        printf("Error: hypertext_Compile_Router failed.\n");
+        return 1;
+    }
+
+    hypertext_Route_Match result;
+
+    if (match(router, "GET /users/me HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || result.data != &routes[2] || result.capture_count != 0)
+    {
+        printf("Error: A static route didn't take priority.\n");
+        return 1;
+    }
+
+    if (match(router, "PUT /users/42?full=1 HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || result.data != &routes[4] || result.capture_count != 1 || !equals(&result.captures[0].name, "id") || !equals(&result.captures[0].value, "42"))
+    {
+        printf("Error: A parameter route didn't match.\n");
+        return 1;
+    }
+
+    if (match(router, "GET /users/42/files/a/b.txt HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || result.data != &routes[5] || result.capture_count != 2 || !equals(&result.captures[1].value, "a/b.txt"))
+    {
+        printf("Error: A wildcard route didn't match.\n");
+        return 1;
+    }
+
+    if (match(router, "POST /static/app.js HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || result.data != &routes[7])
+    {
+        printf("Error: A route accepting any method didn't match.\n");
+        return 1;
+    }
+
+    if (match(router, "GET /user-agents HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || result.data != &routes[6])
+    {
+        printf("Error: A route sharing a prefix didn't match.\n");
+        return 1;
+    }
+
+    if (match(router, "GET /generated/999/x HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Success || !equals(&result.captures[0].value, "x"))
+    {
+        printf("Error: A generated route didn't match.\n");
+        return 1;
+    }
+
+    if (match(router, "DELETE /users/42 HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Invalid_Method)
+    {
+        printf("Error: A route with another method matched.\n");
+        return 1;
+    }
+
+    if (match(router, "GET /nothing HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Not_Found || match(router, "GET /users/ HTTP/1.1\r\n\r\n", &result) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A missing route matched.\n");
+        return 1;
+    }
+
+    printf("Success.\n");
+
+    hypertext_Destroy(instance);
+    free(instance);
+
+    hypertext_Destroy_Router(router);
+    free(router);
+
+    return 0;
+}
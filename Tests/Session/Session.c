@@ -0,0 +1,352 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <hypertext.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    uint8_t         type;
+    uint8_t         flags;
+    uint32_t        stream;
+    const uint8_t*  payload;
+    size_t          length;
+} frame;
+
+char input[4096];
+size_t input_length = 0;
+
+hypertext_HPACK* encoder = NULL;
+hypertext_HPACK* decoder = NULL;
+
+static void add_frame(uint8_t type, uint8_t flags, uint32_t stream, const void* payload, size_t length)
+{
+    uint8_t header[9] = { (uint8_t)(length >> 16), (uint8_t)(length >> 8), (uint8_t)length, type, flags, (uint8_t)(stream >> 24), (uint8_t)(stream >> 16), (uint8_t)(stream >> 8), (uint8_t)stream };
+
+    memcpy(input + input_length, header, 9);
+    memcpy(input + input_length + 9, payload, length);
+    input_length += 9 + length;
+}
+
+static void add_headers(uint8_t flags, uint32_t stream, const hypertext_Header_Field* fields, size_t count)
+{
+    hypertext_View block;
+    hypertext_Encode_HPACK(encoder, fields, count, &block);
+
+    add_frame(1, flags, stream, block.data, block.length);
+}
+
+// Splits the drained output into frames.
+static size_t drain(hypertext_Session* session, frame* frames, size_t capacity)
+{
+    hypertext_View output;
+    if (hypertext_Drain_Session(session, &output) != hypertext_Result_Success) return 0;
+
+    const uint8_t* data = (const uint8_t*)output.data;
+    size_t count = 0;
+
+    for (size_t position = 0; position + 9 <= output.length && count != capacity; count++)
+    {
+        frames[count].length    = (size_t)data[position] << 16 | (size_t)data[position + 1] << 8 | data[position + 2];
+        frames[count].type      = data[position + 3];
+        frames[count].flags     = data[position + 4];
+        frames[count].stream    = (uint32_t)data[position + 5] << 24 | (uint32_t)data[position + 6] << 16 | (uint32_t)data[position + 7] << 8 | data[position + 8];
+        frames[count].payload   = data + position + 9;
+
+        position += 9 + frames[count].length;
+    }
+
+    return count;
+}
+
+static bool has_field(hypertext_Header_Field* fields, size_t count, const char* key, const char* value)
+{
+    for (size_t i = 0; i != count; i++) if (strcmp(fields[i].key, key) == 0) return value == NULL || strcmp(fields[i].value, value) == 0;
+
+    return false;
+}
+
+int main()
+{
+    hypertext_Session* session = hypertext_New_Session(1024);
+
+    encoder = hypertext_New_HPACK(4096);
+    decoder = hypertext_New_HPACK(4096);
+
+    if (session == NULL || encoder == NULL || decoder == NULL)
+    {
+        printf("Error: Failed to create the session.\n");
+        return 1;
+    }
+
+    memcpy(input, "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", 24);
+    input_length = 24;
+
+    // A tiny initial window forces the response body to wait for WINDOW_UPDATE frames.
+    const uint8_t settings[6] = { 0, 4, 0, 0, 0, 16 };
+    add_frame(4, 0, 0, settings, sizeof(settings));
+
+    hypertext_Header_Field get[] = { { ":method", "GET" }, { ":scheme", "https" }, { ":authority", "example.com" }, { ":path", "/index?x=1" }, { "accept", "*/*" } };
+    add_headers(0x05, 1, get, 5);
+
+    hypertext_Header_Field post[] = { { ":method", "POST" }, { ":scheme", "https" }, { ":authority", "example.com" }, { ":path", "/upload" } };
+    add_headers(0x04, 3, post, 4);
+    add_frame(0, 0x00, 3, "hel", 3);
+    add_frame(0, 0x01, 3, "lo", 2);
+
+    add_frame(6, 0, 0, "pingpong", 8);
+
+    // Feeding the input in two uneven parts checks that partial frames are kept.
+    if (hypertext_Feed_Session(session, input, 50) != hypertext_Result_Success || hypertext_Feed_Session(session, input + 50, input_length - 50) != hypertext_Result_Success)
+    {
+        printf("Error: Failed to feed the session.\n");
+        return 1;
+    }
+
+    uint32_t streams[2];
+    hypertext_Instance* requests[2];
+
+    for (uint8_t i = 0; i != 2; i++) if (hypertext_Fetch_Session_Request(session, &streams[i], &requests[i]) != hypertext_Result_Success)
+    {
+        printf("Error: Request %d is missing.\n", i);
+        return 1;
+    }
+
+    uint8_t method;
+    size_t length = 0;
+    char body[8] = { 0 };
+
+    hypertext_Fetch_Method(requests[0], &method);
+    hypertext_Fetch_Header_Field_Count(requests[0], &length);
+
+    if (streams[0] != 1 || method != hypertext_Method_GET || length != 2)
+    {
+        printf("Error: The first request has stream %u, method %d and %zu fields.\n", streams[0], method, length);
+        return 1;
+    }
+
+    hypertext_View path, query;
+    hypertext_Fetch_Target_Component(requests[0], hypertext_Target_Component_Path, &path);
+    hypertext_Fetch_Target_Component(requests[0], hypertext_Target_Component_Query, &query);
+
+    hypertext_Header_Field host;
+
+    if (path.length != 6 || memcmp(path.data, "/index", 6) != 0 || query.length != 3 || memcmp(query.data, "x=1", 3) != 0 || hypertext_Fetch_Header_Field(requests[0], &host, "host") != hypertext_Result_Success || strcmp(host.value, "example.com") != 0)
+    {
+        printf("Error: The first request's target or Host field is wrong.\n");
+        return 1;
+    }
+
+    hypertext_Fetch_Method(requests[1], &method);
+    length = 0;
+    hypertext_Fetch_Body(requests[1], NULL, &length);
+    hypertext_Fetch_Body(requests[1], body, &length);
+
+    if (streams[1] != 3 || method != hypertext_Method_POST || length != 5 || strcmp(body, "hello") != 0)
+    {
+        printf("Error: The second request has stream %u, method %d and body \"%s\".\n", streams[1], method, body);
+        return 1;
+    }
+    else if (hypertext_Fetch_Session_Request(session, &streams[0], &requests[0]) != hypertext_Result_Not_Found)
+    {
+        printf("Error: A request was returned twice.\n");
+        return 1;
+    }
+
+    frame frames[16];
+    size_t count = drain(session, frames, 16);
+
+    // Server SETTINGS, WINDOW_UPDATE widening the connection's window, SETTINGS acknowledgement, PING acknowledgement, WINDOW_UPDATE once the body was fetched.
+    const uint8_t expected[] = { 4, 8, 4, 6, 8 };
+
+    if (count != sizeof(expected))
+    {
+        printf("Error: Drained %zu frames instead of %zu.\n", count, sizeof(expected));
+        return 1;
+    }
+
+    for (size_t i = 0; i != count; i++) if (frames[i].type != expected[i])
+    {
+        printf("Error: Frame %zu has type %d instead of %d.\n", i, frames[i].type, expected[i]);
+        return 1;
+    }
+
+    if (frames[2].flags != 1 || frames[3].flags != 1 || memcmp(frames[3].payload, "pingpong", 8) != 0)
+    {
+        printf("Error: Missing acknowledgements.\n");
+        return 1;
+    }
+    else if (frames[4].stream != 0 || frames[4].payload[3] != 5)
+    {
+        printf("Error: The fetched body's credit wasn't given back.\n");
+        return 1;
+    }
+
+    hypertext_Header_Field fields[] = { { "Content-Type", "text/plain" }, { "Connection", "close" } };
+    const char* text = "0123456789abcdefghijklmnopqrstuvwxyz!?";
+
+    hypertext_Instance* response = hypertext_New();
+    hypertext_Create_Response(response, hypertext_HTTP_Version_1_1, hypertext_Status_OK, fields, 2, text, strlen(text));
+
+    if (hypertext_Submit_Session_Response(session, 1, response) != hypertext_Result_Success)
+    {
+        printf("Error: Failed to submit the first response.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(response);
+
+    count = drain(session, frames, 16);
+
+    hypertext_Header_Field* decoded;
+    size_t decoded_count;
+
+    if (count != 2 || frames[0].type != 1 || frames[0].flags != 0x04 || hypertext_Decode_HPACK(decoder, (const char*)frames[0].payload, frames[0].length, &decoded, &decoded_count) != hypertext_Result_Success)
+    {
+        printf("Error: The first response's header block is wrong.\n");
+        return 1;
+    }
+    else if (decoded_count != 2 || !has_field(decoded, decoded_count, ":status", "200") || !has_field(decoded, decoded_count, "content-type", "text/plain") || has_field(decoded, decoded_count, "connection", NULL))
+    {
+        printf("Error: The first response's fields are wrong.\n");
+        return 1;
+    }
+    else if (frames[1].type != 0 || frames[1].flags != 0 || frames[1].length != 16 || memcmp(frames[1].payload, text, 16) != 0)
+    {
+        printf("Error: The first DATA frame should stop at the window.\n");
+        return 1;
+    }
+
+    // Granting more credit sends the rest of the body.
+    input_length = 0;
+    const uint8_t increment[4] = { 0, 0, 0, 100 };
+    add_frame(8, 0, 1, increment, sizeof(increment));
+
+    hypertext_Feed_Session(session, input, input_length);
+    count = drain(session, frames, 16);
+
+    if (count != 1 || frames[0].type != 0 || frames[0].flags != 1 || frames[0].length != strlen(text) - 16 || memcmp(frames[0].payload, text + 16, frames[0].length) != 0)
+    {
+        printf("Error: The rest of the body wasn't sent.\n");
+        return 1;
+    }
+
+    hypertext_Create_Response(response, hypertext_HTTP_Version_1_1, hypertext_Status_No_Content, NULL, 0, NULL, 0);
+    hypertext_Submit_Session_Response(session, 3, response);
+
+    count = drain(session, frames, 16);
+    if (count != 1 || frames[0].type != 1 || frames[0].flags != 0x05 || hypertext_Submit_Session_Response(session, 3, response) != hypertext_Result_Not_Found)
+    {
+        printf("Error: The second response should end its stream.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(response);
+    free(response);
+
+    // Clients can't open even streams.
+    input_length = 0;
+    add_headers(0x05, 4, get, 5);
+
+    count = 0;
+    if (hypertext_Feed_Session(session, input, input_length) != hypertext_Result_Invalid_Parameters || (count = drain(session, frames, 16)) != 1 || frames[0].type != 7 || frames[0].payload[7] != hypertext_Session_Error_Protocol)
+    {
+        printf("Error: An even stream didn't fail the connection.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Session(session);
+    hypertext_Destroy_HPACK(encoder);
+    hypertext_Destroy_HPACK(decoder);
+
+    free(session);
+
+    // Bodies above the limit are answered with 413, and frames beyond the window reset their stream; both compression contexts start over.
+    session = hypertext_New_Session(8);
+
+    memcpy(input, "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", 24);
+    input_length = 24;
+
+    add_frame(4, 0, 0, NULL, 0);
+    add_headers(0x04, 1, post, 4);
+    add_frame(0, 0x00, 1, "hello", 5);
+    add_frame(0, 0x00, 1, "world", 5);
+
+    hypertext_Header_Field declared[] = { { ":method", "POST" }, { ":scheme", "https" }, { ":path", "/upload" }, { "content-length", "100" } };
+    add_headers(0x04, 3, declared, 4);
+
+    // Once the settings are acknowledged, each stream's window is the limit.
+    add_frame(4, 0x01, 0, NULL, 0);
+    add_headers(0x04, 5, post, 4);
+    add_frame(0, 0x00, 5, "123456789", 9);
+
+    if (hypertext_Feed_Session(session, input, input_length) != hypertext_Result_Success || hypertext_Fetch_Session_Request(session, &streams[0], &requests[0]) != hypertext_Result_Not_Found)
+    {
+        printf("Error: Failed to feed the limited session.\n");
+        return 1;
+    }
+
+    count = drain(session, frames, 16);
+
+    // Server SETTINGS, SETTINGS acknowledgement, then 413, credit and RST_STREAM for each stream; the last one didn't get to buffer anything.
+    const uint8_t limited[] = { 4, 4, 1, 8, 3, 1, 3, 8, 3 };
+    const uint8_t errors[] = { hypertext_Session_Error_None, hypertext_Session_Error_None, hypertext_Session_Error_Flow_Control };
+
+    if (count != sizeof(limited))
+    {
+        printf("Error: Drained %zu frames from the limited session instead of %zu.\n", count, sizeof(limited));
+        return 1;
+    }
+
+    for (size_t i = 0, reset = 0; i != count; i++)
+    {
+        if (frames[i].type != limited[i] || (frames[i].type == 3 && frames[i].payload[3] != errors[reset++]))
+        {
+            printf("Error: Frame %zu of the limited session has type %d instead of %d.\n", i, frames[i].type, limited[i]);
+            return 1;
+        }
+    }
+
+    if (frames[0].length != 12 || frames[0].payload[7] != 4 || frames[0].payload[11] != 8 || frames[2].flags != 0x05 || hypertext_Decode_HPACK(decoder, (const char*)frames[2].payload, frames[2].length, &decoded, &decoded_count) != hypertext_Result_Success || !has_field(decoded, decoded_count, ":status", "413"))
+    {
+        printf("Error: The limited session's window or 413 response is wrong.\n");
+        return 1;
+    }
+    else if (frames[3].payload[3] != 10 || frames[7].payload[3] != 9)
+    {
+        printf("Error: The refused bodies' credit wasn't given back.\n");
+        return 1;
+    }
+
+    hypertext_Destroy_Session(session);
+    hypertext_Destroy_HPACK(encoder);
+    hypertext_Destroy_HPACK(decoder);
+
+    free(session);
+    free(encoder);
+    free(decoder);
+
+    printf("Success.\n");
+    return 0;
+}
@@ -0,0 +1,569 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#define _GNU_SOURCE
+
+#include <hypertext.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+// Keeps requests in flight against a loopback server and records how long each took; in constant-throughput mode,
+// latency counts from when a request was due rather than when it was sent, so a stalled server can't hide its stalls.
+
+// Values are kept to about three significant digits: 2^11 linear sub-buckets per power of two, as HdrHistogram does.
+#define histogram_sub_bits  11
+#define histogram_sub_count (1 << histogram_sub_bits)
+#define histogram_half      (histogram_sub_count / 2)
+#define histogram_size      (histogram_sub_count + (64 - histogram_sub_bits) * histogram_half)
+
+#define load_events         256
+#define load_read_size      65536
+
+typedef struct
+{
+    uint64_t counts[histogram_size];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t maximum;
+} histogram;
+
+typedef struct
+{
+    int         descriptor;
+    char*       input;
+    size_t      input_length;
+    size_t      input_capacity;
+    char*       output;
+    size_t      output_length;
+    size_t      output_capacity;
+    size_t      output_sent;
+    uint64_t*   started;
+    size_t      first;
+    size_t      outstanding;
+    uint64_t    due;
+} connection;
+
+typedef struct
+{
+    pthread_t   thread;
+    connection* connections;
+    size_t      count;
+    histogram   latency;
+    uint64_t    responses;
+    uint64_t    failures;
+    uint64_t    errors;
+    uint64_t    received;
+    uint64_t    sent;
+    uint64_t    parse_time;
+    uint64_t    output_time;
+    size_t      offset;
+} loader;
+
+static struct
+{
+    char*       host;
+    char*       path;
+    uint16_t    port;
+    size_t      depth;
+    size_t      total;
+    uint64_t    interval;
+    uint64_t    duration;
+    size_t      request_length;
+} settings;
+
+static uint64_t now()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+}
+
+static size_t histogram_index(uint64_t value)
+{
+    if (value < histogram_sub_count) return (size_t)value;
+
+    size_t shift = (size_t)(63 - __builtin_clzll(value)) - (histogram_sub_bits - 1);
+
+    return histogram_sub_count + (shift - 1) * histogram_half + (size_t)(value >> shift) - histogram_half;
+}
+
+// The highest value that lands within the same bucket, which is what percentiles report.
+static uint64_t histogram_value(size_t index)
+{
+    if (index < histogram_sub_count) return index;
+
+    size_t shift = (index - histogram_sub_count) / histogram_half + 1;
+    uint64_t sub = (index - histogram_sub_count) % histogram_half + histogram_half;
+
+    return ((sub + 1) << shift) - 1;
+}
+
+static void histogram_record(histogram* target, uint64_t value)
+{
+    target->counts[histogram_index(value)]++;
+    target->total++;
+    target->sum += value;
+
+    if (value > target->maximum) target->maximum = value;
+}
+
+static void histogram_merge(histogram* target, const histogram* source)
+{
+    for (size_t i = 0; i != histogram_size; i++) target->counts[i] += source->counts[i];
+
+    target->total += source->total;
+    target->sum   += source->sum;
+
+    if (source->maximum > target->maximum) target->maximum = source->maximum;
+}
+
+static uint64_t histogram_percentile(const histogram* source, double percentile)
+{
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)source->total + 0.5), seen = 0;
+    if (rank == 0) rank = 1;
+
+    for (size_t i = 0; i != histogram_size; i++)
+    {
+        seen += source->counts[i];
+        if (seen >= rank) return histogram_value(i) < source->maximum ? histogram_value(i) : source->maximum;
+    }
+
+    return source->maximum;
+}
+
+static int open_connection()
+{
+    int descriptor = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (descriptor < 0) return -1;
+
+    struct sockaddr_in address = { .sin_family = AF_INET, .sin_port = htons(settings.port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    int enable = 1;
+
+    // Connecting blocks, which takes no time over loopback; everything after doesn't.
+    if (connect(descriptor, (struct sockaddr*)&address, sizeof(address)) != 0 || setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)) != 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+
+    return descriptor;
+}
+
+static void close_connection(loader* self, connection* target)
+{
+    if (target->descriptor >= 0) close(target->descriptor);
+
+    // Requests that were still in flight never get an answer.
+    self->errors           += target->outstanding;
+    target->descriptor      = -1;
+    target->input_length    = 0;
+    target->output_length   = 0;
+    target->output_sent     = 0;
+    target->first           = 0;
+    target->outstanding     = 0;
+}
+
+static bool reopen_connection(int poller, connection* target)
+{
+    target->descriptor = open_connection();
+    if (target->descriptor < 0) return false;
+
+    struct epoll_event event = { .events = EPOLLIN | EPOLLOUT | EPOLLET, .data.ptr = target };
+
+    return epoll_ctl(poller, EPOLL_CTL_ADD, target->descriptor, &event) == 0;
+}
+
+// Serializes one more request straight into the output buffer and remembers when it was due.
+static bool queue_request(loader* self, connection* target, hypertext_Instance* request, uint64_t started)
+{
+    if (target->output_length + settings.request_length > target->output_capacity)
+    {
+        size_t capacity = target->output_capacity * 2 + settings.request_length;
+        char* output = realloc(target->output, capacity);
+        if (output == NULL) return false;
+
+        target->output          = output;
+        target->output_capacity = capacity;
+    }
+
+    size_t length = settings.request_length;
+    uint64_t begin = now();
+
+    if (hypertext_Output_Request(request, target->output + target->output_length, &length, true) != hypertext_Result_Success) return false;
+
+    self->output_time += now() - begin;
+    self->sent++;
+
+    target->output_length += length;
+    target->started[(target->first + target->outstanding) % settings.depth] = started;
+    target->outstanding++;
+
+    return true;
+}
+
+static bool flush_connection(connection* target)
+{
+    while (target->output_sent != target->output_length)
+    {
+        ssize_t sent = send(target->descriptor, target->output + target->output_sent, target->output_length - target->output_sent, MSG_NOSIGNAL);
+
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            else if (errno == EINTR) continue;
+
+            return false;
+        }
+
+        target->output_sent += (size_t)sent;
+    }
+
+    target->output_length = target->output_sent = 0;
+
+    return true;
+}
+
+// Reads everything the socket holds and frames as many responses as it can; the rest waits for more input.
+static bool receive_responses(loader* self, connection* target, hypertext_Instance* response)
+{
+    for (;;)
+    {
+        if (target->input_length == target->input_capacity)
+        {
+            char* input = realloc(target->input, target->input_capacity * 2);
+            if (input == NULL) return false;
+
+            target->input           = input;
+            target->input_capacity *= 2;
+        }
+
+        ssize_t received = recv(target->descriptor, target->input + target->input_length, target->input_capacity - target->input_length, 0);
+
+        if (received == 0) return false;
+        else if (received < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            else if (errno == EINTR) continue;
+
+            return false;
+        }
+
+        target->input_length += (size_t)received;
+        self->received       += (uint64_t)received;
+    }
+
+    uint64_t arrived = now();
+    size_t offset = 0;
+
+    while (offset != target->input_length)
+    {
+        size_t consumed = 0;
+        uint8_t result = hypertext_Parse_Response_Buffer(response, target->input + offset, target->input_length - offset, &consumed);
+
+        if (result == hypertext_Result_Incomplete) break;
+        else if (result != hypertext_Result_Success || target->outstanding == 0) return false;
+
+        uint16_t code = 0;
+        hypertext_Fetch_Code(response, &code);
+        hypertext_Destroy(response);
+
+        if (code < 200 || code >= 400) self->failures++;
+
+        histogram_record(&self->latency, arrived - target->started[target->first]);
+
+        target->first = (target->first + 1) % settings.depth;
+        target->outstanding--;
+        self->responses++;
+
+        offset += consumed;
+    }
+
+    self->parse_time += now() - arrived;
+
+    memmove(target->input, target->input + offset, target->input_length - offset);
+    target->input_length -= offset;
+
+    return true;
+}
+
+static void* run(void* argument)
+{
+    loader* self = argument;
+
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    hypertext_Instance* request = hypertext_New();
+    hypertext_Instance* response = hypertext_New();
+
+    hypertext_Header_Field fields[] = { { .key = "Host", .value = settings.host } };
+
+    struct epoll_event wakeup = { .events = EPOLLIN, .data.ptr = NULL };
+
+    if (poller < 0 || timer < 0 || epoll_ctl(poller, EPOLL_CTL_ADD, timer, &wakeup) != 0 || request == NULL || response == NULL || hypertext_Create_Request(request, hypertext_Method_GET, settings.path, strlen(settings.path), hypertext_HTTP_Version_1_1, fields, 1, NULL, 0) != hypertext_Result_Success)
+    {
+        self->errors++;
+        goto done;
+    }
+
+    uint64_t start = now(), end = start + settings.duration;
+
+    for (size_t i = 0; i != self->count; i++)
+    {
+        connection* target = &self->connections[i];
+
+        target->descriptor      = -1;
+        target->input_capacity  = load_read_size;
+        target->input           = malloc(target->input_capacity);
+        target->started         = malloc(settings.depth * sizeof(uint64_t));
+
+        // Spread the schedules over one interval, so that not every connection sends at the same instant.
+        target->due = start + settings.interval * (self->offset + i) / settings.total;
+
+        if (target->input == NULL || target->started == NULL || !reopen_connection(poller, target))
+        {
+            fprintf(stderr, "Error: Couldn't connect to port %u.\n", settings.port);
+            self->errors++;
+            goto done;
+        }
+    }
+
+    struct epoll_event events[load_events];
+
+    for (uint64_t time = start; time < end; time = now())
+    {
+        if (settings.interval != 0)
+        {
+            uint64_t earliest = end;
+            for (size_t i = 0; i != self->count; i++) if (self->connections[i].outstanding < settings.depth && self->connections[i].due < earliest) earliest = self->connections[i].due;
+
+            // epoll only sleeps in milliseconds, which is too coarse for a schedule; the timer wakes the loop right when the next request is due.
+            struct itimerspec deadline = { .it_value = { .tv_sec = (time_t)(earliest / 1000000000), .tv_nsec = (long)(earliest % 1000000000) } };
+            if (earliest <= time) deadline.it_value = (struct timespec){ 0, 1 };
+
+            timerfd_settime(timer, TFD_TIMER_ABSTIME, &deadline, NULL);
+        }
+
+        int count = epoll_wait(poller, events, load_events, 10);
+
+        for (int i = 0; i < count; i++)
+        {
+            connection* target = events[i].data.ptr;
+
+            if (target == NULL)
+            {
+                // The timer only wakes the loop; whatever is due gets sent below.
+                uint64_t expirations;
+                ssize_t drained = read(timer, &expirations, sizeof(expirations));
+                (void)drained;
+                continue;
+            }
+            else if (target->descriptor < 0) continue;
+
+            bool healthy = !(events[i].events & (EPOLLERR | EPOLLHUP));
+
+            if (healthy && (events[i].events & EPOLLIN)) healthy = receive_responses(self, target, response);
+            if (healthy && (events[i].events & EPOLLOUT)) healthy = flush_connection(target);
+
+            if (!healthy) close_connection(self, target);
+        }
+
+        time = now();
+
+        for (size_t i = 0; i != self->count; i++)
+        {
+            connection* target = &self->connections[i];
+
+            if (target->descriptor < 0 && !reopen_connection(poller, target)) continue;
+
+            size_t queued = target->outstanding;
+
+            // A request that is due is counted from then on; if the pipeline is full, the time it waits is part of its latency.
+            if (settings.interval == 0) while (target->outstanding < settings.depth && queue_request(self, target, request, time));
+            else while (target->outstanding < settings.depth && target->due <= time && queue_request(self, target, request, target->due)) target->due += settings.interval;
+
+            if (target->outstanding != queued && !flush_connection(target)) close_connection(self, target);
+        }
+    }
+
+done:
+    for (size_t i = 0; i != self->count; i++)
+    {
+        if (self->connections[i].descriptor >= 0) close(self->connections[i].descriptor);
+
+        free(self->connections[i].input);
+        free(self->connections[i].output);
+        free(self->connections[i].started);
+    }
+
+    if (poller >= 0) close(poller);
+    if (timer >= 0) close(timer);
+
+    hypertext_Destroy(request);
+    hypertext_Destroy(response);
+    free(request);
+    free(response);
+
+    return NULL;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-c connections] [-t threads] [-d seconds] [-p pipelining] [-r requests per second] [port [path]]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    long connections = 64, threads = 1, seconds = 10, depth = 1;
+    double rate = 0;
+    int option;
+
+    while ((option = getopt(argc, argv, "c:t:d:p:r:")) != -1)
+    {
+        switch (option)
+        {
+        case 'c': connections = strtol(optarg, NULL, 10); break;
+        case 't': threads = strtol(optarg, NULL, 10); break;
+        case 'd': seconds = strtol(optarg, NULL, 10); break;
+        case 'p': depth = strtol(optarg, NULL, 10); break;
+        case 'r': rate = strtod(optarg, NULL); break;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    long port = optind < argc ? strtol(argv[optind], NULL, 10) : 8080;
+    settings.path = optind + 1 < argc ? argv[optind + 1] : "/";
+
+    if (port <= 0 || port > 65535 || threads <= 0 || connections < threads || seconds <= 0 || depth <= 0 || rate < 0 || settings.path[0] != '/')
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    static char host[32];
+    snprintf(host, sizeof(host), "127.0.0.1:%ld", port);
+
+    settings.host       = host;
+    settings.port       = (uint16_t)port;
+    settings.depth      = (size_t)depth;
+    settings.total      = (size_t)connections;
+    settings.duration   = (uint64_t)seconds * 1000000000;
+    settings.interval   = rate != 0 ? (uint64_t)(1e9 * (double)connections / rate) : 0;
+
+    // Every request is the same, so its length is known up front; each one is still serialized on its own.
+    hypertext_Instance* request = hypertext_New();
+    hypertext_Header_Field fields[] = { { .key = "Host", .value = settings.host } };
+
+    if (request == NULL || hypertext_Create_Request(request, hypertext_Method_GET, settings.path, strlen(settings.path), hypertext_HTTP_Version_1_1, fields, 1, NULL, 0) != hypertext_Result_Success || hypertext_Output_Request(request, NULL, &settings.request_length, true) != hypertext_Result_Success)
+    {
+        fprintf(stderr, "Error: The request couldn't be created.\n");
+        return 1;
+    }
+
+    hypertext_Destroy(request);
+    free(request);
+
+    loader* loaders = calloc((size_t)threads, sizeof(loader));
+    connection* pool = calloc((size_t)connections, sizeof(connection));
+
+    if (loaders == NULL || pool == NULL)
+    {
+        fprintf(stderr, "Error: The connections couldn't be allocated.\n");
+        return 1;
+    }
+
+    if (rate != 0) printf("Running for %lds against port %ld with %ld connections on %ld threads, pipelining %ld, at %.0f requests per second.\n", seconds, port, connections, threads, depth, rate);
+    else printf("Running for %lds against port %ld with %ld connections on %ld threads, pipelining %ld.\n", seconds, port, connections, threads, depth);
+
+    fflush(stdout);
+
+    uint64_t begin = now();
+
+    for (long i = 0, offset = 0; i != threads; i++)
+    {
+        long count = connections / threads + (i < connections % threads);
+
+        loaders[i].connections  = pool + offset;
+        loaders[i].count        = (size_t)count;
+        loaders[i].offset       = (size_t)offset;
+
+        pthread_create(&loaders[i].thread, NULL, run, &loaders[i]);
+        offset += count;
+    }
+
+    histogram* latency = calloc(1, sizeof(histogram));
+    uint64_t responses = 0, failures = 0, errors = 0, received = 0, parse_time = 0, output_time = 0, sent = 0;
+
+    for (long i = 0; i != threads; i++)
+    {
+        pthread_join(loaders[i].thread, NULL);
+
+        if (latency != NULL) histogram_merge(latency, &loaders[i].latency);
+
+        responses   += loaders[i].responses;
+        failures    += loaders[i].failures;
+        errors      += loaders[i].errors;
+        received    += loaders[i].received;
+        parse_time  += loaders[i].parse_time;
+        output_time += loaders[i].output_time;
+        sent        += loaders[i].sent;
+    }
+
+    double elapsed = (double)(now() - begin) / 1e9;
+
+    printf("Responses: %" PRIu64 " (%.0f per second, %.2f MB/s), outside 2xx and 3xx: %" PRIu64 ", errors: %" PRIu64 ".\n", responses, (double)responses / elapsed, (double)received / elapsed / 1e6, failures, errors);
+
+    if (latency != NULL && latency->total != 0)
+    {
+        static const double percentiles[] = { 50, 75, 90, 99, 99.9, 99.99, 100 };
+
+        printf("Latency: mean %.2fus, max %.2fus%s.\n", (double)latency->sum / (double)latency->total / 1e3, (double)latency->maximum / 1e3, rate != 0 ? ", counted from when each request was due" : "");
+
+        for (size_t i = 0; i != sizeof(percentiles) / sizeof(percentiles[0]); i++) printf("%10.3f%% %12.2fus\n", percentiles[i], (double)histogram_percentile(latency, percentiles[i]) / 1e3);
+    }
+
+    if (responses != 0 && sent != 0) printf("Client: %.0fns serializing per request, %.0fns parsing per response.\n", (double)output_time / (double)sent, (double)parse_time / (double)responses);
+
+    free(latency);
+    free(loaders);
+    free(pool);
+
+    return errors != 0;
+}
@@ -0,0 +1,304 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <hypertext.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Walks a capture of concatenated raw HTTP messages in place and reports what it contains and how fast it was parsed.
+
+#define replay_name_slots   4096
+#define replay_error_limit  10
+
+typedef struct
+{
+    char*   name;
+    size_t  length;
+    size_t  count;
+} name_entry;
+
+typedef struct
+{
+    size_t      requests;
+    size_t      responses;
+    size_t      errors;
+    size_t      methods[256];
+    char        method_names[256][32];
+    size_t      codes[1000];
+    name_entry  names[replay_name_slots];
+    size_t      name_count;
+    size_t      name_overflow;
+} statistics;
+
+static statistics stats;
+
+static char to_lower(char character)
+{
+    return character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+}
+
+// Counts a header name case-insensitively within an open-addressing table.
+static void count_name(const char* name)
+{
+    size_t length = strlen(name);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i != length; i++) hash = (hash ^ (uint8_t)to_lower(name[i])) * 16777619u;
+
+    for (size_t probe = 0; probe != replay_name_slots; probe++)
+    {
+        name_entry* entry = &stats.names[(hash + probe) % replay_name_slots];
+
+        if (entry->name == NULL)
+        {
+            // The table is kept at most half full, so probing stays short.
+            if (stats.name_count == replay_name_slots / 2) break;
+
+            entry->name = malloc(length + 1);
+            if (entry->name == NULL) break;
+
+            for (size_t i = 0; i != length; i++) entry->name[i] = to_lower(name[i]);
+            entry->name[length] = '\0';
+            entry->length       = length;
+            entry->count        = 1;
+
+            stats.name_count++;
+            return;
+        }
+        else if (entry->length == length)
+        {
+            size_t i = 0;
+            while (i != length && entry->name[i] == to_lower(name[i])) i++;
+
+            if (i == length)
+            {
+                entry->count++;
+                return;
+            }
+        }
+    }
+
+    stats.name_overflow++;
+}
+
+static void count_message(hypertext_Instance* instance, bool request)
+{
+    if (request)
+    {
+        uint8_t method = hypertext_Method_Unknown;
+        hypertext_View token = { NULL, 0 };
+
+        stats.requests++;
+        hypertext_Fetch_Method(instance, &method);
+
+        if (stats.methods[method]++ == 0 && hypertext_Fetch_Method_Token(instance, &token) == hypertext_Result_Success)
+        {
+            size_t length = token.length < sizeof(stats.method_names[0]) - 1 ? token.length : sizeof(stats.method_names[0]) - 1;
+            memcpy(stats.method_names[method], token.data, length);
+        }
+    }
+    else
+    {
+        uint16_t code = 0;
+
+        stats.responses++;
+        hypertext_Fetch_Code(instance, &code);
+
+        if (code < 1000) stats.codes[code]++;
+    }
+
+    size_t field_count = 0;
+    hypertext_Fetch_Header_Field_Count(instance, &field_count);
+
+    for (size_t i = 0; i != field_count; i++)
+    {
+        hypertext_Header_Field field;
+        if (hypertext_Fetch_Header_Field_At(instance, i, &field) == hypertext_Result_Success) count_name(field.key);
+    }
+}
+
+static int compare_names(const void* first, const void* second)
+{
+    const name_entry* a = first;
+    const name_entry* b = second;
+
+    return a->count < b->count ? 1 : a->count > b->count ? -1 : 0;
+}
+
+// Finds the end of the next head, to get back on track after a message that couldn't be parsed.
+static size_t resynchronize(const char* data, size_t position, size_t size)
+{
+    while (position < size)
+    {
+        const char* newline = memchr(data + position, '\n', size - position);
+        if (newline == NULL) return size;
+
+        position = (size_t)(newline - data) + 1;
+
+        if (position < size && data[position] == '\n') return position + 1;
+        else if (position + 1 < size && data[position] == '\r' && data[position + 1] == '\n') return position + 2;
+    }
+
+    return size;
+}
+
+static double elapsed_seconds(const struct timespec* start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <capture> [header names to list]\n", argv[0]);
+        return 1;
+    }
+
+    size_t listed = argc > 2 ? strtoul(argv[2], NULL, 10) : 20;
+
+    int descriptor = open(argv[1], O_RDONLY);
+    struct stat status;
+
+    if (descriptor < 0 || fstat(descriptor, &status) != 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    size_t size = (size_t)status.st_size;
+    const char* data = NULL;
+
+    if (size != 0)
+    {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            perror("mmap");
+            return 1;
+        }
+
+        // The capture is read front to back exactly once.
+        madvise((void*)data, size, MADV_SEQUENTIAL);
+    }
+
+    hypertext_Instance* instance = hypertext_New();
+    if (instance == NULL)
+    {
+        fprintf(stderr, "Error: The instance couldn't be allocated.\n");
+        return 1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t position = 0;
+    while (position < size)
+    {
+        // Skip the empty lines between messages to tell requests from responses.
+        size_t first = position;
+        while (first < size && (data[first] == '\r' || data[first] == '\n')) first++;
+
+        if (first == size)
+        {
+            position = size;
+            break;
+        }
+
+        bool request = size - first < 5 || memcmp(data + first, "HTTP/", 5) != 0;
+        size_t consumed = 0;
+
+        uint8_t result = request ? hypertext_Parse_Request_Buffer(instance, data + position, size - position, &consumed) : hypertext_Parse_Response_Buffer(instance, data + position, size - position, &consumed);
+        if (result == hypertext_Result_Success)
+        {
+            count_message(instance, request);
+            hypertext_Destroy(instance);
+
+            position += consumed;
+            continue;
+        }
+        else if (result == hypertext_Result_Incomplete) break;
+
+        if (stats.errors++ < replay_error_limit) fprintf(stderr, "Error: The %s at offset %zu couldn't be parsed; code %d.\n", request ? "request" : "response", first, result);
+
+        position = resynchronize(data, first, size);
+    }
+
+    double seconds = elapsed_seconds(&start);
+    size_t messages = stats.requests + stats.responses;
+
+    printf("Parsed %zu messages (%zu requests, %zu responses) from %zu bytes in %.3f s.\n", messages, stats.requests, stats.responses, position, seconds);
+    if (seconds > 0) printf("Throughput: %.1f MiB/s, %.0f messages/s.\n", (double)position / seconds / (1024 * 1024), (double)messages / seconds);
+    if (stats.errors != 0) printf("Errors: %zu.\n", stats.errors);
+    if (position != size) printf("Incomplete: the last %zu bytes don't form a whole message.\n", size - position);
+
+    if (stats.requests != 0)
+    {
+        printf("\nMethods:\n");
+        for (size_t i = 0; i != 256; i++) if (stats.methods[i] != 0) printf("  %-12s %zu\n", stats.method_names[i][0] != '\0' ? stats.method_names[i] : "(unknown)", stats.methods[i]);
+    }
+
+    if (stats.responses != 0)
+    {
+        printf("\nStatus codes:\n");
+        for (size_t i = 0; i != 1000; i++) if (stats.codes[i] != 0) printf("  %-12zu %zu\n", i, stats.codes[i]);
+    }
+
+    if (stats.name_count != 0 && listed != 0)
+    {
+        name_entry* names = malloc(stats.name_count * sizeof(name_entry));
+        size_t count = 0;
+
+        for (size_t i = 0; names != NULL && i != replay_name_slots; i++) if (stats.names[i].name != NULL) names[count++] = stats.names[i];
+
+        if (names != NULL)
+        {
+            qsort(names, count, sizeof(name_entry), compare_names);
+
+            printf("\nHeader fields (%zu distinct):\n", stats.name_count);
+            for (size_t i = 0; i != count && i != listed; i++) printf("  %-32s %zu\n", names[i].name, names[i].count);
+        }
+
+        if (stats.name_overflow != 0) printf("  (%zu fields with further names weren't counted)\n", stats.name_overflow);
+
+        free(names);
+    }
+
+    for (size_t i = 0; i != replay_name_slots; i++) free(stats.names[i].name);
+
+    free(instance);
+    if (size != 0) munmap((void*)data, size);
+    close(descriptor);
+
+    return stats.errors != 0;
+}
@@ -0,0 +1,470 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#define _GNU_SOURCE
+
+#include "Server.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+// Serves a fixed response from one loop per thread; every thread has its own SO_REUSEPORT listener, so the kernel spreads connections across cores.
+// The loops use io_uring where the kernel supports it, and edge-triggered epoll otherwise.
+
+#define server_events 256
+
+static const char server_body[]         = "Hello, World!\n";
+static const char server_not_found[]    = "Not Found\n";
+static const char server_not_allowed[]  = "Method Not Allowed\n";
+
+volatile sig_atomic_t server_stopping = 0;
+
+typedef struct
+{
+    int                     descriptor;
+    hypertext_Connection*   input;
+    output_queue            output;
+    bool                    closing;
+} client;
+
+static void stop(int signal)
+{
+    (void)signal;
+    server_stopping = 1;
+}
+
+static int open_listener(uint16_t port)
+{
+    int descriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (descriptor < 0) return -1;
+
+    int enable = 1;
+    setsockopt(descriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in address = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY) };
+
+    if (setsockopt(descriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0 || bind(descriptor, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(descriptor, SOMAXCONN) != 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+
+    return descriptor;
+}
+
+// Serializes the head of a response into the head buffer and queues it along with the body, which isn't copied.
+bool queue_response(output_queue* output, hypertext_Instance* request, bool keep_alive)
+{
+    uint8_t method = 0, version = hypertext_HTTP_Version_1_1;
+    hypertext_View path = { NULL, 0 }, date;
+
+    hypertext_Fetch_Method(request, &method);
+    hypertext_Fetch_Version(request, &version);
+    hypertext_Fetch_Target_Component(request, hypertext_Target_Component_Path, &path);
+    hypertext_Fetch_Current_Date(&date);
+
+    uint16_t code = hypertext_Status_OK;
+    const char* body = server_body;
+    size_t body_length = sizeof(server_body) - 1;
+
+    hypertext_Header_Field fields[5] =
+    {
+        { "Server",         "hypertext" },
+        { "Date",           (char*)date.data },
+        { "Content-Type",   "text/plain" }
+    };
+    size_t field_count = 3;
+
+    if (method != hypertext_Method_GET && method != hypertext_Method_HEAD)
+    {
+        code        = hypertext_Status_Method_Not_Allowed;
+        body        = server_not_allowed;
+        body_length = sizeof(server_not_allowed) - 1;
+
+        fields[field_count++] = (hypertext_Header_Field){ "Allow", "GET, HEAD" };
+    }
+    else if (path.length != 1 || path.data[0] != '/')
+    {
+        code        = hypertext_Status_Not_Found;
+        body        = server_not_found;
+        body_length = sizeof(server_not_found) - 1;
+    }
+
+    if (!keep_alive) fields[field_count++] = (hypertext_Header_Field){ "Connection", "close" };
+    else if (version == hypertext_HTTP_Version_1_0) fields[field_count++] = (hypertext_Header_Field){ "Connection", "keep-alive" };
+
+    hypertext_Instance* instance = hypertext_New();
+    size_t length = 0;
+    bool success = false;
+
+    if (instance != NULL && hypertext_Create_Response(instance, version, code, fields, field_count, body, body_length) == hypertext_Result_Success && hypertext_Output_Response_Head(instance, NULL, &length, true, true) == hypertext_Result_Success)
+    {
+        if (output->heads_capacity - output->heads_length < length + 1)
+        {
+            size_t capacity = output->heads_capacity != 0 ? output->heads_capacity : 1024;
+            while (capacity - output->heads_length < length + 1) capacity *= 2;
+
+            char* heads = realloc(output->heads, capacity);
+            if (heads != NULL)
+            {
+                output->heads           = heads;
+                output->heads_capacity  = capacity;
+            }
+        }
+
+        if (output->piece_count == output->piece_capacity)
+        {
+            size_t capacity = output->piece_capacity != 0 ? output->piece_capacity * 2 : 16;
+
+            piece* pieces = realloc(output->pieces, capacity * sizeof(piece));
+            if (pieces != NULL)
+            {
+                output->pieces          = pieces;
+                output->piece_capacity  = capacity;
+            }
+        }
+
+        if (output->heads_capacity - output->heads_length >= length + 1 && output->piece_count != output->piece_capacity && hypertext_Output_Response_Head(instance, output->heads + output->heads_length, &length, true, true) == hypertext_Result_Success)
+        {
+            // A response to HEAD announces the body's length without carrying it.
+            output->pieces[output->piece_count++] = (piece){ output->heads_length, length, body, method == hypertext_Method_HEAD ? 0 : body_length };
+            output->heads_length += length;
+
+            success = true;
+        }
+    }
+
+    if (instance != NULL)
+    {
+        hypertext_Destroy(instance);
+        free(instance);
+    }
+
+    return success;
+}
+
+size_t queued_bytes(output_queue* output)
+{
+    size_t total = 0;
+
+    for (size_t i = output->first; i != output->piece_count; i++) total += output->pieces[i].head_length + output->pieces[i].body_length;
+
+    return total - output->sent;
+}
+
+// Points vectors at what's left to send, heads and bodies alike; returns how many were used.
+size_t gather_output(output_queue* output, struct iovec* vectors, size_t capacity)
+{
+    size_t count = 0, skip = output->sent;
+
+    for (size_t i = output->first; i != output->piece_count && count + 2 <= capacity; i++)
+    {
+        piece* current = &output->pieces[i];
+        const char* parts[2] = { output->heads + current->head_offset, current->body };
+        size_t lengths[2] = { current->head_length, current->body_length };
+
+        for (size_t j = 0; j != 2; j++)
+        {
+            if (skip >= lengths[j])
+            {
+                skip -= lengths[j];
+                continue;
+            }
+
+            vectors[count++] = (struct iovec){ (void*)(parts[j] + skip), lengths[j] - skip };
+            skip = 0;
+        }
+    }
+
+    return count;
+}
+
+// Marks bytes as sent; true once everything went out, and the queue starts over.
+bool advance_output(output_queue* output, size_t written)
+{
+    size_t remaining = output->sent + written;
+
+    while (output->first != output->piece_count)
+    {
+        piece* current = &output->pieces[output->first];
+        size_t length = current->head_length + current->body_length;
+
+        if (remaining < length) break;
+
+        remaining -= length;
+        output->first++;
+    }
+
+    output->sent = remaining;
+
+    if (output->first != output->piece_count) return false;
+
+    output->first        = 0;
+    output->piece_count  = 0;
+    output->heads_length = 0;
+    output->sent         = 0;
+
+    return true;
+}
+
+void release_output(output_queue* output)
+{
+    free(output->heads);
+    free(output->pieces);
+}
+
+static void close_client(client* connection)
+{
+    close(connection->descriptor);
+
+    hypertext_Destroy_Connection(connection->input);
+    free(connection->input);
+    release_output(&connection->output);
+    free(connection);
+}
+
+// Sends as much of the queued output as the socket takes, gathering heads and bodies into one writev call each time.
+static bool flush(client* connection)
+{
+    while (connection->output.first != connection->output.piece_count)
+    {
+        struct iovec vectors[server_iovecs];
+        size_t count = gather_output(&connection->output, vectors, server_iovecs);
+
+        ssize_t written = writev(connection->descriptor, vectors, (int)count);
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        advance_output(&connection->output, (size_t)written);
+    }
+
+    return true;
+}
+
+// Reads until the socket is drained, answering every complete request; false once the client should be closed.
+static bool serve(worker* self, client* connection)
+{
+    hypertext_Instance* request = hypertext_New();
+    if (request == NULL) return false;
+
+    bool open = true;
+
+    while (open && !connection->closing && queued_bytes(&connection->output) < server_output_limit)
+    {
+        char* space;
+        size_t available;
+
+        if (hypertext_Fetch_Connection_Space(connection->input, server_read_size, &space, &available) != hypertext_Result_Success)
+        {
+            // The head doesn't fit into the input limit.
+            self->errors++;
+            open = false;
+            break;
+        }
+
+        ssize_t received = recv(connection->descriptor, space, available, 0);
+        if (received < 0)
+        {
+            if (errno == EINTR) continue;
+
+            open = errno == EAGAIN || errno == EWOULDBLOCK;
+            break;
+        }
+        else if (received == 0)
+        {
+            open = false;
+            break;
+        }
+
+        hypertext_Commit_Connection(connection->input, (size_t)received);
+
+        bool keep_alive = false;
+        uint8_t result;
+
+        while ((result = hypertext_Next_Request(connection->input, request, &keep_alive)) == hypertext_Result_Success)
+        {
+            self->requests++;
+
+            if (!queue_response(&connection->output, request, keep_alive)) open = false;
+            else if (!keep_alive) connection->closing = true;
+
+            hypertext_Destroy(request);
+        }
+
+        if (result != hypertext_Result_Incomplete && result != hypertext_Result_Not_Found)
+        {
+            self->errors++;
+            open = false;
+        }
+    }
+
+    free(request);
+
+    if (!flush(connection)) return false;
+
+    // A closing client is done once its last response went out.
+    return open && !(connection->closing && connection->output.piece_count == 0);
+}
+
+static void run_epoll(worker* self)
+{
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    if (poller < 0) return;
+
+    struct epoll_event event = { .events = EPOLLIN | EPOLLET, .data.ptr = NULL };
+    epoll_ctl(poller, EPOLL_CTL_ADD, self->listener, &event);
+
+    struct epoll_event events[server_events];
+
+    while (!server_stopping)
+    {
+        int count = epoll_wait(poller, events, server_events, 500);
+
+        for (int i = 0; i < count; i++)
+        {
+            client* connection = events[i].data.ptr;
+
+            if (connection == NULL)
+            {
+                int descriptor;
+
+                while ((descriptor = accept4(self->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                {
+                    int enable = 1;
+                    setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+                    connection = calloc(1, sizeof(client));
+                    if (connection == NULL || (connection->input = hypertext_New_Connection(server_input_limit)) == NULL)
+                    {
+                        free(connection);
+                        close(descriptor);
+                        continue;
+                    }
+
+                    connection->descriptor = descriptor;
+
+                    // Both directions are watched from the start; edge triggering only reports changes.
+                    struct epoll_event client_event = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, .data.ptr = connection };
+                    epoll_ctl(poller, EPOLL_CTL_ADD, descriptor, &client_event);
+
+                    self->connections++;
+                }
+
+                continue;
+            }
+
+            bool open = !(events[i].events & EPOLLERR);
+
+            if (open && (events[i].events & EPOLLOUT)) open = flush(connection);
+
+            // Anything left to read is read once the output drained, even if only EPOLLOUT fired.
+            if (open && queued_bytes(&connection->output) < server_output_limit) open = serve(self, connection);
+            else if (open && connection->closing && connection->output.piece_count == 0) open = false;
+
+            if (!open) close_client(connection);
+        }
+    }
+
+    close(poller);
+}
+
+static void* run(void* argument)
+{
+    worker* self = argument;
+
+    // Kernels without the required io_uring features fall back to epoll.
+    if (self->uring && !run_uring(self)) self->uring = false;
+    if (!self->uring) run_epoll(self);
+
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    long port = argc > 1 ? strtol(argv[1], NULL, 10) : 8080;
+    long threads = argc > 2 ? strtol(argv[2], NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    const char* backend = argc > 3 ? argv[3] : "uring";
+
+    if (port <= 0 || port > 65535 || threads <= 0 || (strcmp(backend, "uring") != 0 && strcmp(backend, "epoll") != 0))
+    {
+        fprintf(stderr, "Usage: %s [port] [threads] [uring|epoll]\n", argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    worker* workers = calloc((size_t)threads, sizeof(worker));
+    if (workers == NULL)
+    {
+        fprintf(stderr, "Error: The workers couldn't be allocated.\n");
+        return 1;
+    }
+
+    for (long i = 0; i != threads; i++)
+    {
+        workers[i].port     = (uint16_t)port;
+        workers[i].uring    = strcmp(backend, "uring") == 0;
+        workers[i].listener = open_listener((uint16_t)port);
+
+        if (workers[i].listener < 0)
+        {
+            perror("listen");
+            return 1;
+        }
+    }
+
+    for (long i = 0; i != threads; i++) pthread_create(&workers[i].thread, NULL, run, &workers[i]);
+
+    printf("Listening on port %ld with %ld threads.\n", port, threads);
+    fflush(stdout);
+
+    size_t connections = 0, requests = 0, errors = 0, uring = 0;
+
+    for (long i = 0; i != threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        close(workers[i].listener);
+
+        connections += workers[i].connections;
+        requests    += workers[i].requests;
+        errors      += workers[i].errors;
+        uring       += workers[i].uring;
+    }
+
+    printf("Connections: %zu, requests: %zu, errors: %zu, threads using io_uring: %zu.\n", connections, requests, errors, uring);
+
+    free(workers);
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef hypertext_SERVER
+#define hypertext_SERVER
+
+#include <hypertext.h>
+
+#include <signal.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+// Shared between the epoll and io_uring loops of hypertext_server.
+
+#define server_iovecs           64
+#define server_read_size        16384
+#define server_input_limit      (1 << 20)
+
+// Reading stops while this much output is queued, so a client that doesn't read can't make the server buffer without bound.
+#define server_output_limit     (4 << 20)
+
+typedef struct
+{
+    size_t      head_offset;
+    size_t      head_length;
+    const char* body;
+    size_t      body_length;
+} piece;
+
+// Serialized heads plus the bodies they announce; bodies are static and never copied.
+typedef struct
+{
+    char*   heads;
+    size_t  heads_length;
+    size_t  heads_capacity;
+    piece*  pieces;
+    size_t  piece_count;
+    size_t  piece_capacity;
+    size_t  first;
+    size_t  sent;
+} output_queue;
+
+typedef struct
+{
+    pthread_t   thread;
+    uint16_t    port;
+    int         listener;
+    bool        uring;
+    size_t      connections;
+    size_t      requests;
+    size_t      errors;
+} worker;
+
+extern volatile sig_atomic_t server_stopping;
+
+bool queue_response(output_queue* output, hypertext_Instance* request, bool keep_alive);
+size_t queued_bytes(output_queue* output);
+size_t gather_output(output_queue* output, struct iovec* vectors, size_t capacity);
+bool advance_output(output_queue* output, size_t written);
+void release_output(output_queue* output);
+
+bool run_uring(worker* self);
+
+#endif
@@ -0,0 +1,538 @@
+// This file is part of the hypertext project.
+//
+// Copyright (c) 2020-2021 Apfel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software.
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#define _GNU_SOURCE
+
+#include "Server.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+// Serves clients through io_uring, using the raw system calls: one multishot accept, multishot receives into a buffer ring registered with the kernel,
+// and sends that are submitted along with everything else once per loop iteration, however many clients were answered.
+
+#define uring_entries       1024
+#define uring_completions   8192
+#define uring_buffer_count  1024
+#define uring_buffer_size   4096
+#define uring_buffer_group  0
+
+// The kind of operation is kept within the low bits of the client's address.
+enum
+{
+    uring_accept,
+    uring_receive,
+    uring_send,
+    uring_shutdown
+};
+
+typedef struct
+{
+    int                     descriptor;
+    hypertext_Connection*   input;
+    output_queue            queues[2];
+    size_t                  sending;
+    struct iovec            vectors[server_iovecs];
+    struct msghdr           message;
+    size_t                  operations;
+    bool                    receiving;
+    bool                    in_flight;
+    bool                    closing;
+    bool                    finished;
+} uring_client;
+
+typedef struct
+{
+    int                         descriptor;
+    int                         enter_descriptor;
+    unsigned                    enter_flags;
+    unsigned*                   sq_head;
+    unsigned*                   sq_tail;
+    unsigned                    sq_mask;
+    unsigned                    sq_entries;
+    struct io_uring_sqe*        sqes;
+    unsigned*                   cq_head;
+    unsigned*                   cq_tail;
+    unsigned                    cq_mask;
+    struct io_uring_cqe*        cqes;
+    unsigned                    queued;
+    void*                       rings;
+    size_t                      rings_size;
+    size_t                      sqes_size;
+    struct io_uring_buf_ring*   buffers;
+    size_t                      buffers_size;
+    char*                       buffer_memory;
+    uint16_t                    buffer_tail;
+} uring;
+
+static int uring_enter(uring* ring, unsigned submit, unsigned wait, unsigned flags, void* argument, size_t size)
+{
+    return (int)syscall(__NR_io_uring_enter, ring->enter_descriptor, submit, wait, flags | ring->enter_flags, argument, size);
+}
+
+static int uring_register(int descriptor, unsigned opcode, void* argument, unsigned count)
+{
+    return (int)syscall(__NR_io_uring_register, descriptor, opcode, argument, count);
+}
+
+static void uring_close(uring* ring)
+{
+    if (ring->buffers != NULL) munmap(ring->buffers, ring->buffers_size);
+    if (ring->sqes != NULL) munmap(ring->sqes, ring->sqes_size);
+    if (ring->rings != NULL) munmap(ring->rings, ring->rings_size);
+
+    free(ring->buffer_memory);
+    close(ring->descriptor);
+}
+
+// Multishot receives came with the same kernel as zero-copy sends, so probing for the latter tells whether the former work.
+static bool uring_probe(int descriptor)
+{
+    static const uint8_t required[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_SHUTDOWN, IORING_OP_SEND_ZC };
+
+    struct io_uring_probe* probe = calloc(1, sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op));
+    if (probe == NULL) return false;
+
+    bool supported = uring_register(descriptor, IORING_REGISTER_PROBE, probe, 256) >= 0;
+
+    for (size_t i = 0; supported && i != sizeof(required); i++) supported = required[i] <= probe->last_op && (probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED);
+
+    free(probe);
+
+    return supported;
+}
+
+static void uring_provide(uring* ring, uint16_t id)
+{
+    struct io_uring_buf* buffer = &ring->buffers->bufs[ring->buffer_tail & (uring_buffer_count - 1)];
+
+    buffer->addr = (uint64_t)(uintptr_t)(ring->buffer_memory + (size_t)id * uring_buffer_size);
+    buffer->len  = uring_buffer_size;
+    buffer->bid  = id;
+
+    ring->buffer_tail++;
+}
+
+static void uring_publish(uring* ring)
+{
+    __atomic_store_n(&ring->buffers->tail, ring->buffer_tail, __ATOMIC_RELEASE);
+}
+
+static bool uring_open(uring* ring)
+{
+    memset(ring, 0, sizeof(uring));
+
+    struct io_uring_params parameters = { .flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN, .cq_entries = uring_completions };
+
+    ring->descriptor = (int)syscall(__NR_io_uring_setup, uring_entries, &parameters);
+    if (ring->descriptor < 0 && errno == EINVAL)
+    {
+        // Deferred task running is newer than everything else used here.
+        memset(&parameters, 0, sizeof(parameters));
+        parameters.flags      = IORING_SETUP_CQSIZE;
+        parameters.cq_entries = uring_completions;
+
+        ring->descriptor = (int)syscall(__NR_io_uring_setup, uring_entries, &parameters);
+    }
+
+    if (ring->descriptor < 0) return false;
+
+    ring->enter_descriptor = ring->descriptor;
+
+    if (!(parameters.features & IORING_FEAT_SINGLE_MMAP) || !(parameters.features & IORING_FEAT_EXT_ARG) || !uring_probe(ring->descriptor))
+    {
+        uring_close(ring);
+        return false;
+    }
+
+    size_t submission_size = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+    size_t completion_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+
+    ring->rings_size = submission_size > completion_size ? submission_size : completion_size;
+    ring->sqes_size  = parameters.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->rings = mmap(NULL, ring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQ_RING);
+    ring->sqes  = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQES);
+
+    if (ring->rings == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        if (ring->rings == MAP_FAILED) ring->rings = NULL;
+        if (ring->sqes == MAP_FAILED) ring->sqes = NULL;
+
+        uring_close(ring);
+        return false;
+    }
+
+    char* rings = ring->rings;
+
+    ring->sq_head    = (unsigned*)(rings + parameters.sq_off.head);
+    ring->sq_tail    = (unsigned*)(rings + parameters.sq_off.tail);
+    ring->sq_mask    = *(unsigned*)(rings + parameters.sq_off.ring_mask);
+    ring->sq_entries = parameters.sq_entries;
+    ring->cq_head    = (unsigned*)(rings + parameters.cq_off.head);
+    ring->cq_tail    = (unsigned*)(rings + parameters.cq_off.tail);
+    ring->cq_mask    = *(unsigned*)(rings + parameters.cq_off.ring_mask);
+    ring->cqes       = (struct io_uring_cqe*)(rings + parameters.cq_off.cqes);
+
+    // Every submission queue slot always refers to the entry of the same index.
+    unsigned* array = (unsigned*)(rings + parameters.sq_off.array);
+    for (unsigned i = 0; i != parameters.sq_entries; i++) array[i] = i;
+
+    // Receives pick their memory out of this ring, so idle clients don't hold any.
+    ring->buffers_size  = uring_buffer_count * sizeof(struct io_uring_buf);
+    ring->buffers       = mmap(NULL, ring->buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buffer_memory = aligned_alloc(4096, (size_t)uring_buffer_count * uring_buffer_size);
+
+    if (ring->buffers == MAP_FAILED) ring->buffers = NULL;
+
+    struct io_uring_buf_reg registration = { .ring_addr = (uint64_t)(uintptr_t)ring->buffers, .ring_entries = uring_buffer_count, .bgid = uring_buffer_group };
+
+    if (ring->buffers == NULL || ring->buffer_memory == NULL || uring_register(ring->descriptor, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        uring_close(ring);
+        return false;
+    }
+
+    for (uint16_t i = 0; i != uring_buffer_count; i++) uring_provide(ring, i);
+    uring_publish(ring);
+
+    // A registered ring descriptor saves looking it up on every io_uring_enter; it's optional.
+    struct io_uring_rsrc_update update = { .offset = UINT32_MAX, .data = (uint64_t)ring->descriptor };
+    if (uring_register(ring->descriptor, IORING_REGISTER_RING_FDS, &update, 1) == 1)
+    {
+        ring->enter_descriptor = (int)update.offset;
+        ring->enter_flags      = IORING_ENTER_REGISTERED_RING;
+    }
+
+    return true;
+}
+
+static struct io_uring_sqe* uring_sqe(uring* ring, uring_client* client, uint8_t kind)
+{
+    unsigned tail = *ring->sq_tail;
+
+    // A full queue is submitted right away; the kernel copies entries out on submission.
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->sq_entries)
+    {
+        int submitted = uring_enter(ring, ring->queued, 0, 0, NULL, 0);
+        if (submitted > 0) ring->queued -= (unsigned)submitted;
+    }
+
+    struct io_uring_sqe* entry = &ring->sqes[tail & ring->sq_mask];
+    memset(entry, 0, sizeof(struct io_uring_sqe));
+    entry->user_data = (uint64_t)(uintptr_t)client | kind;
+
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+
+    return entry;
+}
+
+static void uring_arm_accept(uring* ring, int listener)
+{
+    struct io_uring_sqe* entry = uring_sqe(ring, NULL, uring_accept);
+
+    entry->opcode       = IORING_OP_ACCEPT;
+    entry->fd           = listener;
+    entry->ioprio       = IORING_ACCEPT_MULTISHOT;
+    entry->accept_flags = SOCK_CLOEXEC;
+}
+
+static void uring_arm_receive(uring* ring, uring_client* client)
+{
+    struct io_uring_sqe* entry = uring_sqe(ring, client, uring_receive);
+
+    entry->opcode    = IORING_OP_RECV;
+    entry->fd        = client->descriptor;
+    entry->ioprio    = IORING_RECV_MULTISHOT;
+    entry->flags     = IOSQE_BUFFER_SELECT;
+    entry->buf_group = uring_buffer_group;
+
+    client->receiving = true;
+    client->operations++;
+}
+
+// Stops the client; the multishot receive ends on its own once the socket is shut down.
+static void uring_finish(uring_client* client)
+{
+    if (client->finished) return;
+
+    client->finished = true;
+    shutdown(client->descriptor, SHUT_RDWR);
+}
+
+static void uring_release(uring_client* client)
+{
+    if (!client->finished || client->operations != 0) return;
+
+    close(client->descriptor);
+
+    hypertext_Destroy_Connection(client->input);
+    free(client->input);
+    release_output(&client->queues[0]);
+    release_output(&client->queues[1]);
+    free(client);
+}
+
+// Sends one queue at a time while the other one fills; the last response of a closing client is linked to a shutdown.
+static void uring_send_output(uring* ring, uring_client* client)
+{
+    if (client->in_flight || client->finished) return;
+
+    output_queue* output = &client->queues[client->sending];
+    if (output->piece_count == 0)
+    {
+        client->sending ^= 1;
+        output = &client->queues[client->sending];
+
+        if (output->piece_count == 0) return;
+    }
+
+    size_t count = gather_output(output, client->vectors, server_iovecs), total = 0;
+    for (size_t i = 0; i != count; i++) total += client->vectors[i].iov_len;
+
+    bool last = client->closing && total == queued_bytes(output) && client->queues[client->sending ^ 1].piece_count == 0;
+
+    memset(&client->message, 0, sizeof(struct msghdr));
+    client->message.msg_iov    = client->vectors;
+    client->message.msg_iovlen = count;
+
+    struct io_uring_sqe* entry = uring_sqe(ring, client, uring_send);
+
+    entry->opcode    = IORING_OP_SENDMSG;
+    entry->fd        = client->descriptor;
+    entry->addr      = (uint64_t)(uintptr_t)&client->message;
+    entry->msg_flags = MSG_NOSIGNAL;
+
+    client->in_flight = true;
+    client->operations++;
+
+    if (last)
+    {
+        // Waiting for everything keeps a short send from letting the shutdown run early.
+        entry->msg_flags |= MSG_WAITALL;
+        entry->flags     |= IOSQE_IO_LINK;
+
+        entry = uring_sqe(ring, client, uring_shutdown);
+        entry->opcode = IORING_OP_SHUTDOWN;
+        entry->fd     = client->descriptor;
+        entry->len    = SHUT_RDWR;
+
+        client->operations++;
+    }
+}
+
+// Answers every complete request within received bytes, parsing straight out of the kernel's buffer while nothing is left over from before.
+static void uring_process(worker* self, uring* ring, uring_client* client, hypertext_Instance* request, const char* data, size_t length)
+{
+    size_t position = 0, buffered = 0;
+    bool keep_alive = true;
+    uint8_t result = hypertext_Result_Success;
+
+    output_queue* output = &client->queues[client->in_flight ? client->sending ^ 1 : client->sending];
+
+    hypertext_Fetch_Connection_Length(client->input, &buffered);
+
+    while (buffered == 0 && keep_alive && position != length)
+    {
+        size_t consumed = 0;
+
+        result = hypertext_Parse_Request_Buffer(request, data + position, length - position, &consumed);
+        if (result != hypertext_Result_Success) break;
+
+        hypertext_Fetch_Keep_Alive(request, &keep_alive);
+
+        self->requests++;
+        if (!queue_response(output, request, keep_alive)) result = hypertext_Result_Out_Of_Memory;
+
+        hypertext_Destroy(request);
+        position += consumed;
+
+        if (result != hypertext_Result_Success) break;
+    }
+
+    if (keep_alive && (result == hypertext_Result_Success || result == hypertext_Result_Incomplete) && position != length)
+    {
+        result = hypertext_Feed_Connection(client->input, data + position, length - position);
+
+        while (result == hypertext_Result_Success && (result = hypertext_Next_Request(client->input, request, &keep_alive)) == hypertext_Result_Success)
+        {
+            self->requests++;
+            if (!queue_response(output, request, keep_alive)) result = hypertext_Result_Out_Of_Memory;
+
+            hypertext_Destroy(request);
+            if (!keep_alive) break;
+        }
+    }
+
+    if (!keep_alive) client->closing = true;
+    else if (result != hypertext_Result_Success && result != hypertext_Result_Incomplete)
+    {
+        self->errors++;
+        uring_finish(client);
+        return;
+    }
+
+    // Pipelining without reading the responses gets the client dropped instead of buffered for.
+    if (queued_bytes(&client->queues[0]) + queued_bytes(&client->queues[1]) > server_output_limit)
+    {
+        self->errors++;
+        uring_finish(client);
+        return;
+    }
+
+    uring_send_output(ring, client);
+}
+
+static void uring_complete(worker* self, uring* ring, hypertext_Instance* request, struct io_uring_cqe* completion)
+{
+    uring_client* client = (uring_client*)(uintptr_t)(completion->user_data & ~(uint64_t)3);
+    uint8_t kind = (uint8_t)(completion->user_data & 3);
+    bool more = completion->flags & IORING_CQE_F_MORE;
+
+    if (kind == uring_accept)
+    {
+        if (completion->res >= 0)
+        {
+            int enable = 1;
+            setsockopt(completion->res, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+            client = calloc(1, sizeof(uring_client));
+            if (client == NULL || (client->input = hypertext_New_Connection(server_input_limit)) == NULL)
+            {
+                free(client);
+                close(completion->res);
+            }
+            else
+            {
+                client->descriptor = completion->res;
+                uring_arm_receive(ring, client);
+
+                self->connections++;
+            }
+        }
+
+        if (!more) uring_arm_accept(ring, self->listener);
+    }
+    else if (kind == uring_receive)
+    {
+        if (!more)
+        {
+            client->receiving = false;
+            client->operations--;
+        }
+
+        if (completion->res > 0 && (completion->flags & IORING_CQE_F_BUFFER))
+        {
+            uint16_t id = (uint16_t)(completion->flags >> IORING_CQE_BUFFER_SHIFT);
+
+            if (!client->closing && !client->finished) uring_process(self, ring, client, request, ring->buffer_memory + (size_t)id * uring_buffer_size, (size_t)completion->res);
+
+            uring_provide(ring, id);
+        }
+        else if (completion->res != -ENOBUFS) uring_finish(client);
+
+        // A multishot receive also ends when the buffer ring ran dry; it's armed again, as the buffers come back with this batch.
+        if (!client->receiving && !client->finished) uring_arm_receive(ring, client);
+    }
+    else if (kind == uring_send)
+    {
+        client->in_flight = false;
+        client->operations--;
+
+        if (completion->res < 0) uring_finish(client);
+        else
+        {
+            advance_output(&client->queues[client->sending], (size_t)completion->res);
+            uring_send_output(ring, client);
+        }
+    }
+    else
+    {
+        // The shutdown is cancelled along with a failed send; the socket still has to be shut down to end the receive.
+        if (completion->res < 0) shutdown(client->descriptor, SHUT_RDWR);
+
+        client->operations--;
+        client->finished = true;
+    }
+
+    if (kind != uring_accept) uring_release(client);
+}
+
+bool run_uring(worker* self)
+{
+    uring ring;
+    if (!uring_open(&ring)) return false;
+
+    hypertext_Instance* request = hypertext_New();
+    if (request == NULL)
+    {
+        uring_close(&ring);
+        return false;
+    }
+
+    uring_arm_accept(&ring, self->listener);
+
+    while (!server_stopping)
+    {
+        struct __kernel_timespec timeout = { .tv_sec = 0, .tv_nsec = 500000000 };
+        struct io_uring_getevents_arg argument = { .ts = (uint64_t)(uintptr_t)&timeout };
+
+        // One system call submits every queued operation and waits for completions.
+        int submitted = uring_enter(&ring, ring.queued, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument, sizeof(argument));
+        if (submitted > 0) ring.queued -= (unsigned)submitted;
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++)
+        {
+            struct io_uring_cqe* completion = &ring.cqes[head & ring.cq_mask];
+
+            // Kernels without multishot accepts reject it before any client came in; epoll takes over then.
+            if ((completion->user_data & 3) == uring_accept && completion->res == -EINVAL && self->connections == 0)
+            {
+                free(request);
+                uring_close(&ring);
+
+                return false;
+            }
+
+            uring_complete(self, &ring, request, completion);
+        }
+
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+        uring_publish(&ring);
+    }
+
+    free(request);
+    uring_close(&ring);
+
+    return true;
+}